@@ -574,7 +574,7 @@ void drawInstances(RenderingContext & rc, Mesh* m, uint32_t firstElement, uint32
 			indexBuffer.bind(GL_ELEMENT_ARRAY_BUFFER);
 			
 			glDrawElementsInstanced(m->getGLDrawMode(), elementCount > 0 ? std::min(elementCount,id.getIndexCount()) : id.getIndexCount(), 
-					GL_UNSIGNED_INT, reinterpret_cast<void*>(sizeof(GLuint)*firstElement), instanceCount);
+					id.getUploadedIndexType(), reinterpret_cast<void*>(getGLTypeSize(id.getUploadedIndexType())*firstElement), instanceCount);
 					
 			indexBuffer.unbind(GL_ELEMENT_ARRAY_BUFFER);
 			id._swapBufferObject(indexBuffer);
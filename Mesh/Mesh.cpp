@@ -11,8 +11,10 @@
 #include "Mesh.h"
 #include "MeshDataStrategy.h"
 #include "VertexDescription.h"
+#include "../MeshUtils/TriangleBVH.h"
 #include "../RenderingContext/RenderingContext.h"
 #include "../GLHeader.h"
+#include "../Helper.h"
 #include <Util/IO/FileName.h>
 #include <Util/ReferenceCounter.h>
 #include <algorithm>
@@ -25,20 +27,27 @@ static_assert(GL_TRIANGLES<256 && GL_LINES<256 && GL_POINTS<256 && GL_LINE_STRIP
 			"Constants for Mesh's triangleMode are expected to fit into a single byte; This should be true on all platforms."); 
 
 Mesh::Mesh() :
-		ReferenceCounter_t(), fileName(), dataStrategy(MeshDataStrategy::getDefaultStrategy()),drawMode(DRAW_TRIANGLES), useIndexData(true) {
+		ReferenceCounter_t(), fileName(), dataStrategy(MeshDataStrategy::getDefaultStrategy()),
+		triangleBVH(), triangleBVHVertexRevision(0), triangleBVHIndexRevision(0), drawMode(DRAW_TRIANGLES), useIndexData(true) {
 }
 
 Mesh::Mesh(MeshIndexData meshIndexData, MeshVertexData meshVertexData) :
 		ReferenceCounter_t(), indexData(std::move(meshIndexData)), fileName(), vertexData(std::move(meshVertexData)), 
-		dataStrategy(MeshDataStrategy::getDefaultStrategy()), drawMode(DRAW_TRIANGLES), useIndexData(true) {
+		dataStrategy(MeshDataStrategy::getDefaultStrategy()),
+		triangleBVH(), triangleBVHVertexRevision(0), triangleBVHIndexRevision(0), drawMode(DRAW_TRIANGLES), useIndexData(true) {
 }
 
 Mesh::Mesh(const VertexDescription & desc, uint32_t vertexCount, uint32_t indexCount) :
-		ReferenceCounter_t(), fileName(), dataStrategy(MeshDataStrategy::getDefaultStrategy()), drawMode(DRAW_TRIANGLES), useIndexData(true) {
+		ReferenceCounter_t(), fileName(), dataStrategy(MeshDataStrategy::getDefaultStrategy()),
+		triangleBVH(), triangleBVHVertexRevision(0), triangleBVHIndexRevision(0), drawMode(DRAW_TRIANGLES), useIndexData(true) {
 	indexData.allocate(indexCount);
 	vertexData.allocate(vertexCount, desc);
 }
 
+Mesh::Mesh(const Mesh &) = default;
+Mesh::Mesh(Mesh &&) = default;
+Mesh::~Mesh() = default;
+
 Mesh * Mesh::clone()const{
 	return new Mesh(*this);
 }
@@ -52,15 +61,18 @@ void Mesh::swap(Mesh & m){
 	swap(fileName, m.fileName);
 	swap(drawMode, m.drawMode);
 	swap(useIndexData, m.useIndexData);
+	swap(triangleBVH, m.triangleBVH);
+	swap(triangleBVHVertexRevision, m.triangleBVHVertexRevision);
+	swap(triangleBVHIndexRevision, m.triangleBVHIndexRevision);
 }
 
 size_t Mesh::getMainMemoryUsage() const {
-	return sizeof(Mesh) + indexData.dataSize() + vertexData.dataSize();
+	return sizeof(Mesh) + indexData.dataSize() + vertexData.dataSize() + (triangleBVH.isNull() ? 0 : triangleBVH->getMemoryUsage());
 }
 
 size_t Mesh::getGraphicsMemoryUsage() const {
-	return 	(indexData.isUploaded() ? indexData.getIndexCount() * sizeof(uint32_t) : 0)
-			+ (vertexData.isUploaded() ? vertexData.getVertexCount() * vertexData.getVertexDescription().getVertexSize() : 0);
+	return 	(indexData.isUploaded() ? indexData.getIndexCount() * getGLTypeSize(indexData.getUploadedIndexType()) : 0)
+			+ (vertexData.isUploaded() ? vertexData.getVertexDescription().getDataSize(vertexData.getVertexCount()) : 0);
 }
 
 void Mesh::_display(RenderingContext & context,uint32_t firstElement,uint32_t elementCount) {
@@ -98,6 +110,18 @@ MeshVertexData & Mesh::openVertexData(){
 	return vertexData;
 }
 
+MeshUtils::TriangleBVH * Mesh::_getTriangleBVH() const {
+	if(triangleBVHVertexRevision != vertexData.getRevision() || triangleBVHIndexRevision != indexData.getRevision())
+		return nullptr;
+	return triangleBVH.get();
+}
+
+void Mesh::_setTriangleBVH(MeshUtils::TriangleBVH * bvh) {
+	triangleBVH = bvh;
+	triangleBVHVertexRevision = vertexData.getRevision();
+	triangleBVHIndexRevision = indexData.getRevision();
+}
+
 void Mesh::setDataStrategy(MeshDataStrategy * newStrategy) {
 	dataStrategy = newStrategy;
 }
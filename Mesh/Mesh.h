@@ -14,6 +14,7 @@
 #include "MeshIndexData.h"
 #include "MeshVertexData.h"
 #include <Util/ReferenceCounter.h>
+#include <Util/References.h>
 #include <Util/TypeNameMacro.h>
 #include <Util/IO/FileName.h>
 #include <cstddef>
@@ -29,6 +30,9 @@ namespace Rendering{
 class MeshDataStrategy;
 class VertexDescription;
 class RenderingContext;
+namespace MeshUtils {
+class TriangleBVH;
+}
 
 //! @addtogroup rendering_resources
 //! @{
@@ -75,8 +79,9 @@ class Mesh : public Util::ReferenceCounter<Mesh> {
 		Mesh();
 		Mesh(MeshIndexData meshIndexData, MeshVertexData meshVertexData);
 		Mesh(const VertexDescription & desc,uint32_t vertexCount,uint32_t indexCount);
-		Mesh(const Mesh &) = default;
-		Mesh(Mesh &&) = default;
+		Mesh(const Mesh &);
+		Mesh(Mesh &&);
+		~Mesh();
 
 		Mesh* clone()const;
 
@@ -199,6 +204,22 @@ class Mesh : public Util::ReferenceCounter<Mesh> {
 		MeshDataStrategy * dataStrategy;
 	// @}
 
+	/*!	@name Triangle BVH */
+	// @{
+	public:
+		/*! (internal) Return the cached triangle BVH, or nullptr if there is none or if the
+			vertex or index data has been marked as changed since it was set.
+			\note In most cases: MeshUtils::TriangleBVH::get(mesh) is what you want. */
+		MeshUtils::TriangleBVH * _getTriangleBVH() const;
+		//! (internal) Cache the given triangle BVH for the current vertex and index data.
+		void _setTriangleBVH(MeshUtils::TriangleBVH * bvh);
+
+	private:
+		Util::Reference<MeshUtils::TriangleBVH> triangleBVH;
+		uint32_t triangleBVHVertexRevision;
+		uint32_t triangleBVHIndexRevision;
+	// @}
+
 
 
 	/*!	@name DrawMode */
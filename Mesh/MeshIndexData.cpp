@@ -13,34 +13,57 @@
 #include "../Helper.h"
 #include <Util/Macros.h>
 #include <algorithm>
+#include <atomic>
 #include <limits>
 #include <stdexcept>
 #include <utility>
 
 namespace Rendering {
 
+//! Return the smallest index type not smaller than @p minType that can hold @p maxIndex.
+static uint32_t selectIndexType(uint32_t minType, uint32_t maxIndex) {
+	if(minType == GL_UNSIGNED_BYTE && maxIndex <= std::numeric_limits<uint8_t>::max())
+		return GL_UNSIGNED_BYTE;
+	if(minType != GL_UNSIGNED_INT && maxIndex <= std::numeric_limits<uint16_t>::max())
+		return GL_UNSIGNED_SHORT;
+	return GL_UNSIGNED_INT;
+}
+
 /*! (ctor)  */
 MeshIndexData::MeshIndexData() :
-			indexCount(0), minIndex(0), maxIndex(0),
-			bufferObject(), dataChanged(false) {
+			indexCount(0), indexArray(), externalData(), minIndex(0), maxIndex(0),
+			minIndexType(GL_UNSIGNED_SHORT), indexType(GL_UNSIGNED_SHORT), uploadedIndexType(GL_UNSIGNED_INT),
+			bufferObject(), dataChanged(false), revision(0) {
 }
 
 /*! (ctor)  */
 MeshIndexData::MeshIndexData(const MeshIndexData & other) :
 			indexCount(other.getIndexCount()), 
 			minIndex(other.getMinIndex()), maxIndex(other.getMaxIndex()),
-			bufferObject(), dataChanged(true) {
+			minIndexType(other.minIndexType), indexType(other.indexType), uploadedIndexType(GL_UNSIGNED_INT),
+			bufferObject(), dataChanged(true), revision(other.revision) {
 	if(other.hasLocalData()) {
-		indexArray = other.indexArray;
+		indexArray.assign(other.data(), other.data() + other.getIndexCount());
 	} else if(other.isUploaded()) {
-		other.downloadTo(indexArray);
+		std::vector<uint32_t> downloadedIndices;
+		other.downloadTo(downloadedIndices);
+		indexArray.assign(downloadedIndices.begin(), downloadedIndices.end());
 	} else {
 		WARN("Cannot access index data."); // should not happen
 	}
 }
 
+//! Source of the revisions of all index data.
+static std::atomic<uint32_t> revisionCounter(0);
+
+void MeshIndexData::markAsChanged() {
+	dataChanged = true;
+	revision = ++revisionCounter;
+}
+
 //!(internal)
 void MeshIndexData::releaseLocalData(){
+	externalData.reset();
 	indexArray.clear();
 	indexArray.shrink_to_fit();
 }
@@ -53,27 +76,93 @@ void MeshIndexData::swap(MeshIndexData & other){
 	swap(indexCount, other.indexCount);
 	swap(minIndex, other.minIndex);
 	swap(maxIndex, other.maxIndex);
+	swap(minIndexType, other.minIndexType);
+	swap(indexType, other.indexType);
+	swap(uploadedIndexType, other.uploadedIndexType);
 	swap(bufferObject, other.bufferObject);
 	swap(dataChanged, other.dataChanged);
+	swap(revision, other.revision);
 	swap(indexArray, other.indexArray);
+	swap(externalData, other.externalData);
 }
 
-void MeshIndexData::allocate(uint32_t count) {
+void MeshIndexData::allocate(uint32_t count, bool initialize) {
 	indexCount = count;
-	indexArray.resize(indexCount, std::numeric_limits<uint32_t>::max());
+	externalData.reset();
+	if(initialize)
+		indexArray.resize(indexCount, std::numeric_limits<uint32_t>::max());
+	else
+		indexArray.resize(indexCount);
 	indexArray.shrink_to_fit();
 	markAsChanged();
 }
 
+void MeshIndexData::setExternalData(uint32_t count, std::shared_ptr<uint32_t> memory) {
+	indexCount = count;
+	indexArray.clear();
+	indexArray.shrink_to_fit();
+	externalData = std::move(memory);
+	markAsChanged();
+}
+
+void MeshIndexData::writePacked(uint32_t type, uint8_t * destination) const {
+	switch(type) {
+		case GL_UNSIGNED_BYTE:
+			std::copy(data(), data() + indexCount, destination);
+			break;
+		case GL_UNSIGNED_SHORT:
+			std::copy(data(), data() + indexCount, reinterpret_cast<uint16_t *>(destination));
+			break;
+		case GL_UNSIGNED_INT:
+			std::copy(data(), data() + indexCount, reinterpret_cast<uint32_t *>(destination));
+			break;
+		default:
+			throw std::invalid_argument("MeshIndexData::writePacked: Invalid index type.");
+	}
+}
+
+void MeshIndexData::readPacked(uint32_t type, const uint8_t * source) {
+	switch(type) {
+		case GL_UNSIGNED_BYTE:
+			std::copy(source, source + indexCount, data());
+			break;
+		case GL_UNSIGNED_SHORT:
+			std::copy(reinterpret_cast<const uint16_t *>(source), reinterpret_cast<const uint16_t *>(source) + indexCount, data());
+			break;
+		case GL_UNSIGNED_INT:
+			std::copy(reinterpret_cast<const uint32_t *>(source), reinterpret_cast<const uint32_t *>(source) + indexCount, data());
+			break;
+		default:
+			throw std::invalid_argument("MeshIndexData::readPacked: Invalid index type.");
+	}
+	markAsChanged();
+}
+
 void MeshIndexData::updateIndexRange() {
-	if(indexArray.empty()) {
+	if(!hasLocalData() || indexCount == 0) {
 		minIndex = 1;
 		maxIndex = 0;
 	} else {
-		auto minMaxPair = std::minmax_element(indexArray.begin(), indexArray.end());
+		auto minMaxPair = std::minmax_element(data(), data() + indexCount);
 		minIndex = *minMaxPair.first;
 		maxIndex = *minMaxPair.second;
 	}
+	indexType = selectIndexType(minIndexType, maxIndex);
+}
+
+uint32_t MeshIndexData::getRequiredIndexType() const {
+	if(!hasLocalData() || indexCount == 0)
+		return selectIndexType(minIndexType, 0);
+	return selectIndexType(minIndexType, *std::max_element(data(), data() + indexCount));
+}
+
+void MeshIndexData::setIndexType(uint32_t type) {
+	if(type == 0)
+		type = GL_UNSIGNED_SHORT;
+	if(type != GL_UNSIGNED_BYTE && type != GL_UNSIGNED_SHORT && type != GL_UNSIGNED_INT)
+		throw std::invalid_argument("MeshIndexData::setIndexType: Invalid index type.");
+	minIndexType = type;
+	indexType = selectIndexType(minIndexType, maxIndex);
 }
 
 bool MeshIndexData::upload() {
@@ -85,11 +174,22 @@ bool MeshIndexData::upload(uint32_t usageHint){
 	if( isUploaded() )
 		removeGlBuffer();
 
-	if(indexCount == 0 || indexArray.empty() )
+	if(indexCount == 0 || !hasLocalData() )
 		return false;
 
+	// the index range may be outdated => make sure that the indices fit into the type
+	if(indexType != GL_UNSIGNED_INT)
+		indexType = selectIndexType(minIndexType, *std::max_element(data(), data() + indexCount));
+
 	try {
-		bufferObject.uploadData(GL_ELEMENT_ARRAY_BUFFER, indexArray, usageHint);
+		if(indexType == GL_UNSIGNED_INT) {
+			bufferObject.uploadData(GL_ELEMENT_ARRAY_BUFFER, reinterpret_cast<const uint8_t *>(data()), dataSize(), usageHint);
+		} else {
+			std::vector<uint8_t> packedIndices(indexCount * getGLTypeSize(indexType));
+			writePacked(indexType, packedIndices.data());
+			bufferObject.uploadData(GL_ELEMENT_ARRAY_BUFFER, packedIndices.data(), packedIndices.size(), usageHint);
+		}
+		uploadedIndexType = indexType;
 		GET_GL_ERROR()
 	}
 	catch (...) {
@@ -105,7 +205,10 @@ bool MeshIndexData::upload(uint32_t usageHint){
 bool MeshIndexData::download(){
 	if(!isUploaded() || indexCount==0)
 		return false;
-	downloadTo(indexArray);
+	externalData.reset();
+	std::vector<uint32_t> downloadedIndices;
+	downloadTo(downloadedIndices);
+	indexArray.assign(downloadedIndices.begin(), downloadedIndices.end());
 	dataChanged = false;
 	return true;
 }
@@ -113,7 +216,15 @@ bool MeshIndexData::download(){
 //!	(internal)
 #ifdef LIB_GL
 void MeshIndexData::downloadTo(std::vector<uint32_t> & destination) const {
-	destination = bufferObject.downloadData<uint32_t>(GL_ELEMENT_ARRAY_BUFFER, getIndexCount());
+	if(uploadedIndexType == GL_UNSIGNED_BYTE) {
+		const auto packedIndices = bufferObject.downloadData<uint8_t>(GL_ELEMENT_ARRAY_BUFFER, getIndexCount());
+		destination.assign(packedIndices.begin(), packedIndices.end());
+	} else if(uploadedIndexType == GL_UNSIGNED_SHORT) {
+		const auto packedIndices = bufferObject.downloadData<uint16_t>(GL_ELEMENT_ARRAY_BUFFER, getIndexCount());
+		destination.assign(packedIndices.begin(), packedIndices.end());
+	} else {
+		destination = bufferObject.downloadData<uint32_t>(GL_ELEMENT_ARRAY_BUFFER, getIndexCount());
+	}
 }
 #else
 void MeshIndexData::downloadTo(std::vector<uint32_t> & /*destination*/) const {
@@ -134,7 +245,7 @@ void MeshIndexData::drawElements(bool useVBO,uint32_t drawMode,uint32_t startInd
 #ifdef LIB_GL
 	if(useVBO && isUploaded()) { // VBO
 		bufferObject.bind(GL_ELEMENT_ARRAY_BUFFER);
-		glDrawRangeElements(drawMode, getMinIndex(), getMaxIndex(), numberOfIndices, GL_UNSIGNED_INT, reinterpret_cast<void*>(sizeof(GLuint)*startIndex));
+		glDrawRangeElements(drawMode, getMinIndex(), getMaxIndex(), numberOfIndices, uploadedIndexType, reinterpret_cast<void*>(getGLTypeSize(uploadedIndexType)*startIndex));
 		bufferObject.unbind(GL_ELEMENT_ARRAY_BUFFER);
 	} else if(hasLocalData()) { // VertexArray
 		glDrawRangeElements(drawMode, getMinIndex(), getMaxIndex(), numberOfIndices, GL_UNSIGNED_INT, reinterpret_cast<void*>(data()+startIndex));
@@ -142,7 +253,7 @@ void MeshIndexData::drawElements(bool useVBO,uint32_t drawMode,uint32_t startInd
 #else
 	if (useVBO && isUploaded()) { // VBO
 		bufferObject.bind(GL_ELEMENT_ARRAY_BUFFER);
-		glDrawElements(drawMode, numberOfIndices, GL_UNSIGNED_INT, reinterpret_cast<void*>(sizeof(GLuint)*startIndex));
+		glDrawElements(drawMode, numberOfIndices, uploadedIndexType, reinterpret_cast<void*>(getGLTypeSize(uploadedIndexType)*startIndex));
 		bufferObject.unbind(GL_ELEMENT_ARRAY_BUFFER);
 	} else if (hasLocalData()) { // VertexArray
 		glDrawElements(drawMode, numberOfIndices, GL_UNSIGNED_INT, reinterpret_cast<void*>(data()+startIndex));
@@ -11,15 +11,22 @@
 #ifndef RENDERING_MESHINDEXDATA_H
 #define RENDERING_MESHINDEXDATA_H
 
+#include "MeshMemoryPool.h"
 #include "../BufferObject.h"
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 namespace Rendering {
 
 /*! IndexData-Class .
 	Part of the Mesh implementation containing all index specific data of a mesh. 
+	The local data always stores 32 bit indices, so that it can be accessed and
+	modified directly. The buffer object and serialized meshes use the smallest
+	index type that can hold all indices (see getIndexType()).
+	The local data is taken from the default MeshMemoryResource; it may also reference
+	external memory, e.g. a memory mapped file.
 	@ingroup mesh
 */
 class MeshIndexData {
@@ -39,25 +46,65 @@ class MeshIndexData {
 		bool empty()const									{	return indexCount==0;	}
 
 		// data
-		void allocate(uint32_t count);
+		/*! Set the number of local indices. The first indices are kept.
+			\param initialize If @c false, the new indices are not initialized;
+				use this if all indices are overwritten afterwards.
+			\note Sets dataChanged. */
+		void allocate(uint32_t count, bool initialize = true);
+		/*! Use external memory holding @p count 32 bit indices as local data without copying it.
+			The memory is kept alive by the shared pointer as long as it is used.
+			\note The memory has to be writable, but may be copied on write
+				(e.g. a private memory mapping of a file, see Serialization::MappedFile).
+			\note Sets dataChanged. */
+		void setExternalData(uint32_t count, std::shared_ptr<uint32_t> memory);
+		//! Return @c true iff the local data references external memory.
+		bool hasExternalData() const						{	return externalData.get() != nullptr;	}
 		void releaseLocalData();
-		const uint32_t * data() const						{	return indexArray.data();	}
-		uint32_t * data() 									{	return indexArray.data();	}
-		std::size_t dataSize() const						{	return indexArray.size() * sizeof(uint32_t);	}
-		void markAsChanged()								{  	dataChanged=true;	}
+		const uint32_t * data() const						{	return hasExternalData() ? externalData.get() : indexArray.data();	}
+		uint32_t * data() 									{	return hasExternalData() ? externalData.get() : indexArray.data();	}
+		std::size_t dataSize() const						{	return (hasExternalData() ? indexCount : indexArray.size()) * sizeof(uint32_t);	}
+		void markAsChanged();
 		bool hasChanged()const								{  	return dataChanged;	}
-		bool hasLocalData()const							{  	return !indexArray.empty();	}
+		/*! Return the revision of the data, which is set to a new value whenever the data is marked as changed.
+			The revisions are unique among all objects, so that they also change when data is swapped in. */
+		uint32_t getRevision()const							{	return revision;	}
+		bool hasLocalData()const							{  	return hasExternalData() || !indexArray.empty();	}
 
-		const uint32_t & operator[](uint32_t index) const	{	return indexArray[index]; }
-		uint32_t & operator[](uint32_t index) 				{	return indexArray[index]; }
+		const uint32_t & operator[](uint32_t index) const	{	return data()[index]; }
+		uint32_t & operator[](uint32_t index) 				{	return data()[index]; }
+
+		/*! Convert the local indices to @p type (GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT)
+			and write them to @p destination, which has to provide getIndexCount() * getGLTypeSize(type) bytes.
+			\note The indices have to fit into the type.	*/
+		void writePacked(uint32_t type, uint8_t * destination) const;
+		/*! Set the local indices from getIndexCount() indices of the given @p type stored at @p source.
+			\note Call allocate() first.	*/
+		void readPacked(uint32_t type, const uint8_t * source);
 
 		// index range
 		inline uint32_t getMinIndex() const 				{   return minIndex;    }
 		inline uint32_t getMaxIndex() const 				{   return maxIndex;    }
-		/*! Recalculates the index range of the mesh.
+		/*! Recalculates the index range of the mesh and selects the index type.
 			\note Should be called whenever the vertices are changed.	*/
 		void updateIndexRange();
 
+		// index type
+		/*! Return the type of the indices in the buffer object and in serialized meshes:
+			GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.
+			It is the smallest type not smaller than the one set by setIndexType() that can hold getMaxIndex().	*/
+		uint32_t getIndexType() const						{	return indexType;	}
+		/*! Return the index type required for the current local indices, which is the one
+			updateIndexRange() would select, without changing the stored index range.	*/
+		uint32_t getRequiredIndexType() const;
+		/*! Set the smallest index type to use (GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_UNSIGNED_INT).
+			A value of 0 selects the default GL_UNSIGNED_SHORT; 8 bit indices are only used if requested
+			explicitly, as many GPUs handle them inefficiently.
+			If the type is invalid, an std::invalid_argument exception is thrown.
+			\note Takes effect on the next upload.	*/
+		void setIndexType(uint32_t type);
+		//! Return the type of the indices in the uploaded buffer object.
+		uint32_t getUploadedIndexType() const				{	return uploadedIndexType;	}
+
 		// vbo
 		inline bool isUploaded()const						{   return bufferObject.isValid();    }
 
@@ -82,11 +129,17 @@ class MeshIndexData {
 		void _swapBufferObject(BufferObject & other)	{	bufferObject.swap(other);	}
 	private:
 		uint32_t indexCount;
-		std::vector<uint32_t> indexArray;
+		std::vector<uint32_t, MeshDataAllocator<uint32_t>> indexArray;
+		//! If set, the local data is stored in external memory instead of indexArray.
+		std::shared_ptr<uint32_t> externalData;
 		uint32_t minIndex;
 		uint32_t maxIndex;
+		uint32_t minIndexType;
+		uint32_t indexType;
+		uint32_t uploadedIndexType;
 		BufferObject bufferObject;
 		bool dataChanged;
+		uint32_t revision;
 };
 }
 
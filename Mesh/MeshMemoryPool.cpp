@@ -0,0 +1,223 @@
+/*
+	This file is part of the Rendering library.
+	Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+	This library is subject to the terms of the Mozilla Public License, v. 2.0.
+	You should have received a copy of the MPL along with this library; see the
+	file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#include "MeshMemoryPool.h"
+#include <cstdlib>
+
+namespace Rendering {
+
+const size_t MeshMemoryResource::ALIGNMENT;
+const size_t MeshMemoryPool::MIN_BLOCK_SIZE;
+const size_t MeshMemoryPool::MAX_POOLED_SIZE;
+
+//! log2 of MIN_BLOCK_SIZE
+static const size_t MIN_BLOCK_SIZE_LOG = 6;
+//! Number of size classes per power of two.
+static const size_t CLASSES_PER_OCTAVE = 4;
+//! Number of size classes; the last one holds the unpooled blocks.
+static const size_t POOL_COUNT = 2 + (26 - MIN_BLOCK_SIZE_LOG) * CLASSES_PER_OCTAVE;
+static const size_t UNPOOLED = POOL_COUNT - 1;
+
+//! Return the size class of blocks having at least @p size bytes.
+static size_t getSizeClass(size_t size) {
+	if(size <= MeshMemoryPool::MIN_BLOCK_SIZE)
+		return 0;
+	if(size > MeshMemoryPool::MAX_POOLED_SIZE)
+		return UNPOOLED;
+	// 2^k < size <= 2^(k+1)
+	size_t k = MIN_BLOCK_SIZE_LOG;
+	while(((size - 1) >> (k + 1)) != 0)
+		++k;
+	const size_t step = (size - 1 - (static_cast<size_t>(1) << k)) >> (k - 2);
+	return 1 + (k - MIN_BLOCK_SIZE_LOG) * CLASSES_PER_OCTAVE + step;
+}
+
+static size_t getClassSize(size_t sizeClass) {
+	if(sizeClass == 0)
+		return MeshMemoryPool::MIN_BLOCK_SIZE;
+	const size_t k = MIN_BLOCK_SIZE_LOG + (sizeClass - 1) / CLASSES_PER_OCTAVE;
+	const size_t step = (sizeClass - 1) % CLASSES_PER_OCTAVE;
+	return (static_cast<size_t>(1) << k) + ((step + 1) << (k - 2));
+}
+
+//! Allocate aligned memory; the pointer returned by malloc is stored in front of the block.
+static void * allocateAligned(size_t size) {
+	void * memory = std::malloc(size + MeshMemoryResource::ALIGNMENT);
+	if(memory == nullptr)
+		throw std::bad_alloc();
+	const uintptr_t aligned = (reinterpret_cast<uintptr_t>(memory) + MeshMemoryResource::ALIGNMENT) & ~static_cast<uintptr_t>(MeshMemoryResource::ALIGNMENT - 1);
+	reinterpret_cast<void **>(aligned)[-1] = memory;
+	return reinterpret_cast<void *>(aligned);
+}
+
+static void freeAligned(void * block) {
+	std::free(reinterpret_cast<void **>(block)[-1]);
+}
+
+// ---------------------------
+
+static std::mutex & getDefaultResourceMutex() {
+	static std::mutex mutex;
+	return mutex;
+}
+
+static std::shared_ptr<MeshMemoryResource> & accessDefaultResource() {
+	static std::shared_ptr<MeshMemoryResource> resource = std::make_shared<MeshMemoryPool>();
+	return resource;
+}
+
+MeshMemoryResource::~MeshMemoryResource() = default;
+
+//! (static)
+std::shared_ptr<MeshMemoryResource> MeshMemoryResource::getDefault() {
+	std::lock_guard<std::mutex> lock(getDefaultResourceMutex());
+	return accessDefaultResource();
+}
+
+//! (static)
+void MeshMemoryResource::setDefault(std::shared_ptr<MeshMemoryResource> resource) {
+	if(!resource)
+		resource = std::make_shared<MeshMemoryPool>();
+	std::lock_guard<std::mutex> lock(getDefaultResourceMutex());
+	accessDefaultResource().swap(resource);
+}
+
+// ---------------------------
+
+//! (ctor)
+MeshMemoryPool::MeshMemoryPool(size_t _cacheLimit) : pools(POOL_COUNT), cacheLimit(_cacheLimit), bytesCached(0) {
+	for(size_t i = 0; i < POOL_COUNT; ++i) {
+		PoolStatistics & statistics = pools[i].statistics;
+		statistics.blockSize = i == UNPOOLED ? 0 : getClassSize(i);
+		statistics.blocksInUse = statistics.bytesInUse = statistics.bytesRequested = 0;
+		statistics.blocksCached = statistics.bytesCached = 0;
+	}
+}
+
+MeshMemoryPool::~MeshMemoryPool() {
+	release();
+}
+
+//! (static)
+size_t MeshMemoryPool::getBlockSize(size_t size) {
+	const size_t sizeClass = getSizeClass(size);
+	return sizeClass == UNPOOLED ? size : getClassSize(sizeClass);
+}
+
+void * MeshMemoryPool::allocate(size_t size) {
+	const size_t sizeClass = getSizeClass(size);
+	const size_t blockSize = sizeClass == UNPOOLED ? size : getClassSize(sizeClass);
+	void * block = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		Pool & pool = pools[sizeClass];
+		if(!pool.freeBlocks.empty()) {
+			block = pool.freeBlocks.back();
+			pool.freeBlocks.pop_back();
+			--pool.statistics.blocksCached;
+			pool.statistics.bytesCached -= blockSize;
+			bytesCached -= blockSize;
+		}
+	}
+	if(block == nullptr)
+		block = allocateAligned(blockSize);
+
+	std::lock_guard<std::mutex> lock(mutex);
+	PoolStatistics & statistics = pools[sizeClass].statistics;
+	++statistics.blocksInUse;
+	statistics.bytesInUse += blockSize;
+	statistics.bytesRequested += size;
+	return block;
+}
+
+void MeshMemoryPool::deallocate(void * block, size_t size) {
+	if(block == nullptr)
+		return;
+	const size_t sizeClass = getSizeClass(size);
+	const size_t blockSize = sizeClass == UNPOOLED ? size : getClassSize(sizeClass);
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		Pool & pool = pools[sizeClass];
+		--pool.statistics.blocksInUse;
+		pool.statistics.bytesInUse -= blockSize;
+		pool.statistics.bytesRequested -= size;
+		if(sizeClass != UNPOOLED && bytesCached + blockSize <= cacheLimit) {
+			try {
+				pool.freeBlocks.push_back(block);
+				++pool.statistics.blocksCached;
+				pool.statistics.bytesCached += blockSize;
+				bytesCached += blockSize;
+				return;
+			} catch(const std::bad_alloc &) {
+				// free the block instead
+			}
+		}
+	}
+	freeAligned(block);
+}
+
+size_t MeshMemoryPool::release() {
+	std::vector<std::vector<void *>> freeBlocks;
+	size_t releasedBytes;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		freeBlocks.reserve(POOL_COUNT);
+		for(auto & pool : pools) {
+			freeBlocks.emplace_back();
+			freeBlocks.back().swap(pool.freeBlocks);
+			pool.statistics.blocksCached = pool.statistics.bytesCached = 0;
+		}
+		releasedBytes = bytesCached;
+		bytesCached = 0;
+	}
+	for(const auto & blocks : freeBlocks)
+		for(void * block : blocks)
+			freeAligned(block);
+	return releasedBytes;
+}
+
+void MeshMemoryPool::setCacheLimit(size_t bytes) {
+	bool exceeded;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		cacheLimit = bytes;
+		exceeded = bytesCached > cacheLimit;
+	}
+	if(exceeded)
+		release();
+}
+
+size_t MeshMemoryPool::getCacheLimit() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return cacheLimit;
+}
+
+std::vector<MeshMemoryPool::PoolStatistics> MeshMemoryPool::getStatistics() const {
+	std::vector<PoolStatistics> result;
+	std::lock_guard<std::mutex> lock(mutex);
+	for(const auto & pool : pools) {
+		if(pool.statistics.blocksInUse > 0 || pool.statistics.blocksCached > 0)
+			result.push_back(pool.statistics);
+	}
+	return result;
+}
+
+size_t MeshMemoryPool::getBytesInUse() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	size_t bytes = 0;
+	for(const auto & pool : pools)
+		bytes += pool.statistics.bytesInUse;
+	return bytes;
+}
+
+size_t MeshMemoryPool::getBytesCached() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return bytesCached;
+}
+
+}
@@ -0,0 +1,154 @@
+/*
+	This file is part of the Rendering library.
+	Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+	This library is subject to the terms of the Mozilla Public License, v. 2.0.
+	You should have received a copy of the MPL along with this library; see the
+	file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#ifndef RENDERING_MESH_MESHMEMORYPOOL_H_
+#define RENDERING_MESH_MESHMEMORYPOOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Rendering {
+
+/**
+ * Source of the memory used for the local data of meshes (see MeshVertexData and MeshIndexData).
+ * All blocks are aligned to ALIGNMENT bytes, so that SIMD loads never cross a cache line.
+ * The resource used for new mesh data can be replaced with setDefault(); data that has
+ * already been allocated keeps a reference to the resource it was allocated from.
+ * @ingroup mesh
+ */
+class MeshMemoryResource {
+	public:
+		//! Alignment of all allocated blocks in bytes.
+		static const size_t ALIGNMENT = 64;
+
+		virtual ~MeshMemoryResource();
+
+		/*! Return a block of at least @p size bytes aligned to ALIGNMENT.
+			If the memory cannot be allocated, an std::bad_alloc exception is thrown. */
+		virtual void * allocate(size_t size) = 0;
+		//! Free a block returned by allocate() for the same @p size.
+		virtual void deallocate(void * block, size_t size) = 0;
+
+		//! (static) Return the resource used for new mesh data; initially a MeshMemoryPool.
+		static std::shared_ptr<MeshMemoryResource> getDefault();
+		//! (static) Set the resource used for new mesh data; @c nullptr restores the initial pool.
+		static void setDefault(std::shared_ptr<MeshMemoryResource> resource);
+};
+
+/**
+ * Memory resource keeping freed blocks in pools of similar sizes for reuse.
+ * Meshes that are cloned, combined, split or reloaded often have the same sizes,
+ * so their memory is reused instead of fragmenting the heap of long running applications.
+ * There are four size classes per power of two (wasting at most 25% of a block); blocks
+ * larger than MAX_POOLED_SIZE are not pooled. The freed blocks are kept until their total
+ * size exceeds the cache limit (see setCacheLimit()) or release() is called.
+ * \note The pool is thread-safe.
+ * @ingroup mesh
+ */
+class MeshMemoryPool : public MeshMemoryResource {
+	public:
+		//! Size of the smallest blocks in bytes.
+		static const size_t MIN_BLOCK_SIZE = 64;
+		//! Size of the largest pooled blocks in bytes.
+		static const size_t MAX_POOLED_SIZE = static_cast<size_t>(1) << 26;
+
+		//! Counters of the blocks of one size class.
+		struct PoolStatistics {
+			size_t blockSize; //!< size of the blocks in bytes; 0 for the blocks larger than MAX_POOLED_SIZE
+			size_t blocksInUse;
+			size_t bytesInUse; //!< size of the blocks in use
+			size_t bytesRequested; //!< sum of the requested sizes of the blocks in use
+			size_t blocksCached;
+			size_t bytesCached; //!< size of the freed blocks kept for reuse
+		};
+
+		explicit MeshMemoryPool(size_t cacheLimit = static_cast<size_t>(256) << 20);
+		virtual ~MeshMemoryPool();
+
+		void * allocate(size_t size) override;
+		void deallocate(void * block, size_t size) override;
+
+		//! Free all cached blocks and return the number of freed bytes.
+		size_t release();
+
+		//! Set the maximum total size of the cached blocks in bytes; exceeding blocks are freed immediately.
+		void setCacheLimit(size_t bytes);
+		size_t getCacheLimit() const;
+
+		//! Return the counters of all size classes having blocks in use or cached, ordered by block size with the unpooled blocks last.
+		std::vector<PoolStatistics> getStatistics() const;
+		//! Return the total size of the blocks in use in bytes.
+		size_t getBytesInUse() const;
+		//! Return the total size of the cached blocks in bytes.
+		size_t getBytesCached() const;
+
+		//! (static) Return the size of the blocks used for allocations of @p size bytes.
+		static size_t getBlockSize(size_t size);
+
+	private:
+		struct Pool {
+			PoolStatistics statistics;
+			std::vector<void *> freeBlocks;
+		};
+
+		mutable std::mutex mutex;
+		std::vector<Pool> pools; //!< indexed by size class; the last one holds the unpooled blocks
+		size_t cacheLimit;
+		size_t bytesCached;
+};
+
+/**
+ * Standard allocator taking its memory from a MeshMemoryResource.
+ * Elements are default-initialized instead of value-initialized, so resizing a
+ * container of fundamental types leaves the new elements uninitialized.
+ * @ingroup mesh
+ */
+template<typename value_t>
+class MeshDataAllocator {
+	public:
+		typedef value_t value_type;
+		typedef std::true_type propagate_on_container_move_assignment;
+		typedef std::true_type propagate_on_container_swap;
+
+		MeshDataAllocator() : resource(MeshMemoryResource::getDefault()) {}
+		explicit MeshDataAllocator(std::shared_ptr<MeshMemoryResource> _resource) : resource(std::move(_resource)) {}
+		template<typename other_t>
+		MeshDataAllocator(const MeshDataAllocator<other_t> & other) : resource(other.getResource()) {}
+
+		value_t * allocate(size_t count)					{	return static_cast<value_t *>(resource->allocate(count * sizeof(value_t)));	}
+		void deallocate(value_t * block, size_t count)		{	resource->deallocate(block, count * sizeof(value_t));	}
+
+		template<typename other_t>
+		void construct(other_t * ptr)						{	::new(static_cast<void *>(ptr)) other_t;	}
+		template<typename other_t, typename ... args_t>
+		void construct(other_t * ptr, args_t && ... args)	{	::new(static_cast<void *>(ptr)) other_t(std::forward<args_t>(args)...);	}
+
+		const std::shared_ptr<MeshMemoryResource> & getResource() const	{	return resource;	}
+
+	private:
+		std::shared_ptr<MeshMemoryResource> resource;
+};
+
+template<typename value1_t, typename value2_t>
+bool operator==(const MeshDataAllocator<value1_t> & a, const MeshDataAllocator<value2_t> & b) {
+	return a.getResource() == b.getResource();
+}
+template<typename value1_t, typename value2_t>
+bool operator!=(const MeshDataAllocator<value1_t> & a, const MeshDataAllocator<value2_t> & b) {
+	return !(a == b);
+}
+
+}
+
+#endif /* RENDERING_MESH_MESHMEMORYPOOL_H_ */
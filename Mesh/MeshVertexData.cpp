@@ -14,14 +14,15 @@
 #include "VertexAttributeAccessors.h"
 #include "../Shader/Shader.h"
 #include "../RenderingContext/RenderingContext.h"
+#include "../MeshUtils/ParallelFor.h"
 #include "../GLHeader.h"
 #include "../Helper.h"
 #include <Util/Macros.h>
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <limits>
 #include <memory>
-#include <mutex>
-#include <set>
 #include <vector>
 #include <utility>
 
@@ -30,35 +31,43 @@ namespace Rendering{
 
 //! (internal)
 void MeshVertexData::setVertexDescription(const VertexDescription & vd){
-	static std::mutex mutex;
-	std::lock_guard<std::mutex> lock(mutex);
-
-	static std::set<VertexDescription> descriptionCollections;
-	std::pair<std::set<VertexDescription>::iterator,bool> result = descriptionCollections.insert(vd);
-	vertexDescription = &*(result.first);
+	if(&vd != vertexDescription)
+		vertexDescription = &VertexDescription::intern(vd);
 }
 
 // ---------------------------
 
 //! (ctor)
 MeshVertexData::MeshVertexData() :
-	binaryData(), vertexDescription(nullptr), vertexCount(0), bufferObject(), bb(), dataChanged(false) {
-	setVertexDescription(VertexDescription());
+	binaryData(), externalData(), vertexDescription(nullptr), vertexCount(0), bufferObject(), bb(), dataChanged(false), revision(0) {
+	static const VertexDescription & emptyDescription = VertexDescription::intern(VertexDescription());
+	vertexDescription = &emptyDescription;
 }
 
 //! (ctor)
 MeshVertexData::MeshVertexData(const MeshVertexData & other) :
-	binaryData(), vertexDescription(other.vertexDescription), vertexCount(other.getVertexCount()), bufferObject(), bb(other.getBoundingBox()), dataChanged(true) {
+	binaryData(), externalData(), vertexDescription(other.vertexDescription), vertexCount(other.getVertexCount()), bufferObject(), bb(other.getBoundingBox()), dataChanged(true), revision(other.revision) {
 	if(other.hasLocalData()) {
-		binaryData = other.binaryData;
+		binaryData.assign(other.data(), other.data() + other.dataSize());
 	} else if(other.isUploaded()) {
-		other.downloadTo(binaryData);
+		std::vector<uint8_t> downloadedData;
+		other.downloadTo(downloadedData);
+		binaryData.assign(downloadedData.begin(), downloadedData.end());
 	} else {
 		WARN("Cannot access vertex data."); // should not happen
 	}
 }
 
+//! Source of the revisions of all vertex data.
+static std::atomic<uint32_t> revisionCounter(0);
+
+void MeshVertexData::markAsChanged() {
+	dataChanged = true;
+	revision = ++revisionCounter;
+}
+
 void MeshVertexData::releaseLocalData(){
+	externalData.reset();
 	binaryData.resize(0);
 	binaryData.shrink_to_fit();
 }
@@ -73,24 +82,113 @@ void MeshVertexData::swap(MeshVertexData & other){
 	swap(bufferObject, other.bufferObject);
 	swap(bb, other.bb);
 	swap(dataChanged, other.dataChanged);
+	swap(revision, other.revision);
 	swap(binaryData, other.binaryData);
+	swap(externalData, other.externalData);
 }
 
-void MeshVertexData::allocate(uint32_t count, const VertexDescription & vd){
+void MeshVertexData::allocate(uint32_t count, const VertexDescription & vd, bool initialize){
 	setVertexDescription(vd);
 	vertexCount = count;
-	binaryData.resize(vd.getVertexSize() * count);
+	externalData.reset();
+	const size_t oldSize = binaryData.size();
+	binaryData.resize(vd.getDataSize(count));
 	binaryData.shrink_to_fit();
+	if(initialize && binaryData.size() > oldSize)
+		std::fill(binaryData.begin() + oldSize, binaryData.end(), 0);
 	markAsChanged();
 }
 
+void MeshVertexData::setExternalData(uint32_t count, const VertexDescription & vd, std::shared_ptr<uint8_t> memory){
+	setVertexDescription(vd);
+	vertexCount = count;
+	binaryData.clear();
+	binaryData.shrink_to_fit();
+	externalData = std::move(memory);
+	markAsChanged();
+}
+
+size_t MeshVertexData::dataSize() const {
+	return hasExternalData() ? vertexDescription->getDataSize(vertexCount) : binaryData.size();
+}
+
+size_t MeshVertexData::getAttributeOffset(const VertexAttribute & attr) const {
+	return vertexDescription->getAttributeDataOffset(attr, vertexCount);
+}
+
+size_t MeshVertexData::getAttributeStride(const VertexAttribute & attr) const {
+	return vertexDescription->getAttributeStride(attr);
+}
+
 const uint8_t * MeshVertexData::operator[](uint32_t index) const {
-	return binaryData.data() + index * vertexDescription->getVertexSize();
+	return data() + index * vertexDescription->getVertexSize();
 
 }
 
 uint8_t * MeshVertexData::operator[](uint32_t index) {
-	return binaryData.data() + index * vertexDescription->getVertexSize();
+	return data() + index * vertexDescription->getVertexSize();
+}
+
+//! Number of vertices whose coordinates are gathered together to update the bounds.
+static const uint32_t BOUNDS_BLOCK_SIZE = 1024;
+//! Number of vertices per worker from which on the bounding box is computed in parallel.
+static const uint32_t PARALLEL_VERTEX_COUNT = 1u << 18;
+
+//! Minima and maxima of up to three coordinates. They are kept separately for each SIMD lane to allow vectorization.
+struct LaneBounds {
+	static const uint32_t LANES = 8;
+	float min[3][LANES];
+	float max[3][LANES];
+
+	LaneBounds() {
+		std::fill_n(&min[0][0], 3 * LANES, std::numeric_limits<float>::max());
+		std::fill_n(&max[0][0], 3 * LANES, std::numeric_limits<float>::lowest());
+	}
+	void include(const LaneBounds & other) {
+		for(uint_fast8_t d = 0; d < 3; ++d) {
+			for(uint32_t l = 0; l < LANES; ++l) {
+				min[d][l] = std::min(min[d][l], other.min[d][l]);
+				max[d][l] = std::max(max[d][l], other.max[d][l]);
+			}
+		}
+	}
+	float getMin(uint_fast8_t d) const	{	return *std::min_element(min[d], min[d] + LANES);	}
+	float getMax(uint_fast8_t d) const	{	return *std::max_element(max[d], max[d] + LANES);	}
+};
+
+/*! (internal) Include the first @p dims coordinates of @p count float vectors stored @p stride bytes apart into the bounds.
+	The coordinates of a block of vectors are gathered into separate arrays first, so that the minima and maxima are
+	computed with SIMD instructions. */
+static void includeFloatVectors(const uint8_t * data, size_t stride, uint_fast8_t dims, uint32_t count, LaneBounds & bounds) {
+	const uint32_t LANES = LaneBounds::LANES;
+	float block[3][BOUNDS_BLOCK_SIZE];
+	for(uint32_t first = 0; first < count; first += BOUNDS_BLOCK_SIZE) {
+		const uint32_t n = std::min(BOUNDS_BLOCK_SIZE, count - first);
+		const uint8_t * const blockData = data + static_cast<size_t>(first) * stride;
+		for(uint32_t i = 0; i < n; ++i) {
+			const float * v = reinterpret_cast<const float *>(blockData + i * stride);
+			for(uint_fast8_t d = 0; d < dims; ++d)
+				block[d][i] = v[d];
+		}
+		// fill up the last lanes with the first vector, which does not change the bounds
+		const uint32_t paddedCount = (n + LANES - 1) / LANES * LANES;
+		for(uint_fast8_t d = 0; d < dims; ++d) {
+			std::fill(block[d] + n, block[d] + paddedCount, block[d][0]);
+			float laneMin[LANES];
+			float laneMax[LANES];
+			std::copy(bounds.min[d], bounds.min[d] + LANES, laneMin);
+			std::copy(bounds.max[d], bounds.max[d] + LANES, laneMax);
+			for(uint32_t i = 0; i < paddedCount; i += LANES) {
+				for(uint32_t l = 0; l < LANES; ++l) {
+					const float value = block[d][i + l];
+					laneMin[l] = value < laneMin[l] ? value : laneMin[l];
+					laneMax[l] = value > laneMax[l] ? value : laneMax[l];
+				}
+			}
+			std::copy(laneMin, laneMin + LANES, bounds.min[d]);
+			std::copy(laneMax, laneMax + LANES, bounds.max[d]);
+		}
+	}
 }
 
 void MeshVertexData::updateBoundingBox() {
@@ -98,38 +196,53 @@ void MeshVertexData::updateBoundingBox() {
 		bb = Geometry::Box();
 		return;
 	}
-	const VertexDescription & vd=getVertexDescription();	
-	auto acc = FloatAttributeAccessor::create(*this, VertexAttributeIds::POSITION);
-	
+	const VertexDescription & vd=getVertexDescription();
 	const VertexAttribute & attr = vd.getAttribute(VertexAttributeIds::POSITION);
 	const uint8_t vertexNum = attr.getNumValues();
 	if (vertexNum < 1) {
 		WARN(std::string("Vertex component count is zero."));
 		return;
 	}
-	
-	// The following implementation calculates minima and maxima for the coordinates.
-	// This is faster than calling Geometry::Box::include for each vertex.
-	std::vector<float> min(vertexNum, std::numeric_limits<float>::max());
-	std::vector<float> max(vertexNum, std::numeric_limits<float>::lowest());
-	for (uint_fast32_t i = 0; i < vertexCount; ++i) {
-		auto p = acc->getValues(i);
-		for (uint_fast8_t dim = 0; dim < vertexNum; ++dim) {
-			if (p[dim] < min[dim]) {
-				min[dim] = p[dim];
-			}
-			if (p[dim] > max[dim]) {
-				max[dim] = p[dim];
+	const uint_fast8_t dims = std::min<uint_fast8_t>(vertexNum, 3);
+
+	// large meshes: each worker computes the bounds of a contiguous range of vertices
+	const uint32_t workerCount = std::max(1u, std::min(MeshUtils::getWorkerCount(0), vertexCount / PARALLEL_VERTEX_COUNT));
+	std::vector<LaneBounds> bounds(workerCount);
+	if(attr.getDataType() == GL_FLOAT) {
+		const uint8_t * positions = getAttributeData(attr);
+		const size_t stride = getAttributeStride(attr);
+		MeshUtils::parallelFor(workerCount, 0, vertexCount, [&](uint32_t worker, uint32_t begin, uint32_t end) {
+			includeFloatVectors(positions + static_cast<size_t>(begin) * stride, stride, dims, end - begin, bounds[worker]);
+		});
+	} else if(vertexNum >= 3 && (attr.getDataType() == GL_HALF_FLOAT || (attr.getNormalize() &&
+			(attr.getDataType() == GL_SHORT || attr.getDataType() == GL_UNSIGNED_SHORT)))) {
+		// convert blocks of positions using the accessor's batch function
+		Util::Reference<PositionAttributeAccessor> acc = PositionAttributeAccessor::create(*this, VertexAttributeIds::POSITION);
+		MeshUtils::parallelFor(workerCount, 0, vertexCount, [&](uint32_t worker, uint32_t begin, uint32_t end) {
+			float buffer[3 * BOUNDS_BLOCK_SIZE];
+			for(uint32_t first = begin; first < end; first += BOUNDS_BLOCK_SIZE) {
+				const uint32_t count = std::min(BOUNDS_BLOCK_SIZE, end - first);
+				acc->getPositions(first, count, buffer);
+				includeFloatVectors(reinterpret_cast<const uint8_t *>(buffer), 3 * sizeof(float), 3, count, bounds[worker]);
 			}
+		});
+	} else {
+		auto acc = FloatAttributeAccessor::create(*this, VertexAttributeIds::POSITION);
+		for(uint32_t i = 0; i < vertexCount; ++i) {
+			const std::vector<float> p = acc->getValues(i);
+			includeFloatVectors(reinterpret_cast<const uint8_t *>(p.data()), 0, dims, 1, bounds.front());
 		}
 	}
+	for(uint32_t worker = 1; worker < workerCount; ++worker)
+		bounds.front().include(bounds[worker]);
+	const LaneBounds & b = bounds.front();
 
 	if (vertexNum == 1) {
-		bb = Geometry::Box(min[0], max[0], 0.0f, 0.0f, 0.0f, 0.0f);
+		bb = Geometry::Box(b.getMin(0), b.getMax(0), 0.0f, 0.0f, 0.0f, 0.0f);
 	} else if (vertexNum == 2) {
-		bb = Geometry::Box(min[0], max[0], min[1], max[1], 0.0f, 0.0f);
+		bb = Geometry::Box(b.getMin(0), b.getMax(0), b.getMin(1), b.getMax(1), 0.0f, 0.0f);
 	} else {
-		bb = Geometry::Box(min[0], max[0], min[1], max[1], min[2], max[2]);
+		bb = Geometry::Box(b.getMin(0), b.getMax(0), b.getMin(1), b.getMax(1), b.getMin(2), b.getMax(2));
 	}
 }
 
@@ -138,14 +251,14 @@ bool MeshVertexData::upload() {
 }
 
 bool MeshVertexData::upload(uint32_t usageHint){
-	if(vertexCount == 0 || binaryData.empty() )
+	if(vertexCount == 0 || !hasLocalData() )
 		return false;
 		
 	if( isUploaded() )
 		removeGlBuffer();
 
 	try {
-		bufferObject.uploadData(GL_ARRAY_BUFFER, binaryData, usageHint);
+		bufferObject.uploadData(GL_ARRAY_BUFFER, data(), dataSize(), usageHint);
 		GET_GL_ERROR()
 	}
 	catch (...) {
@@ -160,14 +273,17 @@ bool MeshVertexData::upload(uint32_t usageHint){
 bool MeshVertexData::download(){
 	if(!isUploaded() || vertexCount==0)
 		return false;
-	downloadTo(binaryData);
+	externalData.reset();
+	std::vector<uint8_t> downloadedData;
+	downloadTo(downloadedData);
+	binaryData.assign(downloadedData.begin(), downloadedData.end());
 	dataChanged = false;
 	return true;
 }
 
 #ifdef LIB_GL
 void MeshVertexData::downloadTo(std::vector<uint8_t> & destination) const {
-	const std::size_t numBytes = getVertexDescription().getVertexSize() * getVertexCount();
+	const std::size_t numBytes = getVertexDescription().getDataSize(getVertexCount());
 	destination = bufferObject.downloadData<uint8_t>(GL_ARRAY_BUFFER, numBytes);
 }
 #else
@@ -191,7 +307,6 @@ void MeshVertexData::bind(RenderingContext & context, bool useVBO) {
 	}
 
 	Shader * shader = context.getActiveShader();
-	const GLsizei vSize=vd.getVertexSize();
 #ifdef LIB_GL
 	if (RenderingContext::getCompabilityMode() && (shader == nullptr || shader->usesClassicOpenGL())) {
 
@@ -199,42 +314,44 @@ void MeshVertexData::bind(RenderingContext & context, bool useVBO) {
 			if(attr.empty())
 				continue;
 			const Util::StringIdentifier nameId=attr.getNameId();
+			const uint8_t * attrPosition = vertexPosition + getAttributeOffset(attr);
+			const GLsizei vSize = getAttributeStride(attr);
 
 			if(nameId==VertexAttributeIds::POSITION) {
 				context.enableClientState(GL_VERTEX_ARRAY);
-				glVertexPointer(attr.getNumValues(), attr.getDataType(), vSize, vertexPosition + attr.getOffset());
+				glVertexPointer(attr.getNumValues(), attr.getDataType(), vSize, attrPosition);
 			} else if(nameId==VertexAttributeIds::NORMAL) {
 				context.enableClientState(GL_NORMAL_ARRAY);
-				glNormalPointer(attr.getDataType(), vSize, vertexPosition + attr.getOffset());
+				glNormalPointer(attr.getDataType(), vSize, attrPosition);
 			} else if(nameId==VertexAttributeIds::COLOR) {
 				context.enableClientState(GL_COLOR_ARRAY);
-				glColorPointer(attr.getNumValues(), attr.getDataType(), vSize, vertexPosition + attr.getOffset());
+				glColorPointer(attr.getNumValues(), attr.getDataType(), vSize, attrPosition);
 			} else if(nameId==VertexAttributeIds::TEXCOORD0) {
 				context.enableTextureClientState(GL_TEXTURE0);
-				glTexCoordPointer(attr.getNumValues(), attr.getDataType(), vSize, vertexPosition + attr.getOffset());
+				glTexCoordPointer(attr.getNumValues(), attr.getDataType(), vSize, attrPosition);
 			} else if(nameId==VertexAttributeIds::TEXCOORD1) {
 				context.enableTextureClientState(GL_TEXTURE1);
-				glTexCoordPointer(attr.getNumValues(), attr.getDataType(), vSize, vertexPosition + attr.getOffset());
+				glTexCoordPointer(attr.getNumValues(), attr.getDataType(), vSize, attrPosition);
 			} else if(nameId==VertexAttributeIds::TEXCOORD2) {
 				context.enableTextureClientState(GL_TEXTURE2);
-				glTexCoordPointer(attr.getNumValues(), attr.getDataType(), vSize, vertexPosition + attr.getOffset());
+				glTexCoordPointer(attr.getNumValues(), attr.getDataType(), vSize, attrPosition);
 			} else if(nameId==VertexAttributeIds::TEXCOORD3) {
 				context.enableTextureClientState(GL_TEXTURE3);
-				glTexCoordPointer(attr.getNumValues(), attr.getDataType(), vSize, vertexPosition + attr.getOffset());
+				glTexCoordPointer(attr.getNumValues(), attr.getDataType(), vSize, attrPosition);
 			} else if(nameId==VertexAttributeIds::TEXCOORD4) {
 				context.enableTextureClientState(GL_TEXTURE4);
-				glTexCoordPointer(attr.getNumValues(), attr.getDataType(), vSize, vertexPosition + attr.getOffset());
+				glTexCoordPointer(attr.getNumValues(), attr.getDataType(), vSize, attrPosition);
 			} else if(nameId==VertexAttributeIds::TEXCOORD5) {
 				context.enableTextureClientState(GL_TEXTURE5);
-				glTexCoordPointer(attr.getNumValues(), attr.getDataType(), vSize, vertexPosition + attr.getOffset());
+				glTexCoordPointer(attr.getNumValues(), attr.getDataType(), vSize, attrPosition);
 			} else if(nameId==VertexAttributeIds::TEXCOORD6) {
 				context.enableTextureClientState(GL_TEXTURE6);
-				glTexCoordPointer(attr.getNumValues(), attr.getDataType(), vSize, vertexPosition + attr.getOffset());
+				glTexCoordPointer(attr.getNumValues(), attr.getDataType(), vSize, attrPosition);
 			} else if(nameId==VertexAttributeIds::TEXCOORD7) {
 				context.enableTextureClientState(GL_TEXTURE7);
-				glTexCoordPointer(attr.getNumValues(), attr.getDataType(), vSize, vertexPosition + attr.getOffset());
+				glTexCoordPointer(attr.getNumValues(), attr.getDataType(), vSize, attrPosition);
 			} else if(shader != nullptr) { // ????????does this work?????
-				context.enableVertexAttribArray(attr, vertexPosition, vSize);
+				context.enableVertexAttribArray(attr, attrPosition - attr.getOffset(), vSize);
 			}
 		}
 	}else if( shader != nullptr && context.useAMDAttrBugWorkaround() ){
@@ -243,7 +360,7 @@ void MeshVertexData::bind(RenderingContext & context, bool useVBO) {
 				continue;
 			if(attr.getNameId()==VertexAttributeIds::POSITION) {
 				context.enableClientState(GL_VERTEX_ARRAY);
-				glVertexPointer(attr.getNumValues(), attr.getDataType(), vSize, vertexPosition + attr.getOffset());
+				glVertexPointer(attr.getNumValues(), attr.getDataType(), getAttributeStride(attr), vertexPosition + getAttributeOffset(attr));
 				break;
 			}
 		}
@@ -252,7 +369,8 @@ void MeshVertexData::bind(RenderingContext & context, bool useVBO) {
 	if (shader != nullptr && shader->usesSGUniforms()) {
 		for(const auto & attr : vd.getAttributes()) {
 			if(!attr.empty()) {
-				context.enableVertexAttribArray(attr, vertexPosition, vSize);
+				// enableVertexAttribArray adds the attribute's offset inside the vertex
+				context.enableVertexAttribArray(attr, vertexPosition + getAttributeOffset(attr) - attr.getOffset(), getAttributeStride(attr));
 			}
 		}
 	}
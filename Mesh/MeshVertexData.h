@@ -11,36 +11,44 @@
 #ifndef MeshVertexData_H
 #define MeshVertexData_H
 
+#include "MeshMemoryPool.h"
 #include "../BufferObject.h"
 #include <Geometry/Box.h>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 namespace Rendering {
 
 class RenderingContext;
+class VertexAttribute;
 class VertexDescription;
 
 /*! VertexData-Class.
 	Part of the Mesh implementation containing all vertex specific data of a mesh:
 	- VertexDescription: Data format of the vertices.
 	- The local storage for the vertex data (If the data is uploaded to
-		the graphics card, the local copy may be freed.)
+		the graphics card, the local copy may be freed.) The local data is
+		taken from the default MeshMemoryResource; it may also reference
+		external memory, e.g. a memory mapped file.
 	- The vertex buffer id, if the data has been uploaded to graphics memory.
 	- A bounding box enclosing all vertices.
 	@ingroup mesh
 */
 class MeshVertexData {
-		std::vector<uint8_t> binaryData;
+		std::vector<uint8_t, MeshDataAllocator<uint8_t>> binaryData;
+		//! If set, the local data is stored in external memory instead of binaryData.
+		std::shared_ptr<uint8_t> externalData;
 		const VertexDescription * vertexDescription;
 		uint32_t vertexCount;
 		BufferObject bufferObject;
 
 		Geometry::Box bb;
 		bool dataChanged;
+		uint32_t revision;
 
-		/*! (internal) To save memory, the vertexDescription is stored in a static set
+		/*! (internal) To save memory, the vertexDescription is interned (see VertexDescription::intern())
 			so that each MeshVertexData-Object having the same vertex description references the same
 			VertexDescription object. */
 		void setVertexDescription(const VertexDescription & vd);
@@ -66,18 +74,45 @@ class MeshVertexData {
 
 		// data
 		/*! Set the local vertex data. The old data is freed.
+			If the vertex description is not changed and the data is interleaved and not external,
+			the data of the first vertices is kept. The streams of non-interleaved data start at offsets
+			depending on the vertex count, so their old content is not kept.
+			\param initialize If @c false, the data of the new vertices is not set to zero;
+				use this if all data is overwritten afterwards.
 			\note Sets dataChanged. */
-		void allocate(uint32_t count, const VertexDescription & vd);
+		void allocate(uint32_t count, const VertexDescription & vd, bool initialize = true);
+		/*! Use external memory holding @p count vertices as local data without copying it.
+			The memory is kept alive by the shared pointer as long as it is used.
+			\note The memory has to be writable, but may be copied on write
+				(e.g. a private memory mapping of a file, see Serialization::MappedFile).
+			\note Sets dataChanged. */
+		void setExternalData(uint32_t count, const VertexDescription & vd, std::shared_ptr<uint8_t> memory);
+		//! Return @c true iff the local data references external memory.
+		bool hasExternalData()const							{	return externalData.get() != nullptr;	}
 		void releaseLocalData();
-		void markAsChanged()								{  	dataChanged=true;	}
+		void markAsChanged();
 		bool hasChanged()const								{  	return dataChanged;	}
-		bool hasLocalData()const							{  	return !binaryData.empty();	}
-		const uint8_t * data()const							{	return binaryData.data();	}
-		uint8_t * data()									{	return binaryData.data();	}
-		size_t dataSize()const								{	return binaryData.size();	}
+		/*! Return the revision of the data, which is set to a new value whenever the data is marked as changed.
+			The revisions are unique among all objects, so that they also change when data is swapped in. */
+		uint32_t getRevision()const							{	return revision;	}
+		bool hasLocalData()const							{  	return hasExternalData() || !binaryData.empty();	}
+		const uint8_t * data()const							{	return hasExternalData() ? externalData.get() : binaryData.data();	}
+		uint8_t * data()									{	return hasExternalData() ? externalData.get() : binaryData.data();	}
+		size_t dataSize()const;
+		/*! Return the local data of the vertex with the given index.
+			\note Requires interleaved data (see VertexDescription::setInterleaved). */
 		const uint8_t * operator[](uint32_t index) const;
 		uint8_t * operator[](uint32_t index);
 
+		/*! Return the position in bytes of the attribute's value of the first vertex in the data.
+			The values of the following vertices follow in steps of getAttributeStride(). */
+		size_t getAttributeOffset(const VertexAttribute & attr)const;
+		//! Return the distance in bytes between the attribute's values of two consecutive vertices.
+		size_t getAttributeStride(const VertexAttribute & attr)const;
+		//! Return the attribute's value of the first vertex in the local data.
+		const uint8_t * getAttributeData(const VertexAttribute & attr)const	{	return data() + getAttributeOffset(attr);	}
+		uint8_t * getAttributeData(const VertexAttribute & attr)			{	return data() + getAttributeOffset(attr);	}
+
 		// bounding box
 		void updateBoundingBox();
 		const Geometry::Box & getBoundingBox() const		{	return bb;	}
@@ -93,7 +128,8 @@ class MeshVertexData {
 		// vbo
 		inline bool isUploaded()const						{   return bufferObject.isValid();    }
 
-		/*! (internal) */
+		/*! (internal) Bind the attributes to the vertex arrays. Each attribute stream of non-interleaved data is
+			bound separately from its position in the vertex data or the VBO. */
 		void bind(RenderingContext & context, bool useVBO);
 		/*! (internal) */
 		void unbind(RenderingContext & context, bool useVBO);
@@ -0,0 +1,121 @@
+/*
+	This file is part of the Rendering library.
+	Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+	This library is subject to the terms of the Mozilla Public License, v. 2.0.
+	You should have received a copy of the MPL along with this library; see the
+	file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#ifndef RENDERING_MESH_STRIDEDATTRIBUTEVIEW_H_
+#define RENDERING_MESH_STRIDEDATTRIBUTEVIEW_H_
+
+#include "MeshVertexData.h"
+#include "VertexAttribute.h"
+#include "VertexDescription.h"
+#include "../Helper.h"
+
+#include <Util/StringIdentifier.h>
+#include <Util/TypeConstant.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+
+namespace Rendering {
+
+//! @cond INTERNAL
+namespace _Internal {
+template<typename value_t> struct AttributeType;
+template<> struct AttributeType<float>		{	static const Util::TypeConstant value = Util::TypeConstant::FLOAT;	};
+template<> struct AttributeType<int8_t>		{	static const Util::TypeConstant value = Util::TypeConstant::INT8;	};
+template<> struct AttributeType<uint8_t>	{	static const Util::TypeConstant value = Util::TypeConstant::UINT8;	};
+template<> struct AttributeType<int16_t>	{	static const Util::TypeConstant value = Util::TypeConstant::INT16;	};
+template<> struct AttributeType<uint16_t>	{	static const Util::TypeConstant value = Util::TypeConstant::UINT16;	};
+template<> struct AttributeType<int32_t>	{	static const Util::TypeConstant value = Util::TypeConstant::INT32;	};
+template<> struct AttributeType<uint32_t>	{	static const Util::TypeConstant value = Util::TypeConstant::UINT32;	};
+}
+//! @endcond
+
+/**
+ * Typed view on the values of one vertex attribute, which are stored with the
+ * vertex size as stride. In contrast to the VertexAttributeAccessors, the data
+ * format is checked once when the view is created; the values are accessed
+ * directly without conversions, virtual calls or range checks.
+ *
+ * @code
+ * auto positions = StridedAttributeView<float>::create(vData, VertexAttributeIds::POSITION, 3);
+ * for(float * p : positions)
+ * 	p[1] += 1.0f;
+ * vData.markAsChanged();
+ * @endcode
+ *
+ * \note The view only stays valid as long as the referenced MeshVertexData is not reallocated.
+ * @ingroup mesh_accessor
+ */
+template<typename value_t>
+class StridedAttributeView {
+	public:
+		class iterator {
+				uint8_t * ptr;
+				size_t stride;
+			public:
+				typedef std::input_iterator_tag iterator_category; // operator* returns a pointer instead of a reference
+				typedef value_t * value_type;
+				typedef std::ptrdiff_t difference_type;
+				typedef value_t ** pointer;
+				typedef value_t * reference;
+
+				iterator(uint8_t * _ptr, size_t _stride) : ptr(_ptr), stride(_stride) {}
+				value_t * operator*() const								{	return reinterpret_cast<value_t *>(ptr);	}
+				value_t * operator[](std::ptrdiff_t n) const			{	return reinterpret_cast<value_t *>(ptr + n * static_cast<std::ptrdiff_t>(stride));	}
+				iterator & operator++()									{	ptr += stride; return *this;	}
+				iterator operator++(int)								{	iterator it(*this); ptr += stride; return it;	}
+				iterator & operator--()									{	ptr -= stride; return *this;	}
+				iterator operator--(int)								{	iterator it(*this); ptr -= stride; return it;	}
+				iterator & operator+=(std::ptrdiff_t n)					{	ptr += n * static_cast<std::ptrdiff_t>(stride); return *this;	}
+				iterator & operator-=(std::ptrdiff_t n)					{	ptr -= n * static_cast<std::ptrdiff_t>(stride); return *this;	}
+				iterator operator+(std::ptrdiff_t n) const				{	return iterator(*this) += n;	}
+				iterator operator-(std::ptrdiff_t n) const				{	return iterator(*this) -= n;	}
+				std::ptrdiff_t operator-(const iterator & other) const	{	return (ptr - other.ptr) / static_cast<std::ptrdiff_t>(stride);	}
+				bool operator==(const iterator & other) const			{	return ptr == other.ptr;	}
+				bool operator!=(const iterator & other) const			{	return ptr != other.ptr;	}
+				bool operator<(const iterator & other) const			{	return ptr < other.ptr;	}
+		};
+
+		StridedAttributeView(uint8_t * _data, size_t _stride, uint32_t _count) : data(_data), stride(_stride), count(_count) {}
+
+		//! Return @c true iff the attribute's values are of type value_t and it has at least @p minValues values.
+		static bool isCompatible(const VertexAttribute & attr, uint32_t minValues = 1) {
+			return !attr.empty() && attr.getNumValues() >= minValues &&
+					attr.getDataType() == getGLType(_Internal::AttributeType<typename std::remove_const<value_t>::type>::value);
+		}
+
+		/*! (static factory)
+			Create a view on the attribute having the given name.
+			If the attribute does not exist or is not compatible (see isCompatible()), an std::invalid_argument exception is thrown. */
+		static StridedAttributeView create(MeshVertexData & vData, Util::StringIdentifier name, uint32_t minValues = 1) {
+			const VertexDescription & vd = vData.getVertexDescription();
+			const VertexAttribute & attr = vd.getAttribute(name);
+			if(!isCompatible(attr, minValues))
+				throw std::invalid_argument("StridedAttributeView: Incompatible attribute '" + name.toString() + '\'');
+			return StridedAttributeView(vData.getAttributeData(attr), vData.getAttributeStride(attr), vData.getVertexCount());
+		}
+
+		value_t * operator[](uint32_t index) const					{	return reinterpret_cast<value_t *>(data + static_cast<size_t>(index) * stride);	}
+		uint32_t size() const										{	return count;	}
+		bool empty() const											{	return count == 0;	}
+		size_t getStride() const									{	return stride;	}
+		iterator begin() const										{	return iterator(data, stride);	}
+		iterator end() const										{	return iterator(data + static_cast<size_t>(count) * stride, stride);	}
+
+	private:
+		uint8_t * data;
+		size_t stride;
+		uint32_t count;
+};
+
+}
+
+#endif /* RENDERING_MESH_STRIDEDATTRIBUTEVIEW_H_ */
@@ -36,6 +36,10 @@ VertexAccessor::~VertexAccessor() {
 }
 
 Util::Reference<VertexAccessor> VertexAccessor::create(MeshVertexData& vData) {
+	if(!vData.getVertexDescription().isInterleaved()) {
+		WARN("VertexAccessor: vertex data has to be interleaved.");
+		return nullptr;
+	}
 	uint8_t* ptr = vData.isUploaded() ? vData._getBufferObject().map() : vData.data();
 	if(!ptr) {
 		WARN("VertexAccessor: could not map vertex data.");
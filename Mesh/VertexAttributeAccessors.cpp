@@ -12,6 +12,9 @@
 #include "VertexAttributeAccessors.h"
 #include "../GLHeader.h"
 #include <Geometry/Convert.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <sstream>
 #include <exception>
 
@@ -48,9 +51,35 @@ static const VertexAttribute & assertAttribute(MeshVertexData & _vData, const Ut
 	return attr;
 }
 
+//! (helper) Normalized integer values in [-1,1] (signed) or [0,1] (unsigned).
+static inline float normalizedToFloat(int8_t v)		{	return Geometry::Convert::fromSignedTo<float>(v);	}
+static inline float normalizedToFloat(int16_t v)	{	return Geometry::Convert::fromSignedTo<float>(v);	}
+static inline float normalizedToFloat(uint16_t v)	{	return Geometry::Convert::fromUnsignedTo<float>(v);	}
+
+//! (helper) Round to the nearest representable value to keep the quantization error at half a step.
+template<typename value_t>
+static inline value_t floatToNormalized(float f) {
+	const float minValue = std::numeric_limits<value_t>::is_signed ? -1.0f : 0.0f;
+	return static_cast<value_t>(std::round(std::max(minValue, std::min(f, 1.0f)) * std::numeric_limits<value_t>::max()));
+}
+
 // ---------------------------------
 // Color
 
+void ColorAttributeAccessor::getColors(uint32_t begin, uint32_t count, float * out)const {
+	assertRange(begin, count);
+	for(uint32_t i = 0; i < count; ++i, out += 4) {
+		const Util::Color4f c = getColor4f(begin + i);
+		out[0] = c.getR(), out[1] = c.getG(), out[2] = c.getB(), out[3] = c.getA();
+	}
+}
+
+void ColorAttributeAccessor::setColors(uint32_t begin, uint32_t count, const float * values) {
+	assertRange(begin, count);
+	for(uint32_t i = 0; i < count; ++i, values += 4)
+		setColor(begin + i, Util::Color4f(values[0], values[1], values[2], values[3]));
+}
+
 /*! ColorAttributeAccessor3f ---|> ColorAttributeAccessor	*/
 class ColorAttributeAccessor3f : public ColorAttributeAccessor {
 	public:
@@ -83,6 +112,18 @@ class ColorAttributeAccessor3f : public ColorAttributeAccessor {
 			float * v = _ptr<float>(index);
 			v[0] = c.getR() , v[1] = c.getG() , v[2] = c.getB();
 		}
+		//! ---|> ColorAttributeAccessor
+		void getColors(uint32_t begin, uint32_t count, float * out)const override {
+			decodeRange<float, 4>(begin, count, out, [](const float * v, float * c) {
+				c[0] = v[0], c[1] = v[1], c[2] = v[2], c[3] = 1.0f;
+			});
+		}
+		//! ---|> ColorAttributeAccessor
+		void setColors(uint32_t begin, uint32_t count, const float * values) override {
+			encodeRange<float, 4>(begin, count, values, [](const float * c, float * v) {
+				v[0] = c[0], v[1] = c[1], v[2] = c[2];
+			});
+		}
 };
 
 /*! ColorAttributeAccessor4f ---|> ColorAttributeAccessor	*/
@@ -117,6 +158,18 @@ class ColorAttributeAccessor4f : public ColorAttributeAccessor {
 			float * v = _ptr<float>(index);
 			v[0] = c.getR() , v[1] = c.getG() , v[2] = c.getB() , v[3] = c.getA();
 		}
+		//! ---|> ColorAttributeAccessor
+		void getColors(uint32_t begin, uint32_t count, float * out)const override {
+			decodeRange<float, 4>(begin, count, out, [](const float * v, float * c) {
+				c[0] = v[0], c[1] = v[1], c[2] = v[2], c[3] = v[3];
+			});
+		}
+		//! ---|> ColorAttributeAccessor
+		void setColors(uint32_t begin, uint32_t count, const float * values) override {
+			encodeRange<float, 4>(begin, count, values, [](const float * c, float * v) {
+				v[0] = c[0], v[1] = c[1], v[2] = c[2], v[3] = c[3];
+			});
+		}
 };
 
 /*! ColorAttributeAccessor4ub ---|> ColorAttributeAccessor	*/
@@ -151,6 +204,20 @@ class ColorAttributeAccessor4ub : public ColorAttributeAccessor {
 			uint8_t * v = _ptr<uint8_t>(index);
 			v[0] = c.getR() , v[1] = c.getG() , v[2] = c.getB() , v[3] = c.getA();
 		}
+		//! ---|> ColorAttributeAccessor
+		void getColors(uint32_t begin, uint32_t count, float * out)const override {
+			decodeRange<uint8_t, 4>(begin, count, out, [](const uint8_t * v, float * c) {
+				const Util::Color4f cf(Util::Color4ub(v[0], v[1], v[2], v[3]));
+				c[0] = cf.getR(), c[1] = cf.getG(), c[2] = cf.getB(), c[3] = cf.getA();
+			});
+		}
+		//! ---|> ColorAttributeAccessor
+		void setColors(uint32_t begin, uint32_t count, const float * values) override {
+			encodeRange<uint8_t, 4>(begin, count, values, [](const float * c, uint8_t * v) {
+				const Util::Color4ub cub(Util::Color4f(c[0], c[1], c[2], c[3]));
+				v[0] = cub.getR(), v[1] = cub.getG(), v[2] = cub.getB(), v[3] = cub.getA();
+			});
+		}
 };
 
 
@@ -171,6 +238,20 @@ Util::Reference<ColorAttributeAccessor> ColorAttributeAccessor::create(MeshVerte
 // ---------------------------------
 // Normals
 
+void NormalAttributeAccessor::getNormals(uint32_t begin, uint32_t count, float * out)const {
+	assertRange(begin, count);
+	for(uint32_t i = 0; i < count; ++i, out += 3) {
+		const Geometry::Vec3 n = getNormal(begin + i);
+		out[0] = n.x(), out[1] = n.y(), out[2] = n.z();
+	}
+}
+
+void NormalAttributeAccessor::setNormals(uint32_t begin, uint32_t count, const float * values) {
+	assertRange(begin, count);
+	for(uint32_t i = 0; i < count; ++i, values += 3)
+		setNormal(begin + i, Geometry::Vec3(values[0], values[1], values[2]));
+}
+
 /*! NormalAttributeAccessor4b ---|> NormalAttributeAccessor */
 class NormalAttributeAccessor4b : public NormalAttributeAccessor {
 	public:
@@ -196,6 +277,25 @@ class NormalAttributeAccessor4b : public NormalAttributeAccessor {
 			v[2] = Geometry::Convert::toSigned<int8_t>(n.z());
 			v[3] = 0;
 		}
+
+		//! ---|> NormalAttributeAccessor
+		void getNormals(uint32_t begin, uint32_t count, float * out)const override {
+			decodeRange<int8_t, 3>(begin, count, out, [](const int8_t * v, float * n) {
+				n[0] = Geometry::Convert::fromSignedTo<float>(v[0]);
+				n[1] = Geometry::Convert::fromSignedTo<float>(v[1]);
+				n[2] = Geometry::Convert::fromSignedTo<float>(v[2]);
+			});
+		}
+
+		//! ---|> NormalAttributeAccessor
+		void setNormals(uint32_t begin, uint32_t count, const float * values) override {
+			encodeRange<int8_t, 3>(begin, count, values, [](const float * n, int8_t * v) {
+				v[0] = Geometry::Convert::toSigned<int8_t>(n[0]);
+				v[1] = Geometry::Convert::toSigned<int8_t>(n[1]);
+				v[2] = Geometry::Convert::toSigned<int8_t>(n[2]);
+				v[3] = 0;
+			});
+		}
 };
 
 /*! NormalAttributeAccessor3f ---|> NormalAttributeAccessor */
@@ -218,6 +318,84 @@ class NormalAttributeAccessor3f : public NormalAttributeAccessor {
 			float * v = _ptr<float>(index);
 			v[0] = n.x() , v[1] = n.y() , v[2] = n.z();
 		}
+
+		//! ---|> NormalAttributeAccessor
+		void getNormals(uint32_t begin, uint32_t count, float * out)const override {
+			decodeRange<float, 3>(begin, count, out, [](const float * v, float * n) {
+				n[0] = v[0], n[1] = v[1], n[2] = v[2];
+			});
+		}
+
+		//! ---|> NormalAttributeAccessor
+		void setNormals(uint32_t begin, uint32_t count, const float * values) override {
+			encodeRange<float, 3>(begin, count, values, [](const float * n, float * v) {
+				v[0] = n[0], v[1] = n[1], v[2] = n[2];
+			});
+		}
+};
+
+/*! NormalAttributeAccessorOct ---|> NormalAttributeAccessor
+	Unit vectors stored as two signed normalized values using an octahedral encoding:
+	The vector is projected onto the octahedron |x|+|y|+|z|=1, and the lower half
+	of the octahedron is folded over the upper half onto the square [-1,1]^2. */
+template<typename value_t>
+class NormalAttributeAccessorOct : public NormalAttributeAccessor {
+		static float signNotZero(float f)	{	return f < 0.0f ? -1.0f : 1.0f;	}
+
+		static void decode(const value_t * v, float * n) {
+			const float x = normalizedToFloat(v[0]);
+			const float y = normalizedToFloat(v[1]);
+			const float z = 1.0f - std::abs(x) - std::abs(y);
+			Geometry::Vec3 unit;
+			if(z < 0.0f) {
+				unit = Geometry::Vec3((1.0f - std::abs(y)) * signNotZero(x), (1.0f - std::abs(x)) * signNotZero(y), z).normalize();
+			} else {
+				unit = Geometry::Vec3(x, y, z).normalize();
+			}
+			n[0] = unit.x(), n[1] = unit.y(), n[2] = unit.z();
+		}
+
+		static void encode(const float * n, value_t * v) {
+			const float l1 = std::abs(n[0]) + std::abs(n[1]) + std::abs(n[2]);
+			float x = l1 > 0.0f ? n[0] / l1 : 0.0f;
+			float y = l1 > 0.0f ? n[1] / l1 : 0.0f;
+			if(n[2] < 0.0f) {
+				const float foldedX = (1.0f - std::abs(y)) * signNotZero(x);
+				y = (1.0f - std::abs(x)) * signNotZero(y);
+				x = foldedX;
+			}
+			v[0] = floatToNormalized<value_t>(x);
+			v[1] = floatToNormalized<value_t>(y);
+		}
+	public:
+		NormalAttributeAccessorOct(MeshVertexData & _vData, const VertexAttribute & _attribute) :
+			NormalAttributeAccessor(_vData, _attribute) {}
+		virtual ~NormalAttributeAccessorOct() {}
+
+		//! ---|> NormalAttributeAccessor
+		Geometry::Vec3 getNormal(uint32_t index)const override {
+			assertRange(index);
+			float n[3];
+			decode(_ptr<const value_t>(index), n);
+			return Geometry::Vec3(n[0], n[1], n[2]);
+		}
+
+		//! ---|> NormalAttributeAccessor
+		void setNormal(uint32_t index, const Geometry::Vec3 & n) override {
+			assertRange(index);
+			const float values[3] = {n.x(), n.y(), n.z()};
+			encode(values, _ptr<value_t>(index));
+		}
+
+		//! ---|> NormalAttributeAccessor
+		void getNormals(uint32_t begin, uint32_t count, float * out)const override {
+			decodeRange<value_t, 3>(begin, count, out, decode);
+		}
+
+		//! ---|> NormalAttributeAccessor
+		void setNormals(uint32_t begin, uint32_t count, const float * values) override {
+			encodeRange<value_t, 3>(begin, count, values, encode);
+		}
 };
 
 //! (static)
@@ -227,6 +405,10 @@ Util::Reference<NormalAttributeAccessor> NormalAttributeAccessor::create(MeshVer
 		return new NormalAttributeAccessor3f(_vData, attr);
 	} else if(attr.getNumValues() >= 4 && attr.getDataType() == GL_BYTE) {
 		return new NormalAttributeAccessor4b(_vData, attr);
+	} else if(attr.getNumValues() == 2 && attr.getDataType() == GL_SHORT) {
+		return new NormalAttributeAccessorOct<int16_t>(_vData, attr);
+	} else if(attr.getNumValues() == 2 && attr.getDataType() == GL_BYTE) {
+		return new NormalAttributeAccessorOct<int8_t>(_vData, attr);
 	} else {
 		throw std::invalid_argument(unimplementedFormatMsg + name.toString() + '\'');
 	}
@@ -235,6 +417,20 @@ Util::Reference<NormalAttributeAccessor> NormalAttributeAccessor::create(MeshVer
 // ---------------------------------
 // Position
 
+void PositionAttributeAccessor::getPositions(uint32_t begin, uint32_t count, float * out)const {
+	assertRange(begin, count);
+	for(uint32_t i = 0; i < count; ++i, out += 3) {
+		const Geometry::Vec3 p = getPosition(begin + i);
+		out[0] = p.x(), out[1] = p.y(), out[2] = p.z();
+	}
+}
+
+void PositionAttributeAccessor::setPositions(uint32_t begin, uint32_t count, const float * values) {
+	assertRange(begin, count);
+	for(uint32_t i = 0; i < count; ++i, values += 3)
+		setPosition(begin + i, Geometry::Vec3(values[0], values[1], values[2]));
+}
+
 /*! PositionAttributeAccessorF ---|> PositionAttributeAccessor */
 class PositionAttributeAccessorF : public PositionAttributeAccessor {
 	public:
@@ -255,6 +451,20 @@ class PositionAttributeAccessorF : public PositionAttributeAccessor {
 			float * v=_ptr<float>(index);
 			v[0] = p.x() , v[1] = p.y() , v[2] = p.z();
 		}
+
+		//! ---|> PositionAttributeAccessor
+		void getPositions(uint32_t begin, uint32_t count, float * out)const override {
+			decodeRange<float, 3>(begin, count, out, [](const float * v, float * p) {
+				p[0] = v[0], p[1] = v[1], p[2] = v[2];
+			});
+		}
+
+		//! ---|> PositionAttributeAccessor
+		void setPositions(uint32_t begin, uint32_t count, const float * values) override {
+			encodeRange<float, 3>(begin, count, values, [](const float * p, float * v) {
+				v[0] = p[0], v[1] = p[1], v[2] = p[2];
+			});
+		}
 };
 
 /*! PositionAttributeAccessorHF ---|> PositionAttributeAccessor */
@@ -283,6 +493,74 @@ class PositionAttributeAccessorHF : public PositionAttributeAccessor {
 			v[1] = Geometry::Convert::floatToHalf(p.y());
 			v[2] = Geometry::Convert::floatToHalf(p.z());
 		}
+
+		//! ---|> PositionAttributeAccessor
+		void getPositions(uint32_t begin, uint32_t count, float * out)const override {
+			decodeRange<uint16_t, 3>(begin, count, out, [](const uint16_t * v, float * p) {
+				p[0] = Geometry::Convert::halfToFloat(v[0]);
+				p[1] = Geometry::Convert::halfToFloat(v[1]);
+				p[2] = Geometry::Convert::halfToFloat(v[2]);
+			});
+		}
+
+		//! ---|> PositionAttributeAccessor
+		void setPositions(uint32_t begin, uint32_t count, const float * values) override {
+			encodeRange<uint16_t, 3>(begin, count, values, [](const float * p, uint16_t * v) {
+				v[0] = Geometry::Convert::floatToHalf(p[0]);
+				v[1] = Geometry::Convert::floatToHalf(p[1]);
+				v[2] = Geometry::Convert::floatToHalf(p[2]);
+			});
+		}
+};
+
+/*! PositionAttributeAccessorN ---|> PositionAttributeAccessor
+	Quantized positions stored as normalized values in [-1,1] (signed) or [0,1] (unsigned).
+	A fourth value is set to one. */
+template<typename value_t>
+class PositionAttributeAccessorN : public PositionAttributeAccessor {
+	public:
+		PositionAttributeAccessorN(MeshVertexData & _vData, const VertexAttribute & _attribute) :
+			PositionAttributeAccessor(_vData, _attribute) {}
+		virtual ~PositionAttributeAccessorN() {}
+
+		//! ---|> PositionAttributeAccessor
+		const Geometry::Vec3 getPosition(uint32_t index) const override {
+			assertRange(index);
+			const value_t * v=_ptr<const value_t>(index);
+			return Geometry::Vec3(normalizedToFloat(v[0]), normalizedToFloat(v[1]), normalizedToFloat(v[2]));
+		}
+
+		//! ---|> PositionAttributeAccessor
+		void setPosition(uint32_t index,const Geometry::Vec3 & p) override {
+			assertRange(index);
+			value_t * v=_ptr<value_t>(index);
+			v[0] = floatToNormalized<value_t>(p.x());
+			v[1] = floatToNormalized<value_t>(p.y());
+			v[2] = floatToNormalized<value_t>(p.z());
+			if(getAttribute().getNumValues() >= 4)
+				v[3] = std::numeric_limits<value_t>::max();
+		}
+
+		//! ---|> PositionAttributeAccessor
+		void getPositions(uint32_t begin, uint32_t count, float * out)const override {
+			decodeRange<value_t, 3>(begin, count, out, [](const value_t * v, float * p) {
+				p[0] = normalizedToFloat(v[0]);
+				p[1] = normalizedToFloat(v[1]);
+				p[2] = normalizedToFloat(v[2]);
+			});
+		}
+
+		//! ---|> PositionAttributeAccessor
+		void setPositions(uint32_t begin, uint32_t count, const float * values) override {
+			const bool hasW = getAttribute().getNumValues() >= 4;
+			encodeRange<value_t, 3>(begin, count, values, [hasW](const float * p, value_t * v) {
+				v[0] = floatToNormalized<value_t>(p[0]);
+				v[1] = floatToNormalized<value_t>(p[1]);
+				v[2] = floatToNormalized<value_t>(p[2]);
+				if(hasW)
+					v[3] = std::numeric_limits<value_t>::max();
+			});
+		}
 };
 
 //! (static)
@@ -292,6 +570,10 @@ Util::Reference<PositionAttributeAccessor> PositionAttributeAccessor::create(Mes
 		return new PositionAttributeAccessorF(_vData, attr);
 	} else if(attr.getNumValues() >= 3 && attr.getDataType() == GL_HALF_FLOAT) {
 		return new PositionAttributeAccessorHF(_vData, attr);
+	} else if(attr.getNumValues() >= 3 && attr.getDataType() == GL_UNSIGNED_SHORT && attr.getNormalize()) {
+		return new PositionAttributeAccessorN<uint16_t>(_vData, attr);
+	} else if(attr.getNumValues() >= 3 && attr.getDataType() == GL_SHORT && attr.getNormalize()) {
+		return new PositionAttributeAccessorN<int16_t>(_vData, attr);
 	} else {
 		throw std::invalid_argument(unimplementedFormatMsg + name.toString() + '\'');
 	}
@@ -300,11 +582,87 @@ Util::Reference<PositionAttributeAccessor> PositionAttributeAccessor::create(Mes
 // ---------------------------------
 // TexCoord
 
+/*! TexCoordAttributeAccessor2f ---|> TexCoordAttributeAccessor */
+class TexCoordAttributeAccessor2f : public TexCoordAttributeAccessor {
+	public:
+		TexCoordAttributeAccessor2f(MeshVertexData & _vData, const VertexAttribute & _attribute) :
+			TexCoordAttributeAccessor(_vData, _attribute) {}
+		virtual ~TexCoordAttributeAccessor2f() {}
+
+		//! ---|> TexCoordAttributeAccessor
+		const Geometry::Vec2 getCoordinate(uint32_t index) const override {
+			assertRange(index);
+			const float * v=_ptr<const float>(index);
+			return Geometry::Vec2(v[0],v[1]);
+		}
+
+		//! ---|> TexCoordAttributeAccessor
+		void setCoordinate(uint32_t index,const Geometry::Vec2 & p) override {
+			assertRange(index);
+			float * v=_ptr<float>(index);
+			v[0] = p.x() , v[1] = p.y();
+		}
+};
+
+/*! TexCoordAttributeAccessor2HF ---|> TexCoordAttributeAccessor */
+class TexCoordAttributeAccessor2HF : public TexCoordAttributeAccessor {
+	public:
+		TexCoordAttributeAccessor2HF(MeshVertexData & _vData, const VertexAttribute & _attribute) :
+			TexCoordAttributeAccessor(_vData, _attribute) {}
+		virtual ~TexCoordAttributeAccessor2HF() {}
+
+		//! ---|> TexCoordAttributeAccessor
+		const Geometry::Vec2 getCoordinate(uint32_t index) const override {
+			assertRange(index);
+			const uint16_t * v=_ptr<const uint16_t>(index);
+			return Geometry::Vec2(Geometry::Convert::halfToFloat(v[0]), Geometry::Convert::halfToFloat(v[1]));
+		}
+
+		//! ---|> TexCoordAttributeAccessor
+		void setCoordinate(uint32_t index,const Geometry::Vec2 & p) override {
+			assertRange(index);
+			uint16_t * v=_ptr<uint16_t>(index);
+			v[0] = Geometry::Convert::floatToHalf(p.x());
+			v[1] = Geometry::Convert::floatToHalf(p.y());
+		}
+};
+
+/*! TexCoordAttributeAccessor2N ---|> TexCoordAttributeAccessor
+	Texture coordinates stored as normalized values in [-1,1] (signed) or [0,1] (unsigned). */
+template<typename value_t>
+class TexCoordAttributeAccessor2N : public TexCoordAttributeAccessor {
+	public:
+		TexCoordAttributeAccessor2N(MeshVertexData & _vData, const VertexAttribute & _attribute) :
+			TexCoordAttributeAccessor(_vData, _attribute) {}
+		virtual ~TexCoordAttributeAccessor2N() {}
+
+		//! ---|> TexCoordAttributeAccessor
+		const Geometry::Vec2 getCoordinate(uint32_t index) const override {
+			assertRange(index);
+			const value_t * v=_ptr<const value_t>(index);
+			return Geometry::Vec2(normalizedToFloat(v[0]), normalizedToFloat(v[1]));
+		}
+
+		//! ---|> TexCoordAttributeAccessor
+		void setCoordinate(uint32_t index,const Geometry::Vec2 & p) override {
+			assertRange(index);
+			value_t * v=_ptr<value_t>(index);
+			v[0] = floatToNormalized<value_t>(p.x());
+			v[1] = floatToNormalized<value_t>(p.y());
+		}
+};
+
 //! (static)
 Util::Reference<TexCoordAttributeAccessor> TexCoordAttributeAccessor::create(MeshVertexData & _vData, Util::StringIdentifier name) {
 	const VertexAttribute & attr = assertAttribute(_vData, name);
 	if(attr.getNumValues() == 2 && attr.getDataType() == GL_FLOAT) {
-		return new TexCoordAttributeAccessor(_vData, attr);
+		return new TexCoordAttributeAccessor2f(_vData, attr);
+	} else if(attr.getNumValues() == 2 && attr.getDataType() == GL_HALF_FLOAT) {
+		return new TexCoordAttributeAccessor2HF(_vData, attr);
+	} else if(attr.getNumValues() == 2 && attr.getDataType() == GL_UNSIGNED_SHORT && attr.getNormalize()) {
+		return new TexCoordAttributeAccessor2N<uint16_t>(_vData, attr);
+	} else if(attr.getNumValues() == 2 && attr.getDataType() == GL_SHORT && attr.getNormalize()) {
+		return new TexCoordAttributeAccessor2N<int16_t>(_vData, attr);
 	} else {
 		throw std::invalid_argument(unimplementedFormatMsg + name.toString() + '\'');
 	}
@@ -430,12 +788,55 @@ class FloatAttributeAccessorHF : public FloatAttributeAccessor {
 		void setValues(uint32_t index, const float* values, uint32_t count) override {
 			assertRange(index);
 			count = std::min<uint32_t>(count, getAttribute().getNumValues());
-			uint8_t * v = _ptr<uint8_t>(index);
+			uint16_t * v = _ptr<uint16_t>(index);
 			for(uint32_t i=0; i<count; ++i)
 				v[i] = Geometry::Convert::floatToHalf(values[i]);
 		}
 };
 
+/*! FloatAttributeAccessorN ---|> FloatAttributeAccessor
+	Values stored as normalized 16 bit integers in [-1,1] (signed) or [0,1] (unsigned). */
+template<typename value_t>
+class FloatAttributeAccessorN : public FloatAttributeAccessor {
+	public:
+		FloatAttributeAccessorN(MeshVertexData & _vData, const VertexAttribute & _attribute) :
+			FloatAttributeAccessor(_vData, _attribute) {}
+		virtual ~FloatAttributeAccessorN() {}
+
+		//! ---|> FloatAttributeAccessor
+		float getValue(uint32_t index) const override {
+			assertRange(index);
+			const value_t * v = _ptr<const value_t>(index);
+			return normalizedToFloat(v[0]);
+		}
+
+		//! ---|> FloatAttributeAccessor
+		void setValue(uint32_t index, float value) override {
+			assertRange(index);
+			value_t * v = _ptr<value_t>(index);
+			v[0] = floatToNormalized<value_t>(value);
+		}
+
+		//! ---|> FloatAttributeAccessor
+		const std::vector<float> getValues(uint32_t index) const override {
+			assertRange(index);
+			const value_t * v = _ptr<const value_t>(index);
+			std::vector<float> out(getAttribute().getNumValues());
+			for(uint32_t i=0; i<out.size(); ++i)
+				out[i] = normalizedToFloat(v[i]);
+			return out;
+		}
+
+		//! ---|> FloatAttributeAccessor
+		void setValues(uint32_t index, const float* values, uint32_t count) override {
+			assertRange(index);
+			count = std::min<uint32_t>(count, getAttribute().getNumValues());
+			value_t * v = _ptr<value_t>(index);
+			for(uint32_t i=0; i<count; ++i)
+				v[i] = floatToNormalized<value_t>(values[i]);
+		}
+};
+
 /*! FloatAttributeAccessorf ---|> FloatAttributeAccessor */
 class FloatAttributeAccessorf : public FloatAttributeAccessor {
 	public:
@@ -484,6 +885,10 @@ Util::Reference<FloatAttributeAccessor> FloatAttributeAccessor::create(MeshVerte
 		return new FloatAttributeAccessorub(_vData, attr);
 	} else if(attr.getDataType() == GL_HALF_FLOAT) {
 		return new FloatAttributeAccessorHF(_vData, attr);
+	} else if(attr.getDataType() == GL_SHORT && attr.getNormalize()) {
+		return new FloatAttributeAccessorN<int16_t>(_vData, attr);
+	} else if(attr.getDataType() == GL_UNSIGNED_SHORT && attr.getNormalize()) {
+		return new FloatAttributeAccessorN<uint16_t>(_vData, attr);
 	} else {
 		throw std::invalid_argument(unimplementedFormatMsg + name.toString() + '\'');
 	}
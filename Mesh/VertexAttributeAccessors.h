@@ -34,17 +34,37 @@ namespace Rendering {
 class VertexAttributeAccessor : public Util::ReferenceCounter<VertexAttributeAccessor>{
 		MeshVertexData & vData;
 		const VertexAttribute attribute;
-		const size_t vertexSize;
+		const size_t stride;
 		uint8_t * const dataPtr;
 	protected:
 
 		VertexAttributeAccessor(MeshVertexData & _vData,VertexAttribute _attribute) :
 				ReferenceCounter_t(),vData(_vData),attribute(std::move(_attribute)),
-				vertexSize(_vData.getVertexDescription().getVertexSize()),
-				dataPtr( vData.data() + attribute.getOffset() ) {}
+				stride(_vData.getAttributeStride(attribute)),
+				dataPtr( vData.getAttributeData(attribute) ) {}
 
 		void assertRange(uint32_t index)const			{	if(index>=vData.getVertexCount()) throwRangeError(index); }
+		void assertRange(uint32_t begin, uint32_t count)const	{	if(begin>vData.getVertexCount() || count>vData.getVertexCount()-begin) throwRangeError(begin+count-1); }
 		void assertNumValues(uint32_t index, uint32_t count) const;
+
+		/*! (internal) Call @p decode(const value_t * vertexValues, float * out) for the vertices [begin, begin + count)
+			with a single range check, advancing @p out by @p dim floats per vertex. */
+		template<typename value_t, uint32_t dim, typename Decode>
+		void decodeRange(uint32_t begin, uint32_t count, float * out, Decode decode)const {
+			assertRange(begin, count);
+			const uint8_t * ptr = dataPtr + static_cast<size_t>(begin) * stride;
+			for(uint32_t i = 0; i < count; ++i, ptr += stride, out += dim)
+				decode(reinterpret_cast<const value_t *>(ptr), out);
+		}
+		/*! (internal) Call @p encode(const float * in, value_t * vertexValues) for the vertices [begin, begin + count)
+			with a single range check, advancing @p in by @p dim floats per vertex. */
+		template<typename value_t, uint32_t dim, typename Encode>
+		void encodeRange(uint32_t begin, uint32_t count, const float * in, Encode encode) {
+			assertRange(begin, count);
+			uint8_t * ptr = dataPtr + static_cast<size_t>(begin) * stride;
+			for(uint32_t i = 0; i < count; ++i, ptr += stride, in += dim)
+				encode(in, reinterpret_cast<value_t *>(ptr));
+		}
 	public:
 		virtual ~VertexAttributeAccessor() {}
 
@@ -52,7 +72,7 @@ class VertexAttributeAccessor : public Util::ReferenceCounter<VertexAttributeAcc
 		const VertexAttribute & getAttribute()const		{	return attribute;	}
 
 		template<typename number_t>
-		number_t * _ptr(uint32_t index)const			{	return reinterpret_cast<number_t*>(dataPtr+index*vertexSize); }
+		number_t * _ptr(uint32_t index)const			{	return reinterpret_cast<number_t*>(dataPtr+index*stride); }
 	private:
 		void throwRangeError(uint32_t index)const;		
 };
@@ -79,13 +99,20 @@ class ColorAttributeAccessor : public VertexAttributeAccessor{
 		virtual Util::Color4ub getColor4ub(uint32_t index)const = 0;
 		virtual void setColor(uint32_t index,const Util::Color4f & c) = 0;
 		virtual void setColor(uint32_t index,const Util::Color4ub & c) = 0;
+
+		/*! Read the colors of the vertices [begin, begin + count) as four floats (r, g, b, a) each into @p out.
+			The data format is resolved once for all vertices; the range is checked once.	*/
+		virtual void getColors(uint32_t begin, uint32_t count, float * out)const;
+		//! Set the colors of the vertices [begin, begin + count) from four floats (r, g, b, a) each.
+		virtual void setColors(uint32_t begin, uint32_t count, const float * values);
 };
 
 // ---------------------------------
 // Normals
 
 /*! NormalAttributeAccessor ---|> VertexAttributeAccessor
-	Abstract accessor for vertex normals (or tangents etc.)*/
+	Abstract accessor for vertex normals (or tangents etc.)
+	Attributes with two byte or short values are octahedral encoded unit vectors (see VertexDescription::appendNormalOctahedral()). */
 class NormalAttributeAccessor : public VertexAttributeAccessor{
 	protected:
 		NormalAttributeAccessor(MeshVertexData & _vData,const VertexAttribute & _attribute) :
@@ -100,14 +127,20 @@ class NormalAttributeAccessor : public VertexAttributeAccessor{
 
 		virtual Geometry::Vec3 getNormal(uint32_t index)const = 0;
 		virtual void setNormal(uint32_t index,const Geometry::Vec3 & vec) = 0;
+
+		/*! Read the normals of the vertices [begin, begin + count) as three floats each into @p out.
+			The data format is resolved once for all vertices; the range is checked once.	*/
+		virtual void getNormals(uint32_t begin, uint32_t count, float * out)const;
+		//! Set the normals of the vertices [begin, begin + count) from three floats each.
+		virtual void setNormals(uint32_t begin, uint32_t count, const float * values);
 };
 
 // ---------------------------------
 // Position
 
 /*! PositionAttributeAccessor ---|> VertexAttributeAccessor
-	Accessor for float vertex positions.
-	\note If someday something else than vec3 is used for storing positions, this has to be implemented using new subclasses! */
+	Accessor for three-dimensional vertex positions stored as float, half float or normalized short values.
+	\note Normalized short values are quantized positions (see MeshUtils::compressVertices). */
 class PositionAttributeAccessor : public VertexAttributeAccessor{
 	protected:
 		PositionAttributeAccessor(MeshVertexData & _vData,const VertexAttribute & _attribute) :
@@ -122,14 +155,19 @@ class PositionAttributeAccessor : public VertexAttributeAccessor{
 
 		virtual const Geometry::Vec3 getPosition(uint32_t index) const = 0;
 		virtual void setPosition(uint32_t index, const Geometry::Vec3 & p) = 0;
+
+		/*! Read the positions of the vertices [begin, begin + count) as three floats each into @p out.
+			The data format is resolved once for all vertices; the range is checked once.	*/
+		virtual void getPositions(uint32_t begin, uint32_t count, float * out)const;
+		//! Set the positions of the vertices [begin, begin + count) from three floats each.
+		virtual void setPositions(uint32_t begin, uint32_t count, const float * values);
 };
 
 // ---------------------------------
 // TexCoord
 
 /*! TexCoordAttributeAccessor ---|> VertexAttributeAccessor
-	Abstract accessor for texture coordinates.
-	\note If someday something else than vec2f is used for storing texture coordinates, this has to be implemented using new subclasses! */
+	Abstract accessor for two-dimensional texture coordinates stored as float, half float or normalized short values. */
 class TexCoordAttributeAccessor : public VertexAttributeAccessor{
 	protected:
 		TexCoordAttributeAccessor(MeshVertexData & _vData,const VertexAttribute & _attribute) :
@@ -143,17 +181,8 @@ class TexCoordAttributeAccessor : public VertexAttributeAccessor{
 
 		virtual ~TexCoordAttributeAccessor(){}
 
-		const Geometry::Vec2 getCoordinate(uint32_t index)const	{
-			assertRange(index);
-			const float * v=_ptr<const float>(index);
-			return Geometry::Vec2(v[0],v[1]);
-		}
-
-		void setCoordinate(uint32_t index,const Geometry::Vec2 & p){
-			assertRange(index);
-			float * v=_ptr<float>(index);
-			v[0] = p.x() , v[1] = p.y();
-		}
+		virtual const Geometry::Vec2 getCoordinate(uint32_t index) const = 0;
+		virtual void setCoordinate(uint32_t index,const Geometry::Vec2 & p) = 0;
 };
 
 
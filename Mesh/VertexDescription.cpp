@@ -13,18 +13,50 @@
 #include "../GLHeader.h"
 #include <Util/StringIdentifier.h>
 #include <iterator>
+#include <mutex>
 #include <sstream>
+#include <unordered_set>
 
 namespace Rendering {
 
 
 //! (ctor)
-VertexDescription::VertexDescription() : attributes(), vertexSize(0) {
+VertexDescription::VertexDescription() : attributes(), vertexSize(0), interleaved(true), hash(0), attributeTable() {
+	updateLookupData();
+}
+
+const size_t VertexDescription::STREAM_ALIGNMENT;
+
+static size_t getStreamSize(const VertexAttribute & attr, uint32_t vertexCount) {
+	const size_t size = static_cast<size_t>(attr.getDataSize()) * vertexCount;
+	return (size + VertexDescription::STREAM_ALIGNMENT - 1) / VertexDescription::STREAM_ALIGNMENT * VertexDescription::STREAM_ALIGNMENT;
+}
+
+size_t VertexDescription::getAttributeDataOffset(const VertexAttribute & attr, uint32_t vertexCount) const {
+	if(interleaved)
+		return attr.getOffset();
+	size_t offset = 0;
+	for(const auto & other : attributes) {
+		if(other.getNameId() == attr.getNameId())
+			return offset;
+		offset += getStreamSize(other, vertexCount);
+	}
+	return 0;
+}
+
+size_t VertexDescription::getDataSize(uint32_t vertexCount) const {
+	if(interleaved)
+		return vertexSize * vertexCount;
+	size_t size = 0;
+	for(const auto & attr : attributes)
+		size += getStreamSize(attr, vertexCount);
+	return size;
 }
 
 const VertexAttribute & VertexDescription::appendAttribute(const Util::StringIdentifier & nameId, uint8_t numValues, uint32_t glType, bool normalize, bool convertToFloat/*=true*/) {
 	attributes.push_back(VertexAttribute(getVertexSize(), numValues, glType, nameId, nameId.toString(),normalize,convertToFloat));
 	vertexSize += attributes.back().getDataSize();
+	updateLookupData();
 	return attributes.back();
 }
 const VertexAttribute & VertexDescription::appendAttribute(const Util::StringIdentifier & nameId, uint8_t numValues, uint32_t glType) {
@@ -34,6 +66,7 @@ const VertexAttribute & VertexDescription::appendAttribute(const Util::StringIde
 const VertexAttribute & VertexDescription::appendAttribute(const std::string & name, uint8_t numValues, uint32_t type, bool normalize, bool convertToFloat/*=true*/) {
 	attributes.push_back(VertexAttribute(getVertexSize(), numValues, type, Util::StringIdentifier(name), name, normalize, convertToFloat));
 	vertexSize += attributes.back().getDataSize();
+	updateLookupData();
 	return attributes.back();
 }
 
@@ -51,12 +84,8 @@ const VertexAttribute & VertexDescription::getAttribute(const std::string & name
 
 const VertexAttribute & VertexDescription::getAttribute(const Util::StringIdentifier & nameId) const {
 	static const VertexAttribute emptyAttribute;
-	for(const auto & attr : getAttributes()) {
-		if(attr.getNameId() == nameId) {
-			return attr;
-		}
-	}
-	return emptyAttribute;
+	const size_t index = findAttribute(nameId);
+	return index < attributes.size() ? attributes[index] : emptyAttribute;
 }
 
 bool VertexDescription::hasAttribute(const std::string & name) const {
@@ -64,12 +93,52 @@ bool VertexDescription::hasAttribute(const std::string & name) const {
 }
 
 bool VertexDescription::hasAttribute(const Util::StringIdentifier & nameId) const {
-	for(const auto & attr : getAttributes()) {
-		if(attr.getNameId() == nameId) {
-			return true;
-		}
+	return findAttribute(nameId) < attributes.size();
+}
+
+size_t VertexDescription::findAttribute(const Util::StringIdentifier & nameId) const {
+	if(attributeTable.empty())
+		return attributes.size();
+	const size_t mask = attributeTable.size() - 1;
+	for(size_t slot = nameId.getValue() & mask; attributeTable[slot] != 0; slot = (slot + 1) & mask) {
+		const size_t index = attributeTable[slot] - 1;
+		if(attributes[index].getNameId() == nameId)
+			return index;
+	}
+	return attributes.size();
+}
+
+static void combineHash(size_t & hash, size_t value) {
+	hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+}
+
+void VertexDescription::updateLookupData() {
+	// the hash covers the properties compared by operator==
+	hash = 0;
+	combineHash(hash, vertexSize);
+	combineHash(hash, interleaved ? 1 : 0);
+	for(const auto & attr : attributes) {
+		combineHash(hash, attr.getNameId().getValue());
+		combineHash(hash, attr.getOffset());
+		combineHash(hash, attr.getNumValues());
+		combineHash(hash, attr.getDataType());
+		combineHash(hash, attr.getNormalize() ? 1 : 0);
+	}
+
+	size_t tableSize = attributes.empty() ? 0 : 1;
+	while(tableSize < 2 * attributes.size())
+		tableSize <<= 1;
+	attributeTable.assign(tableSize, 0);
+	const size_t mask = tableSize - 1;
+	for(size_t index = 0; index < attributes.size(); ++index) {
+		const Util::StringIdentifier nameId = attributes[index].getNameId();
+		size_t slot = nameId.getValue() & mask;
+		while(attributeTable[slot] != 0 && attributes[attributeTable[slot] - 1].getNameId() != nameId)
+			slot = (slot + 1) & mask;
+		// if several attributes have the same name, the first one is found
+		if(attributeTable[slot] == 0)
+			attributeTable[slot] = static_cast<uint16_t>(index + 1);
 	}
-	return false;
 }
 
 void VertexDescription::updateAttribute(const VertexAttribute & attr) {
@@ -87,6 +156,7 @@ void VertexDescription::updateAttribute(const VertexAttribute & attr) {
 				toUpdateAttr.offset = vertexSize;
 				vertexSize += toUpdateAttr.getDataSize();
 			}
+			updateLookupData();
 			return;
 		}
 	}
@@ -100,18 +170,22 @@ std::string VertexDescription::toString() const {
 	for(const auto & attr : getAttributes()) {
 		s << ", " << attr.toString();
 	}
+	if(!interleaved)
+		s << ", non-interleaved";
 	s<< ")";
 	return s.str();
 }
 
-bool VertexDescription::operator==(const VertexDescription & other) const {
-	return getVertexSize() == other.getVertexSize() &&
+bool VertexDescription::isEqual(const VertexDescription & other) const {
+	return getVertexSize() == other.getVertexSize() && interleaved == other.interleaved &&
 		   getAttributes() == other.getAttributes();
 }
 
 bool VertexDescription::operator<(const VertexDescription & other)const{
 	if(getVertexSize() != other.getVertexSize()){
 		return getVertexSize() < other.getVertexSize();
+	}else if(interleaved != other.interleaved){
+		return interleaved < other.interleaved;
 	}else if(getNumAttributes() != other.getNumAttributes()){
 		return getNumAttributes() < other.getNumAttributes();
 	}
@@ -124,6 +198,19 @@ bool VertexDescription::operator<(const VertexDescription & other)const{
 	return false;
 }
 
+struct VertexDescriptionHash {
+	size_t operator()(const VertexDescription & vd) const {
+		return vd.getHash();
+	}
+};
+
+//! (static)
+const VertexDescription & VertexDescription::intern(const VertexDescription & vd) {
+	static std::mutex mutex;
+	static std::unordered_set<VertexDescription, VertexDescriptionHash> descriptions;
+	std::lock_guard<std::mutex> lock(mutex);
+	return *descriptions.insert(vd).first;
+}
 
 const VertexAttribute & VertexDescription::appendColorRGBAByte() {
 	return appendAttribute(VertexAttributeIds::COLOR, 4, GL_UNSIGNED_BYTE, true);
@@ -145,6 +232,10 @@ const VertexAttribute & VertexDescription::appendNormalFloat() {
 	return appendAttribute(VertexAttributeIds::NORMAL, 3, GL_FLOAT, false);
 }
 
+const VertexAttribute & VertexDescription::appendNormalOctahedral() {
+	return appendAttribute(VertexAttributeIds::NORMAL, 2, GL_SHORT, true);
+}
+
 const VertexAttribute & VertexDescription::appendPosition2D() {
 	return appendAttribute(VertexAttributeIds::POSITION, 2, GL_FLOAT, false);
 }
@@ -161,9 +252,21 @@ const VertexAttribute & VertexDescription::appendPosition4DHalf() {
 	return appendAttribute(VertexAttributeIds::POSITION, 4, GL_HALF_FLOAT, false);
 }
 
+const VertexAttribute & VertexDescription::appendPositionQuantized() {
+	return appendAttribute(VertexAttributeIds::POSITION, 4, GL_UNSIGNED_SHORT, true);
+}
+
 const VertexAttribute & VertexDescription::appendTexCoord(uint_fast8_t textureUnit /*= 0*/) {
 	return appendAttribute(VertexAttributeIds::getTextureCoordinateIdentifier(textureUnit), 2, GL_FLOAT, false);
 }
 
+const VertexAttribute & VertexDescription::appendTexCoordHalf(uint_fast8_t textureUnit /*= 0*/) {
+	return appendAttribute(VertexAttributeIds::getTextureCoordinateIdentifier(textureUnit), 2, GL_HALF_FLOAT, false);
+}
+
+const VertexAttribute & VertexDescription::appendTexCoordShort(uint_fast8_t textureUnit /*= 0*/) {
+	return appendAttribute(VertexAttributeIds::getTextureCoordinateIdentifier(textureUnit), 2, GL_UNSIGNED_SHORT, true);
+}
+
 
 }
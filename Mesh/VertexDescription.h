@@ -16,6 +16,7 @@
 #include <deque>
 #include <cstdint>
 #include <string>
+#include <vector>
 
 namespace Util {
 class StringIdentifier;
@@ -24,6 +25,10 @@ namespace Rendering {
 
 /**
  * VertexDescription
+ * A hash of the description and a lookup table for the attributes' names are updated
+ * whenever the description is changed, so that getAttribute() does not search the
+ * attributes and unequal descriptions are compared in constant time. Equal descriptions
+ * can be shared using intern(); the shared descriptions are compared by their address.
  * @ingroup mesh
  */
 class VertexDescription {
@@ -64,6 +69,10 @@ class VertexDescription {
 		//! Add a three-dimensional normal attribute. It is stored as three float values.
 		const VertexAttribute & appendNormalFloat();
 
+		/*! Add a three-dimensional normal attribute. It is stored as two normalized short values using an octahedral encoding.
+			\note A shader has to decode the normal: n = vec3(v, 1 - |v.x| - |v.y|); if n.z < 0: n.xy = (1 - |v.yx|) * sign(v.xy) (with sign(0) = 1); normalize(n) */
+		const VertexAttribute & appendNormalOctahedral();
+
 		//! Add a two-dimensional position attribute. It is stored as two float values.
 		const VertexAttribute & appendPosition2D();
 
@@ -76,10 +85,20 @@ class VertexDescription {
 		//! Add a three-dimensional position attribute. It is stored as four half float values.
 		const VertexAttribute & appendPosition4DHalf();
 
+		/*! Add a three-dimensional position attribute. It is stored as four normalized unsigned short values in [0,1]; the fourth value is one.
+			\see MeshUtils::compressVertices for quantizing the positions relative to the bounding box */
+		const VertexAttribute & appendPositionQuantized();
+
 		//! Add a texture coordinate attribute. It is stored as two float values.
 		const VertexAttribute & appendTexCoord(uint_fast8_t textureUnit = 0);
 
-		/*! Get a reference to the attribute with the corresponding name.
+		//! Add a texture coordinate attribute. It is stored as two half float values.
+		const VertexAttribute & appendTexCoordHalf(uint_fast8_t textureUnit = 0);
+
+		//! Add a texture coordinate attribute for coordinates in [0,1]. It is stored as two normalized unsigned short values.
+		const VertexAttribute & appendTexCoordShort(uint_fast8_t textureUnit = 0);
+
+		/*! Get a reference to the attribute with the corresponding name (in constant time).
 			\return Always returns an attribute.
 					If the attribute is not present in the vertex description, it is empty.
 			\note The owner of the attribute is the vertexDescription, so be careful if the
@@ -98,17 +117,55 @@ class VertexDescription {
 		 */
 		void updateAttribute(const VertexAttribute & attr);
 
+		/*! Select the memory layout of the vertex data. By default, the values of all attributes of a vertex
+			are stored together (interleaved). Otherwise, the values of each attribute are stored in a separate
+			stream (structure of arrays), which lets loops over single attributes run on contiguous data.
+			The streams are stored one after another; each starts at a multiple of STREAM_ALIGNMENT bytes.
+			\note Code accessing the vertex data directly has to use MeshVertexData::getAttributeData() and
+				getAttributeStride(); functions relying on whole vertices (e.g. MeshVertexData::operator[])
+				require interleaved data. See MeshUtils::convertVertexLayout(). */
+		void setInterleaved(bool b)							{	interleaved = b; updateLookupData();	}
+		bool isInterleaved()const							{	return interleaved;	}
+
+		//! Alignment in bytes of the attribute streams of non-interleaved vertex data.
+		static const size_t STREAM_ALIGNMENT = 16;
+
+		//! Return the position in bytes of the attribute's first value in vertex data holding @p vertexCount vertices.
+		size_t getAttributeDataOffset(const VertexAttribute & attr, uint32_t vertexCount)const;
+		//! Return the distance in bytes between the attribute's values of two consecutive vertices.
+		size_t getAttributeStride(const VertexAttribute & attr)const	{	return interleaved ? vertexSize : attr.getDataSize();	}
+		//! Return the size in bytes of vertex data holding @p vertexCount vertices.
+		size_t getDataSize(uint32_t vertexCount)const;
+
 		size_t getVertexSize()const							{	return vertexSize;	}
 		size_t getNumAttributes()const						{	return attributes.size();	}
 		const attributeContainer_t & getAttributes()const	{	return attributes;	}
-		bool operator==(const VertexDescription & other)const;
+		bool operator==(const VertexDescription & other)const	{	return this == &other || (hash == other.hash && isEqual(other));	}
 		bool operator<(const VertexDescription & other)const;
 
+		//! Return a hash value of the description; equal descriptions have the same hash value.
+		size_t getHash()const								{	return hash;	}
+
+		/*! (static) Return the shared instance of the given description.
+			Equal descriptions share the same instance, which is never deleted. */
+		static const VertexDescription & intern(const VertexDescription & vd);
+
 		std::string toString()const;
 
 	private:
 		attributeContainer_t attributes;
 		size_t vertexSize;
+		bool interleaved;
+		size_t hash;
+		/*! Open addressing hash table on the attributes' name ids. An entry holds the index of an attribute
+			plus one; zero marks an empty entry. The size is a power of two and at least twice the number of attributes. */
+		std::vector<uint16_t> attributeTable;
+
+		//! Recalculate the hash value and the attribute table after the description has been changed.
+		void updateLookupData();
+		//! Return the index of the first attribute with the given name, or getNumAttributes() if there is none.
+		size_t findAttribute(const Util::StringIdentifier & nameId)const;
+		bool isEqual(const VertexDescription & other)const;
 
 };
 // ----------------------------------
@@ -0,0 +1,194 @@
+/*
+	This file is part of the Rendering library.
+	Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+	This library is subject to the terms of the Mozilla Public License, v. 2.0.
+	You should have received a copy of the MPL along with this library; see the
+	file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#include "CompactKeyFrames.h"
+#include "../Mesh/VertexAttribute.h"
+#include "../Mesh/VertexAttributeIds.h"
+#include "../Mesh/VertexDescription.h"
+#include "../GLHeader.h"
+#include <Geometry/Vec3.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace Rendering {
+namespace MeshUtils {
+
+static const float MAX_OFFSET = 32767.0f;
+static const float MAX_NORMAL = 127.0f;
+
+static bool isFloat3(const VertexAttribute & attr) {
+	return attr.getDataType() == GL_FLOAT && attr.getNumValues() >= 3;
+}
+
+//! out[i] = base[i] + a[i] * factorA + b[i] * factorB
+static void blendOffsets(const float * base, const int16_t * a, const int16_t * b, float factorA, float factorB, float * out, uint32_t count) {
+	for(uint32_t i = 0; i < count; ++i)
+		out[i] = base[i] + static_cast<float>(a[i]) * factorA + static_cast<float>(b[i]) * factorB;
+}
+
+//! out[i] = a[i] * factorA + b[i] * factorB
+static void blendNormals(const int8_t * a, const int8_t * b, float factorA, float factorB, float * out, uint32_t count) {
+	for(uint32_t i = 0; i < count; ++i)
+		out[i] = static_cast<float>(a[i]) * factorA + static_cast<float>(b[i]) * factorB;
+}
+
+CompactKeyFrames::CompactKeyFrames(MeshVertexData && _baseFrame, std::vector<uint32_t> _keyVertexIndices) :
+		baseFrame(std::move(_baseFrame)), keyVertexIndices(std::move(_keyVertexIndices)), keyVertexCount(0),
+		positionOffset(0), normalOffset(0), hasNormals(false) {
+	const VertexDescription & vd = baseFrame.getVertexDescription();
+	const VertexAttribute & posAttr = vd.getAttribute(VertexAttributeIds::POSITION);
+	const VertexAttribute & normalAttr = vd.getAttribute(VertexAttributeIds::NORMAL);
+	if(!isFloat3(posAttr) || (!normalAttr.empty() && !isFloat3(normalAttr)))
+		throw std::invalid_argument("CompactKeyFrames: Positions and normals have to be stored as floats.");
+	if(!vd.isInterleaved())
+		throw std::invalid_argument("CompactKeyFrames: The base frame has to be interleaved.");
+	if(!baseFrame.hasLocalData())
+		throw std::invalid_argument("CompactKeyFrames: The base frame has no local data.");
+	positionOffset = posAttr.getOffset();
+	normalOffset = normalAttr.getOffset();
+	hasNormals = !normalAttr.empty();
+
+	const uint32_t vertexCount = baseFrame.getVertexCount();
+	if(keyVertexIndices.empty()) {
+		keyVertexCount = vertexCount;
+		firstVertices.resize(vertexCount);
+		for(uint32_t v = 0; v < vertexCount; ++v)
+			firstVertices[v] = v;
+	} else {
+		if(keyVertexIndices.size() != vertexCount)
+			throw std::invalid_argument("CompactKeyFrames: The number of keyframe vertex indices differs from the number of vertices.");
+		keyVertexCount = *std::max_element(keyVertexIndices.begin(), keyVertexIndices.end()) + 1;
+		firstVertices.assign(keyVertexCount, vertexCount);
+		for(uint32_t v = vertexCount; v-- > 0;)
+			firstVertices[keyVertexIndices[v]] = v;
+		if(std::find(firstVertices.begin(), firstVertices.end(), vertexCount) != firstVertices.end())
+			throw std::invalid_argument("CompactKeyFrames: Unused keyframe vertex.");
+	}
+
+	basePositions.resize(3 * keyVertexCount);
+	for(uint32_t k = 0; k < keyVertexCount; ++k) {
+		const float * position = reinterpret_cast<const float *>(baseFrame[firstVertices[k]] + positionOffset);
+		for(uint_fast8_t c = 0; c < 3; ++c)
+			basePositions[c * keyVertexCount + k] = position[c];
+	}
+}
+
+void CompactKeyFrames::addFrame(const float * positions, const float * frameNormals) {
+	const uint32_t n = keyVertexCount;
+	Frame frame;
+	frame.bounds.invalidate();
+	const size_t positionsBegin = positionOffsets.size();
+	positionOffsets.resize(positionsBegin + 3 * n);
+	int16_t * quantized = positionOffsets.data() + positionsBegin;
+	for(uint_fast8_t c = 0; c < 3; ++c) {
+		const float * base = basePositions.data() + c * n;
+		float maxOffset = 0.0f;
+		for(uint32_t k = 0; k < n; ++k)
+			maxOffset = std::max(maxOffset, std::abs(positions[3 * k + c] - base[k]));
+		frame.scale[c] = maxOffset > 0.0f ? maxOffset / MAX_OFFSET : 1.0f;
+		const float invScale = 1.0f / frame.scale[c];
+		for(uint32_t k = 0; k < n; ++k) {
+			const float offset = std::round((positions[3 * k + c] - base[k]) * invScale);
+			quantized[c * n + k] = static_cast<int16_t>(std::max(-MAX_OFFSET, std::min(MAX_OFFSET, offset)));
+		}
+	}
+	// the bounds of the decoded positions
+	for(uint32_t k = 0; k < n; ++k) {
+		frame.bounds.include(Geometry::Vec3(basePositions[k] + quantized[k] * frame.scale[0],
+											basePositions[n + k] + quantized[n + k] * frame.scale[1],
+											basePositions[2 * n + k] + quantized[2 * n + k] * frame.scale[2]));
+	}
+
+	if(hasNormals) {
+		const size_t normalsBegin = normals.size();
+		normals.resize(normalsBegin + 3 * n);
+		int8_t * quantizedNormals = normals.data() + normalsBegin;
+		for(uint_fast8_t c = 0; c < 3; ++c) {
+			for(uint32_t k = 0; k < n; ++k) {
+				const float value = std::max(-1.0f, std::min(1.0f, frameNormals[3 * k + c]));
+				quantizedNormals[c * n + k] = static_cast<int8_t>(std::round(value * MAX_NORMAL));
+			}
+		}
+	}
+	frames.push_back(frame);
+}
+
+void CompactKeyFrames::addFrame(const MeshVertexData & frame) {
+	if(!(frame.getVertexDescription() == baseFrame.getVertexDescription()) || frame.getVertexCount() != baseFrame.getVertexCount())
+		throw std::invalid_argument("CompactKeyFrames::addFrame: The frame's layout differs from the base frame.");
+	std::vector<float> positions(3 * keyVertexCount);
+	std::vector<float> frameNormals(hasNormals ? 3 * keyVertexCount : 0);
+	for(uint32_t k = 0; k < keyVertexCount; ++k) {
+		const uint8_t * vertex = frame[firstVertices[k]];
+		std::memcpy(positions.data() + 3 * k, vertex + positionOffset, 3 * sizeof(float));
+		if(hasNormals)
+			std::memcpy(frameNormals.data() + 3 * k, vertex + normalOffset, 3 * sizeof(float));
+	}
+	addFrame(positions.data(), frameNormals.data());
+}
+
+void CompactKeyFrames::interpolate(uint32_t frame1, uint32_t frame2, float t, MeshVertexData & target) const {
+	if(frame1 >= frames.size() || frame2 >= frames.size())
+		throw std::out_of_range("CompactKeyFrames::interpolate: Invalid frame.");
+	if(!(target.getVertexDescription() == baseFrame.getVertexDescription()) || target.getVertexCount() != baseFrame.getVertexCount())
+		throw std::invalid_argument("CompactKeyFrames::interpolate: The target's layout differs from the base frame.");
+
+	// blend the keyframe vertices into a temporary buffer: x, y, z of the positions, then of the normals
+	const uint32_t n = keyVertexCount;
+	static thread_local std::vector<float> blended;
+	blended.resize((hasNormals ? 6 : 3) * static_cast<size_t>(n));
+	const Frame & f1 = frames[frame1];
+	const Frame & f2 = frames[frame2];
+	const int16_t * offsets1 = positionOffsets.data() + 3 * static_cast<size_t>(n) * frame1;
+	const int16_t * offsets2 = positionOffsets.data() + 3 * static_cast<size_t>(n) * frame2;
+	for(uint_fast8_t c = 0; c < 3; ++c)
+		blendOffsets(basePositions.data() + c * n, offsets1 + c * n, offsets2 + c * n, f1.scale[c] * (1.0f - t), f2.scale[c] * t, blended.data() + c * n, n);
+	if(hasNormals) {
+		const int8_t * normals1 = normals.data() + 3 * static_cast<size_t>(n) * frame1;
+		const int8_t * normals2 = normals.data() + 3 * static_cast<size_t>(n) * frame2;
+		blendNormals(normals1, normals2, (1.0f - t) / MAX_NORMAL, t / MAX_NORMAL, blended.data() + 3 * n, 3 * n);
+	}
+
+	// scatter them to the vertices
+	const size_t vertexSize = target.getVertexDescription().getVertexSize();
+	const uint32_t vertexCount = target.getVertexCount();
+	const float * blendedPositions = blended.data();
+	const float * blendedNormals = blended.data() + 3 * n;
+	uint8_t * vertex = target.data();
+	for(uint32_t v = 0; v < vertexCount; ++v, vertex += vertexSize) {
+		const uint32_t k = keyVertexIndices.empty() ? v : keyVertexIndices[v];
+		float * position = reinterpret_cast<float *>(vertex + positionOffset);
+		position[0] = blendedPositions[k];
+		position[1] = blendedPositions[n + k];
+		position[2] = blendedPositions[2 * n + k];
+		if(hasNormals) {
+			float * normal = reinterpret_cast<float *>(vertex + normalOffset);
+			normal[0] = blendedNormals[k];
+			normal[1] = blendedNormals[n + k];
+			normal[2] = blendedNormals[2 * n + k];
+		}
+	}
+
+	Geometry::Box bounds(f1.bounds);
+	bounds.include(f2.bounds);
+	target._setBoundingBox(bounds);
+}
+
+size_t CompactKeyFrames::getMemoryUsage() const {
+	return sizeof(CompactKeyFrames) + baseFrame.dataSize() +
+			keyVertexIndices.capacity() * sizeof(uint32_t) + firstVertices.capacity() * sizeof(uint32_t) +
+			basePositions.capacity() * sizeof(float) + frames.capacity() * sizeof(Frame) +
+			positionOffsets.capacity() * sizeof(int16_t) + normals.capacity() * sizeof(int8_t);
+}
+
+}
+}
@@ -0,0 +1,96 @@
+/*
+	This file is part of the Rendering library.
+	Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+	This library is subject to the terms of the Mozilla Public License, v. 2.0.
+	You should have received a copy of the MPL along with this library; see the
+	file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#ifndef RENDERING_MESHUTILS_COMPACTKEYFRAMES_H
+#define RENDERING_MESHUTILS_COMPACTKEYFRAMES_H
+
+#include "../Mesh/MeshVertexData.h"
+#include <Geometry/Box.h>
+#include <Util/ReferenceCounter.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Rendering {
+namespace MeshUtils {
+
+/**
+ * Memory efficient storage of the frames of a keyframe animation.
+ * Only the positions and normals are animated; all other attributes are taken
+ * from the base frame, which is stored completely. Each frame stores
+ * - the offsets of the positions relative to the base frame, quantized to 16 bit
+ *   with a per-frame scale for each axis, and
+ * - the normals quantized to 8 bit.
+ * Vertices that differ only in their static attributes (e.g. the corners of
+ * adjacent triangles with different texture coordinates) can share one keyframe
+ * vertex, so frames only contain the distinct animated vertices.
+ *
+ * interpolate() blends two frames directly into the vertex data of a mesh. The
+ * frame data is stored per component (structure of arrays), so that the blending
+ * loops are vectorized by the compiler.
+ *
+ * @ingroup mesh
+ */
+class CompactKeyFrames : public Util::ReferenceCounter<CompactKeyFrames> {
+	public:
+		/*! Create the keyframes without any frames.
+			\param baseFrame Vertex data of the animated mesh in its base pose. The positions
+				(and normals, if present) have to be stored as three floats. If it is not used as a
+				frame itself, add it using addFrame().
+			\param keyVertexIndices For each vertex of the base frame, the index of its keyframe
+				vertex. If empty, each vertex has its own keyframe vertex.
+			If the data is invalid, an std::invalid_argument exception is thrown. */
+		CompactKeyFrames(MeshVertexData && baseFrame, std::vector<uint32_t> keyVertexIndices = std::vector<uint32_t>());
+
+		/*! Add a frame given by three floats per keyframe vertex for the positions and
+			(if the base frame has normals) the normals.	*/
+		void addFrame(const float * positions, const float * normals);
+		/*! Add a frame given by the vertex data of the animated mesh in the layout of the base frame.
+			For each keyframe vertex, the values of the first vertex using it are stored.	*/
+		void addFrame(const MeshVertexData & frame);
+
+		/*! Write the linear interpolation of the given frames (weight @p t for @p frame2)
+			into the positions and normals of @p target. All other data of @p target is left
+			unchanged; use a copy of the base frame as target. The bounding box of @p target
+			is set to the union of the frames' bounding boxes.
+			\note @p target is not marked as changed.	*/
+		void interpolate(uint32_t frame1, uint32_t frame2, float t, MeshVertexData & target) const;
+
+		const MeshVertexData & getBaseFrame() const			{	return baseFrame;	}
+		uint32_t getFrameCount() const						{	return static_cast<uint32_t>(frames.size());	}
+		uint32_t getKeyVertexCount() const					{	return keyVertexCount;	}
+		const Geometry::Box & getFrameBounds(uint32_t frame) const	{	return frames.at(frame).bounds;	}
+
+		//! Return the amount of main memory occupied by the frames (including the base frame) in bytes.
+		size_t getMemoryUsage() const;
+
+	private:
+		struct Frame {
+			float scale[3];
+			Geometry::Box bounds;
+		};
+
+		MeshVertexData baseFrame;
+		std::vector<uint32_t> keyVertexIndices; //!< keyframe vertex of each vertex; empty for identity
+		std::vector<uint32_t> firstVertices; //!< first vertex of each keyframe vertex
+		uint32_t keyVertexCount;
+		uint16_t positionOffset;
+		uint16_t normalOffset;
+		bool hasNormals;
+
+		std::vector<float> basePositions; //!< x, y and z of all keyframe vertices of the base frame
+		std::vector<Frame> frames;
+		std::vector<int16_t> positionOffsets; //!< per frame: x, y and z offsets of all keyframe vertices
+		std::vector<int8_t> normals; //!< per frame: x, y and z of all keyframe vertex normals
+};
+
+}
+}
+
+#endif /* RENDERING_MESHUTILS_COMPACTKEYFRAMES_H */
@@ -180,7 +180,8 @@ MeshBuilder::MeshBuilder() {
 	acc->setColor(0, Util::Color4f{1,1,1,1}); // Default color WHITE
 }
 
-MeshBuilder::MeshBuilder(VertexDescription _description) : description(std::move(_description)) {
+MeshBuilder::MeshBuilder(VertexDescription _description) : description(std::move(_description)), interleaved(description.isInterleaved()) {
+	description.setInterleaved(true);
 	vData.allocate(1, description);
 	iData.allocate(1);
 	currentVertex.allocate(1, description);
@@ -284,6 +285,8 @@ Mesh* MeshBuilder::buildMesh() {
 	auto m = new Mesh(iData, vData);
 	if(iSize == 0)
 		m->setUseIndexData(false);
+	if(!interleaved)
+		MeshUtils::convertVertexLayout(m->openVertexData(), false);
 
 	return m;
 }
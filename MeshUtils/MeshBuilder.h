@@ -162,7 +162,8 @@ public:
 	void transform(const Geometry::Matrix4x4 & m);
 	
 private:
-	VertexDescription description;
+	VertexDescription description; //!< always interleaved; the vertices are built as a whole
+	bool interleaved=true; //!< layout of the built meshes
 	uint32_t vSize=0;
 	uint32_t iSize=0;
 	MeshVertexData vData; //!< vertex buffer
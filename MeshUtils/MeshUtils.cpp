@@ -10,6 +10,7 @@
 */
 #include "MeshUtils.h"
 #include "../Mesh/Mesh.h"
+#include "../Mesh/StridedAttributeView.h"
 #include "../Mesh/VertexDescription.h"
 #include "../Mesh/VertexAttributeAccessors.h"
 #include "../Mesh/VertexAttributeIds.h"
@@ -17,7 +18,9 @@
 #include "../Helper.h"
 #include "../Texture/Texture.h"
 #include "../Texture/TextureUtils.h"
+#include "ParallelFor.h"
 #include "TriangleAccessor.h"
+#include "TriangleBVH.h"
 #include <Geometry/BoundingSphere.h>
 #include <Geometry/Box.h>
 #include <Geometry/Matrix4x4.h>
@@ -43,10 +46,10 @@
 #include <cstring> /* for memcmp */
 #include <map>
 #include <memory>
+#include <numeric>
 #include <queue>
 #include <deque>
 #include <set>
-#include <stack>
 #include <stdexcept>
 #include <vector>
 #include <unordered_map>
@@ -59,7 +62,6 @@ namespace MeshUtils {
 
 /**
  * Class which stores raw vertex data. Used in
- * @a eliminateDuplicateVertices().
  * @a splitLargeTriangles().
  *
  * @author Benjamin Eikel
@@ -453,6 +455,13 @@ bool compareMeshes( Mesh * mesh1,Mesh * mesh2 ){
 // -----------------------------------------------------------------------------
 
 float getLongestSideLength(Mesh * m){
+	if(!m->getVertexDescription().isInterleaved()) {
+		// the triangles are built from whole vertices
+		convertVertexLayout(m->openVertexData(), true);
+		const float length = getLongestSideLength(m);
+		convertVertexLayout(m->openVertexData(), false);
+		return length;
+	}
 	float maxSideLength = 0.0;
 	const VertexDescription & vd = m->getVertexDescription();
 	const VertexAttribute & posAttr = vd.getAttribute(VertexAttributeIds::POSITION);
@@ -512,6 +521,13 @@ void setColor(Mesh * mesh, const Util::Color4f & _color) {
 
 //! (static)
 void splitLargeTriangles(Mesh * m, float maxSideLength) {
+	if(!m->getVertexDescription().isInterleaved()) {
+		// the triangles are built from whole vertices
+		convertVertexLayout(m->openVertexData(), true);
+		splitLargeTriangles(m, maxSideLength);
+		convertVertexLayout(m->openVertexData(), false);
+		return;
+	}
 	const VertexDescription & vd = m->getVertexDescription();
 	const VertexAttribute & posAttr = vd.getAttribute(VertexAttributeIds::POSITION);
 	if (posAttr.getDataType() != GL_FLOAT || m->getDrawMode() != Mesh::DRAW_TRIANGLES) {
@@ -655,14 +671,82 @@ void transform(MeshVertexData & vData, const Matrix4x4f & transMat) {
 
 // -----------------------------------------------------------------------------
 
+//! Number of vertices that are converted together by the batch functions of the attribute accessors.
+static const uint32_t VERTEX_BLOCK_SIZE = 1024;
+//! Number of vertices per worker from which on vertex data is transformed in parallel.
+static const uint32_t PARALLEL_VERTEX_COUNT = 1u << 18;
+
+/*! (internal) Apply the upper 3x4 part of the matrix to @p count 3D float vectors stored @p stride bytes apart.
+	If @p withTranslation is false, only the linear part is applied.
+	The components of a block of vectors are gathered into separate arrays first, so that the compiler
+	vectorizes the multiplication over the vectors of the block. */
+static void transformVectors(const Geometry::Matrix4x4 & transMat, bool withTranslation, uint8_t * data, size_t stride, uint32_t count) {
+	float m[3][4];
+	for(uint_fast8_t r = 0; r < 3; ++r) {
+		for(uint_fast8_t c = 0; c < 4; ++c)
+			m[r][c] = transMat.at(r, c);
+		if(!withTranslation)
+			m[r][3] = 0.0f;
+	}
+	float in[3][VERTEX_BLOCK_SIZE];
+	float out[3][VERTEX_BLOCK_SIZE];
+	for(uint32_t first = 0; first < count; first += VERTEX_BLOCK_SIZE) {
+		const uint32_t n = std::min(VERTEX_BLOCK_SIZE, count - first);
+		uint8_t * const block = data + static_cast<size_t>(first) * stride;
+		for(uint32_t i = 0; i < n; ++i) {
+			const float * v = reinterpret_cast<const float *>(block + i * stride);
+			in[0][i] = v[0];
+			in[1][i] = v[1];
+			in[2][i] = v[2];
+		}
+		for(uint_fast8_t r = 0; r < 3; ++r) {
+			const float mx = m[r][0], my = m[r][1], mz = m[r][2], mw = m[r][3];
+			for(uint32_t i = 0; i < n; ++i)
+				out[r][i] = mx * in[0][i] + my * in[1][i] + mz * in[2][i] + mw;
+		}
+		for(uint32_t i = 0; i < n; ++i) {
+			float * v = reinterpret_cast<float *>(block + i * stride);
+			v[0] = out[0][i];
+			v[1] = out[1][i];
+			v[2] = out[2][i];
+		}
+	}
+}
+
+/*! (internal) Call @p fn(first, end) for disjoint ranges covering the vertices [begin, begin + count).
+	Large ranges are split among several worker threads. */
+template<typename Function>
+static void forVertexRanges(uint32_t begin, uint32_t count, Function fn) {
+	const uint32_t workerCount = std::max(1u, std::min(getWorkerCount(0), count / PARALLEL_VERTEX_COUNT));
+	parallelFor(workerCount, begin, begin + count, [&fn](uint32_t, uint32_t first, uint32_t end) {
+		fn(first, end);
+	});
+}
+
 //! (static)
 void transformCoordinates(MeshVertexData & vData, Util::StringIdentifier attrName, const Geometry::Matrix4x4 & transMat, uint32_t begin,
 		uint32_t numVerts) {
 
-	Util::Reference<PositionAttributeAccessor> positionAccessor(PositionAttributeAccessor::create(vData,attrName));
-	const uint32_t end = begin+numVerts;
-	for(uint32_t i=begin;i<end;++i)
-		positionAccessor->setPosition(i,transMat.transformPosition(positionAccessor->getPosition(i)));
+	if(begin + numVerts > vData.getVertexCount())
+		throw std::range_error("transformCoordinates: Invalid vertex range.");
+	const VertexAttribute & attr = vData.getVertexDescription().getAttribute(attrName);
+	if(StridedAttributeView<float>::isCompatible(attr, 3)) {
+		const auto positions = StridedAttributeView<float>::create(vData, attrName, 3);
+		forVertexRanges(begin, numVerts, [&](uint32_t first, uint32_t end) {
+			transformVectors(transMat, true, reinterpret_cast<uint8_t *>(positions[first]), positions.getStride(), end - first);
+		});
+	} else {
+		Util::Reference<PositionAttributeAccessor> positionAccessor(PositionAttributeAccessor::create(vData,attrName));
+		forVertexRanges(begin, numVerts, [&](uint32_t first, uint32_t end) {
+			float buffer[3 * VERTEX_BLOCK_SIZE];
+			for(; first < end; first += VERTEX_BLOCK_SIZE) {
+				const uint32_t count = std::min(VERTEX_BLOCK_SIZE, end - first);
+				positionAccessor->getPositions(first, count, buffer);
+				transformVectors(transMat, true, reinterpret_cast<uint8_t *>(buffer), 3 * sizeof(float), count);
+				positionAccessor->setPositions(first, count, buffer);
+			}
+		});
+	}
 	vData.markAsChanged();
 }
 
@@ -672,24 +756,71 @@ void transformCoordinates(MeshVertexData & vData, Util::StringIdentifier attrNam
 void transformNormals(MeshVertexData & vData, Util::StringIdentifier attrName, const Geometry::Matrix4x4 & transMat, uint32_t begin,
 		uint32_t numVerts) {
 
-	Util::Reference<NormalAttributeAccessor> normalAccessor(NormalAttributeAccessor::create(vData,attrName));
-	const uint32_t end = begin+numVerts;
-	for(uint32_t i=begin;i<end;++i)
-		normalAccessor->setNormal(i, (transMat * Geometry::Vec4(normalAccessor->getNormal(i),0)).xyz());
+	if(begin + numVerts > vData.getVertexCount())
+		throw std::range_error("transformNormals: Invalid vertex range.");
+	const VertexAttribute & attr = vData.getVertexDescription().getAttribute(attrName);
+	if(StridedAttributeView<float>::isCompatible(attr, 3)) {
+		const auto normals = StridedAttributeView<float>::create(vData, attrName, 3);
+		forVertexRanges(begin, numVerts, [&](uint32_t first, uint32_t end) {
+			transformVectors(transMat, false, reinterpret_cast<uint8_t *>(normals[first]), normals.getStride(), end - first);
+		});
+	} else {
+		Util::Reference<NormalAttributeAccessor> normalAccessor(NormalAttributeAccessor::create(vData,attrName));
+		forVertexRanges(begin, numVerts, [&](uint32_t first, uint32_t end) {
+			float buffer[3 * VERTEX_BLOCK_SIZE];
+			for(; first < end; first += VERTEX_BLOCK_SIZE) {
+				const uint32_t count = std::min(VERTEX_BLOCK_SIZE, end - first);
+				normalAccessor->getNormals(first, count, buffer);
+				transformVectors(transMat, false, reinterpret_cast<uint8_t *>(buffer), 3 * sizeof(float), count);
+				normalAccessor->setNormals(first, count, buffer);
+			}
+		});
+	}
 	vData.markAsChanged();
 }
 
 // -----------------------------------------------------------------------------
 
+//! Return @c true iff the values of the attribute can be converted from and to floats by a FloatAttributeAccessor.
+inline bool hasFloatValues(const VertexAttribute& attr) {
+	switch(attr.getDataType()) {
+		case GL_FLOAT:
+		case GL_HALF_FLOAT:
+		case GL_BYTE:
+		case GL_UNSIGNED_BYTE:
+			return true;
+		case GL_SHORT:
+		case GL_UNSIGNED_SHORT:
+			return attr.getNormalize();
+		default:
+			return false;
+	}
+}
+
 inline bool canConvert(const VertexAttribute& oldAttr, const VertexAttribute& newAttr) {
-	if(oldAttr.getDataType() == GL_FLOAT) {
-		return newAttr.getDataType() == GL_BYTE || newAttr.getDataType() == GL_UNSIGNED_BYTE; // float to byte
-	} else if(newAttr.getDataType() == GL_FLOAT) {
-		return oldAttr.getDataType() == GL_BYTE || oldAttr.getDataType() == GL_UNSIGNED_BYTE; // byte to float
+	return oldAttr.getDataType() != newAttr.getDataType() && hasFloatValues(oldAttr) && hasFloatValues(newAttr);
+}
+
+//! Return @c true iff the attribute contains octahedral encoded normals or tangents (@see NormalAttributeAccessor).
+inline bool isOctahedral(const VertexAttribute& attr) {
+	return (attr.getNameId() == VertexAttributeIds::NORMAL || attr.getNameId() == VertexAttributeIds::TANGENT) &&
+			attr.getNumValues() == 2 && (attr.getDataType() == GL_SHORT || attr.getDataType() == GL_BYTE);
+}
+
+inline bool isTextureCoordinate(const Util::StringIdentifier & nameId) {
+	for(uint_fast8_t unit = 0; unit < 8; ++unit) {
+		if(nameId == VertexAttributeIds::getTextureCoordinateIdentifier(unit))
+			return true;
 	}
 	return false;
 }
 
+//! Return @c true iff a NormalAttributeAccessor can be created for the attribute.
+inline bool hasNormalValues(const VertexAttribute& attr) {
+	return isOctahedral(attr) || (attr.getDataType() == GL_FLOAT && attr.getNumValues() >= 3) ||
+			(attr.getDataType() == GL_BYTE && attr.getNumValues() >= 4);
+}
+
 // -----------------------------------------------------------------------------
 
 //! (static)
@@ -706,23 +837,31 @@ MeshVertexData * convertVertices(const MeshVertexData & oldVertices, const Verte
 	// Initialize the data with zero.
 	std::fill_n(newVertices->data(), newVertices->dataSize(), 0);
 
-	const std::size_t oldVertexSize = oldVertexDescription.getVertexSize();
-	const std::size_t newVertexSize = newVertexDescription.getVertexSize();
 	for(const auto & oldAttr : oldVertexDescription.getAttributes()) {
 		const VertexAttribute & newAttr = newVertexDescription.getAttribute(oldAttr.getNameId());
 
 		if (oldAttr.empty() || newAttr.empty()) {
 			continue;
 		}
-		if(oldAttr.getDataType() == newAttr.getDataType()) {					
+		if(isOctahedral(oldAttr) != isOctahedral(newAttr)) {
+			if(hasNormalValues(oldAttr) && hasNormalValues(newAttr)) {
+				auto oldAcc = NormalAttributeAccessor::create(const_cast<MeshVertexData&>(oldVertices), newAttr.getNameId());
+				auto newAcc = NormalAttributeAccessor::create(*newVertices, newAttr.getNameId());
+				for (uint32_t i = 0; i < numVertices; ++i) {
+					newAcc->setNormal(i, oldAcc->getNormal(i));
+				}
+			}
+		} else if(oldAttr.getDataType() == newAttr.getDataType()) {					
 			uint32_t dataSize = std::min(oldAttr.getDataSize(), newAttr.getDataSize());
-			const uint8_t * source = oldVertices.data() + oldAttr.getOffset();
-			uint8_t * target = newVertices->data() + newAttr.getOffset();
+			const uint8_t * source = oldVertices.getAttributeData(oldAttr);
+			uint8_t * target = newVertices->getAttributeData(newAttr);
+			const size_t oldStride = oldVertices.getAttributeStride(oldAttr);
+			const size_t newStride = newVertices->getAttributeStride(newAttr);
 			for (uint32_t i = 0; i < numVertices; ++i) {
 				std::copy(source, source + dataSize, target);
-				source += oldVertexSize;
-				target += newVertexSize;
-			}			
+				source += oldStride;
+				target += newStride;
+			}
 		} else if( canConvert(oldAttr, newAttr) ) {
 			auto oldAcc = FloatAttributeAccessor::create(const_cast<MeshVertexData&>(oldVertices), newAttr.getNameId());
 			auto newAcc = FloatAttributeAccessor::create(*newVertices, newAttr.getNameId());
@@ -737,6 +876,99 @@ MeshVertexData * convertVertices(const MeshVertexData & oldVertices, const Verte
 
 // -----------------------------------------------------------------------------
 
+//! (static)
+void convertVertexLayout(MeshVertexData & vertices, bool interleaved) {
+	if(vertices.getVertexDescription().isInterleaved() == interleaved)
+		return;
+	VertexDescription vd(vertices.getVertexDescription());
+	vd.setInterleaved(interleaved);
+	std::unique_ptr<MeshVertexData> newVertices(convertVertices(vertices, vd));
+	vertices.swap(*newVertices.get());
+}
+
+// -----------------------------------------------------------------------------
+
+//! (static)
+void copyVertexRange(const MeshVertexData & source, uint32_t sourceIndex, MeshVertexData & target, uint32_t targetIndex, uint32_t count) {
+	const VertexDescription & vd = source.getVertexDescription();
+	if(vd.isInterleaved()) {
+		const size_t vertexSize = vd.getVertexSize();
+		const uint8_t * values = source.data() + sourceIndex * vertexSize;
+		std::copy(values, values + count * vertexSize, target.data() + targetIndex * vertexSize);
+		return;
+	}
+	for(const auto & attr : vd.getAttributes()) {
+		const size_t attrSize = attr.getDataSize();
+		const uint8_t * values = source.getAttributeData(attr) + sourceIndex * attrSize;
+		std::copy(values, values + count * attrSize, target.getAttributeData(attr) + targetIndex * attrSize);
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+//! (static)
+VertexDescription createCompactVertexDescription(const VertexDescription & vertexDescription, bool quantizePositions) {
+	VertexDescription compact;
+	for(const auto & attr : vertexDescription.getAttributes()) {
+		const Util::StringIdentifier nameId = attr.getNameId();
+		if(nameId == VertexAttributeIds::POSITION && quantizePositions && attr.getNumValues() >= 3) {
+			compact.appendPositionQuantized();
+		} else if(nameId == VertexAttributeIds::NORMAL && hasNormalValues(attr)) {
+			compact.appendNormalOctahedral();
+		} else if(nameId == VertexAttributeIds::TANGENT && attr.getDataType() == GL_FLOAT && attr.getNumValues() == 3) {
+			compact.appendAttribute(nameId, 2, GL_SHORT, true);
+		} else if(nameId == VertexAttributeIds::TANGENT && attr.getDataType() == GL_FLOAT && attr.getNumValues() == 4) {
+			compact.appendAttribute(nameId, 4, GL_BYTE, true);
+		} else if(nameId == VertexAttributeIds::COLOR && attr.getDataType() == GL_FLOAT) {
+			compact.appendColorRGBAByte();
+		} else if(attr.getDataType() == GL_FLOAT && attr.getNumValues() == 2 && isTextureCoordinate(nameId)) {
+			compact.appendAttribute(nameId, 2, GL_HALF_FLOAT, false);
+		} else {
+			compact.appendAttribute(nameId, attr.getNumValues(), attr.getDataType(), attr.getNormalize(), attr.getConvertToFloat());
+		}
+	}
+	return compact;
+}
+
+// -----------------------------------------------------------------------------
+
+//! (static)
+Geometry::Matrix4x4 compressVertices(Mesh * mesh, const VertexDescription & newVertexDescription) {
+	MeshVertexData & vertices = mesh->openVertexData();
+	const VertexAttribute & oldPosAttr = vertices.getVertexDescription().getAttribute(VertexAttributeIds::POSITION);
+	const VertexAttribute & newPosAttr = newVertexDescription.getAttribute(VertexAttributeIds::POSITION);
+	const bool quantize = !oldPosAttr.empty() && newPosAttr.getNumValues() >= 3 && newPosAttr.getNormalize() &&
+			(newPosAttr.getDataType() == GL_UNSIGNED_SHORT || newPosAttr.getDataType() == GL_SHORT);
+
+	std::unique_ptr<MeshVertexData> newVertices(convertVertices(vertices, newVertexDescription));
+	Geometry::Matrix4x4 decode;
+	if(quantize) {
+		// map the bounding box uniformly into [0,1]^3 (unsigned) or [-1,1]^3 (signed)
+		vertices.updateBoundingBox();
+		const Geometry::Box & box = vertices.getBoundingBox();
+		const bool isSigned = newPosAttr.getDataType() == GL_SHORT;
+		float scale = std::max(box.getExtentX(), std::max(box.getExtentY(), box.getExtentZ()));
+		if(isSigned)
+			scale *= 0.5f;
+		if(scale <= 0.0f)
+			scale = 1.0f;
+		const Geometry::Vec3 origin = isSigned ? box.getCenter() : Geometry::Vec3(box.getMinX(), box.getMinY(), box.getMinZ());
+		decode.translate(origin);
+		decode.scale(scale);
+
+		auto oldAcc = PositionAttributeAccessor::create(vertices, VertexAttributeIds::POSITION);
+		auto newAcc = PositionAttributeAccessor::create(*newVertices, VertexAttributeIds::POSITION);
+		for(uint32_t i = 0; i < vertices.getVertexCount(); ++i) {
+			newAcc->setPosition(i, (oldAcc->getPosition(i) - origin) / scale);
+		}
+		newVertices->updateBoundingBox();
+	}
+	vertices.swap(*newVertices.get());
+	return decode;
+}
+
+// -----------------------------------------------------------------------------
+
 VertexDescription uniteVertexDescriptions(const std::deque<VertexDescription> & vertexDescs) {
 	VertexDescription result;
 	for(const auto & desc : vertexDescs) {
@@ -772,8 +1004,71 @@ void removeColorData(Mesh * m) {
 
 // -----------------------------------------------------------------------------
 
+//! Number of triangles whose values are computed together before they are added to their vertices.
+static const uint32_t TRIANGLE_BLOCK_SIZE = 256;
+
+//! Float vectors of the vertices stored with the given stride in bytes.
+struct FloatAttributeView {
+	const uint8_t * data;
+	size_t stride;
+
+	const float * operator[](uint32_t index) const {
+		return reinterpret_cast<const float *>(data + static_cast<size_t>(index) * stride);
+	}
+};
+
+/**
+ * Sum up per-triangle values at the vertices of the triangles.
+ * @a computeBlock(first, count, values) has to write the @a Dim values of the triangles [first, first + count)
+ * component-wise into @a values, i.e. component d of triangle first + t into values[d * TRIANGLE_BLOCK_SIZE + t].
+ * Computing a whole block at once lets the compiler vectorize the arithmetic over the triangles.
+ * With more than one thread, each worker sums up a contiguous range of triangles in its own buffer,
+ * and the buffers are added up in parallel afterwards.
+ *
+ * @return @a Dim sums per vertex
+ */
+template<uint32_t Dim, typename BlockFunction>
+static std::vector<float> accumulateAtVertices(const MeshIndexData & indexData, uint32_t vertexCount, uint32_t threadCount, BlockFunction computeBlock) {
+	const uint32_t * indices = indexData.data();
+	const uint32_t triangleCount = indexData.getIndexCount() / 3;
+	// each worker needs a buffer for all vertices => use additional workers only for large meshes
+	const uint32_t workerCount = std::max(1u, std::min(getWorkerCount(threadCount), triangleCount / 65536));
+	std::vector<std::vector<float>> sums(workerCount);
+	parallelFor(workerCount, 0, triangleCount, [&](uint32_t worker, uint32_t begin, uint32_t end) {
+		std::vector<float> & sum = sums[worker];
+		sum.assign(static_cast<size_t>(vertexCount) * Dim, 0.0f);
+		std::vector<float> values(Dim * TRIANGLE_BLOCK_SIZE);
+		for(uint32_t first = begin; first < end; first += TRIANGLE_BLOCK_SIZE) {
+			const uint32_t count = std::min(TRIANGLE_BLOCK_SIZE, end - first);
+			computeBlock(first, count, values.data());
+			for(uint32_t t = 0; t < count; ++t) {
+				for(uint_fast8_t c = 0; c < 3; ++c) {
+					float * target = sum.data() + static_cast<size_t>(indices[3 * (first + t) + c]) * Dim;
+					for(uint32_t d = 0; d < Dim; ++d) {
+						target[d] += values[d * TRIANGLE_BLOCK_SIZE + t];
+					}
+				}
+			}
+		}
+	});
+
+	std::vector<float> result(std::move(sums.front()));
+	result.resize(static_cast<size_t>(vertexCount) * Dim, 0.0f);
+	if(workerCount > 1) {
+		parallelFor(workerCount, 0, vertexCount, [&](uint32_t, uint32_t begin, uint32_t end) {
+			for(uint32_t worker = 1; worker < workerCount; ++worker) {
+				const float * sum = sums[worker].data();
+				for(size_t i = static_cast<size_t>(begin) * Dim; i < static_cast<size_t>(end) * Dim; ++i) {
+					result[i] += sum[i];
+				}
+			}
+		});
+	}
+	return result;
+}
+
 //! (static)
-void calculateNormals(Mesh * m) {
+void calculateNormals(Mesh * m, uint32_t threadCount) {
 	MeshVertexData & vData = m->openVertexData();
 
 	// add normals to vData if necessary
@@ -785,34 +1080,83 @@ void calculateNormals(Mesh * m) {
 	}
 
 	const uint32_t vertexCount = vData.getVertexCount();
+	const VertexDescription & vDesc = vData.getVertexDescription();
+	const VertexAttribute & posAttr = vDesc.getAttribute(VertexAttributeIds::POSITION);
+	const VertexAttribute & normalAttr = vDesc.getAttribute(VertexAttributeIds::NORMAL);
 
-	std::vector<Geometry::Vec3> normals(vertexCount);
+	// read float positions directly from the vertex data; convert other formats once
+	std::vector<float> convertedPositions;
+	FloatAttributeView positions{vData.getAttributeData(posAttr), vData.getAttributeStride(posAttr)};
+	if(posAttr.getDataType() != GL_FLOAT || posAttr.getNumValues() < 3) {
+		Util::Reference<PositionAttributeAccessor> positionAccessor(PositionAttributeAccessor::create(vData,VertexAttributeIds::POSITION));
+		convertedPositions.resize(3 * vertexCount);
+		positionAccessor->getPositions(0, vertexCount, convertedPositions.data());
+		positions = FloatAttributeView{reinterpret_cast<const uint8_t *>(convertedPositions.data()), 3 * sizeof(float)};
+	}
 
 	// accumulate normals
 	const MeshIndexData & indices = m->openIndexData();
-	const uint32_t indexCount = m->getIndexCount();
-	Util::Reference<PositionAttributeAccessor> positionAccessor(PositionAttributeAccessor::create(vData,VertexAttributeIds::POSITION));
-	for (uint32_t i = 0; i < indexCount-2; i += 3) {
+	const uint32_t * index = indices.data();
+	const std::vector<float> normals = accumulateAtVertices<3>(indices, vertexCount, threadCount, [&](uint32_t first, uint32_t count, float * n) {
+		float * const nx = n;
+		float * const ny = n + TRIANGLE_BLOCK_SIZE;
+		float * const nz = n + 2 * TRIANGLE_BLOCK_SIZE;
+		float cb[3][TRIANGLE_BLOCK_SIZE];
+		float ab[3][TRIANGLE_BLOCK_SIZE];
+		for(uint32_t t = 0; t < count; ++t) {
+			const float * a = positions[index[3 * (first + t) + 0]];
+			const float * b = positions[index[3 * (first + t) + 1]];
+			const float * c = positions[index[3 * (first + t) + 2]];
+			for(uint_fast8_t d = 0; d < 3; ++d) {
+				cb[d][t] = c[d] - b[d];
+				ab[d][t] = a[d] - b[d];
+			}
+		}
 		// n = cb x ab
-		const Geometry::Vec3 a( positionAccessor->getPosition(indices[i + 0]) );
-		const Geometry::Vec3 b( positionAccessor->getPosition(indices[i + 1]) );
-		const Geometry::Vec3 c( positionAccessor->getPosition(indices[i + 2]) );
-
-		Geometry::Vec3 n( (c-b).cross(a-b) );
-		const float length = n.length();
-		if(length>0)
-			n.normalize();
-		normals[indices[i+0]] += n;
-		normals[indices[i+1]] += n;
-		normals[indices[i+2]] += n;
-	}
+		for(uint32_t t = 0; t < count; ++t) {
+			const float x = cb[1][t] * ab[2][t] - cb[2][t] * ab[1][t];
+			const float y = cb[2][t] * ab[0][t] - cb[0][t] * ab[2][t];
+			const float z = cb[0][t] * ab[1][t] - cb[1][t] * ab[0][t];
+			const float length = std::sqrt(x * x + y * y + z * z);
+			const float scale = length > 0 ? 1.0f / length : 1.0f;
+			nx[t] = x * scale;
+			ny[t] = y * scale;
+			nz[t] = z * scale;
+		}
+	});
 
 	// set normals
-	Util::Reference<NormalAttributeAccessor> normalAccessor(NormalAttributeAccessor::create(vData,VertexAttributeIds::NORMAL));
-	for(uint32_t i=0;i<vertexCount;++i){
-		const Geometry::Vec3 n = normals[i];
-		const float length = n.length();
-		normalAccessor->setNormal(i, length>0 ? n/length : n);
+	if(normalAttr.getDataType() == GL_FLOAT && normalAttr.getNumValues() >= 3) {
+		uint8_t * const normalData = vData.getAttributeData(normalAttr);
+		const size_t stride = vData.getAttributeStride(normalAttr);
+		parallelFor(getWorkerCount(threadCount), 0, vertexCount, [&](uint32_t, uint32_t begin, uint32_t end) {
+			for(uint32_t i = begin; i < end; ++i) {
+				const float * n = normals.data() + 3 * i;
+				const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+				const float scale = length > 0 ? 1.0f / length : 1.0f;
+				float * target = reinterpret_cast<float *>(normalData + i * stride);
+				target[0] = n[0] * scale;
+				target[1] = n[1] * scale;
+				target[2] = n[2] * scale;
+			}
+		});
+	} else {
+		Util::Reference<NormalAttributeAccessor> normalAccessor(NormalAttributeAccessor::create(vData,VertexAttributeIds::NORMAL));
+		parallelFor(getWorkerCount(threadCount), 0, vertexCount, [&](uint32_t, uint32_t begin, uint32_t end) {
+			float buffer[3 * VERTEX_BLOCK_SIZE];
+			for(uint32_t first = begin; first < end; first += VERTEX_BLOCK_SIZE) {
+				const uint32_t count = std::min(VERTEX_BLOCK_SIZE, end - first);
+				for(uint32_t i = 0; i < count; ++i) {
+					const float * n = normals.data() + 3 * (first + i);
+					const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+					const float scale = length > 0 ? 1.0f / length : 1.0f;
+					buffer[3 * i + 0] = n[0] * scale;
+					buffer[3 * i + 1] = n[1] * scale;
+					buffer[3 * i + 2] = n[2] * scale;
+				}
+				normalAccessor->setNormals(first, count, buffer);
+			}
+		});
 	}
 	vData.markAsChanged();
 }
@@ -869,9 +1213,9 @@ Mesh * combineMeshes(const std::deque<Mesh *> & meshArray, const std::deque<Geom
 	// create mesh
 	auto mesh = new Mesh;
 	MeshVertexData & vertices = mesh->openVertexData();
-	vertices.allocate(vertexCount, vd);
+	vertices.allocate(vertexCount, vd, false);
 	MeshIndexData & indices = mesh->openIndexData();
-	indices.allocate(indexCount);
+	indices.allocate(indexCount, false);
 
 	// copy data
 
@@ -890,7 +1234,15 @@ Mesh * combineMeshes(const std::deque<Mesh *> & meshArray, const std::deque<Geom
 
 		// add vertices
 		MeshVertexData & currentVertices = currentMesh->openVertexData();
-		std::copy(currentVertices.data(), currentVertices.data() + currentVertices.dataSize(), vertices[vertexPointer]);
+		if(vd.isInterleaved()) {
+			std::copy(currentVertices.data(), currentVertices.data() + currentVertices.dataSize(), vertices[vertexPointer]);
+		} else {
+			for(const auto & attr : vd.getAttributes()) {
+				const uint8_t * source = currentVertices.getAttributeData(attr);
+				std::copy(source, source + static_cast<size_t>(attr.getDataSize()) * currentVertices.getVertexCount(),
+						vertices.getAttributeData(attr) + static_cast<size_t>(attr.getDataSize()) * vertexPointer);
+			}
+		}
 
 		if (tIt2 != transformations2.cend() && (*tIt2) != noTrans) {
 			transformVertexData(vertices, (*tIt2), vertexPointer, currentVertices.getVertexCount());
@@ -927,13 +1279,9 @@ std::deque<MeshVertexData> splitVertexData(Mesh * mesh, uint32_t chunkSize){
 			currentChunkSize = vertexCount - vertexPointer;
 
 		MeshVertexData currentVertices;
-		currentVertices.allocate(currentChunkSize, desc);
-
-		uint32_t chunkFront = vertexPointer * desc.getVertexSize();
-		uint32_t chunkEnd = chunkFront + currentChunkSize * desc.getVertexSize();
-
+		currentVertices.allocate(currentChunkSize, desc, false);
 
-		std::copy(meshVertices.data() + chunkFront, meshVertices.data() + chunkEnd, currentVertices.data());
+		copyVertexRange(meshVertices, vertexPointer, currentVertices, 0, currentChunkSize);
 
 		result.emplace_back(std::move(currentVertices));
 
@@ -959,12 +1307,9 @@ MeshVertexData * extractVertexData(Mesh * mesh, uint32_t begin, uint32_t length)
 		return nullptr;
 
 	auto result = new MeshVertexData;
-	result->allocate(length, desc);
+	result->allocate(length, desc, false);
 
-	uint32_t front = begin*desc.getVertexSize();
-	uint32_t end = front + length*desc.getVertexSize();
-
-	std::copy(meshVertices.data() + front, meshVertices.data() + end, result->data());
+	copyVertexRange(meshVertices, begin, *result, 0, length);
 
 	return result;
 
@@ -972,63 +1317,172 @@ MeshVertexData * extractVertexData(Mesh * mesh, uint32_t begin, uint32_t length)
 
 // -----------------------------------------------------------------------------
 
+/**
+ * Open addressing hash table storing vertex indices which are compared by
+ * their raw vertex data. Used in @a eliminateDuplicateVertices().
+ */
+class VertexHashTable {
+	public:
+		static const uint32_t EMPTY = 0xffffffff;
+
+		VertexHashTable(const uint8_t * vertexData, std::size_t vertexSize, const uint32_t * vertexHashes, uint32_t expectedCount) :
+				data(vertexData), size(vertexSize), hashes(vertexHashes) {
+			std::size_t capacity = 16;
+			while(capacity < 2 * static_cast<std::size_t>(expectedCount))
+				capacity <<= 1;
+			slots.assign(capacity, EMPTY);
+			mask = capacity - 1;
+		}
+
+		/**
+		 * Insert the vertex with the given index, if no vertex with equal data
+		 * has been inserted before.
+		 *
+		 * @return Index of the stored vertex having the same data.
+		 */
+		uint32_t insert(uint32_t index) {
+			const uint32_t hash = hashes[index];
+			const uint8_t * vertex = data + index * size;
+			for(std::size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+				const uint32_t other = slots[slot];
+				if(other == EMPTY) {
+					slots[slot] = index;
+					return index;
+				} else if(hashes[other] == hash && std::memcmp(data + other * size, vertex, size) == 0) {
+					return other;
+				}
+			}
+		}
+
+		//! Return a well mixed hash value of the given raw vertex data.
+		static uint32_t hashVertex(const uint8_t * vertex, std::size_t vertexSize) {
+			uint64_t h = 0xcbf29ce484222325ull;
+			std::size_t i = 0;
+			for(; i + 4 <= vertexSize; i += 4) {
+				uint32_t word;
+				std::memcpy(&word, vertex + i, 4);
+				h = (h ^ word) * 0x100000001b3ull;
+			}
+			for(; i < vertexSize; ++i)
+				h = (h ^ vertex[i]) * 0x100000001b3ull;
+			h ^= h >> 33;
+			h *= 0xff51afd7ed558ccdull;
+			h ^= h >> 33;
+			return static_cast<uint32_t>(h);
+		}
+
+	private:
+		const uint8_t * data;
+		const std::size_t size;
+		const uint32_t * hashes;
+		std::vector<uint32_t> slots;
+		std::size_t mask;
+};
+const uint32_t VertexHashTable::EMPTY;
+
 //! (static)
-void eliminateDuplicateVertices(Mesh * mesh) {
+void eliminateDuplicateVertices(Mesh * mesh, uint32_t threadCount) {
+	if(!mesh->getVertexDescription().isInterleaved()) {
+		// the vertices are hashed and compared as a whole
+		convertVertexLayout(mesh->openVertexData(), true);
+		eliminateDuplicateVertices(mesh, threadCount);
+		convertVertexLayout(mesh->openVertexData(), false);
+		return;
+	}
+	static const uint32_t NONE = VertexHashTable::EMPTY;
 	const VertexDescription & desc = mesh->getVertexDescription();
+	const std::size_t vertexSize = desc.getVertexSize();
 	const uint32_t indexCount = mesh->getIndexCount();
+	const MeshVertexData & oldVertices = mesh->openVertexData();
+	const MeshIndexData & oldIndices = mesh->openIndexData();
+	const uint32_t vertexCount = oldVertices.getVertexCount();
+	const uint8_t * oldData = oldVertices.data();
+	const uint32_t workerCount = getWorkerCount(threadCount);
+
+	// Only vertices that are referenced by an index are kept.
+	std::vector<uint8_t> used(vertexCount, 0);
+	for(uint32_t counter = 0; counter < indexCount; ++counter)
+		used[oldIndices[counter]] = 1;
+
+	std::vector<uint32_t> hashes(vertexCount, 0);
+	parallelFor(workerCount, 0, vertexCount, [&](uint32_t, uint32_t begin, uint32_t end) {
+		for(uint32_t i = begin; i < end; ++i) {
+			if(used[i])
+				hashes[i] = VertexHashTable::hashVertex(oldData + i * vertexSize, vertexSize);
+		}
+	});
 
-	// Set of vertices used to create unique vertices.
-	std::set<RawVertex> rawVertices;
-	// Mapping from old index to new index.
-	std::map<uint32_t, uint32_t> indexReplace;
-
-	// Simply go over the indices and add one vertex after another.
-	{
-		const MeshVertexData & vertices = mesh->openVertexData();
-		const MeshIndexData & indices = mesh->openIndexData();
-		const std::size_t vertexSize = desc.getVertexSize();
+	const auto lessData = [&](uint32_t a, uint32_t b) {
+		return std::memcmp(oldData + a * vertexSize, oldData + b * vertexSize, vertexSize) < 0;
+	};
 
-		for (uint32_t counter = 0; counter < indexCount; ++counter) {
-			const uint32_t index = indices[counter];
-			const uint8_t * vertex = vertices[index];
-			RawVertex raw(index, vertex, vertexSize);
-			auto it = rawVertices.insert(raw).first;
-			indexReplace.insert(std::make_pair(index, it->getIndex()));
+	// Mapping from old index to the index of the first vertex with equal data.
+	std::vector<uint32_t> representative(vertexCount, NONE);
+	// Every worker handles the vertices whose hash value falls into its partition.
+	std::vector<std::vector<uint32_t>> partitions(workerCount);
+	parallelFor(workerCount, 0, workerCount, [&](uint32_t, uint32_t begin, uint32_t end) {
+		for(uint32_t part = begin; part < end; ++part) {
+			const auto inPartition = [&](uint32_t i) {
+				return used[i] && static_cast<uint32_t>((static_cast<uint64_t>(hashes[i]) * workerCount) >> 32) == part;
+			};
+			uint32_t partitionSize = 0;
+			for(uint32_t i = 0; i < vertexCount; ++i) {
+				if(inPartition(i))
+					++partitionSize;
+			}
+			VertexHashTable table(oldData, vertexSize, hashes.data(), partitionSize);
+			std::vector<uint32_t> & unique = partitions[part];
+			for(uint32_t i = 0; i < vertexCount; ++i) {
+				if(!inPartition(i))
+					continue;
+				representative[i] = table.insert(i);
+				if(representative[i] == i)
+					unique.push_back(i);
+			}
+			// Keep the byte-wise order of the former std::set<RawVertex> implementation.
+			std::sort(unique.begin(), unique.end(), lessData);
 		}
+	});
+
+	// Merge the sorted partitions.
+	std::vector<uint32_t> uniqueVertices;
+	for(const auto & unique : partitions) {
+		const std::size_t middle = uniqueVertices.size();
+		uniqueVertices.insert(uniqueVertices.end(), unique.begin(), unique.end());
+		std::inplace_merge(uniqueVertices.begin(), uniqueVertices.begin() + middle, uniqueVertices.end(), lessData);
 	}
+	partitions.clear();
 
-	// Mapping from new index to vertex position.
-	std::map<uint32_t, uint32_t> indexPosition;
+	// Mapping from representative index to vertex position.
+	std::vector<uint32_t> vertexPosition(vertexCount, NONE);
+	for(uint32_t pos = 0; pos < uniqueVertices.size(); ++pos)
+		vertexPosition[uniqueVertices[pos]] = pos;
 
-	// Create the new mesh and add the rawVertices.
+	// Create the new mesh and add the unique vertices.
 	Util::Reference<Mesh> result = new Mesh;
 	result->setDataStrategy(mesh->getDataStrategy());
 
 	MeshVertexData & vertices = result->openVertexData();
-	vertices.allocate(rawVertices.size(), desc);
+	vertices.allocate(uniqueVertices.size(), desc);
 
 	MeshIndexData & indices = result->openIndexData();
 	indices.allocate(indexCount);
 
-	{
-		uint8_t * data = vertices.data();
-		uint32_t vertexPos = 0;
-		for(const auto & vertex : rawVertices) {
-			std::copy(vertex.getData(), vertex.getData() + vertex.getSize(), data);
-			data += vertex.getSize();
-			indexPosition.insert(std::make_pair(vertex.getIndex(), vertexPos));
-			++vertexPos;
-		}
-		// Translate the indices.
-		const uint32_t * srcIndex = mesh->openIndexData().data();
-		uint32_t * dstIndex = indices.data();
-		for (uint32_t counter = 0; counter < indexCount; ++counter) {
-			const uint32_t newIndex = indexReplace.find(*srcIndex)->second;
-			*dstIndex = indexPosition.find(newIndex)->second;
-			++srcIndex;
-			++dstIndex;
+	uint8_t * data = vertices.data();
+	parallelFor(workerCount, 0, static_cast<uint32_t>(uniqueVertices.size()), [&](uint32_t, uint32_t begin, uint32_t end) {
+		for(uint32_t pos = begin; pos < end; ++pos) {
+			const uint8_t * vertex = oldData + uniqueVertices[pos] * vertexSize;
+			std::copy(vertex, vertex + vertexSize, data + pos * vertexSize);
 		}
-	}
+	});
+
+	// Translate the indices.
+	const uint32_t * srcIndex = oldIndices.data();
+	uint32_t * dstIndex = indices.data();
+	parallelFor(workerCount, 0, indexCount, [&](uint32_t, uint32_t begin, uint32_t end) {
+		for(uint32_t counter = begin; counter < end; ++counter)
+			dstIndex[counter] = vertexPosition[representative[srcIndex[counter]]];
+	});
 
 	vertices.updateBoundingBox();
 	indices.updateIndexRange();
@@ -1077,10 +1531,9 @@ Mesh * eliminateUnusedVertices(Mesh * mesh) {
 
 	const MeshVertexData & oldVertexData = mesh->openVertexData();
 	MeshVertexData & newVertexData = newMesh->openVertexData();
-	const size_t vSize = desc.getVertexSize();
 	uint32_t i = 0;
 	for(const auto & oldIndex : usedOldVertices) {
-		std::copy(oldVertexData[oldIndex], oldVertexData[oldIndex] + vSize, newVertexData[i++]);
+		copyVertexRange(oldVertexData, oldIndex, newVertexData, i++, 1);
 	}
 	newVertexData.updateBoundingBox();
 
@@ -1093,13 +1546,16 @@ Mesh * eliminateUnusedVertices(Mesh * mesh) {
 Mesh * eliminateLongTriangles(Mesh * mesh, float ratio) {
 	const MeshIndexData & originalIndices = mesh->openIndexData();
 	const MeshVertexData & vertexData = mesh->openVertexData();
+	const VertexAttribute & posAttr = vertexData.getVertexDescription().getAttribute(VertexAttributeIds::POSITION);
+	const uint8_t * positions = vertexData.getAttributeData(posAttr);
+	const size_t stride = vertexData.getAttributeStride(posAttr);
 	std::deque<uint32_t> newIndices;
 	const uint32_t indexCount = mesh->getIndexCount();
 
 	for (uint32_t counter = 0; counter < indexCount; counter += 3) {
-		Geometry::Vec3 p1(reinterpret_cast<const float*> (vertexData[originalIndices[counter]]));
-		Geometry::Vec3 p2(reinterpret_cast<const float*> (vertexData[originalIndices[counter + 1]]));
-		Geometry::Vec3 p3(reinterpret_cast<const float*> (vertexData[originalIndices[counter + 2]]));
+		Geometry::Vec3 p1(reinterpret_cast<const float*> (positions + originalIndices[counter] * stride));
+		Geometry::Vec3 p2(reinterpret_cast<const float*> (positions + originalIndices[counter + 1] * stride));
+		Geometry::Vec3 p3(reinterpret_cast<const float*> (positions + originalIndices[counter + 2] * stride));
 
 		float a2 = (p1 - p2).lengthSquared();
 		float b2 = (p2 - p3).lengthSquared();
@@ -1132,6 +1588,9 @@ Mesh * eliminateLongTriangles(Mesh * mesh, float ratio) {
 Mesh * eliminateTrianglesBehindPlane(Mesh * mesh, const Geometry::Plane & plane) {
 	const MeshIndexData & originalIndices = mesh->openIndexData();
 	const MeshVertexData & vertexData = mesh->openVertexData();
+	const VertexAttribute & posAttr = vertexData.getVertexDescription().getAttribute(VertexAttributeIds::POSITION);
+	const uint8_t * positions = vertexData.getAttributeData(posAttr);
+	const size_t stride = vertexData.getAttributeStride(posAttr);
 	std::deque<uint32_t> newIndices;
 	const uint32_t indexCount = mesh->getIndexCount();
 
@@ -1140,19 +1599,19 @@ Mesh * eliminateTrianglesBehindPlane(Mesh * mesh, const Geometry::Plane & plane)
 		const uint32_t & indexB = originalIndices[counter + 1];
 		const uint32_t & indexC = originalIndices[counter + 2];
 		{
-			const Geometry::Vec3 vertex(reinterpret_cast<const float *> (vertexData[indexA]));
+			const Geometry::Vec3 vertex(reinterpret_cast<const float *>(positions + indexA * stride));
 			if (plane.planeTest(vertex) < 0.0f) {
 				continue;
 			}
 		}
 		{
-			const Geometry::Vec3 vertex(reinterpret_cast<const float *> (vertexData[indexB]));
+			const Geometry::Vec3 vertex(reinterpret_cast<const float *>(positions + indexB * stride));
 			if (plane.planeTest(vertex) < 0.0f) {
 				continue;
 			}
 		}
 		{
-			const Geometry::Vec3 vertex(reinterpret_cast<const float *> (vertexData[indexC]));
+			const Geometry::Vec3 vertex(reinterpret_cast<const float *>(positions + indexC * stride));
 			if (plane.planeTest(vertex) < 0.0f) {
 				continue;
 			}
@@ -1173,6 +1632,9 @@ Mesh * eliminateTrianglesBehindPlane(Mesh * mesh, const Geometry::Plane & plane)
 Mesh * eliminateZeroAreaTriangles(Mesh * mesh) {
 	const MeshIndexData & originalIndices = mesh->openIndexData();
 	const MeshVertexData & vertexData = mesh->openVertexData();
+	const VertexAttribute & posAttr = vertexData.getVertexDescription().getAttribute(VertexAttributeIds::POSITION);
+	const uint8_t * positions = vertexData.getAttributeData(posAttr);
+	const size_t stride = vertexData.getAttributeStride(posAttr);
 	const uint32_t indexCount = mesh->getIndexCount();
 	std::vector<uint32_t> newIndices;
 	newIndices.reserve(indexCount);
@@ -1182,9 +1644,9 @@ Mesh * eliminateZeroAreaTriangles(Mesh * mesh) {
 		const uint32_t & indexB = originalIndices[counter + 1];
 		const uint32_t & indexC = originalIndices[counter + 2];
 		const Geometry::Triangle<Geometry::Vec3f> triangle(
-						Geometry::Vec3f(reinterpret_cast<const float *>(vertexData[indexA])),
-						Geometry::Vec3f(reinterpret_cast<const float *>(vertexData[indexB])),
-						Geometry::Vec3f(reinterpret_cast<const float *>(vertexData[indexC])));
+						Geometry::Vec3f(reinterpret_cast<const float *>(positions + indexA * stride)),
+						Geometry::Vec3f(reinterpret_cast<const float *>(positions + indexB * stride)),
+						Geometry::Vec3f(reinterpret_cast<const float *>(positions + indexC * stride)));
 
 		if (!triangle.isDegenerate()) {
 			newIndices.push_back(indexA);
@@ -1245,14 +1707,18 @@ Mesh * removeSkinsWithHoleCovering(Mesh * mesh, float maxNormalZ, float covering
 	std::deque<uint32_t> newIndices;
 	const MeshVertexData & vertexData = mesh->openVertexData();
 	MeshVertexData newVertexData = vertexData;
+	const VertexAttribute & posAttr = vertexData.getVertexDescription().getAttribute(VertexAttributeIds::POSITION);
+	const uint8_t * positions = vertexData.getAttributeData(posAttr);
+	const size_t stride = vertexData.getAttributeStride(posAttr);
+	uint8_t * newPositions = newVertexData.getAttributeData(posAttr);
 
 	for (uint32_t counter = 0; counter < indexCount; counter += 3) {
 		const uint32_t & indexA = originalIndices[counter];
 		const uint32_t & indexB = originalIndices[counter + 1];
 		const uint32_t & indexC = originalIndices[counter + 2];
-		const float * vertexA = reinterpret_cast<const float *> (vertexData[indexA]);
-		const float * vertexB = reinterpret_cast<const float *> (vertexData[indexB]);
-		const float * vertexC = reinterpret_cast<const float *> (vertexData[indexC]);
+		const float * vertexA = reinterpret_cast<const float *>(positions + indexA * stride);
+		const float * vertexB = reinterpret_cast<const float *>(positions + indexB * stride);
+		const float * vertexC = reinterpret_cast<const float *>(positions + indexC * stride);
 
 		float normal[3];
 		calcNormal(vertexA, vertexB, vertexC, normal);
@@ -1266,17 +1732,17 @@ Mesh * removeSkinsWithHoleCovering(Mesh * mesh, float maxNormalZ, float covering
 			// Move the vertices lying in the background.
 			const float halfZ = (maxZ + minZ) / 2.0f;
 			if (vertexA[2] > halfZ) {
-				float * newVertexA = reinterpret_cast<float *> (newVertexData[indexA]);
+				float * newVertexA = reinterpret_cast<float *>(newPositions + indexA * stride);
 				newVertexA[0] += coveringMovement * depthRange * normal[0];
 				newVertexA[1] += coveringMovement * depthRange * normal[1];
 			}
 			if (vertexB[2] > halfZ) {
-				float * newVertexB = reinterpret_cast<float *> (newVertexData[indexB]);
+				float * newVertexB = reinterpret_cast<float *>(newPositions + indexB * stride);
 				newVertexB[0] += coveringMovement * depthRange * normal[0];
 				newVertexB[1] += coveringMovement * depthRange * normal[1];
 			}
 			if (vertexC[2] > halfZ) {
-				float * newVertexC = reinterpret_cast<float *> (newVertexData[indexC]);
+				float * newVertexC = reinterpret_cast<float *>(newPositions + indexC * stride);
 				newVertexC[0] += coveringMovement * depthRange * normal[0];
 				newVertexC[1] += coveringMovement * depthRange * normal[1];
 			}
@@ -1297,138 +1763,106 @@ Mesh * removeSkinsWithHoleCovering(Mesh * mesh, float maxNormalZ, float covering
 
 // -----------------------------------------------------------------------------
 
-void optimizeIndices(Mesh * mesh, const uint_fast8_t _cacheSize) {
-	struct Inner {
-		/**
-		 * Consider all 1-ring candidates and select the best for fanning.
-		 *
-		 * @param stop Flag which tells if the algorithm has ended.
-		 * @param nextCand Passed from caller.
-		 * @param stamp Passed from caller.
-		 * @param cacheSize Passed from caller.
-		 * @param cacheTimes Passed from caller.
-		 * @param liveTriangles Passed from caller.
-		 * @param deadEndStack Passed from caller.
-		 * @param numVertices Passed from caller.
-		 * @param cursor Passed from caller.
-		 * @return Number of next vertex.
-		 */
-		static uint32_t getNextVertex(bool & stop, const std::set<uint32_t> & nextCand, const uint32_t stamp, const uint8_t cacheSize,
-				const uint32_t * cacheTimes, const uint_fast16_t * liveTriangles, std::stack<uint32_t> & deadEndStack, const uint32_t numVertices,
-				uint32_t & cursor) {
-			// Best candidate and priority.
-			bool found = false;
-			uint32_t n = 0;
-			uint32_t maxPriority = 0; // m
-			for(const auto & v : nextCand) {
-				// Must have live triangles.
-				if (liveTriangles[v] > 0) {
-					// Initial priority.
-					uint32_t p = 0;
-					// In cache even after fanning?
-					if (stamp - cacheTimes[v] + 2 * liveTriangles[v] <= cacheSize) {
-						// Priority is position in cache.
-						p = stamp - cacheTimes[v];
-					}
-					// Keep best candidate.
-					if (p > maxPriority) {
-						maxPriority = p;
-						n = v;
-						found = true;
-					}
-				}
-			}
-			// Reached a dead-end?
-			if (!found) {
-				n = skipDeadEnd(stop, liveTriangles, deadEndStack, numVertices, cursor);
-			}
-			return n;
+/**
+ * Simulation of a FIFO post-transform vertex cache.
+ * A vertex is in the cache, if less than cacheSize vertices have been inserted after it.
+ */
+class FifoVertexCache {
+		std::vector<uint32_t> insertionTimes;
+		uint32_t time;
+		const uint32_t cacheSize;
+	public:
+		FifoVertexCache(uint32_t vertexCount, uint32_t _cacheSize) :
+				insertionTimes(vertexCount, 0), time(_cacheSize), cacheSize(_cacheSize) {
 		}
 
-		/**
-		 * When there are no candidates left we might have to choose an non-
-		 * local vertex.
-		 *
-		 * @param stop Flag which tells if the algorithm has ended.
-		 * @param liveTriangles Passed from caller.
-		 * @param deadEndStack Passed from caller.
-		 * @param numVertices Passed from caller.
-		 * @param cursor Passed from caller.
-		 * @return Number of non-local vertex.
-		 */
-		static uint32_t skipDeadEnd(bool & stop, const uint_fast16_t * liveTriangles, std::stack<uint32_t> & deadEndStack,
-				const uint32_t numVertices, uint32_t & cursor) {
-			while (!deadEndStack.empty()) {
-				// Next in dead-end stack.
-				uint32_t d = deadEndStack.top();
-				deadEndStack.pop();
-				// Check for live triangles.
-				if (liveTriangles[d] > 0) {
-					return d;
-				}
-			}
-			while (cursor < numVertices) {
-				// Check for live triangles.
-				if (liveTriangles[cursor] > 0) {
-					return cursor;
-				}
-				// Next in input order.
-				// Cursor sweeps list only once.
-				++cursor;
-			}
-			// We are done!
-			stop = true;
-			return 0;
+		//! Access the given vertex; return true if it has to be transformed (cache miss).
+		bool access(uint32_t vertex) {
+			if(time - insertionTimes[vertex] < cacheSize)
+				return false;
+			insertionTimes[vertex] = ++time;
+			return true;
 		}
-	};
+
+		//! Remove all vertices from the cache.
+		void clear() {
+			time += cacheSize;
+		}
+};
+
+//!	(static)
+VertexCacheStatistics calculateVertexCacheStatistics(Mesh * mesh, const uint_fast8_t cacheSize) {
+	VertexCacheStatistics statistics{0.0f, 0.0f};
+	if (mesh->getDrawMode() != Mesh::DRAW_TRIANGLES) {
+		WARN("This function only works with meshes with a triangle list.");
+		return statistics;
+	}
+	const uint32_t numIndices = mesh->getIndexCount();
+	const uint32_t * indices = mesh->openIndexData().data();
+
+	FifoVertexCache cache(mesh->getVertexCount(), cacheSize);
+	std::vector<bool> used(mesh->getVertexCount(), false);
+	uint32_t misses = 0;
+	uint32_t usedVertices = 0;
+	for (uint32_t i = 0; i < numIndices; ++i) {
+		if (cache.access(indices[i]))
+			++misses;
+		if (!used[indices[i]]) {
+			used[indices[i]] = true;
+			++usedVertices;
+		}
+	}
+	if (numIndices >= 3) {
+		statistics.acmr = static_cast<float>(misses) / (numIndices / 3);
+		statistics.atvr = static_cast<float>(misses) / usedVertices;
+	}
+	return statistics;
+}
+
+// -----------------------------------------------------------------------------
+
+void optimizeIndices(Mesh * mesh, const uint_fast8_t cacheSize) {
 	if (mesh->getDrawMode() != Mesh::DRAW_TRIANGLES) {
 		WARN("This function only works with meshes with a triangle list.");
 		return;
 	}
-	uint32_t numVertices = mesh->getVertexCount();
-	uint32_t numIndices = mesh->getIndexCount();
-	uint32_t numTriangles = numIndices / 3;
+	const uint32_t numVertices = mesh->getVertexCount();
+	const uint32_t numIndices = mesh->getIndexCount();
+	const uint32_t numTriangles = numIndices / 3;
+	if (numTriangles == 0)
+		return;
 	MeshIndexData & indices = mesh->openIndexData();
+	const uint32_t * input = indices.data();
 
 	// Build vertex-triangle adjacency.
-	// First pass: Count occurrences.
-	auto occurrences = new uint_fast16_t[numVertices];
-	std::fill_n(occurrences, numVertices, 0);
-	for (uint32_t i = 0; i < numIndices; ++i) {
-		++occurrences[indices[i]];
-	}
-	// Second pass: Create the offset map.
-	auto offsetMap = new uint32_t[numVertices];
-	uint32_t sum = 0;
-	for (uint32_t v = 0; v < numVertices; ++v) {
-		offsetMap[v] = sum;
-		sum += occurrences[v];
+	// The triangles of vertex v are stored in triangleLists[offsets[v], offsets[v + 1]).
+	std::vector<uint32_t> offsets(numVertices + 1, 0);
+	for (uint32_t i = 0; i < 3 * numTriangles; ++i) {
+		++offsets[input[i] + 1];
 	}
-	// Third pass: Construct triangle lists.
-	auto triangleLists = new uint32_t[sum]; // A
-	auto tmpOffsetMap = new uint32_t[numVertices];
-	std::copy(offsetMap, offsetMap + numVertices, tmpOffsetMap);
-	for (uint32_t i = 0; i < numIndices; ++i) {
-		uint32_t vertex = indices[i];
-		uint32_t offset = tmpOffsetMap[vertex];
-		triangleLists[offset] = i / 3;
-		++tmpOffsetMap[vertex];
+	std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+	std::vector<uint32_t> triangleLists(offsets.back()); // A
+	{
+		std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+		for (uint32_t i = 0; i < 3 * numTriangles; ++i) {
+			triangleLists[fill[input[i]]++] = i / 3;
+		}
 	}
-	delete[] tmpOffsetMap;
 
 	// Create per-vertex live triangle count.
-	auto liveTriangles = new uint_fast16_t[numVertices]; // L
-	std::copy(occurrences, occurrences + numVertices, liveTriangles);
+	std::vector<uint32_t> liveTriangles(numVertices); // L
+	for (uint32_t v = 0; v < numVertices; ++v) {
+		liveTriangles[v] = offsets[v + 1] - offsets[v];
+	}
 	// Create per-vertex caching time stamps.
-	auto cacheTimes = new uint32_t[numVertices]; // C
-	std::fill_n(cacheTimes, numVertices, 0);
+	std::vector<uint32_t> cacheTimes(numVertices, 0); // C
 	// Create dead-end vertex stack.
-	std::stack<uint32_t> deadEndStack; // D
+	std::vector<uint32_t> deadEndStack; // D
+	deadEndStack.reserve(3 * numTriangles);
 	// Create per-triangles emitted flags.
-	auto emitted = new bool[numTriangles]; // E
-	for (uint32_t t = 0; t < numTriangles; ++t) {
-		emitted[t] = false;
-	}
+	std::vector<bool> emitted(numTriangles, false); // E
+	// 1-ring of next candidates; may contain duplicates.
+	std::vector<uint32_t> nextCand; // N
 	// Create output buffer.
 	MeshIndexData newIndices;
 	newIndices.allocate(numIndices);
@@ -1436,33 +1870,30 @@ void optimizeIndices(Mesh * mesh, const uint_fast8_t _cacheSize) {
 	// Initialize fanning vertex.
 	uint32_t fanVertex = 0; // f
 	// Initialize time stamp.
-	uint32_t stamp = static_cast<uint32_t> (_cacheSize) + 1; // s
+	uint32_t stamp = static_cast<uint32_t> (cacheSize) + 1; // s
 	// Initialize the cursor.
 	uint32_t cursor = 1; // i
 
-	bool stop = false;
-	while (!stop) {
-		// 1-ring of next candidates.
-		std::set<uint32_t> nextCand; // N
-		uint_fast16_t numNeighbors = occurrences[fanVertex];
-		for (uint_fast16_t i = 0; i < numNeighbors; ++i) {
-			uint32_t t = triangleLists[offsetMap[fanVertex] + i];
+	while (true) {
+		nextCand.clear();
+		for (uint32_t a = offsets[fanVertex]; a < offsets[fanVertex + 1]; ++a) {
+			const uint32_t t = triangleLists[a];
 			if (emitted[t])
 				continue;
 
 			for (uint_fast8_t ii = 0; ii < 3; ++ii) {
-				uint32_t v = indices[3 * t + ii];
+				const uint32_t v = input[3 * t + ii];
 				// Output vertex.
 				*output = v;
 				++output;
 				// Add to dead-end stack.
-				deadEndStack.push(v);
+				deadEndStack.push_back(v);
 				// Register as candidate.
-				nextCand.insert(v);
+				nextCand.push_back(v);
 				// Decrease live triangle count.
 				--liveTriangles[v];
 				// If not in cache
-				if (stamp - cacheTimes[v] > _cacheSize) {
+				if (stamp - cacheTimes[v] > cacheSize) {
 					// Set time stamp.
 					cacheTimes[v] = stamp;
 					// Increment time stamp.
@@ -1471,18 +1902,52 @@ void optimizeIndices(Mesh * mesh, const uint_fast8_t _cacheSize) {
 			}
 			// Flag triangle as emitted.
 			emitted[t] = true;
+		}
 
+		// Consider all 1-ring candidates and select the best for fanning.
+		bool found = false;
+		uint32_t maxPriority = 0; // m
+		for (const auto & v : nextCand) {
+			// Must have live triangles.
+			if (liveTriangles[v] == 0)
+				continue;
+			// Priority is position in cache, if still in cache after fanning; zero otherwise.
+			const uint32_t p = (stamp - cacheTimes[v] + 2 * liveTriangles[v] <= cacheSize) ? stamp - cacheTimes[v] : 0;
+			// Keep best candidate.
+			if (!found || p > maxPriority) {
+				maxPriority = p;
+				fanVertex = v;
+				found = true;
+			}
 		}
-		fanVertex = Inner::getNextVertex(stop, nextCand, stamp, _cacheSize, cacheTimes, liveTriangles, deadEndStack, numVertices, cursor);
-	}
+		if (found)
+			continue;
 
-	// Clean up.
-	delete[] occurrences;
-	delete[] offsetMap;
-	delete[] triangleLists;
-	delete[] liveTriangles;
-	delete[] cacheTimes;
-	delete[] emitted;
+		// Reached a dead-end: choose a non-local vertex.
+		while (!deadEndStack.empty() && !found) {
+			// Next in dead-end stack.
+			const uint32_t d = deadEndStack.back();
+			deadEndStack.pop_back();
+			if (liveTriangles[d] > 0) {
+				fanVertex = d;
+				found = true;
+			}
+		}
+		// Next in input order; the cursor sweeps the list only once.
+		while (!found && cursor < numVertices) {
+			if (liveTriangles[cursor] > 0) {
+				fanVertex = cursor;
+				found = true;
+			} else {
+				++cursor;
+			}
+		}
+		// We are done!
+		if (!found)
+			break;
+	}
+	// Keep an incomplete trailing triangle.
+	std::copy(input + 3 * numTriangles, input + numIndices, output);
 
 	newIndices.markAsChanged();
 	newIndices.updateIndexRange();
@@ -1493,6 +1958,138 @@ void optimizeIndices(Mesh * mesh, const uint_fast8_t _cacheSize) {
 
 // -----------------------------------------------------------------------------
 
+void optimizeOverdraw(Mesh * mesh, float threshold, const uint_fast8_t cacheSize) {
+	if (mesh->getDrawMode() != Mesh::DRAW_TRIANGLES) {
+		WARN("This function only works with meshes with a triangle list.");
+		return;
+	}
+	const uint32_t numTriangles = mesh->getIndexCount() / 3;
+	if (numTriangles == 0)
+		return;
+	MeshIndexData & indices = mesh->openIndexData();
+	const uint32_t * input = indices.data();
+	const float acmr = calculateVertexCacheStatistics(mesh, cacheSize).acmr;
+
+	// Split the triangles into clusters: A cluster ends where the cache runs empty (hard boundary),
+	// or where the cache miss ratio of the cluster is close to the one of the whole mesh (soft boundary).
+	std::vector<uint32_t> clusterBegins;
+	{
+		FifoVertexCache meshCache(mesh->getVertexCount(), cacheSize);
+		FifoVertexCache clusterCache(mesh->getVertexCount(), cacheSize);
+		uint32_t clusterMisses = 0;
+		uint32_t clusterBegin = 0;
+		for (uint32_t t = 0; t < numTriangles; ++t) {
+			uint_fast8_t meshMisses = 0;
+			for (uint_fast8_t c = 0; c < 3; ++c) {
+				meshMisses += meshCache.access(input[3 * t + c]) ? 1 : 0;
+			}
+			if (t == 0 || meshMisses == 3 || clusterMisses <= threshold * acmr * (t - clusterBegin)) {
+				clusterBegins.push_back(t);
+				clusterBegin = t;
+				clusterMisses = 0;
+				clusterCache.clear();
+			}
+			for (uint_fast8_t c = 0; c < 3; ++c) {
+				clusterMisses += clusterCache.access(input[3 * t + c]) ? 1 : 0;
+			}
+		}
+		clusterBegins.push_back(numTriangles);
+	}
+
+	// Sort the clusters by their occlusion potential: Clusters facing away from the mesh's center are drawn first.
+	Util::Reference<PositionAttributeAccessor> positionAccessor(PositionAttributeAccessor::create(mesh->openVertexData(), VertexAttributeIds::POSITION));
+	const uint32_t numClusters = static_cast<uint32_t>(clusterBegins.size() - 1);
+	std::vector<Geometry::Vec3> clusterCenters(numClusters);
+	std::vector<Geometry::Vec3> clusterNormals(numClusters);
+	Geometry::Vec3 meshCenter;
+	float meshArea = 0.0f;
+	for (uint32_t cluster = 0; cluster < numClusters; ++cluster) {
+		float clusterArea = 0.0f;
+		for (uint32_t t = clusterBegins[cluster]; t < clusterBegins[cluster + 1]; ++t) {
+			const Geometry::Vec3 a( positionAccessor->getPosition(input[3 * t + 0]) );
+			const Geometry::Vec3 b( positionAccessor->getPosition(input[3 * t + 1]) );
+			const Geometry::Vec3 c( positionAccessor->getPosition(input[3 * t + 2]) );
+			// the length of the normal is twice the area of the triangle
+			const Geometry::Vec3 n( (c-b).cross(a-b) );
+			const float area = n.length();
+			clusterCenters[cluster] += (a + b + c) * (area / 3.0f);
+			clusterNormals[cluster] += n;
+			clusterArea += area;
+		}
+		meshCenter += clusterCenters[cluster];
+		meshArea += clusterArea;
+		if (clusterArea > 0.0f)
+			clusterCenters[cluster] /= clusterArea;
+	}
+	if (meshArea > 0.0f)
+		meshCenter /= meshArea;
+
+	std::vector<float> occlusionPotential(numClusters);
+	for (uint32_t cluster = 0; cluster < numClusters; ++cluster) {
+		const float length = clusterNormals[cluster].length();
+		occlusionPotential[cluster] = length > 0.0f ? (clusterCenters[cluster] - meshCenter).dot(clusterNormals[cluster]) / length : 0.0f;
+	}
+	std::vector<uint32_t> clusterOrder(numClusters);
+	std::iota(clusterOrder.begin(), clusterOrder.end(), 0);
+	std::stable_sort(clusterOrder.begin(), clusterOrder.end(), [&occlusionPotential](uint32_t a, uint32_t b) {
+		return occlusionPotential[a] > occlusionPotential[b];
+	});
+
+	MeshIndexData newIndices;
+	newIndices.allocate(indices.getIndexCount());
+	uint32_t * output = newIndices.data();
+	for (const auto & cluster : clusterOrder) {
+		output = std::copy(input + 3 * clusterBegins[cluster], input + 3 * clusterBegins[cluster + 1], output);
+	}
+	std::copy(input + 3 * numTriangles, input + indices.getIndexCount(), output);
+
+	newIndices.markAsChanged();
+	newIndices.updateIndexRange();
+	indices.swap(newIndices);
+}
+
+// -----------------------------------------------------------------------------
+
+void optimizeVertexFetch(Mesh * mesh) {
+	if (!mesh->isUsingIndexData()) {
+		WARN("This function only works with indexed meshes.");
+		return;
+	}
+	const uint32_t numVertices = mesh->getVertexCount();
+	MeshIndexData & indices = mesh->openIndexData();
+	uint32_t * index = indices.data();
+
+	// Number the vertices in the order of their first use; unused vertices are moved to the end.
+	const uint32_t unused = std::numeric_limits<uint32_t>::max();
+	std::vector<uint32_t> newIndexOfVertex(numVertices, unused);
+	uint32_t next = 0;
+	for (uint32_t i = 0; i < indices.getIndexCount(); ++i) {
+		uint32_t & newIndex = newIndexOfVertex[index[i]];
+		if (newIndex == unused)
+			newIndex = next++;
+		index[i] = newIndex;
+	}
+	for (uint32_t v = 0; v < numVertices; ++v) {
+		if (newIndexOfVertex[v] == unused)
+			newIndexOfVertex[v] = next++;
+	}
+
+	MeshVertexData & vertices = mesh->openVertexData();
+	MeshVertexData newVertices;
+	newVertices.allocate(numVertices, vertices.getVertexDescription());
+	for (uint32_t v = 0; v < numVertices; ++v) {
+		copyVertexRange(vertices, v, newVertices, newIndexOfVertex[v], 1);
+	}
+	newVertices._setBoundingBox(vertices.getBoundingBox());
+	vertices.swap(newVertices);
+	vertices.markAsChanged();
+
+	indices.markAsChanged();
+	indices.updateIndexRange();
+}
+
+// -----------------------------------------------------------------------------
+
 void reverseWinding(Mesh * mesh) {
 	if (mesh->getDrawMode() != Mesh::DRAW_TRIANGLES) {
 		WARN("GL_TRIANGLES is the only supported mode.");
@@ -1532,15 +2129,16 @@ void copyVertexAttribute(Mesh * mesh, Util::StringIdentifier from, Util::StringI
 	const VertexAttribute & vaFrom = vd.getAttribute(from);
 	const VertexAttribute & vaTo = vd.getAttribute(to);
 
-	uint8_t * data = vertices.data();
-	const size_t stride = vd.getVertexSize();
-	const uint16_t offsetFrom = vaFrom.getOffset();
-	const uint16_t offsetTo = vaTo.getOffset();
+	const uint8_t * source = vertices.getAttributeData(vaFrom);
+	uint8_t * target = vertices.getAttributeData(vaTo);
+	const size_t strideFrom = vertices.getAttributeStride(vaFrom);
+	const size_t strideTo = vertices.getAttributeStride(vaTo);
 	const size_t attrSize = vaFrom.getDataSize();
 
 	for (uint_fast32_t v = 0; v < vertices.getVertexCount(); ++v) {
-		std::copy(data + offsetFrom , data + offsetFrom + attrSize, data + offsetTo);
-		data += stride;
+		std::copy(source, source + attrSize, target);
+		source += strideFrom;
+		target += strideTo;
 	}
 
 	vertices.markAsChanged();
@@ -1574,7 +2172,7 @@ void calculateTextureCoordinates_projection(Mesh * mesh, Util::StringIdentifier
 // -----------------------------------------------------------------------------
 
 //!	(static)
-void calculateTangentVectors(Mesh * mesh, const Util::StringIdentifier uvName, const Util::StringIdentifier tangentVecName) {
+void calculateTangentVectors(Mesh * mesh, const Util::StringIdentifier uvName, const Util::StringIdentifier tangentVecName, uint32_t threadCount) {
 	using Geometry::Vec3;
 	using Geometry::Vec2;
 	MeshVertexData & vertices(mesh->openVertexData());
@@ -1613,77 +2211,79 @@ void calculateTangentVectors(Mesh * mesh, const Util::StringIdentifier uvName, c
 	const VertexAttribute & uvAttr = vDesc.getAttribute(uvName);
 	const VertexAttribute & tanAttr = vDesc.getAttribute(tangentVecName);
 
-	std::vector<Vec3> tan1(vertices.getVertexCount());
-	std::vector<Vec3> tan2(vertices.getVertexCount());
-
-	for (uint32_t i = 0; i < indices.getIndexCount(); i += 3) {
-		const uint32_t index1 = indices[i];
-		const uint32_t index2 = indices[i + 1];
-		const uint32_t index3 = indices[i + 2];
-
-		const Vec3 pos1(reinterpret_cast<float*> (vertices[index1] + posAttr.getOffset()));
-		const Vec3 pos2(reinterpret_cast<float*> (vertices[index2] + posAttr.getOffset()));
-		const Vec3 pos3(reinterpret_cast<float*> (vertices[index3] + posAttr.getOffset()));
-
-		const Vec2 uv1(reinterpret_cast<float*> (vertices[index1] + uvAttr.getOffset()));
-		const Vec2 uv2(reinterpret_cast<float*> (vertices[index2] + uvAttr.getOffset()));
-		const Vec2 uv3(reinterpret_cast<float*> (vertices[index3] + uvAttr.getOffset()));
-
-		const float x1 = pos2.x() - pos1.x();
-		const float x2 = pos3.x() - pos1.x();
-		const float y1 = pos2.y() - pos1.y();
-		const float y2 = pos3.y() - pos1.y();
-		const float z1 = pos2.z() - pos1.z();
-		const float z2 = pos3.z() - pos1.z();
-
-		const float s1 = uv2.x() - uv1.x();
-		const float s2 = uv3.x() - uv1.x();
-		const float t1 = uv2.y() - uv1.y();
-		const float t2 = uv3.y() - uv1.y();
-
-		const float r = 1.0f / (s1 * t2 - s2 * t1);
-		const Vec3 sdir((t2 * x1 - t1 * x2) * r, (t2 * y1 - t1 * y2) * r, (t2 * z1 - t1 * z2) * r);
-		const Vec3 tdir((s1 * x2 - s2 * x1) * r, (s1 * y2 - s2 * y1) * r, (s1 * z2 - s2 * z1) * r);
-
-		tan1[index1] += sdir;
-		tan1[index2] += sdir;
-		tan1[index3] += sdir;
-
-		tan2[index1] += tdir;
-		tan2[index2] += tdir;
-		tan2[index3] += tdir;
-	}
+	const FloatAttributeView positions{vertices.getAttributeData(posAttr), vertices.getAttributeStride(posAttr)};
+	const FloatAttributeView uvs{vertices.getAttributeData(uvAttr), vertices.getAttributeStride(uvAttr)};
+	const uint32_t * index = indices.data();
+
+	// per vertex: sum of the tangents (sdir) followed by the sum of the bitangents (tdir)
+	const std::vector<float> tangents = accumulateAtVertices<6>(indices, vertices.getVertexCount(), threadCount, [&](uint32_t first, uint32_t count, float * dirs) {
+		float edge1[3][TRIANGLE_BLOCK_SIZE];
+		float edge2[3][TRIANGLE_BLOCK_SIZE];
+		float uvEdge1[2][TRIANGLE_BLOCK_SIZE];
+		float uvEdge2[2][TRIANGLE_BLOCK_SIZE];
+		for(uint32_t t = 0; t < count; ++t) {
+			const uint32_t index1 = index[3 * (first + t)];
+			const uint32_t index2 = index[3 * (first + t) + 1];
+			const uint32_t index3 = index[3 * (first + t) + 2];
+			const float * pos1 = positions[index1];
+			const float * pos2 = positions[index2];
+			const float * pos3 = positions[index3];
+			for(uint_fast8_t d = 0; d < 3; ++d) {
+				edge1[d][t] = pos2[d] - pos1[d];
+				edge2[d][t] = pos3[d] - pos1[d];
+			}
+			const float * uv1 = uvs[index1];
+			const float * uv2 = uvs[index2];
+			const float * uv3 = uvs[index3];
+			for(uint_fast8_t d = 0; d < 2; ++d) {
+				uvEdge1[d][t] = uv2[d] - uv1[d];
+				uvEdge2[d][t] = uv3[d] - uv1[d];
+			}
+		}
+		for(uint32_t t = 0; t < count; ++t) {
+			const float s1 = uvEdge1[0][t];
+			const float s2 = uvEdge2[0][t];
+			const float t1 = uvEdge1[1][t];
+			const float t2 = uvEdge2[1][t];
+
+			const float r = 1.0f / (s1 * t2 - s2 * t1);
+			for(uint_fast8_t d = 0; d < 3; ++d) {
+				dirs[d * TRIANGLE_BLOCK_SIZE + t] = (t2 * edge1[d][t] - t1 * edge2[d][t]) * r; // sdir
+				dirs[(d + 3) * TRIANGLE_BLOCK_SIZE + t] = (s1 * edge2[d][t] - s2 * edge1[d][t]) * r; // tdir
+			}
+		}
+	});
 
 	// -----------------------------------------------------------------------------
 
-	if (normalAttr.getDataType() == GL_FLOAT) {
-		for (uint32_t i = 0; i < vertices.getVertexCount(); ++i) {
-			const Vec3 normal(reinterpret_cast<float*> (vertices[i] + normalAttr.getOffset()));
-			const Vec3 & t = tan1[i];
-			const Vec3 tan((t - normal * normal.dot(t)).getNormalized() * 127); // Gram-Schmidt orthogonalize
-
-			int8_t * const tPtr = reinterpret_cast<int8_t*> (vertices[i] + tanAttr.getOffset());
-			int8_t handedness = (normal.cross(t).dot(tan2[i]) < 0.0f) ? -1 : 1; // Calculate handedness
-			tPtr[0] = handedness * static_cast<int8_t> (tan.x());
-			tPtr[1] = handedness * static_cast<int8_t> (tan.y());
-			tPtr[2] = handedness * static_cast<int8_t> (tan.z());
-			tPtr[3] = handedness;
-		}
-	} else if (normalAttr.getDataType() == GL_BYTE) {
-		for (uint32_t i = 0; i < vertices.getVertexCount(); ++i) {
-			const int8_t * nPtr = reinterpret_cast<const int8_t*> (vertices[i] + normalAttr.getOffset());
-			const Vec3 normal((Vec3(nPtr[0], nPtr[1], nPtr[2])).normalize());
-			const Vec3 & t = tan1[i];
+	const bool floatNormals = normalAttr.getDataType() == GL_FLOAT;
+	if (!floatNormals && normalAttr.getDataType() != GL_BYTE)
+		return;
+	uint8_t * const normalData = vertices.getAttributeData(normalAttr);
+	uint8_t * const tangentData = vertices.getAttributeData(tanAttr);
+	const size_t normalStride = vertices.getAttributeStride(normalAttr);
+	const size_t tangentStride = vertices.getAttributeStride(tanAttr);
+	parallelFor(getWorkerCount(threadCount), 0, vertices.getVertexCount(), [&](uint32_t, uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; ++i) {
+			Vec3 normal;
+			if (floatNormals) {
+				normal = Vec3(reinterpret_cast<float*> (normalData + i * normalStride));
+			} else {
+				const int8_t * nPtr = reinterpret_cast<const int8_t*> (normalData + i * normalStride);
+				normal = (Vec3(nPtr[0], nPtr[1], nPtr[2])).normalize();
+			}
+			const Vec3 t(tangents.data() + 6 * i);
+			const Vec3 bitangent(tangents.data() + 6 * i + 3);
 			const Vec3 tan((t - normal * normal.dot(t)).getNormalized() * 127); // Gram-Schmidt orthogonalize
 
-			int8_t * const tPtr = reinterpret_cast<int8_t*> (vertices[i] + tanAttr.getOffset());
-			int8_t handedness = (normal.cross(t).dot(tan2[i]) < 0.0f) ? -1 : 1; // Calculate handedness
+			int8_t * const tPtr = reinterpret_cast<int8_t*> (tangentData + i * tangentStride);
+			int8_t handedness = (normal.cross(t).dot(bitangent) < 0.0f) ? -1 : 1; // Calculate handedness
 			tPtr[0] = handedness * static_cast<int8_t> (tan.x());
 			tPtr[1] = handedness * static_cast<int8_t> (tan.y());
 			tPtr[2] = handedness * static_cast<int8_t> (tan.z());
 			tPtr[3] = handedness;
 		}
-	}
+	});
 }
 
 // -----------------------------------------------------------------------------
@@ -1696,6 +2296,13 @@ inline bool isZero(float f, float tolerance=std::numeric_limits<float>::epsilon(
 
 //!	(static)
 void cutMesh(Mesh* m, const Geometry::Plane& plane, const std::set<uint32_t> tIndices, float tolerance) {
+	if(!m->getVertexDescription().isInterleaved()) {
+		// the triangles are built from whole vertices
+		convertVertexLayout(m->openVertexData(), true);
+		cutMesh(m, plane, tIndices, tolerance);
+		convertVertexLayout(m->openVertexData(), false);
+		return;
+	}
 	const VertexDescription & vd = m->getVertexDescription();
 	const VertexAttribute & posAttr = vd.getAttribute(VertexAttributeIds::POSITION);
 	if (posAttr.getDataType() != GL_FLOAT || m->getDrawMode() != Mesh::DRAW_TRIANGLES) {
@@ -1851,6 +2458,13 @@ uint8_t getAdjacence(const SplitTriangle& t1, const SplitTriangle& t2, const Ver
 
 //!	(static)
 void extrudeTriangles(Mesh* m, const Geometry::Vec3& dir, const std::set<uint32_t> tIndices) {
+	if(!m->getVertexDescription().isInterleaved()) {
+		// the triangles are built from whole vertices
+		convertVertexLayout(m->openVertexData(), true);
+		extrudeTriangles(m, dir, tIndices);
+		convertVertexLayout(m->openVertexData(), false);
+		return;
+	}
 	const VertexDescription & vd = m->getVertexDescription();
 	const VertexAttribute & posAttr = vd.getAttribute(VertexAttributeIds::POSITION);
 	if (posAttr.getDataType() != GL_FLOAT || m->getDrawMode() != Mesh::DRAW_TRIANGLES) {
@@ -1960,77 +2574,199 @@ int32_t getFirstTriangleIntersectingRay(Mesh* m, const Geometry::Ray3& ray) {
 		WARN("getFirstTriangleIntersectingRay: Unsupported vertex format.");
 		return -1;
 	}
-	auto posAcc = PositionAttributeAccessor::create(m->openVertexData(), VertexAttributeIds::POSITION);
-	MeshIndexData & indices = m->openIndexData();
+	return TriangleBVH::get(m)->getFirstIntersection(ray);
+}
 
-	float tLine, uTri, vTri;
-	int32_t closest = -1;
-	float closestDist = std::numeric_limits<float>::infinity();
-	for(uint32_t i=0; i<indices.getIndexCount(); i+=3) {
-		Geometry::Triangle<Geometry::Vec3> triangle(
-			posAcc->getPosition(indices[i+0]),
-			posAcc->getPosition(indices[i+1]),
-			posAcc->getPosition(indices[i+2]));
-		// TODO: check triangle normal
-		if(Geometry::Intersection::getLineTriangleIntersection(ray, triangle, tLine, uTri, vTri)) {
-			if(tLine >= 0 && tLine < closestDist) {
-				closestDist = tLine;
-				closest = i/3;
-			}
-		}
-	}
+// -----------------------------------------------------------------------------
 
-	return closest;
+//!	(static)
+std::vector<int32_t> getFirstTrianglesIntersectingRays(Mesh* m, const std::vector<Geometry::Ray3>& rays, uint32_t threadCount) {
+	if (m->getDrawMode() != Mesh::DRAW_TRIANGLES) {
+		WARN("getFirstTrianglesIntersectingRays: Unsupported vertex format.");
+		return std::vector<int32_t>(rays.size(), -1);
+	}
+	return TriangleBVH::get(m)->getFirstIntersections(rays, threadCount);
 }
 
 // -----------------------------------------------------------------------------
 
 
-//! (static)
-uint32_t mergeCloseVertices(Mesh * mesh, float tolerance) {
-	const VertexDescription & desc = mesh->getVertexDescription();
-	const uint32_t indexCount = mesh->getIndexCount();
+/**
+ * Uniform grid over vertex positions with hashed cells. The vertices of each
+ * cell are stored contiguously in the order they were added.
+ * Used in @a mergeCloseVertices().
+ */
+class VertexGrid {
+	public:
+		static const uint32_t NONE = 0xffffffff;
+		struct Cell {
+			int64_t x, y, z;
+		};
+
+		VertexGrid(const std::vector<Vec3f> & positions, const Vec3f & origin, float cellSize) {
+			const float invCellSize = 1.0f / cellSize;
+			std::size_t capacity = 16;
+			while(capacity < 2 * positions.size())
+				capacity <<= 1;
+			slots.assign(capacity, NONE);
+			mask = capacity - 1;
+
+			std::vector<uint32_t> cellOfVertex;
+			cellOfVertex.reserve(positions.size());
+			for(const auto & pos : positions) {
+				const Vec3f rel = (pos - origin) * invCellSize;
+				const Cell cell{	static_cast<int64_t>(std::floor(rel.x())),
+									static_cast<int64_t>(std::floor(rel.y())),
+									static_cast<int64_t>(std::floor(rel.z())) };
+				std::size_t slot = hashCell(cell) & mask;
+				for(; slots[slot] != NONE; slot = (slot + 1) & mask) {
+					if(isSameCell(cells[slots[slot]], cell))
+						break;
+				}
+				if(slots[slot] == NONE) {
+					slots[slot] = static_cast<uint32_t>(cells.size());
+					cells.push_back(cell);
+				}
+				cellOfVertex.push_back(slots[slot]);
+			}
 
-	auto posAcc = PositionAttributeAccessor::create(mesh->openVertexData(), VertexAttributeIds::POSITION);
+			// Counting sort of the vertices by their cell (stable).
+			cellStart.assign(cells.size() + 1, 0);
+			for(const auto cellId : cellOfVertex)
+				++cellStart[cellId + 1];
+			for(std::size_t c = 0; c < cells.size(); ++c)
+				cellStart[c + 1] += cellStart[c];
+			std::vector<uint32_t> fill(cellStart.begin(), cellStart.end() - 1);
+			cellVertices.resize(positions.size());
+			for(uint32_t v = 0; v < cellOfVertex.size(); ++v)
+				cellVertices[fill[cellOfVertex[v]]++] = v;
+		}
 
-	auto comp = [&posAcc, &tolerance](const RawVertex& lhs, const RawVertex& rhs) -> bool {
-		auto v1 = posAcc->getPosition(lhs.getIndex());
-		auto v2 = posAcc->getPosition(rhs.getIndex());
-		if(std::abs(v1.x()-v2.x()) > tolerance)
-			return v1.x() < v2.x();
-		if(std::abs(v1.y()-v2.y()) > tolerance)
-			return v1.y() < v2.y();
-		if(std::abs(v1.z()-v2.z()) > tolerance)
-			return v1.z() < v2.z();
-		return false;
-	};
+		uint32_t getCellCount() const							{	return static_cast<uint32_t>(cells.size());	}
+		const Cell & getCell(uint32_t cellId) const				{	return cells[cellId];	}
+		const uint32_t * beginCell(uint32_t cellId) const		{	return cellVertices.data() + cellStart[cellId];	}
+		const uint32_t * endCell(uint32_t cellId) const			{	return cellVertices.data() + cellStart[cellId + 1];	}
 
-	uint32_t oldCount = mesh->getVertexCount();
+		//! Return the id of the given cell, or NONE if it contains no vertices.
+		uint32_t findCell(const Cell & cell) const {
+			for(std::size_t slot = hashCell(cell) & mask; slots[slot] != NONE; slot = (slot + 1) & mask) {
+				if(isSameCell(cells[slots[slot]], cell))
+					return slots[slot];
+			}
+			return NONE;
+		}
 
-	// Set of vertices used to create unique vertices.
-	std::set<RawVertex, decltype(comp)> rawVertices(comp);
-	// Mapping from old index to new index.
-	std::map<uint32_t, uint32_t> indexReplace;
+	private:
+		std::vector<Cell> cells;
+		std::vector<uint32_t> slots;
+		std::size_t mask;
+		std::vector<uint32_t> cellStart;
+		std::vector<uint32_t> cellVertices;
 
-	// Simply go over the indices and add one vertex after another.
-	{
-		const MeshVertexData & vertices = mesh->openVertexData();
-		const MeshIndexData & indices = mesh->openIndexData();
-		const std::size_t vertexSize = desc.getVertexSize();
+		static bool isSameCell(const Cell & a, const Cell & b) {
+			return a.x == b.x && a.y == b.y && a.z == b.z;
+		}
+		static std::size_t hashCell(const Cell & cell) {
+			uint64_t h = static_cast<uint64_t>(cell.x) * 0x9e3779b97f4a7c15ull;
+			h ^= static_cast<uint64_t>(cell.y) * 0xc2b2ae3d27d4eb4full + (h >> 29);
+			h ^= static_cast<uint64_t>(cell.z) * 0x165667b19e3779f9ull + (h >> 32);
+			return static_cast<std::size_t>(h ^ (h >> 31));
+		}
+};
+const uint32_t VertexGrid::NONE;
 
-		for (uint32_t counter = 0; counter < indexCount; ++counter) {
-			const uint32_t index = indices[counter];
-			const uint8_t * vertex = vertices[index];
-			RawVertex raw(index, vertex, vertexSize);
-			auto it = rawVertices.insert(raw);
-			indexReplace.insert(std::make_pair(index, it.first->getIndex()));
+//! (static)
+uint32_t mergeCloseVertices(Mesh * mesh, float tolerance, uint32_t threadCount) {
+	static const uint32_t NONE = VertexGrid::NONE;
+	const VertexDescription & desc = mesh->getVertexDescription();
+	const uint32_t indexCount = mesh->getIndexCount();
+	const uint32_t oldCount = mesh->getVertexCount();
+	const MeshVertexData & oldVertices = mesh->openVertexData();
+	const MeshIndexData & oldIndices = mesh->openIndexData();
+	const uint32_t workerCount = getWorkerCount(threadCount);
+
+	// Referenced vertices in the order of their first occurrence.
+	std::vector<uint32_t> listPosition(oldCount, NONE);
+	std::vector<uint32_t> vertexList;
+	for(uint32_t counter = 0; counter < indexCount; ++counter) {
+		const uint32_t index = oldIndices[counter];
+		if(listPosition[index] == NONE) {
+			listPosition[index] = static_cast<uint32_t>(vertexList.size());
+			vertexList.push_back(index);
 		}
 	}
+	const uint32_t listSize = static_cast<uint32_t>(vertexList.size());
 
-	// Mapping from new index to vertex position.
-	std::map<uint32_t, uint32_t> indexPosition;
+	auto posAcc = PositionAttributeAccessor::create(mesh->openVertexData(), VertexAttributeIds::POSITION);
+	std::vector<Vec3f> positions(listSize);
+	for(uint32_t v = 0; v < listSize; ++v)
+		positions[v] = posAcc->getPosition(vertexList[v]);
+
+	// Every vertex within the tolerance of another one lies in one of the 27 surrounding cells.
+	// The cell size is bounded from below to keep the cell coordinates finite.
+	const Geometry::Box & bb = oldVertices.getBoundingBox();
+	const float cellSize = std::max(std::max(tolerance, bb.getExtentMax() * 1.0e-9f), std::numeric_limits<float>::min());
+	const VertexGrid grid(positions, Vec3f(bb.getMinX(), bb.getMinY(), bb.getMinZ()), cellSize);
+
+	// Cells are processed in eight passes by the parity of their coordinates. Cells of the same
+	// parity are never adjacent, so they can be processed concurrently; the result does not
+	// depend on the number of threads.
+	std::vector<uint32_t> cellsByParity[8];
+	for(uint32_t cellId = 0; cellId < grid.getCellCount(); ++cellId) {
+		const VertexGrid::Cell & cell = grid.getCell(cellId);
+		cellsByParity[(cell.x & 1) | ((cell.y & 1) << 1) | ((cell.z & 1) << 2)].push_back(cellId);
+	}
+
+	// Mapping from list position to the list position of the vertex it is merged with.
+	std::vector<uint32_t> representative(listSize, NONE);
+	for(const auto & cellIds : cellsByParity) {
+		parallelFor(workerCount, 0, static_cast<uint32_t>(cellIds.size()), [&](uint32_t, uint32_t begin, uint32_t end) {
+			for(uint32_t c = begin; c < end; ++c) {
+				const uint32_t cellId = cellIds[c];
+				const VertexGrid::Cell & cell = grid.getCell(cellId);
+				uint32_t neighbors[27];
+				uint32_t neighborCount = 0;
+				for(int64_t dx = -1; dx <= 1; ++dx) {
+					for(int64_t dy = -1; dy <= 1; ++dy) {
+						for(int64_t dz = -1; dz <= 1; ++dz) {
+							const uint32_t neighbor = grid.findCell({cell.x + dx, cell.y + dy, cell.z + dz});
+							if(neighbor != NONE)
+								neighbors[neighborCount++] = neighbor;
+						}
+					}
+				}
+				for(const uint32_t * v = grid.beginCell(cellId); v != grid.endCell(cellId); ++v) {
+					const Vec3f & pos = positions[*v];
+					// Merge with the earliest referenced representative in reach.
+					uint32_t best = NONE;
+					for(uint32_t n = 0; n < neighborCount; ++n) {
+						for(const uint32_t * other = grid.beginCell(neighbors[n]); other != grid.endCell(neighbors[n]); ++other) {
+							if(*other >= best || representative[*other] != *other)
+								continue;
+							const Vec3f & otherPos = positions[*other];
+							if(std::abs(pos.x() - otherPos.x()) <= tolerance &&
+									std::abs(pos.y() - otherPos.y()) <= tolerance &&
+									std::abs(pos.z() - otherPos.z()) <= tolerance)
+								best = *other;
+						}
+					}
+					representative[*v] = best == NONE ? *v : best;
+				}
+			}
+		});
+	}
 
-	// Create the new mesh and add the rawVertices.
+	// Mapping from list position of a representative to the new vertex position.
+	std::vector<uint32_t> vertexPosition(listSize, NONE);
+	std::vector<uint32_t> uniqueVertices;
+	for(uint32_t v = 0; v < listSize; ++v) {
+		if(representative[v] == v) {
+			vertexPosition[v] = static_cast<uint32_t>(uniqueVertices.size());
+			uniqueVertices.push_back(vertexList[v]);
+		}
+	}
+
+	// Create the new mesh and add the unique vertices.
 	Util::Reference<Mesh> result = new Mesh;
 	result->setDataStrategy(mesh->getDataStrategy());
 	result->setFileName(mesh->getFileName());
@@ -2038,26 +2774,20 @@ uint32_t mergeCloseVertices(Mesh * mesh, float tolerance) {
 	result->setDrawMode(mesh->getDrawMode());
 
 	MeshVertexData & vertices = result->openVertexData();
-	vertices.allocate(rawVertices.size(), desc);
+	vertices.allocate(uniqueVertices.size(), desc);
 
 	MeshIndexData & indices = result->openIndexData();
 	indices.allocate(indexCount);
 
 	{
-		uint8_t * data = vertices.data();
-		uint32_t vertexPos = 0;
-		for(const auto & vertex : rawVertices) {
-			std::copy(vertex.getData(), vertex.getData() + vertex.getSize(), data);
-			data += vertex.getSize();
-			indexPosition.insert(std::make_pair(vertex.getIndex(), vertexPos));
-			++vertexPos;
-		}
+		uint32_t vertex = 0;
+		for(const auto index : uniqueVertices)
+			copyVertexRange(oldVertices, index, vertices, vertex++, 1);
 		// Translate the indices.
-		const uint32_t * srcIndex = mesh->openIndexData().data();
+		const uint32_t * srcIndex = oldIndices.data();
 		uint32_t * dstIndex = indices.data();
 		for (uint32_t counter = 0; counter < indexCount; ++counter) {
-			const uint32_t newIndex = indexReplace.find(*srcIndex)->second;
-			*dstIndex = indexPosition.find(newIndex)->second;
+			*dstIndex = vertexPosition[representative[listPosition[*srcIndex]]];
 			++srcIndex;
 			++dstIndex;
 		}
@@ -2277,11 +3007,35 @@ void flattenMesh(Mesh* mesh, const Geometry::Vec3& pos, float radius, float fall
 
 float computeSurfaceArea(Mesh* mesh) {
 	if(!mesh || mesh->getDrawMode() != Mesh::DRAW_TRIANGLES) return 0;
-	auto tAcc = TriangleAccessor::create(mesh);
-	float area = 0;
-	for(uint32_t i=0; i<mesh->getPrimitiveCount(); ++i) 
-		area += tAcc->getTriangle(i).calcArea();
-	return area;
+	MeshVertexData & vData = mesh->openVertexData();
+	const VertexAttribute & posAttr = vData.getVertexDescription().getAttribute(VertexAttributeIds::POSITION);
+
+	// read float positions directly from the vertex data; convert other formats once
+	std::vector<float> convertedPositions;
+	FloatAttributeView positions{vData.getAttributeData(posAttr), vData.getAttributeStride(posAttr)};
+	if(!StridedAttributeView<float>::isCompatible(posAttr, 3)) {
+		Util::Reference<PositionAttributeAccessor> positionAccessor(PositionAttributeAccessor::create(vData,VertexAttributeIds::POSITION));
+		convertedPositions.resize(3 * vData.getVertexCount());
+		positionAccessor->getPositions(0, vData.getVertexCount(), convertedPositions.data());
+		positions = FloatAttributeView{reinterpret_cast<const uint8_t *>(convertedPositions.data()), 3 * sizeof(float)};
+	}
+
+	const bool indexed = mesh->isUsingIndexData();
+	const uint32_t * indices = indexed ? mesh->openIndexData().data() : nullptr;
+	const uint32_t triangleCount = mesh->getPrimitiveCount();
+	double area = 0;
+	for(uint32_t t = 0; t < triangleCount; ++t) {
+		const float * a = positions[indexed ? indices[3 * t + 0] : 3 * t + 0];
+		const float * b = positions[indexed ? indices[3 * t + 1] : 3 * t + 1];
+		const float * c = positions[indexed ? indices[3 * t + 2] : 3 * t + 2];
+		const float ab[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+		const float ac[3] = {c[0] - a[0], c[1] - a[1], c[2] - a[2]};
+		const float x = ab[1] * ac[2] - ab[2] * ac[1];
+		const float y = ab[2] * ac[0] - ab[0] * ac[2];
+		const float z = ab[0] * ac[1] - ab[1] * ac[0];
+		area += 0.5 * std::sqrt(x * x + y * y + z * z);
+	}
+	return static_cast<float>(area);
 }
 
 // -----------------------------------------------------------------------------
@@ -2297,11 +3051,8 @@ MeshVertexData* extractVertices(Mesh* mesh, const std::vector<uint32_t>& indices
   result->allocate(indices.size(), desc);
   
   uint32_t i=0;
-  for(const auto& index : indices) {
-    uint32_t start = index * desc.getVertexSize();
-    uint32_t end = start + desc.getVertexSize();
-    std::copy(meshVertices.data() + start, meshVertices.data() + end, result->data() + desc.getVertexSize()*i++);
-  }
+  for(const auto& index : indices)
+    copyVertexRange(meshVertices, index, *result, i++, 1);
 
   return result;
 }
@@ -2326,16 +3077,22 @@ void copyVertices(Rendering::Mesh* source, Rendering::Mesh* target, uint32_t sou
 	auto& srcVertices = source->_getVertexData();
 	auto& tgtVertices = target->_getVertexData();
 	
-	uint32_t srcStart = sourceOffset*vd.getVertexSize();
-	uint32_t tgtStart = targetOffset*vd.getVertexSize();
-	uint32_t srcEnd = (sourceOffset + count)*vd.getVertexSize();
-		
 	if(srcVertices.isUploaded() && tgtVertices.isUploaded()) {
 		BufferObject srcBO;
 		BufferObject tgtBO;
 		srcVertices._swapBufferObject(srcBO);
 		tgtVertices._swapBufferObject(tgtBO);
-		tgtBO.copy(srcBO, srcStart, tgtStart, count*vd.getVertexSize());
+		if(vd.isInterleaved()) {
+			const uint32_t vertexSize = vd.getVertexSize();
+			tgtBO.copy(srcBO, sourceOffset*vertexSize, targetOffset*vertexSize, count*vertexSize);
+		} else {
+			// the streams start at different offsets if the vertex counts differ
+			for(const auto & attr : vd.getAttributes()) {
+				const uint32_t attrSize = attr.getDataSize();
+				tgtBO.copy(srcBO, vd.getAttributeDataOffset(attr, srcVertices.getVertexCount()) + sourceOffset*attrSize,
+						vd.getAttributeDataOffset(attr, tgtVertices.getVertexCount()) + targetOffset*attrSize, count*attrSize);
+			}
+		}
 		srcVertices._swapBufferObject(srcBO);
 		tgtVertices._swapBufferObject(tgtBO);
 		tgtVertices.releaseLocalData();
@@ -2346,7 +3103,7 @@ void copyVertices(Rendering::Mesh* source, Rendering::Mesh* target, uint32_t sou
 	}
 	
 	if(srcVertices.hasLocalData() && tgtVertices.hasLocalData()) {
-		std::copy(srcVertices.data() + srcStart, srcVertices.data() + srcEnd, tgtVertices.data() + tgtStart);
+		copyVertexRange(srcVertices, sourceOffset, tgtVertices, targetOffset, count);
 		tgtVertices.markAsChanged();
 	}
 	
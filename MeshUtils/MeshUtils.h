@@ -80,9 +80,11 @@ uint32_t calculateHash(const VertexDescription & vd);
  * - second calculating the unweighted average of the adjacent face normals for all vertices
  * @note if the mesh has already normals these are ignored and recalculated
  * @param m the mesh to be modified
+ * @param threadCount Number of threads used. A value of zero uses all hardware threads.
+ *        Each thread sums up the normals of a range of triangles in its own buffer.
  * @author Ralf Petring
  */
-void calculateNormals(Mesh * m);
+void calculateNormals(Mesh * m, uint32_t threadCount = 1);
 
 /**
  * Calculate and add tangent space vectors from the normals and uv-coordinates of the given mesh.
@@ -90,9 +92,10 @@ void calculateNormals(Mesh * m);
  * Terathon Software 3D Graphics Library, 2001. http://www.terathon.com/code/tangent.html
  * The bitangent can be calculated in the shader by:
  * float3 bitangent = cross(normal, tangent.xyz) * tangent.w;
+ * @param threadCount Number of threads used. A value of zero uses all hardware threads.
  */
 void calculateTangentVectors(	Mesh * mesh, const Util::StringIdentifier uvName,
-const Util::StringIdentifier tangentVecName);
+const Util::StringIdentifier tangentVecName, uint32_t threadCount = 1);
 
 
 //! Create texture coordinates by projecting the vertices with the given projection matrix.
@@ -140,6 +143,47 @@ bool compareMeshes( Mesh * mesh1,Mesh * mesh2 );
 MeshVertexData * convertVertices(	const MeshVertexData & vertices,
 const VertexDescription & newVertexDescription);
 
+/**
+ * Store the vertices interleaved or with a separate stream for each attribute.
+ * The attributes and their formats are kept; nothing is done if the data already has the requested layout.
+ * @see VertexDescription::setInterleaved
+ */
+void convertVertexLayout(MeshVertexData & vertices, bool interleaved);
+
+/**
+ * Copy @p count vertices beginning at @p sourceIndex in @p source to the vertices beginning at @p targetIndex in @p target.
+ * Both must have the same vertex description and enough local vertices; the attribute streams of
+ * non-interleaved data are copied one after another.
+ */
+void copyVertexRange(const MeshVertexData & source, uint32_t sourceIndex, MeshVertexData & target, uint32_t targetIndex, uint32_t count);
+
+/**
+ * Create a compact version of the given vertex description, which stores
+ * - positions as quantized normalized unsigned shorts (if @a quantizePositions is @c true),
+ * - normals as octahedral encoded shorts,
+ * - float tangents without handedness (three values) as octahedral encoded shorts, others as four bytes,
+ * - colors as four unsigned bytes,
+ * - texture coordinates as half floats.
+ * Other attributes are kept unchanged.
+ * @see compressVertices
+ */
+VertexDescription createCompactVertexDescription(const VertexDescription & vertexDescription, bool quantizePositions = true);
+
+/**
+ * Convert the vertices of the given mesh to the given (compact) vertex description.
+ * If the positions are stored as normalized (unsigned) shorts, they are quantized
+ * relative to the bounding box of the mesh. The scale is uniform, so normals computed
+ * from the quantized positions stay valid.
+ * The returned matrix transforms the quantized positions back into the original
+ * coordinates and has to be applied when rendering (e.g. as part of the model matrix).
+ * The bounding box of the mesh is given in quantized coordinates afterwards.
+ *
+ * @param mesh The mesh to convert.
+ * @param newVertexDescription The target layout (e.g. created by createCompactVertexDescription()).
+ * @return The decoding transformation of the positions; the identity matrix if the positions are not quantized.
+ */
+Geometry::Matrix4x4 compressVertices(Mesh * mesh, const VertexDescription & newVertexDescription);
+
  //! Copy data from one vertex attribute to another. Create, or modify the target attribute.
 void copyVertexAttribute(Mesh * mesh, Util::StringIdentifier from, Util::StringIdentifier to);
 
@@ -147,14 +191,18 @@ void copyVertexAttribute(Mesh * mesh, Util::StringIdentifier from, Util::StringI
 /**
  * Remove vertices which are equal to each other from the mesh and
  * store them only once. The indices to the vertices are adjusted.
- * This function has runtime O(n * log(n)) where n is the
- * number of vertices in @a mesh.
+ * Equal vertices are found with a hash table over the raw vertex data;
+ * only sorting the u unique vertices takes O(u * log(u)).
+ * The resulting vertices are ordered by their raw data, independent of the
+ * number of threads used.
  *
  * @param mesh Mesh to do the elimination on.
+ * @param threadCount Number of threads used; the vertices are partitioned by
+ * their hash values. A value of zero uses all hardware threads.
  *
  * @author Benjamin Eikel
  */
-void eliminateDuplicateVertices(Mesh * mesh);
+void eliminateDuplicateVertices(Mesh * mesh, uint32_t threadCount = 1);
 
 /**
  * Clone the given mesh but remove all vertices which are
@@ -208,6 +256,50 @@ float getLongestSideLength(Mesh * m);
  */
 void optimizeIndices(Mesh * mesh, const uint_fast8_t cacheSize =	24);
 
+/**
+ * Reorder the triangles of the given mesh to reduce overdraw.
+ * The triangles are split into clusters at points where the vertex cache
+ * runs empty, or where the cache miss ratio of the cluster is at most
+ * @a threshold times the one of the whole mesh. The clusters are then
+ * sorted by their occlusion potential, so that clusters facing away from
+ * the center of the mesh are drawn first.
+ * Use this function after optimizeIndices().
+ *
+ * @param mesh Mesh whose triangles will be reordered.
+ * @param threshold Allowed increase of the average cache miss ratio (e.g. 1.05).
+ * @param cacheSize Post-transform vertex cache size.
+ * @see http://doi.acm.org/10.1145/1276377.1276489
+ */
+void optimizeOverdraw(Mesh * mesh, float threshold = 1.05f, const uint_fast8_t cacheSize = 24);
+
+/**
+ * Reorder the vertices of the given mesh in the order they are first
+ * referenced by the indices, to improve the memory locality of vertex
+ * fetching. Unused vertices are moved to the end.
+ * Use this function after the triangles have been reordered.
+ *
+ * @param mesh Mesh whose vertices will be reordered.
+ */
+void optimizeVertexFetch(Mesh * mesh);
+
+//! Efficiency of the post-transform vertex cache for a mesh.
+struct VertexCacheStatistics {
+	//! Average cache miss ratio: number of transformed vertices per triangle (between 0.5 and 3).
+	float acmr;
+	//! Average transform to vertex ratio: number of transformed vertices per used vertex (1 is optimal).
+	float atvr;
+};
+
+/**
+ * Simulate a FIFO post-transform vertex cache of the given size for the
+ * triangles of the given mesh.
+ *
+ * @param mesh Triangle mesh
+ * @param cacheSize Post-transform vertex cache size.
+ * @return Statistics of the cache; zero for meshes without triangles.
+ */
+VertexCacheStatistics calculateVertexCacheStatistics(Mesh * mesh, const uint_fast8_t cacheSize = 24);
+
 /**
  * removes the color information from a mesh
  * @param m the mesh to be modified
@@ -322,7 +414,10 @@ void cutMesh(Mesh* m, const Geometry::Plane& plane, const std::set<uint32_t> tIn
 void extrudeTriangles(Mesh* m, const Geometry::Vec3& dir, const std::set<uint32_t> tIndices);
 
 /**
- * Slow method for finding the first triangle in a mesh that intersects the given ray.
+ * Find the first triangle in a mesh that intersects the given ray.
+ * Uses the triangle BVH cached at the mesh (see TriangleBVH::get()), which is
+ * built on the first call and rebuilt after the mesh has been marked as changed.
+ *
  * @param m the mesh
  * @param ray the ray
  * @return -1 if no intersecting triangle was found, the triangle index otherwise.
@@ -330,17 +425,37 @@ void extrudeTriangles(Mesh* m, const Geometry::Vec3& dir, const std::set<uint32_
  */
 int32_t getFirstTriangleIntersectingRay(Mesh* m, const Geometry::Ray3& ray);
 
+/**
+ * Batched version of getFirstTriangleIntersectingRay().
+ *
+ * @param m the mesh
+ * @param rays the rays
+ * @param threadCount Number of threads used. A value of zero uses all hardware threads.
+ * @return For each ray, -1 if no intersecting triangle was found, the triangle index otherwise.
+ */
+std::vector<int32_t> getFirstTrianglesIntersectingRays(Mesh* m, const std::vector<Geometry::Ray3>& rays, uint32_t threadCount=1);
+
 /**
  * Remove vertices which are close to each other from the mesh and
  * store them only once. The indices to the vertices are adjusted.
- * This function has runtime O(n * log(n)) where n is the
- * number of vertices in @a mesh.
+ * The vertices are sorted into a uniform grid with a cell size of @a tolerance,
+ * so the expected runtime is O(n) where n is the number of vertices in @a mesh.
+ * The cells are processed in eight passes by the parity of their coordinates;
+ * within a cell, the vertices are processed in the order of their first reference.
+ * A vertex is merged with the earliest referenced of the already kept vertices whose
+ * position differs by at most @a tolerance in every coordinate; if there is none, it is kept.
+ * Hence, no two kept vertices are that close, and each merged vertex is that close to
+ * the vertex it is merged with. Which vertices are kept depends on the pass order, not only
+ * on the reference order, but it does not depend on @a threadCount.
  *
  * @param mesh Mesh to do the elimination on.
+ * @param tolerance Maximal distance per coordinate.
+ * @param threadCount Number of threads used for processing the grid cells.
+ * A value of zero uses all hardware threads.
  * @return number of merged vertices
  * @author Sascha Brandt
  */
-uint32_t mergeCloseVertices(Mesh * mesh, float tolerance=std::numeric_limits<float>::epsilon());
+uint32_t mergeCloseVertices(Mesh * mesh, float tolerance=std::numeric_limits<float>::epsilon(), uint32_t threadCount=1);
 
 /**
  * Splits a mesh into its connected components.
@@ -0,0 +1,65 @@
+/*
+	This file is part of the Rendering library.
+	Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+	This library is subject to the terms of the Mozilla Public License, v. 2.0.
+	You should have received a copy of the MPL along with this library; see the
+	file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#ifndef RENDERING_MESHUTILS_PARALLELFOR_H
+#define RENDERING_MESHUTILS_PARALLELFOR_H
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace Rendering {
+namespace MeshUtils {
+
+/**
+ * Return the number of worker threads to use for the given requested count.
+ * A requested count of zero selects the number of hardware threads.
+ */
+inline uint32_t getWorkerCount(uint32_t requested) {
+	if(requested > 0)
+		return requested;
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+/**
+ * Split the range [begin, end) into @a workerCount contiguous chunks and call
+ * @a fn(worker, chunkBegin, chunkEnd) once for each chunk.
+ * The first chunk is processed on the calling thread. If only one worker is
+ * requested (or the range is too small), no thread is spawned at all.
+ *
+ * @note @a fn must not throw.
+ */
+template<typename Function>
+void parallelFor(uint32_t workerCount, uint32_t begin, uint32_t end, Function fn) {
+	if(end <= begin)
+		return;
+	const uint32_t count = end - begin;
+	workerCount = std::max(1u, std::min(workerCount, count));
+	if(workerCount == 1) {
+		fn(0u, begin, end);
+		return;
+	}
+	const uint32_t chunkSize = (count + workerCount - 1) / workerCount;
+	std::vector<std::thread> threads;
+	threads.reserve(workerCount - 1);
+	for(uint32_t worker = 1; worker < workerCount; ++worker) {
+		const uint32_t chunkBegin = begin + std::min(count, worker * chunkSize);
+		const uint32_t chunkEnd = begin + std::min(count, (worker + 1) * chunkSize);
+		if(chunkBegin < chunkEnd)
+			threads.emplace_back(fn, worker, chunkBegin, chunkEnd);
+	}
+	fn(0u, begin, begin + std::min(count, chunkSize));
+	for(auto & thread : threads)
+		thread.join();
+}
+
+}
+}
+
+#endif /* RENDERING_MESHUTILS_PARALLELFOR_H */
@@ -10,7 +10,11 @@
 */
 #include "Simplification.h"
 #include "MeshUtils.h"
+#include "ParallelFor.h"
 #include "../Mesh/Mesh.h"
+#include "../Mesh/MeshIndexData.h"
+#include "../Mesh/MeshVertexData.h"
+#include "../Mesh/VertexDescription.h"
 #include "../Mesh/VertexAttributeAccessors.h"
 #include "../Mesh/VertexAttributeIds.h"
 #include <Geometry/Point.h>
@@ -20,16 +24,17 @@
 #include <Util/Macros.h>
 #include <Util/Numeric.h>
 #include <Util/ProgressIndicator.h>
-#include <Util/UpdatableHeap.h>
 #include <Util/Utils.h>
 #include <Util/References.h>
 #include <Util/Timer.h>
 #include <algorithm>
 #include <array>
+#include <cmath>
 #include <deque>
-#include <set>
-#include <stdexcept>
-#include <unordered_set>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numeric>
 #include <utility>
 #include <vector>
 
@@ -37,23 +42,7 @@ namespace Rendering {
 namespace MeshUtils {
 namespace Simplification {
 
-struct heapData{
-	unsigned int vertex1;
-	unsigned int vertex2;
-	std::vector<float> optPos;
-
-	heapData() :
-		vertex1(std::numeric_limits<unsigned int>::max()), vertex2(std::numeric_limits<unsigned int>::max()), optPos() {
-	}
-	heapData(unsigned int v1, unsigned int v2) :
-		vertex1(v1), vertex2(v2), optPos() {
-	}
-};
-
-typedef Util::UpdatableHeap<float, heapData>::UpdatableHeapElement heapElement;
-typedef std::set<heapElement*>::iterator heapElementSetIterator;
-typedef std::set<unsigned int>::iterator uIntSetIterator;
-const float DONT_MERGE_COST = std::numeric_limits<float>::max();
+static const uint32_t INVALID_INDEX = std::numeric_limits<uint32_t>::max();
 
 struct VertexPoint : public Geometry::Point<Geometry::Vec3f> {
 	unsigned int data;
@@ -64,122 +53,43 @@ struct VertexPoint : public Geometry::Point<Geometry::Vec3f> {
 };
 
 /**
- * Storage of an upper triangular n-by-n square matrix.
- * Only the entries in the upper triangle and the diagonal are stored and no memory is used for the entries in the lower triangle.
- *
- * @author Benjamin Eikel
- * @date 2010-12-20
+ * Quadric error metric Q(v) = v^T A v + 2 b^T v + c of fixed dimension N.
+ * Only the upper triangle and the diagonal of the symmetric matrix A are stored.
  */
-template<typename _T>
-class UpperTriangularMatrix {
-	private:
-		//! Dimension of the matrix
-		size_t n;
-		//! One-dimensional array containing the entries
-		std::vector<_T> data;
-		//! Return the number of entries in the @c data array.
-		size_t arraySize() const {
-			return n * (n + 1) / 2;
-		}
-		//! Calculate the index of an entry (i, j).
-		size_t calcIndex(size_t i, size_t j) const {
-			// index = j + n * i - ((i * (i + 1)) / 2) = 1/2 * i * (2 * n - i - 1)
-			return j + i * (2 * n - i - 1) / 2;
-		}
-	public:
-		/**
-		 * Construct a new square matrix of order n.
-		 * The elements are initialized to zero.
-		 *
-		 * @param size Matrix size n
-		 */
-		explicit UpperTriangularMatrix(size_t size) :
-			n(size), data(arraySize(), static_cast<_T>(0)) {
-		}
-
-		//! Return the dimension of the matrix.
-		size_t getSize() const {
-			return n;
-		}
-
-		/**
-		 * Return an entry of the matrix.
-		 *
-		 * @param i Row number from [0, n-1]
-		 * @param j Column number from [0, n-1]
-		 * @return Element (i, j) of the matrix if i <= j and 0 for i > j
-		 */
-		_T get(size_t i, size_t j) const {
-			if (i > j) {
-				return 0;
-			} else {
-				return data[calcIndex(i, j)];
-			}
-		}
-
-
-		/**
-		 * Set an entry of the matrix to the given value.
-		 * Attempts to set a value in the lower triangle with i > j are ignored.
-		 *
-		 * @param i Row number from [0, n-1]
-		 * @param j Column number from [0, n-1]
-		 * @param value New value
-		 */
-		void set(size_t i, size_t j, _T value) {
-			if (i <= j) {
-				data[calcIndex(i, j)] = value;
-			}
-		}
-
+template<std::size_t N>
+struct Quadric {
+	static const std::size_t MATRIX_SIZE = N * (N + 1) / 2;
 
-		/**
-		 * Add the given value an entry of the matrix.
-		 * Attempts to add a value in the lower triangle with i > j are ignored.
-		 *
-		 * @param i Row number from [0, n-1]
-		 * @param j Column number from [0, n-1]
-		 * @param summand Summand to add
-		 */
-		void add(size_t i, size_t j, _T summand) {
-			if (i <= j) {
-				data[calcIndex(i, j)] += summand;
-			}
-		}
+	std::array<float, MATRIX_SIZE> A;
+	std::array<float, N> b;
+	float c;
 
-		/**
-		 * Add a second matrix component-wise to this matrix.
-		 *
-		 * @param second Another upper triangular matrix.
-		 */
-		void operator+=(const UpperTriangularMatrix<_T> & second) {
-			if (second.n != n) {
-				throw std::invalid_argument("Second matrix has different size");
-			}
-			const size_t size = arraySize();
-			for (size_t i = 0; i < size; ++i) {
-				data[i] += second.data[i];
-			}
-		}
-};
+	Quadric() : c(0.0f) {
+		A.fill(0.0f);
+		b.fill(0.0f);
+	}
 
-template<typename _T>
-struct Quadric {
-	UpperTriangularMatrix<_T> A;
-	std::vector<_T> b;
-	_T c;
+	//! Calculate the index of an entry (i, j) with i <= j.
+	static std::size_t calcIndex(std::size_t i, std::size_t j) {
+		// index = j + n * i - ((i * (i + 1)) / 2) = 1/2 * i * (2 * n - i - 1)
+		return j + i * (2 * N - i - 1) / 2;
+	}
 
-	explicit Quadric(size_t n) : A(n), b(n, static_cast<_T>(0)), c(static_cast<_T>(0)) {}
+	//! Return the entry (i, j) of the symmetric matrix A.
+	float get(std::size_t i, std::size_t j) const {
+		return i <= j ? A[calcIndex(i, j)] : A[calcIndex(j, i)];
+	}
 
 	/**
 	 * Add a second quadric to this quadric by adding the three components.
 	 *
 	 * @param second Another quadric.
 	 */
-	void operator+=(const Quadric<_T> & second) {
-		A += second.A;
-		const size_t size = b.size();
-		for(size_t i = 0; i < size; ++i) {
+	void operator+=(const Quadric<N> & second) {
+		for(std::size_t i = 0; i < MATRIX_SIZE; ++i) {
+			A[i] += second.A[i];
+		}
+		for(std::size_t i = 0; i < N; ++i) {
 			b[i] += second.b[i];
 		}
 		c += second.c;
@@ -188,25 +98,16 @@ struct Quadric {
 	/**
 	 * Return the quadric value given by Q(v) = v^T A v + 2 b^T v + c.
 	 *
-	 * @param v Parameter vector
+	 * @param v Parameter vector with N entries
 	 * @return Value of the quadratic form evaluated using v
 	 */
-	_T getCost(const std::vector<_T> & v) const {
-		const size_t size = v.size();
-		if (size != A.getSize()) {
-			throw std::invalid_argument("Second vector has different size");
-		}
-		_T v_A_v = 0;
-		_T b_v = 0;
-		for(uint_fast8_t i = 0; i < size; ++i) {
-			_T sum = 0;
-			for(uint_fast8_t j = 0; j < size; ++j) {
-				if(i > j) {
-					// Switch row and column to simulate an access to a symmetric matrix.
-					sum += v[j] * A.get(j, i);
-				} else {
-					sum += v[j] * A.get(i, j);
-				}
+	float getCost(const float * v) const {
+		float v_A_v = 0;
+		float b_v = 0;
+		for(std::size_t i = 0; i < N; ++i) {
+			float sum = 0;
+			for(std::size_t j = 0; j < N; ++j) {
+				sum += v[j] * get(i, j);
 			}
 			v_A_v += sum * v[i];
 
@@ -216,41 +117,14 @@ struct Quadric {
 	}
 };
 
-struct vertex_t {
-	Quadric<float> q;
-	std::vector<float> data; // vertex data: VERTEX, NORMAL, COLOR, TEX0
-	std::set<heapElement*> inHeap;
-	std::deque<uint32_t> inIndex;
-	std::set<unsigned int> neighbors;
-
-	explicit vertex_t(size_t n) :
-		q(n), data(), inHeap(), inIndex(), neighbors() {
-		data.reserve(n);
-	}
-};
-
-/**
- * Modify the given @a container and make sure, that it only contains unique elements.
- *
- * @param container Random-access container (e.g. of type std::deque or std::vector).
- */
-template<typename ContainerType>
-inline static void make_unique(ContainerType & container) {
-	// First sort the container because std::unique only works like we expect it here on a sorted range.
-	std::sort(container.begin(), container.end());
-	// Re-order the container and move duplicate entries to the end. The iterator will point to the last element of the range of unique elements.
-	auto it = std::unique(container.begin(), container.end());
-	// Now really remove the duplicate elements at the end.
-	container.resize(static_cast<std::size_t>(std::distance(container.begin(), it)));
-}
-
 /**
  * Normalize a vector
- * 
+ *
  * @param normalVector Vector as array
  * @return @c true if successful, @c false if the length is zero
  */
-static bool normalize(std::vector<float> & normalVector) {
+template<std::size_t N>
+static bool normalize(std::array<float, N> & normalVector) {
 	float length = 0;
 	for(const auto & n : normalVector) {
 		length += n * n;
@@ -270,7 +144,7 @@ static bool normalize(std::vector<float> & normalVector) {
 
 /**
  * Calculate the normal of the triangle that is induced by three vertices.
- * 
+ *
  * @param vertexA First vertex
  * @param vertexB Second vertex
  * @param vertexC Third vertex
@@ -289,29 +163,25 @@ static Geometry::Vec3f calcNormal(const float * vertexA, const float * vertexB,
 }
 
 /**
- * Adds quadric error metric from planes spanned by vertices p, q and r to
- * quadric q.
+ * Sets quadric to the quadric error metric from the plane spanned by vertices p, q and r.
  */
-static void getQuadric(const std::vector<float> & p, const std::vector<float> & q, const std::vector<float> & r, Quadric<float> & quadric){
-	const size_t size = quadric.A.getSize();
-
+template<std::size_t N>
+static void getQuadric(const float * p, const float * q, const float * r, Quadric<N> & quadric){
 	// e1 = (q - p) / ||q - p||
-	std::vector<float> e1;
-	e1.reserve(size);
-	for(uint_fast8_t i=0; i<size; ++i){
-		e1.push_back(q[i] - p[i]);
+	std::array<float, N> e1;
+	for(std::size_t i=0; i<N; ++i){
+		e1[i] = q[i] - p[i];
 	}
 	normalize(e1);
 
 	// e2 = (r - p - (e1 * (r - p)) e1) / ||...||
-	std::vector<float> e2;
-	e2.reserve(size);
+	std::array<float, N> e2;
 	float r_p_e1 = 0.0f;
-	for(uint_fast8_t i=0; i<size; ++i){
+	for(std::size_t i=0; i<N; ++i){
 		r_p_e1 += (r[i] - p[i]) * e1[i];
 	}
-	for(uint_fast8_t i=0; i<size; ++i){
-		e2.push_back(r[i] - p[i] - r_p_e1 * e1[i]);
+	for(std::size_t i=0; i<N; ++i){
+		e2[i] = r[i] - p[i] - r_p_e1 * e1[i];
 	}
 	normalize(e2);
 
@@ -320,11 +190,11 @@ static void getQuadric(const std::vector<float> & p, const std::vector<float> &
 	float p_p = 0.0f;
 
 	// A = I - e1 e1^T - e2 e2^T
-	for(uint_fast8_t i=0; i<size; ++i){
-		for(uint_fast8_t j=0; j<size; ++j){
-			quadric.A.set(i, j, -e1[i]*e1[j]-e2[i]*e2[j]);
+	for(std::size_t i=0; i<N; ++i){
+		for(std::size_t j=i; j<N; ++j){
+			quadric.A[Quadric<N>::calcIndex(i, j)] = -e1[i]*e1[j]-e2[i]*e2[j];
 		}
-		quadric.A.add(i, i, 1.0f);
+		quadric.A[Quadric<N>::calcIndex(i, i)] += 1.0f;
 
 		p_e1 += p[i]*e1[i];
 		p_e2 += p[i]*e2[i];
@@ -332,7 +202,7 @@ static void getQuadric(const std::vector<float> & p, const std::vector<float> &
 	}
 
 	// b = (p * e1) e1 + (p * e2) e2 - p
-	for(uint_fast8_t i=0; i<size; ++i){
+	for(std::size_t i=0; i<N; ++i){
 		quadric.b[i] = p_e1*e1[i]+p_e2*e2[i]-p[i];
 	}
 
@@ -341,656 +211,841 @@ static void getQuadric(const std::vector<float> & p, const std::vector<float> &
 }
 
 /**
- * Allocates memory for array and initializes matrices q
- * @return pointer to allocated array
+ * Calculate optimal position and cost for merging two vertices with the given quadrics and data.
+ * If the optimal position cannot be calculated, only v1, v2 and (v1+v2)/2 are compared as new positions.
+ *
+ * @param optPos (out) Optimal data with N entries
+ * @return cost
  */
-static std::size_t initVertexArray(Mesh * mesh, 
-								   Util::ProgressIndicator & progress, 
-								   const weights_t & weights,
-								   std::vector<vertex_t> & vertices, 
-								   Geometry::PointOctree<VertexPoint> * vOctree) {
-	const uint32_t vertexCount = mesh->getVertexCount();
-	MeshVertexData & vertexData = mesh->openVertexData();
-
-	std::size_t numDataEntries = 0;
+template<std::size_t N>
+static float getOptimalPosition(const Quadric<N> & quadricA, const Quadric<N> & quadricB, const float * dataA, const float * dataB, float * optPos, bool useOptPos){
+	Quadric<N> sumQ(quadricA);
+	sumQ += quadricB;
+	if(useOptPos){
+		// matrix for inversion: A on the left, the inverse is returned on the right
+		const std::size_t rowSize = 2 * N;
+		std::array<float, 2 * N * N> mInvert;
+		for(std::size_t row = 0; row < N; ++row) {
+			for(std::size_t col = 0; col < N; ++col) {
+				mInvert[row * rowSize + col] = sumQ.get(row, col);
+			}
+		}
 
-	Util::Reference<PositionAttributeAccessor> positionAccessor;
-	if(weights[VERTEX_OFFSET] > 0) {
-		try {
-			positionAccessor = PositionAttributeAccessor::create(vertexData, VertexAttributeIds::POSITION);
-			numDataEntries += 3;
-		} catch(...) {
+		if(Util::Numeric::invertMatrix(mInvert.data(), N)){
+			// Optimal position vBar = - A^-1 b
+			for(std::size_t row = 0; row < N; ++row) {
+				const std::size_t rowOffset = row * rowSize + N;
+				float sum = 0.0f;
+				for(std::size_t col = 0; col < N; ++col) {
+					sum += mInvert[rowOffset + col] * sumQ.b[col];
+				}
+				optPos[row] = -sum;
+			}
+			// Cost Q(vBar) = - b^T A^-1 b + c
+			float cost = sumQ.c;
+			for(std::size_t col = 0; col < N; ++col) {
+				float sum = 0.0f;
+				for(std::size_t row = 0; row < N; ++row) {
+					sum += sumQ.b[row] * mInvert[row * rowSize + N + col];
+				}
+				cost -= sum * sumQ.b[col];
+			}
+			return cost;
 		}
 	}
-	Util::Reference<NormalAttributeAccessor> normalAccessor;
-	if(weights[NORMAL_OFFSET] > 0) {
-		try {
-			normalAccessor = NormalAttributeAccessor::create(vertexData, VertexAttributeIds::NORMAL);
-			numDataEntries += 3;
-		} catch(...) {
-		}
+	// matrix is not invertible => get best position of v1, v2 and (v1+v2)/2
+	std::array<float, N> sumData;
+	for(std::size_t i = 0; i < N; ++i) {
+		sumData[i] = 0.5f * (dataA[i] + dataB[i]);
 	}
-	Util::Reference<ColorAttributeAccessor> colorAccessor;
-	if(weights[COLOR_OFFSET] > 0) {
-		try {
-			colorAccessor = ColorAttributeAccessor::create(vertexData, VertexAttributeIds::COLOR);
-			numDataEntries += 4;
-		} catch(...) {
-		}
+	const float costV1 = sumQ.getCost(dataA);
+	const float costV2 = sumQ.getCost(dataB);
+	const float costV1V2div2 = sumQ.getCost(sumData.data());
+	// use minimum of v1 and v2 as optimal position
+	if(costV1<costV2 && costV1<costV1V2div2){
+		std::copy(dataA, dataA + N, optPos);
+		return costV1;
+	}else if(costV2<costV1 && costV2<costV1V2div2){
+		std::copy(dataB, dataB + N, optPos);
+		return costV2;
+	} else{
+		std::copy(sumData.begin(), sumData.end(), optPos);
+		return costV1V2div2;
 	}
-	Util::Reference<TexCoordAttributeAccessor> texCoordAccessor;
-	if(weights[TEX0_OFFSET] > 0) {
-		try {
-			texCoordAccessor = TexCoordAttributeAccessor::create(vertexData, VertexAttributeIds::TEXCOORD0);
-			numDataEntries += 2;
-		} catch(...) {
+}
+
+/**
+ * Accessors for the attributes taking part in the simplification. The
+ * attributes of a vertex are stored consecutively in the order position,
+ * normal, color, tex0, each multiplied by its weight.
+ */
+class AttributeData {
+	private:
+		const weights_t weights;
+		Util::Reference<PositionAttributeAccessor> positionAccessor;
+		Util::Reference<NormalAttributeAccessor> normalAccessor;
+		Util::Reference<ColorAttributeAccessor> colorAccessor;
+		Util::Reference<TexCoordAttributeAccessor> texCoordAccessor;
+	public:
+		AttributeData(MeshVertexData & vertexData, const weights_t & _weights) : weights(_weights) {
+			if(weights[VERTEX_OFFSET] > 0) {
+				try {
+					positionAccessor = PositionAttributeAccessor::create(vertexData, VertexAttributeIds::POSITION);
+				} catch(...) {
+				}
+			}
+			if(weights[NORMAL_OFFSET] > 0) {
+				try {
+					normalAccessor = NormalAttributeAccessor::create(vertexData, VertexAttributeIds::NORMAL);
+				} catch(...) {
+				}
+			}
+			if(weights[COLOR_OFFSET] > 0) {
+				try {
+					colorAccessor = ColorAttributeAccessor::create(vertexData, VertexAttributeIds::COLOR);
+				} catch(...) {
+				}
+			}
+			if(weights[TEX0_OFFSET] > 0) {
+				try {
+					texCoordAccessor = TexCoordAttributeAccessor::create(vertexData, VertexAttributeIds::TEXCOORD0);
+				} catch(...) {
+				}
+			}
 		}
-	}
 
-	// allocate memory for array and values, get values for vertices and set matrix to 0
-	vertices.reserve(vertexCount);
-	for(uint_fast32_t v = 0; v < vertexCount; ++v) {
-		vertex_t vertex(numDataEntries);
+		bool hasPositions() const {
+			return positionAccessor.isNotNull();
+		}
 
-		if(positionAccessor.isNotNull()) {
-			const auto position = positionAccessor->getPosition(v) * weights[VERTEX_OFFSET];
-			vertex.data.push_back(position.getX());
-			vertex.data.push_back(position.getY());
-			vertex.data.push_back(position.getZ());
+		//! Return the number of data entries per vertex.
+		std::size_t getDimension() const {
+			return (positionAccessor.isNotNull() ? 3 : 0) + (normalAccessor.isNotNull() ? 3 : 0) +
+					(colorAccessor.isNotNull() ? 4 : 0) + (texCoordAccessor.isNotNull() ? 2 : 0);
+		}
 
-			// build vertex octree
-			if(vOctree != nullptr) {
-				vOctree->insert(VertexPoint(position, v));
+		//! Read the weighted data of vertex @a v.
+		void read(uint32_t v, float * data) const {
+			if(positionAccessor.isNotNull()) {
+				const auto position = positionAccessor->getPosition(v) * weights[VERTEX_OFFSET];
+				*data++ = position.getX();
+				*data++ = position.getY();
+				*data++ = position.getZ();
+			}
+			if(normalAccessor.isNotNull()) {
+				const auto normal = normalAccessor->getNormal(v);
+				*data++ = normal.getX() * weights[NORMAL_OFFSET];
+				*data++ = normal.getY() * weights[NORMAL_OFFSET];
+				*data++ = normal.getZ() * weights[NORMAL_OFFSET];
+			}
+			if(colorAccessor.isNotNull()) {
+				const auto color = colorAccessor->getColor4f(v);
+				*data++ = color.getR() * weights[COLOR_OFFSET];
+				*data++ = color.getG() * weights[COLOR_OFFSET];
+				*data++ = color.getB() * weights[COLOR_OFFSET];
+				*data++ = color.getA() * weights[COLOR_OFFSET];
+			}
+			if(texCoordAccessor.isNotNull()) {
+				const auto texCoord = texCoordAccessor->getCoordinate(v);
+				*data++ = texCoord.getX() * weights[TEX0_OFFSET];
+				*data++ = texCoord.getY() * weights[TEX0_OFFSET];
 			}
 		}
-		if(normalAccessor.isNotNull()) {
-			const auto normal = normalAccessor->getNormal(v);
-			vertex.data.push_back(normal.getX() * weights[NORMAL_OFFSET]);
-			vertex.data.push_back(normal.getY() * weights[NORMAL_OFFSET]);
-			vertex.data.push_back(normal.getZ() * weights[NORMAL_OFFSET]);
+
+		//! Write the weighted data of vertex @a v.
+		void write(uint32_t v, const float * data) const {
+			if(positionAccessor.isNotNull()) {
+				Geometry::Vec3f position;
+				position.setX(*data++);
+				position.setY(*data++);
+				position.setZ(*data++);
+				positionAccessor->setPosition(v, position / weights[VERTEX_OFFSET]);
+			}
+			if(normalAccessor.isNotNull()) {
+				Geometry::Vec3f normal;
+				normal.setX(*data++);
+				normal.setY(*data++);
+				normal.setZ(*data++);
+				const auto length = normal.length();
+				if(length > 1.0e-6f) {
+					normal /= length;
+				}
+				normalAccessor->setNormal(v, normal);
+			}
+			if(colorAccessor.isNotNull()) {
+				Util::Color4f color;
+				color.setR(*data++);
+				color.setG(*data++);
+				color.setB(*data++);
+				color.setA(*data++);
+				colorAccessor->setColor(v, color / weights[COLOR_OFFSET]);
+			}
+			if(texCoordAccessor.isNotNull()) {
+				Geometry::Vec2f coordinate;
+				coordinate.setX(*data++);
+				coordinate.setY(*data++);
+				texCoordAccessor->setCoordinate(v, coordinate / weights[TEX0_OFFSET]);
+			}
+		}
+};
+
+/**
+ * Forwards progress steps to a progress indicator. If a mutex is given, the
+ * indicator is shared between threads and the steps are forwarded in batches,
+ * so that the workers rarely have to wait for each other.
+ */
+class SharedProgress {
+	private:
+		Util::ProgressIndicator & progress;
+		std::mutex * mutex;
+		uint32_t pendingSteps;
+	public:
+		SharedProgress(Util::ProgressIndicator & _progress, std::mutex * _mutex) :
+			progress(_progress), mutex(_mutex), pendingSteps(0) {
 		}
-		if(colorAccessor.isNotNull()) {
-			const auto color = colorAccessor->getColor4f(v);
-			vertex.data.push_back(color.getR() * weights[COLOR_OFFSET]);
-			vertex.data.push_back(color.getG() * weights[COLOR_OFFSET]);
-			vertex.data.push_back(color.getB() * weights[COLOR_OFFSET]);
-			vertex.data.push_back(color.getA() * weights[COLOR_OFFSET]);
+		~SharedProgress() {
+			flush();
 		}
-		if(texCoordAccessor.isNotNull()) {
-			const auto texCoord = texCoordAccessor->getCoordinate(v);
-			vertex.data.push_back(texCoord.getX() * weights[TEX0_OFFSET]);
-			vertex.data.push_back(texCoord.getY() * weights[TEX0_OFFSET]);
+		void increment() {
+			if(mutex == nullptr) {
+				progress.increment();
+			} else if(++pendingSteps >= 4096) {
+				flush();
+			}
 		}
+		void flush() {
+			if(pendingSteps == 0) {
+				return;
+			}
+			std::lock_guard<std::mutex> lock(*mutex);
+			for(; pendingSteps > 0; --pendingSteps) {
+				progress.increment();
+			}
+		}
+};
 
-		vertices.emplace_back(std::move(vertex));
-
-		progress.increment();
+/**
+ * Structure-of-arrays storage of the vertices and triangles during the simplification.
+ *
+ * The incident triangles of each vertex are stored in compressed sparse row format.
+ * When a vertex is merged into another one, the merged vertex is appended to the
+ * merge chain of the remaining vertex, whose incident triangles then are the
+ * triangles of all the vertices in its chain that have not been removed.
+ *
+ * @tparam N Number of data entries per vertex
+ */
+template<std::size_t N>
+struct MeshState {
+	//! N data entries per vertex
+	std::vector<float> data;
+	std::vector<Quadric<N>> quadrics;
+	//! Vertex a vertex has been merged into; the vertex itself if it has not been removed
+	std::vector<uint32_t> parent;
+	//! Incremented every time a vertex changes
+	std::vector<uint32_t> version;
+	//! Merge chain: next vertex and last vertex of the chain starting at a vertex
+	std::vector<uint32_t> nextMerged;
+	std::vector<uint32_t> lastMerged;
+	//! Triangles incident to each vertex (given by the offset of their first index)
+	std::vector<uint32_t> triangleOffsets;
+	std::vector<uint32_t> triangles;
+	//! Vertices closer than the threshold, but not connected by an edge
+	std::vector<uint32_t> partnerOffsets;
+	std::vector<uint32_t> partners;
+	//! Per triangle: 1 if the triangle has been removed
+	std::vector<uint8_t> triangleRemoved;
+	//! If not empty: per triangle, the vertex whose removal removed the triangle
+	std::vector<uint32_t> triangleRemovedBy;
+	uint32_t * indices;
+
+	float * getData(uint32_t v) {
+		return data.data() + N * v;
+	}
+	const float * getData(uint32_t v) const {
+		return data.data() + N * v;
+	}
+	bool isRemoved(uint32_t v) const {
+		return parent[v] != v;
 	}
 
-	// initialize quadrics q
-	Quadric<float> tmpQ(numDataEntries);
-	const MeshIndexData & iData = mesh->openIndexData();
-
-	const uint32_t indexCount = iData.getIndexCount();
-
-	for (uint_fast32_t i = 0; i < indexCount; i += 3){
-		const uint32_t indexA = iData[i + 0];
-		const uint32_t indexB = iData[i + 1];
-		const uint32_t indexC = iData[i + 2];
-
-		// calculate plane equation
-		getQuadric(vertices[indexA].data, vertices[indexB].data, vertices[indexC].data, tmpQ);
-
-		// add face to vertex attribute
-		vertices[indexA].inIndex.push_back(i);
-		vertices[indexB].inIndex.push_back(i);
-		vertices[indexC].inIndex.push_back(i);
+	//! Return the vertex that @a v has been merged into.
+	uint32_t find(uint32_t v) const {
+		while(parent[v] != v) {
+			v = parent[v];
+		}
+		return v;
+	}
 
-		// add quadric distance matrix to q of vertices spanning this plane
-		vertices[indexA].q += tmpQ;
-		vertices[indexB].q += tmpQ;
-		vertices[indexC].q += tmpQ;
-		progress.increment();
+	//! Call @a fn(triangleOffset) for every triangle that uses @a v and has not been removed.
+	template<typename Function>
+	void forEachTriangle(uint32_t v, Function fn) const {
+		for(uint32_t m = v; m != INVALID_INDEX; m = nextMerged[m]) {
+			for(uint32_t t = triangleOffsets[m]; t < triangleOffsets[m + 1]; ++t) {
+				if(!triangleRemoved[triangles[t] / 3]) {
+					fn(triangles[t]);
+				}
+			}
+		}
 	}
 
-	for(auto & vertex : vertices) {
-		make_unique(vertex.inIndex);
+	//! Collect the neighbors of @a v (connected by an edge or closer than the threshold).
+	void collectNeighbors(uint32_t v, std::vector<uint32_t> & neighbors) const {
+		neighbors.clear();
+		forEachTriangle(v, [this, v, &neighbors](uint32_t triIndex) {
+			for(uint_fast8_t c = 0; c < 3; ++c) {
+				if(indices[triIndex + c] != v) {
+					neighbors.push_back(indices[triIndex + c]);
+				}
+			}
+		});
+		if(!partners.empty()) {
+			for(uint32_t m = v; m != INVALID_INDEX; m = nextMerged[m]) {
+				for(uint32_t p = partnerOffsets[m]; p < partnerOffsets[m + 1]; ++p) {
+					const uint32_t partner = find(partners[p]);
+					if(partner != v) {
+						neighbors.push_back(partner);
+					}
+				}
+			}
+		}
+		std::sort(neighbors.begin(), neighbors.end());
+		neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
 	}
+};
 
-	return numDataEntries;
-}
+//! Parameters of the merging of vertex pairs.
+struct CollapseOptions {
+	//! Calculate the optimal position of a merged vertex; otherwise, the best of v1, v2 and (v1+v2)/2 is used.
+	bool useOptimalPositioning;
+	//! Keep the data of one of the vertices (half-edge collapse); overrides useOptimalPositioning.
+	bool keepVertex;
+	//! Reject merges that rotate a face by more than maxAngle (requires positions).
+	bool checkNormals;
+	float maxAngle;
+};
 
 /**
- *  Adds neighbor vertices of vertex v to list n. Neighbors are all vertices
- *  connected via edges (and those with a distance smaller than the threshold).
- *  Attention: returns v as a neighbor of v and may return v as singleNeighbor
- *  @param mesh mesh to get index data from
- *  @param v vertex to get neighbors of
- *  @param threshold maximum distance between two non connected neighbors
- *  @param n returns set of neighbors in n
- *  @param singleNeighbors returns set of neighbors spanning exactly one face with v
+ * Candidate pair in the heap. An entry is stale if one of its vertices has been
+ * removed or changed after the entry has been created. Stale entries are skipped
+ * when they reach the top of the heap, because an up-to-date entry has been
+ * added for every pair of a changed vertex.
  */
-static void getNeighboursOfVertex(Mesh * mesh, const vertex_t & v, Geometry::PointOctree<VertexPoint> * vOctree, float threshold, std::set<unsigned int> & n, std::set<std::pair<unsigned int, unsigned int> > & singleNeighbors){
-	const MeshIndexData & iData = mesh->openIndexData();
-	const uint32_t * indices = iData.data();
-	std::vector<bool> multiNeighbors(iData.getMaxIndex(), false);
-	for(auto & elem : v.inIndex){
-		if(!n.insert(indices[elem+0]).second){
-			// has been inserted before => is a multiple neighbor of v
-			multiNeighbors[indices[elem+0]] = true;
-		}
-		if(!n.insert(indices[elem+1]).second){
-			// has been inserted before => is a multiple neighbor of v
-			multiNeighbors[indices[elem+1]] = true;
+struct PairEntry {
+	float cost;
+	uint32_t vertex1;
+	uint32_t vertex2;
+	uint32_t version1;
+	uint32_t version2;
+
+	//! Order for a min-heap; ties are broken by the vertex indices to get a deterministic order.
+	bool operator<(const PairEntry & other) const {
+		if(cost != other.cost) {
+			return cost > other.cost;
 		}
-		if(!n.insert(indices[elem + 2]).second){
-			// has been inserted before => is a multiple neighbor of v
-			multiNeighbors[indices[elem+2]] = true;
+		if(vertex1 != other.vertex1) {
+			return vertex1 > other.vertex1;
 		}
+		return vertex2 > other.vertex2;
 	}
+};
 
-	// build single neighbor set
-	for(auto & elem : v.inIndex){
-		if(!multiNeighbors[indices[elem+0]]){
-			// iData[*it+0] is not a multiple neighbor => add to singleNeighbors
-			singleNeighbors.insert(std::make_pair(indices[elem+0], elem));
+/**
+ * Greedy edge collapse on a mesh state shared with other instances.
+ * An instance only reads and writes the vertices that are part of the pairs added to
+ * it, their neighbors, and the triangles using these vertices. If @a locked is given,
+ * pairs containing a locked vertex are ignored. Therefore, several instances may run
+ * concurrently as long as their pairs belong to disjoint regions of the mesh, whose
+ * unlocked vertices have no neighbors outside of their own region.
+ */
+template<std::size_t N>
+class EdgeCollapse {
+	private:
+		MeshState<N> & state;
+		const std::vector<uint8_t> * locked;
+		const CollapseOptions options;
+		SharedProgress progress;
+		std::vector<PairEntry> heap;
+		std::vector<uint32_t> neighbors;
+
+		bool isLocked(uint32_t v) const {
+			return locked != nullptr && (*locked)[v] != 0;
 		}
-		if(!multiNeighbors[indices[elem+1]]){
-			// iData[*it+1] is not a multiple neighbor => add to singleNeighbors
-			singleNeighbors.insert(std::make_pair(indices[elem+1], elem));
+
+		/**
+		 * Check if a triangle of @a vertex that does not use @a other would
+		 * flip or degenerate when moving @a vertex to @a optPos.
+		 */
+		bool flipsNormal(uint32_t vertex, uint32_t other, const float * optPos) const {
+			bool normalFlip = false;
+			state.forEachTriangle(vertex, [&](uint32_t triIndex) {
+				const uint32_t * tri = state.indices + triIndex;
+				if(normalFlip || tri[0] == other || tri[1] == other || tri[2] == other) {
+					// face will be deleted
+					return;
+				}
+				// calculate normal before merging
+				const auto normalBefore = calcNormal(state.getData(tri[0]), state.getData(tri[1]), state.getData(tri[2]));
+				// calculate normal after merging
+				const auto normalAfter = calcNormal(tri[0] == vertex ? optPos : state.getData(tri[0]),
+													tri[1] == vertex ? optPos : state.getData(tri[1]),
+													tri[2] == vertex ? optPos : state.getData(tri[2]));
+				// check if normal has flipped
+				normalFlip = normalBefore.isZero() || normalAfter.isZero() || normalBefore.dot(normalAfter) < options.maxAngle;
+			});
+			return normalFlip;
 		}
-		if(!multiNeighbors[indices[elem+2]]){
-			// iData[*it+2] is not a multiple neighbor => add to singleNeighbors
-			singleNeighbors.insert(std::make_pair(indices[elem+2], elem));
+
+		/**
+		 * Calculate the data and cost of the vertex resulting from merging i and j.
+		 *
+		 * @param keepJ (out) Set to @c true if the data of j is kept by a half-edge collapse.
+		 */
+		float evaluatePair(uint32_t i, uint32_t j, float * optPos, bool & keepJ) const {
+			keepJ = false;
+			if(!options.keepVertex) {
+				return getOptimalPosition(state.quadrics[i], state.quadrics[j], state.getData(i), state.getData(j), optPos, options.useOptimalPositioning);
+			}
+			Quadric<N> sumQ(state.quadrics[i]);
+			sumQ += state.quadrics[j];
+			const float costI = sumQ.getCost(state.getData(i));
+			const float costJ = sumQ.getCost(state.getData(j));
+			keepJ = costJ < costI;
+			std::copy(state.getData(keepJ ? j : i), state.getData(keepJ ? j : i) + N, optPos);
+			return keepJ ? costJ : costI;
 		}
-	}
 
-	// add non connected vertices to neighbors
-	if(threshold > 0.0f) {
-		std::deque<VertexPoint> nonConnectedNeighbors;
-		vOctree->collectPointsWithinSphere(Geometry::Sphere_f(Geometry::Vec3f(v.data[0], v.data[1], v.data[2]), threshold), nonConnectedNeighbors);
-		for(auto & nonConnectedNeighbor : nonConnectedNeighbors) {
-			n.insert(nonConnectedNeighbor.data);
+	public:
+		//! Number of merges that have been rejected because of a normal flip
+		int flipCount;
+		//! Vertices in the order they have been merged into another vertex
+		std::vector<uint32_t> removedVertices;
+
+		EdgeCollapse(MeshState<N> & _state, const std::vector<uint8_t> * _locked, const CollapseOptions & _options,
+					 Util::ProgressIndicator & _progress, std::mutex * progressMutex) :
+			state(_state), locked(_locked), options(_options), progress(_progress, progressMutex), heap(), neighbors(), flipCount(0), removedVertices() {
 		}
-	}
-}
 
-/**
- * Calculated optimal position and cost for merging vertices v1 and v2
- * only compares v1, v2 and (v1+v2)/2 as new positions...
- * @return cost
- */
-static float getOptimalPosition(const vertex_t & vertexA, const vertex_t & vertexB, std::vector<float> & optPos, std::size_t dataSize, bool useOptPos){
-	bool optPosSuccess=false;
-	float cost = 0;
-	if(useOptPos){
-		// allocate and initiate matrix for inversion
-		const auto rowSize = 2 * dataSize;
-		auto mInvert = new float[dataSize * rowSize];
-		for (std::size_t row = 0; row < dataSize; ++row) {
-			for (std::size_t col = 0; col < dataSize; ++col) {
-				const auto rowOffset = row * rowSize;
-				if (row <= col) {
-					mInvert[rowOffset + col] = vertexA.q.A.get(row, col) + vertexB.q.A.get(row, col);
-				} else {
-					mInvert[rowOffset + col] = vertexA.q.A.get(col, row) + vertexB.q.A.get(col, row);
+		//! Add the pair of vertices i and j to the heap.
+		void addPair(uint32_t i, uint32_t j) {
+			std::array<float, N> optPos;
+			bool keepJ;
+			const float cost = evaluatePair(i, j, optPos.data(), keepJ);
+			heap.push_back({cost, i, j, state.version[i], state.version[j]});
+			std::push_heap(heap.begin(), heap.end());
+		}
+
+		/**
+		 * Add the pairs of @a v with all its neighbors to the heap.
+		 *
+		 * @param filter Only neighbors n for which filter(n) returns @c true are used.
+		 */
+		template<typename Filter>
+		void addPairsOf(uint32_t v, Filter filter) {
+			if(isLocked(v)) {
+				return;
+			}
+			state.collectNeighbors(v, neighbors);
+			for(const auto & n : neighbors) {
+				if(!isLocked(n) && filter(n)) {
+					addPair(v, n);
 				}
 			}
 		}
 
-		if(Util::Numeric::invertMatrix(mInvert, dataSize)){
-			optPosSuccess = true;
-			// matrix inversion successful
-			// calculate & store optimal position
-			// Optimal position vBar = - A^-1 b
-			optPos.resize(dataSize);
-			for (uint_fast8_t row = 0; row < dataSize; ++row) {
-				const uint_fast8_t rowOffset = row * rowSize + dataSize;
+		//! Signal one step of progress that is not related to merging (e.g. after adding the pairs of a vertex).
+		void incrementProgress() {
+			progress.increment();
+		}
 
-				float sum = 0.0f;
-				for(uint_fast8_t col = 0; col < dataSize; ++col) {
-					sum += mInvert[rowOffset + col] * (vertexA.q.b[col] + vertexB.q.b[col]);
+		/**
+		 * Merge the vertex pairs in the order of increasing cost.
+		 *
+		 * @param maxRemovedTriangles Stop after this number of triangles has been removed.
+		 * @return Number of removed triangles
+		 */
+		uint32_t run(uint32_t maxRemovedTriangles) {
+			uint32_t removedTriangles = 0;
+			std::array<float, N> optPos;
+			while(removedTriangles < maxRemovedTriangles && !heap.empty()) {
+				std::pop_heap(heap.begin(), heap.end());
+				const PairEntry top = heap.back();
+				heap.pop_back();
+				uint32_t vertex1 = top.vertex1;
+				uint32_t vertex2 = top.vertex2;
+				if(state.isRemoved(vertex1) || state.isRemoved(vertex2) ||
+						state.version[vertex1] != top.version1 || state.version[vertex2] != top.version2) {
+					// stale entry
+					continue;
 				}
-				optPos[row] = -sum;
-			}
-			// Cost Q(vBar) = - b^T A^-1 b + c
-			cost = vertexA.q.c + vertexB.q.c;
-			for(uint_fast8_t col = 0; col < dataSize; ++col) {
-				float sum = 0.0f;
-				for (uint_fast8_t row = 0; row < dataSize; ++row) {
-					const uint_fast8_t rowOffset = row * rowSize + dataSize;
-					sum += (vertexA.q.b[row] + vertexB.q.b[row]) * mInvert[rowOffset + col];
+				bool keepVertex2;
+				evaluatePair(vertex1, vertex2, optPos.data(), keepVertex2);
+				if(keepVertex2) {
+					// merge vertex1 into vertex2
+					std::swap(vertex1, vertex2);
 				}
-				cost -= sum * (vertexA.q.b[col] + vertexB.q.b[col]);
+
+				// check if some normal flips
+				if(options.checkNormals && options.maxAngle != -1 && (flipsNormal(vertex1, vertex2, optPos.data()) || flipsNormal(vertex2, vertex1, optPos.data()))) {
+					++flipCount;
+					continue;
+				}
+
+				// update indexData of vertex2 to vertex1 and remove the triangles using both
+				state.forEachTriangle(vertex2, [&](uint32_t triIndex) {
+					uint32_t * tri = state.indices + triIndex;
+					if(tri[0] == vertex1 || tri[1] == vertex1 || tri[2] == vertex1) {
+						// triangle uses vertex1 and vertex2 => no triangle after merging
+						state.triangleRemoved[triIndex / 3] = 1;
+						if(!state.triangleRemovedBy.empty()) {
+							state.triangleRemovedBy[triIndex / 3] = vertex2;
+						}
+						++removedTriangles;
+						progress.increment();
+					} else {
+						for(uint_fast8_t c = 0; c < 3; ++c) {
+							if(tri[c] == vertex2) {
+								tri[c] = vertex1;
+							}
+						}
+					}
+				});
+
+				// merge vertex1 and vertex2 into vertex1
+				std::copy(optPos.begin(), optPos.end(), state.getData(vertex1));
+				state.quadrics[vertex1] += state.quadrics[vertex2];
+				state.parent[vertex2] = vertex1;
+				state.nextMerged[state.lastMerged[vertex1]] = vertex2;
+				state.lastMerged[vertex1] = state.lastMerged[vertex2];
+				++state.version[vertex1];
+				removedVertices.push_back(vertex2);
+
+				// add the pairs of the changed vertex
+				addPairsOf(vertex1, [](uint32_t) { return true; });
 			}
+			progress.flush();
+			return removedTriangles;
 		}
+};
 
-		// free matrix memory
-		delete[] mInvert;
+/**
+ * Split the vertices in [begin, end) into @a clusterCount spatially coherent clusters
+ * of about equal size by recursive median splits along the axis of largest extent.
+ * Only the first (at most three) data entries of the vertices are used as coordinates.
+ *
+ * @param clusterOfVertex (out) Cluster index for each vertex
+ */
+template<std::size_t N>
+static void partitionVertices(const MeshState<N> & state, std::vector<uint32_t>::iterator begin, std::vector<uint32_t>::iterator end,
+							  uint32_t firstCluster, uint32_t clusterCount, std::vector<uint32_t> & clusterOfVertex) {
+	if(clusterCount <= 1 || std::distance(begin, end) <= 1) {
+		for(auto it = begin; it != end; ++it) {
+			clusterOfVertex[*it] = firstCluster;
+		}
+		return;
 	}
-	if(!optPosSuccess){
-		// matrix is not invertible => get best position of v1, v2 and (v1+v2)/2
-		Quadric<float> sumQ(vertexA.q);
-		sumQ += vertexB.q;
-
-		std::vector<float> sumData;
-		sumData.reserve(dataSize);
-		for (std::size_t i = 0; i < dataSize; ++i) {
-			sumData.push_back(0.5f * (vertexA.data[i] + vertexB.data[i]));
+	const std::size_t dimensions = std::min<std::size_t>(N, 3);
+	std::array<float, 3> minValue, maxValue;
+	minValue.fill(std::numeric_limits<float>::max());
+	maxValue.fill(std::numeric_limits<float>::lowest());
+	for(auto it = begin; it != end; ++it) {
+		for(std::size_t d = 0; d < dimensions; ++d) {
+			minValue[d] = std::min(minValue[d], state.getData(*it)[d]);
+			maxValue[d] = std::max(maxValue[d], state.getData(*it)[d]);
 		}
-		float costV1 = sumQ.getCost(vertexA.data);
-		float costV2 = sumQ.getCost(vertexB.data);
-		float costV1V2div2 = sumQ.getCost(sumData);
-		// use minimum of v1 and v2 as optimal position
-		if(costV1<costV2 && costV1<costV1V2div2){
-			cost = costV1;
-			optPos = vertexA.data;
-		}else if(costV2<costV1 && costV2<costV1V2div2){
-			cost = costV2;
-			optPos = vertexB.data;
-		} else{
-			cost = costV1V2div2;
-			optPos = sumData;
+	}
+	std::size_t axis = 0;
+	for(std::size_t d = 1; d < dimensions; ++d) {
+		if(maxValue[d] - minValue[d] > maxValue[axis] - minValue[axis]) {
+			axis = d;
 		}
 	}
-	return cost;
+	const uint32_t leftClusters = clusterCount / 2;
+	const auto middle = begin + std::distance(begin, end) * leftClusters / clusterCount;
+	std::nth_element(begin, middle, end, [&state, axis](uint32_t a, uint32_t b) {
+		return state.getData(a)[axis] < state.getData(b)[axis];
+	});
+	partitionVertices(state, begin, middle, firstCluster, leftClusters, clusterOfVertex);
+	partitionVertices(state, middle, end, firstCluster + leftClusters, clusterCount - leftClusters, clusterOfVertex);
 }
 
-Mesh * simplifyMesh(Mesh * mesh, uint32_t newNumberOfTriangles, float threshold, bool useOptimalPositioning, float maxAngle, const weights_t & weights) {
-	if(mesh->getDrawMode() != Mesh::DRAW_TRIANGLES) {
-		WARN("Mesh simplification can only be done with triangle meshes.");
-		return mesh;
-	}
-	if(mesh->getPrimitiveCount() <= newNumberOfTriangles) {
-		WARN("Mesh already has less or equal as many triangles as requested.");
-		return mesh;
-	}
-	Util::info<<"\nSimplifying mesh from "<<mesh->getPrimitiveCount()<<" to "<<newNumberOfTriangles<<" triangles; threshold: "<<threshold<<"; optPos: "<<useOptimalPositioning<<"\n";
-	Util::info<<"Weights are: vertex="<<weights[0]<<" normal="<<weights[1]<<" color="<<weights[2]<<" tex0="<<weights[3]<<" boundary="<<weights[4]<<"\n";
-	Util::ProgressIndicator progress("Simplify progress",(mesh->getPrimitiveCount()-newNumberOfTriangles)+mesh->getPrimitiveCount()+3*mesh->getVertexCount(), 2);
-	Util::Timer timer;
-	timer.reset();
+/**
+ * Initialize the mesh state: read the vertex data, build the incident triangle
+ * lists, accumulate the face quadrics, add the boundary constraint planes and
+ * find the non-connected neighbors.
+ */
+template<std::size_t N>
+static void initMeshState(MeshState<N> & state, const AttributeData & attributes, MeshIndexData & iData, uint32_t vertexCount,
+						  float threshold, bool addBoundaryPlanes, Util::ProgressIndicator & progress) {
+	const uint32_t indexCount = iData.getIndexCount();
+	state.indices = iData.data();
 
-	// initialize vertex array
-	const Geometry::Box & meshBB = mesh->getBoundingBox();
-	const float octreeBoxMax = std::max(std::max(meshBB.getMaxX(), meshBB.getMaxY()), meshBB.getMaxZ()) * weights[VERTEX_OFFSET];
-	const float octreeBoxMin = std::min(std::min(meshBB.getMinX(), meshBB.getMinY()), meshBB.getMinZ()) * weights[VERTEX_OFFSET];
-	const Geometry::Box octreeBox(octreeBoxMin, octreeBoxMax, octreeBoxMin, octreeBoxMax, octreeBoxMin, octreeBoxMax);
-	threshold *= weights[VERTEX_OFFSET];
-	Geometry::PointOctree<VertexPoint> * vertexOctree = nullptr;
-	if(threshold > 0.0f) {
-		vertexOctree = new Geometry::PointOctree<VertexPoint>(octreeBox, threshold, 100);
+	state.data.resize(N * static_cast<std::size_t>(vertexCount));
+	for(uint32_t v = 0; v < vertexCount; ++v) {
+		attributes.read(v, state.getData(v));
+		progress.increment();
 	}
-	std::vector<vertex_t> vertices;
-	const auto numDataEntries = initVertexArray(mesh, progress, weights, vertices, vertexOctree);
-	if(numDataEntries == 0) {
-		WARN("Vertex data does not contain readable information, or weights prevent the data usage.");
-		return mesh;
+	state.parent.resize(vertexCount);
+	std::iota(state.parent.begin(), state.parent.end(), 0);
+	state.version.assign(vertexCount, 0);
+	state.nextMerged.assign(vertexCount, INVALID_INDEX);
+	state.lastMerged = state.parent;
+	state.triangleRemoved.assign(indexCount / 3, 0);
+
+	// incident triangles
+	state.triangleOffsets.assign(vertexCount + 1, 0);
+	for(uint32_t i = 0; i < indexCount; ++i) {
+		++state.triangleOffsets[state.indices[i] + 1];
 	}
-
-	// build heap
-	Util::UpdatableHeap<float, heapData> heap;
-
-	const uint32_t vertexCount = mesh->getVertexCount();
-	MeshIndexData iData = mesh->openIndexData();
-
-	// add boundary constraint planes and get neighbors
+	std::partial_sum(state.triangleOffsets.begin(), state.triangleOffsets.end(), state.triangleOffsets.begin());
+	state.triangles.resize(indexCount);
 	{
-		Quadric<float> tmpQ(numDataEntries);
-		std::vector<float> v1(numDataEntries, 0.0f);
-		std::vector<float> v2(numDataEntries, 0.0f);
-		std::vector<float> v3(numDataEntries, 0.0f);
-		for(unsigned int i=0; i<vertexCount; ++i){
-			std::set<std::pair<unsigned int, unsigned int> > singleNeighbors;
-			getNeighboursOfVertex(mesh, vertices[i], vertexOctree, threshold, vertices[i].neighbors, singleNeighbors);
-
-			if(weights[BOUNDARY_OFFSET] && weights[VERTEX_OFFSET]){
-				// make sure to add a boundary plan to only once to both vertices i and *singleNeighborIterator.first by checking first<i
-				for(auto singleNeighborIterator=singleNeighbors.begin(); singleNeighborIterator->first<i && singleNeighborIterator!=singleNeighbors.end(); ++singleNeighborIterator){
-					// plane normal has to be perpendicular to edge between single neighbors and to normal of face spanned by this edge
-					// => plane has to lie in single neighbor vertices and one of those vertices+planeNormal
-					const auto normal = calcNormal(vertices[iData[singleNeighborIterator->second + 0]].data.data(),
-												   vertices[iData[singleNeighborIterator->second + 1]].data.data(),
-												   vertices[iData[singleNeighborIterator->second + 2]].data.data());
-
-					v1[0] = vertices[i].data[0];
-					v1[1] = vertices[i].data[1];
-					v1[2] = vertices[i].data[2];
-					v2[0] = vertices[singleNeighborIterator->first].data[0];
-					v2[1] = vertices[singleNeighborIterator->first].data[1];
-					v2[2] = vertices[singleNeighborIterator->first].data[2];
-					v3[0] = normal.getX() + vertices[i].data[0];
-					v3[1] = normal.getY() + vertices[i].data[1];
-					v3[2] = normal.getZ() + vertices[i].data[2];
-
-
-					//getQuadric(&vertices[i].data[0], &vertices[singleNeighborIterator->first].data[0], v3, tmp_quadric, 4);
-					getQuadric(v1, v2, v3, tmpQ);
-					for(std::size_t j=3; j<numDataEntries; ++j)
-						tmpQ.A.set(j, j, 0.0f);
-
-					// add boundary constraint plane to both vertices that are single neighbors
-					vertices[i].q += tmpQ;
-					vertices[singleNeighborIterator->first].q += tmpQ;
-				}
-			}
-			progress.increment();
-			// singleNeighbors is destroyed here
+		std::vector<uint32_t> fill(state.triangleOffsets.begin(), state.triangleOffsets.end() - 1);
+		for(uint32_t i = 0; i < indexCount; ++i) {
+			state.triangles[fill[state.indices[i]]++] = i - i % 3;
 		}
 	}
 
-	// build heap
-	for(unsigned int i=0; i<vertexCount; ++i){
-		// add unique neighbors to heap (by adding only pairs of (i,j) where i<j)
-		for(auto it=vertices[i].neighbors.upper_bound(i); it!=vertices[i].neighbors.end(); ++it){
-			heapData hd(i, *it);
-			float cost = getOptimalPosition(vertices[i], vertices[*it], hd.optPos, numDataEntries, useOptimalPositioning);
-			heapElement *h = heap.insert(cost, hd);
-			vertices[i].inHeap.insert(h);
-			vertices[*it].inHeap.insert(h);
-		}
-		progress.increment();
-	}
-
-
-	// merge vertices
-	int flipcount = 0;
-	std::unordered_set<unsigned int> indexTrash;
-	std::vector<unsigned int> vertexTrash;
-	// rough estimate of the number of vertices that will be removed
-	vertexTrash.reserve((mesh->getPrimitiveCount() - newNumberOfTriangles) / 2);
-	unsigned int newTriangleCount = mesh->getPrimitiveCount();
-
-	{
-		while(newTriangleCount>newNumberOfTriangles && heap.size()!=0 && heap.top()->getCost()!=DONT_MERGE_COST /*&& iteration<threshold*/){
-			heapElement *heapHead = heap.top();
-			heapData &topData = heapHead->data;
-			std::set<heapElement*> heapTrash;
-
-			if(maxAngle != -1) {
-				// check if some normal flips
-				bool normalFlip = false;
-				// checking for vertex1.inIndex
-				for(const auto & triIndex : vertices[topData.vertex1].inIndex) {
-					if(!(iData[triIndex + 0] == topData.vertex2
-						|| iData[triIndex + 1] == topData.vertex2
-						|| iData[triIndex + 2] == topData.vertex2)) {
-						// face will not be deleted
-
-						// calculate normal before merging
-						const auto normalBefore = calcNormal(vertices[iData[triIndex + 0]].data.data(), 
-															 vertices[iData[triIndex + 1]].data.data(), 
-															 vertices[iData[triIndex + 2]].data.data());
-						if(normalBefore.isZero()) {
-							normalFlip = true;
-							break;
-						}
+	// initialize quadrics q
+	state.quadrics.resize(vertexCount);
+	Quadric<N> tmpQ;
+	for(uint32_t i = 0; i < indexCount; i += 3) {
+		const uint32_t indexA = state.indices[i + 0];
+		const uint32_t indexB = state.indices[i + 1];
+		const uint32_t indexC = state.indices[i + 2];
 
-						// calculate normal after merging
-						Geometry::Vec3f normalAfter;
-						if(iData[triIndex + 0] == topData.vertex1) {
-							normalAfter = calcNormal(topData.optPos.data(), 
-													 vertices[iData[triIndex + 1]].data.data(), 
-													 vertices[iData[triIndex + 2]].data.data());
-						} else if(iData[triIndex + 1] == topData.vertex1) {
-							normalAfter = calcNormal(vertices[iData[triIndex + 0]].data.data(), 
-													 topData.optPos.data(), 
-													 vertices[iData[triIndex + 2]].data.data());
-						} else {
-							normalAfter = calcNormal(vertices[iData[triIndex + 0]].data.data(), 
-													 vertices[iData[triIndex + 1]].data.data(), 
-													 topData.optPos.data());
-						}
-						if(normalAfter.isZero()) {
-							normalFlip = true;
-							break;
-						}
+		// calculate plane equation
+		getQuadric(state.getData(indexA), state.getData(indexB), state.getData(indexC), tmpQ);
 
-						// check if normal has flipped
-						if(normalBefore.dot(normalAfter) < maxAngle) {
-							normalFlip = true;
-							break;
-						}
-					}
-				}
-				// checking for vertex2.inIndex
-				for(const auto & triIndex : vertices[topData.vertex2].inIndex) {
-					if(!(iData[triIndex + 0] == topData.vertex1
-						|| iData[triIndex + 1] == topData.vertex1
-						|| iData[triIndex + 2] == topData.vertex1)) {
-						// face will not be deleted
-
-						// calculate normal before merging
-						const auto normalBefore = calcNormal(vertices[iData[triIndex + 0]].data.data(),
-															 vertices[iData[triIndex + 1]].data.data(), 
-															 vertices[iData[triIndex + 2]].data.data());
-						if(normalBefore.isZero()) {
-							normalFlip = true;
-							break;
-						}
+		// add quadric distance matrix to q of vertices spanning this plane
+		state.quadrics[indexA] += tmpQ;
+		state.quadrics[indexB] += tmpQ;
+		state.quadrics[indexC] += tmpQ;
+		progress.increment();
+	}
 
-						// calculate normal after merging
-						Geometry::Vec3f normalAfter;
-						if(iData[triIndex + 0] == topData.vertex2) {
-							normalAfter = calcNormal(topData.optPos.data(), 
-													 vertices[iData[triIndex + 1]].data.data(), 
-													 vertices[iData[triIndex + 2]].data.data());
-						} else if(iData[triIndex + 1] == topData.vertex2) {
-							normalAfter = calcNormal(vertices[iData[triIndex + 0]].data.data(), 
-													 topData.optPos.data(), 
-													 vertices[iData[triIndex + 2]].data.data());
-						} else {
-							normalAfter = calcNormal(vertices[iData[triIndex + 0]].data.data(), 
-													 vertices[iData[triIndex + 1]].data.data(), 
-													 topData.optPos.data());
-						}
-						if(normalAfter.isZero()) {
-							normalFlip = true;
-							break;
-						}
+	std::unique_ptr<Geometry::PointOctree<VertexPoint>> vertexOctree;
+	if(threshold > 0.0f) {
+		float boxMin = std::numeric_limits<float>::max();
+		float boxMax = std::numeric_limits<float>::lowest();
+		for(uint32_t v = 0; v < vertexCount; ++v) {
+			const float * data = state.getData(v);
+			boxMin = std::min(boxMin, std::min(std::min(data[0], data[1]), data[2]));
+			boxMax = std::max(boxMax, std::max(std::max(data[0], data[1]), data[2]));
+		}
+		vertexOctree.reset(new Geometry::PointOctree<VertexPoint>(Geometry::Box(boxMin, boxMax, boxMin, boxMax, boxMin, boxMax), threshold, 100));
+		for(uint32_t v = 0; v < vertexCount; ++v) {
+			vertexOctree->insert(VertexPoint(Geometry::Vec3f(state.getData(v)), v));
+		}
+	}
 
-						// check if normal has flipped
-						if(normalBefore.dot(normalAfter) < maxAngle) {
-							normalFlip = true;
-							break;
-						}
+	// add boundary constraint planes and get non-connected neighbors
+	std::vector<uint32_t> corners;
+	std::vector<std::pair<uint32_t, uint32_t>> singleNeighbors;
+	std::deque<VertexPoint> nonConnectedNeighbors;
+	// planes are only added if the data starts with positions; the size is given explicitly to keep the instances without positions valid
+	std::array<float, (N > 3 ? N : 3)> v1, v2, v3;
+	v1.fill(0.0f);
+	v2.fill(0.0f);
+	v3.fill(0.0f);
+	state.partnerOffsets.assign(threshold > 0.0f ? vertexCount + 1 : 0, 0);
+	for(uint32_t i = 0; i < vertexCount; ++i) {
+		if(addBoundaryPlanes) {
+			// collect the corners of all faces of i; a vertex occurring only once spans exactly one face with i
+			corners.clear();
+			for(uint32_t t = state.triangleOffsets[i]; t < state.triangleOffsets[i + 1]; ++t) {
+				corners.insert(corners.end(), state.indices + state.triangles[t], state.indices + state.triangles[t] + 3);
+			}
+			std::sort(corners.begin(), corners.end());
+			singleNeighbors.clear();
+			for(uint32_t t = state.triangleOffsets[i]; t < state.triangleOffsets[i + 1]; ++t) {
+				for(uint_fast8_t c = 0; c < 3; ++c) {
+					const uint32_t corner = state.indices[state.triangles[t] + c];
+					const auto range = std::equal_range(corners.begin(), corners.end(), corner);
+					// make sure to add a boundary plane only once to both vertices by checking corner<i
+					if(corner < i && std::distance(range.first, range.second) == 1) {
+						singleNeighbors.emplace_back(corner, state.triangles[t]);
 					}
 				}
-				if(normalFlip){
-					flipcount++;
-					normalFlip = false;
-					heap.update(heapHead, DONT_MERGE_COST);
-					continue;
-				}
 			}
-
-			// merge vertex1 and vertex2 into vertex1
-			vertexTrash.push_back(topData.vertex2);
-
-			// update data of vertex1 to data of merged vertex
-			vertices[topData.vertex1].data = topData.optPos;
-
-			// update indexData of vertex2 to vertex1 and inIndex of vertex1
-			for(const auto & triIndex : vertices[topData.vertex2].inIndex) {
-				std::array<uint32_t, 3> vertexIndices;
-				vertexIndices[0] = iData[triIndex + 0];
-				vertexIndices[1] = iData[triIndex + 1];
-				vertexIndices[2] = iData[triIndex + 2];
-				if(vertexIndices[0] == topData.vertex1 || vertexIndices[1] == topData.vertex1 || vertexIndices[2] == topData.vertex1) {
-					// triangle uses vertex1 and vertex2 => no triangle after merging
-					if(indexTrash.insert(triIndex).second) {
-						// face was inserted => was not deleted before
-						for(const auto & vertexIndex : vertexIndices) {
-							if(vertexIndex != topData.vertex2) {
-								vertices[vertexIndex].inIndex.erase(std::remove(vertices[vertexIndex].inIndex.begin(), vertices[vertexIndex].inIndex.end(), triIndex),
-																	vertices[vertexIndex].inIndex.end());
-							}
-						}
-
-						--newTriangleCount;
-						progress.increment();
-					}
-				} else {
-					// only vertex2 is used in this triangle => update vertex2 to vertex1
-					if(vertexIndices[0] == topData.vertex2) {
-						iData[triIndex + 0] = topData.vertex1;
-					}
-					if(vertexIndices[1] == topData.vertex2) {
-						iData[triIndex + 1] = topData.vertex1;
-					}
-					if(vertexIndices[2] == topData.vertex2) {
-						iData[triIndex + 2] = topData.vertex1;
-					}
-
-					vertices[topData.vertex1].inIndex.push_back(triIndex);
-
-					// Make inIndex unique again.
-					make_unique(vertices[topData.vertex1].inIndex);
+			for(const auto & singleNeighbor : singleNeighbors) {
+				// plane normal has to be perpendicular to edge between single neighbors and to normal of face spanned by this edge
+				// => plane has to lie in single neighbor vertices and one of those vertices+planeNormal
+				const uint32_t * tri = state.indices + singleNeighbor.second;
+				const auto normal = calcNormal(state.getData(tri[0]), state.getData(tri[1]), state.getData(tri[2]));
+				const float * dataI = state.getData(i);
+				const float * dataJ = state.getData(singleNeighbor.first);
+				std::copy(dataI, dataI + 3, v1.begin());
+				std::copy(dataJ, dataJ + 3, v2.begin());
+				v3[0] = normal.getX() + dataI[0];
+				v3[1] = normal.getY() + dataI[1];
+				v3[2] = normal.getZ() + dataI[2];
+
+				getQuadric(v1.data(), v2.data(), v3.data(), tmpQ);
+				for(std::size_t j=3; j<N; ++j)
+					tmpQ.A[Quadric<N>::calcIndex(j, j)] = 0.0f;
+
+				// add boundary constraint plane to both vertices that are single neighbors
+				state.quadrics[i] += tmpQ;
+				state.quadrics[singleNeighbor.first] += tmpQ;
+			}
+		}
+		if(vertexOctree) {
+			// add non connected vertices to neighbors
+			nonConnectedNeighbors.clear();
+			vertexOctree->collectPointsWithinSphere(Geometry::Sphere_f(Geometry::Vec3f(state.getData(i)), threshold), nonConnectedNeighbors);
+			for(const auto & nonConnectedNeighbor : nonConnectedNeighbors) {
+				if(nonConnectedNeighbor.data != i) {
+					state.partners.push_back(nonConnectedNeighbor.data);
 				}
 			}
+			state.partnerOffsets[i + 1] = static_cast<uint32_t>(state.partners.size());
+		}
+		progress.increment();
+	}
+}
 
-			// update heap by replacing vertex2 by vertex1
-			for(auto & elem : vertices[topData.vertex2].inHeap) {
-				// update heapHead->vertex2 in heapElement to heapHead->vertex1 and make sure that heapElements are unique
-				if(elem->data.vertex1==topData.vertex2) {
-					// update vertex1 of heapElement
-					if(vertices[topData.vertex1].neighbors.insert(elem->data.vertex2).second) {
-						// new neighbor has been added => update heap normally
-						vertices[elem->data.vertex2].neighbors.insert(topData.vertex1);
-						vertices[topData.vertex1].inHeap.insert(elem);
-						elem->data.vertex1 = topData.vertex1;
-					} else {
-						// neighbors already existed => delete this heapElement so preserve uniqueness
-						heapTrash.insert(elem);
-					}
-				}else{
-					// update vertex2 of heapElement
-					if(vertices[topData.vertex1].neighbors.insert(elem->data.vertex1).second) {
-						// new neighbor has been added => update heap normally
-						vertices[elem->data.vertex1].neighbors.insert(topData.vertex1);
-						vertices[topData.vertex1].inHeap.insert(elem);
-						elem->data.vertex2 = topData.vertex1;
-					} else {
-						// neighbors already existed => delete this heapElement so preserve uniqueness
-						heapTrash.insert(elem);
-					}
+/**
+ * Merge vertex pairs until the given number of triangles is reached or no pair can be merged any more.
+ * With more than one thread, the vertices are partitioned into one cluster per thread first.
+ * The clusters are simplified concurrently, while the vertices at their borders are locked.
+ * Afterwards, the pairs at the borders are merged.
+ *
+ * @param triangleCount Current number of triangles
+ * @param removedVertices (out) The merged vertices are appended in an order in which they can be merged sequentially.
+ * @param flipcount (out) The number of merges rejected because of flipping triangles is added.
+ * @return Number of remaining triangles
+ */
+template<std::size_t N>
+static uint32_t collapseEdges(MeshState<N> & state, uint32_t triangleCount, uint32_t newNumberOfTriangles, const CollapseOptions & options,
+							  uint32_t threadCount, Util::ProgressIndicator & progress, std::vector<uint32_t> & removedVertices, int & flipcount) {
+	const uint32_t vertexCount = static_cast<uint32_t>(state.parent.size());
+	std::mutex progressMutex;
+	uint32_t newTriangleCount = triangleCount;
+	std::vector<uint8_t> locked(vertexCount, 0);
+
+	std::vector<uint32_t> remainingVertices;
+	for(uint32_t i = 0; i < vertexCount; ++i) {
+		if(!state.isRemoved(i)) {
+			remainingVertices.push_back(i);
+		}
+	}
+	const uint32_t clusterCount = std::min(getWorkerCount(threadCount), static_cast<uint32_t>(remainingVertices.size()) / 2);
+	if(clusterCount > 1) {
+		// partition the vertices into one cluster per worker
+		std::vector<uint32_t> clusterOfVertex(vertexCount, 0);
+		partitionVertices(state, remainingVertices.begin(), remainingVertices.end(), 0, clusterCount, clusterOfVertex);
+		std::sort(remainingVertices.begin(), remainingVertices.end());
+
+		// lock the border: vertices with a neighbor in another cluster are not touched while simplifying the clusters
+		std::vector<std::vector<uint32_t>> clusterVertices(clusterCount);
+		std::vector<uint32_t> neighbors;
+		for(const auto & i : remainingVertices) {
+			const uint32_t cluster = clusterOfVertex[i];
+			state.collectNeighbors(i, neighbors);
+			for(const auto & neighbor : neighbors) {
+				if(clusterOfVertex[neighbor] != cluster) {
+					locked[i] = 1;
+					break;
 				}
 			}
+			clusterVertices[cluster].push_back(i);
+		}
 
-			// update matrix q=(vertex1.q+vertex2.q) of vertex1
-			vertices[topData.vertex1].q += vertices[topData.vertex2].q;
-
-			// update cost of merge with other neighbors
-			for(auto & elem : vertices[topData.vertex1].inHeap) {
-				// only update heapElement if it will not be deleted
-				if(heapTrash.count(elem) == 0) {
-					float cost = getOptimalPosition(vertices[elem->data.vertex1], vertices[elem->data.vertex2], elem->data.optPos, numDataEntries, useOptimalPositioning);
-					heap.update(elem, cost);
+		// each cluster removes its share of the triangles lying completely inside of it
+		std::vector<uint32_t> clusterTriangleCount(clusterCount, 0);
+		for(uint32_t i = 0; i < 3 * state.triangleRemoved.size(); i += 3) {
+			const uint32_t cluster = clusterOfVertex[state.indices[i]];
+			if(!state.triangleRemoved[i / 3] && clusterOfVertex[state.indices[i + 1]] == cluster && clusterOfVertex[state.indices[i + 2]] == cluster) {
+				++clusterTriangleCount[cluster];
+			}
+		}
+		const uint64_t trianglesToRemove = newTriangleCount - newNumberOfTriangles;
+
+		std::vector<uint32_t> clusterRemoved(clusterCount, 0);
+		std::vector<int> clusterFlips(clusterCount, 0);
+		std::vector<std::vector<uint32_t>> clusterRemovedVertices(clusterCount);
+		parallelFor(clusterCount, 0, clusterCount, [&](uint32_t, uint32_t clusterBegin, uint32_t clusterEnd) {
+			for(uint32_t cluster = clusterBegin; cluster < clusterEnd; ++cluster) {
+				EdgeCollapse<N> collapse(state, &locked, options, progress, &progressMutex);
+				for(const auto & i : clusterVertices[cluster]) {
+					// add unique neighbors to heap (by adding only pairs of (i,j) where i<j)
+					collapse.addPairsOf(i, [i](uint32_t j) { return i < j; });
+					collapse.incrementProgress();
 				}
+				clusterRemoved[cluster] = collapse.run(static_cast<uint32_t>(trianglesToRemove * clusterTriangleCount[cluster] / triangleCount));
+				clusterFlips[cluster] = collapse.flipCount;
+				clusterRemovedVertices[cluster] = std::move(collapse.removedVertices);
 			}
+		});
+		for(uint32_t cluster = 0; cluster < clusterCount; ++cluster) {
+			newTriangleCount -= clusterRemoved[cluster];
+			flipcount += clusterFlips[cluster];
+			// the clusters are independent => their merges can be concatenated
+			removedVertices.insert(removedVertices.end(), clusterRemovedVertices[cluster].begin(), clusterRemovedVertices[cluster].end());
+		}
+		Util::info<<"Simplified "<<clusterCount<<" clusters in parallel; "<<newTriangleCount<<" triangles left for the border pass.\n";
+	}
+
+	// build heap; after simplifying the clusters, only pairs at the border are added.
+	EdgeCollapse<N> collapse(state, nullptr, options, progress, nullptr);
+	for(const auto & i : remainingVertices) {
+		if(!state.isRemoved(i)) {
+			// add unique neighbors to heap (by adding only pairs of (i,j) where i<j)
+			collapse.addPairsOf(i, [i, clusterCount, &locked](uint32_t j) { return i < j && (clusterCount <= 1 || locked[i] || locked[j]); });
+		}
+		if(clusterCount <= 1) {
+			collapse.incrementProgress();
+		}
+	}
 
-			// delete heapElements in heapTrash (this is including heapHead)
-			for(auto & elem : heapTrash) {
-				vertices[elem->data.vertex1].inHeap.erase(elem);
-				vertices[elem->data.vertex2].inHeap.erase(elem);
-				heap.erase(elem);
+	// merge vertices
+	if(newTriangleCount > newNumberOfTriangles) {
+		newTriangleCount -= collapse.run(newTriangleCount - newNumberOfTriangles);
+	}
+	if(clusterCount > 1 && newTriangleCount > newNumberOfTriangles) {
+		// the clusters could not reach their targets => continue with all remaining pairs
+		for(const auto & i : remainingVertices) {
+			if(!state.isRemoved(i)) {
+				collapse.addPairsOf(i, [i](uint32_t j) { return i < j; });
 			}
 		}
+		newTriangleCount -= collapse.run(newTriangleCount - newNumberOfTriangles);
 	}
+	flipcount += collapse.flipCount;
+	removedVertices.insert(removedVertices.end(), collapse.removedVertices.begin(), collapse.removedVertices.end());
 
-	if(heap.size()!=0 && heap.top()->getCost()==DONT_MERGE_COST){
+	if(newTriangleCount > newNumberOfTriangles){
 		WARN("Could not merge any more due to constraints.");
 	}
+	return newTriangleCount;
+}
 
+/**
+ * Create a new mesh from the remaining vertices and triangles.
+ *
+ * @param iData index data referenced by the state
+ */
+template<std::size_t N>
+static Mesh * createSimplifiedMesh(Mesh * mesh, const MeshState<N> & state, const MeshIndexData & iData, uint32_t triangleCount, const weights_t & weights) {
 	// write vertex data
 	MeshVertexData vertexData = mesh->openVertexData();
 	{
-		// there should be no duplicates, but the function sorts the array
-		// sorted array is needed for binary_search below
-		make_unique(vertexTrash);
-
-		Util::Reference<PositionAttributeAccessor> positionAccessor;
-		if(weights[VERTEX_OFFSET] > 0) {
-			try {
-				positionAccessor = PositionAttributeAccessor::create(vertexData, VertexAttributeIds::POSITION);
-			} catch(...) {
-			}
-		}
-		Util::Reference<NormalAttributeAccessor> normalAccessor;
-		if(weights[NORMAL_OFFSET] > 0) {
-			try {
-				normalAccessor = NormalAttributeAccessor::create(vertexData, VertexAttributeIds::NORMAL);
-			} catch(...) {
-			}
-		}
-		Util::Reference<ColorAttributeAccessor> colorAccessor;
-		if(weights[COLOR_OFFSET] > 0) {
-			try {
-				colorAccessor = ColorAttributeAccessor::create(vertexData, VertexAttributeIds::COLOR);
-			} catch(...) {
-			}
-		}
-		Util::Reference<TexCoordAttributeAccessor> texCoordAccessor;
-		if(weights[TEX0_OFFSET] > 0) {
-			try {
-				texCoordAccessor = TexCoordAttributeAccessor::create(vertexData, VertexAttributeIds::TEXCOORD0);
-			} catch(...) {
-			}
-		}
-
-		for(unsigned int v = 0; v < vertexCount; ++v) {
-			const bool vertexDeleted = std::binary_search(vertexTrash.begin(), vertexTrash.end(), v);
-			if(vertexDeleted) {
-				// skip vertex
-				continue;
-			}
-			auto dataIt = vertices[v].data.cbegin();
-
-			if(positionAccessor.isNotNull()) {
-				Geometry::Vec3f position;
-				position.setX(*dataIt++);
-				position.setY(*dataIt++);
-				position.setZ(*dataIt++);
-				positionAccessor->setPosition(v, position / weights[VERTEX_OFFSET]);
-			}
-			if(normalAccessor.isNotNull()) {
-				Geometry::Vec3f normal;
-				normal.setX(*dataIt++);
-				normal.setY(*dataIt++);
-				normal.setZ(*dataIt++);
-				const auto length = normal.length();
-				if(length > 1.0e-6f) {
-					normal /= length;
-				}
-				normalAccessor->setNormal(v, normal);
-			}
-			if(colorAccessor.isNotNull()) {
-				Util::Color4f color;
-				color.setR(*dataIt++);
-				color.setG(*dataIt++);
-				color.setB(*dataIt++);
-				color.setA(*dataIt++);
-				colorAccessor->setColor(v, color / weights[COLOR_OFFSET]);
-			}
-			if(texCoordAccessor.isNotNull()) {
-				Geometry::Vec2f coordinate;
-				coordinate.setX(*dataIt++);
-				coordinate.setY(*dataIt++);
-				texCoordAccessor->setCoordinate(v, coordinate / weights[TEX0_OFFSET]);
+		const AttributeData newAttributes(vertexData, weights);
+		for(uint32_t v = 0; v < vertexData.getVertexCount(); ++v) {
+			if(!state.isRemoved(v)) {
+				newAttributes.write(v, state.getData(v));
 			}
 		}
 	}
 
-	// copy indices to newMesh deleting/skipping indexTrash
+	// copy indices to newMesh deleting/skipping removed triangles
 	MeshIndexData indexData;
 	{
-		uint32_t newIndexCount = mesh->getIndexCount() - indexTrash.size() * 3;
-		indexData.allocate(newIndexCount);
+		indexData.allocate(triangleCount * 3);
 
 		uint32_t * indexPointer = indexData.data();
-		for(unsigned int i = 0; i < iData.getIndexCount(); i += 3) {
-			const bool indexDeleted = (indexTrash.count(i) > 0);
-			if(!indexDeleted) {
+		for(uint32_t i = 0; i < iData.getIndexCount(); i += 3) {
+			if(!state.triangleRemoved[i / 3]) {
 				// copy index
 				std::copy(iData.data() + i, iData.data() + i + 3, indexPointer);
 				indexPointer += 3;
@@ -1004,11 +1059,239 @@ Mesh * simplifyMesh(Mesh * mesh, uint32_t newNumberOfTriangles, float threshold,
 	Mesh * returnMesh = MeshUtils::eliminateUnusedVertices(newMesh.get());
 
 	newMesh = nullptr;
+	return returnMesh;
+}
+
+//! Order of the merges of a simplification run.
+struct MergeRecord {
+	//! Vertices in the order they have been merged into another vertex
+	std::vector<uint32_t> removedVertices;
+	//! Vertex a vertex has been merged into; the vertex itself if it has not been removed
+	std::vector<uint32_t> parent;
+	//! Per triangle: the vertex whose removal removed the triangle, or INVALID_INDEX
+	std::vector<uint32_t> triangleRemovedBy;
+};
+
+/**
+ * Simplify the mesh using data with N entries per vertex.
+ *
+ * @param triangleCounts Decreasing numbers of triangles
+ * @param levels (out) If not nullptr, a new mesh is appended for each triangle count.
+ * @param record (out) If not nullptr, the merges are recorded here.
+ * @return Number of merges rejected because of flipping triangles
+ */
+template<std::size_t N>
+static int simplifyLevels(Mesh * mesh, const AttributeData & attributes, const std::vector<uint32_t> & triangleCounts, float threshold,
+						   const CollapseOptions & options, const weights_t & weights, uint32_t threadCount, Util::ProgressIndicator & progress,
+						   std::vector<Mesh *> * levels, MergeRecord * record) {
+	MeshIndexData iData = mesh->openIndexData();
+
+	MeshState<N> state;
+	initMeshState(state, attributes, iData, mesh->getVertexCount(), threshold, attributes.hasPositions() && weights[BOUNDARY_OFFSET] != 0, progress);
+	if(record != nullptr) {
+		state.triangleRemovedBy.assign(state.triangleRemoved.size(), INVALID_INDEX);
+	}
+
+	std::vector<uint32_t> removedVertices;
+	int flipcount = 0;
+	uint32_t triangleCount = mesh->getPrimitiveCount();
+	for(const auto & newNumberOfTriangles : triangleCounts) {
+		if(triangleCount > newNumberOfTriangles) {
+			triangleCount = collapseEdges(state, triangleCount, newNumberOfTriangles, options, threadCount, progress, removedVertices, flipcount);
+		}
+		if(levels != nullptr) {
+			levels->push_back(createSimplifiedMesh(mesh, state, iData, triangleCount, weights));
+		}
+	}
+	if(record != nullptr) {
+		record->removedVertices = std::move(removedVertices);
+		record->parent = std::move(state.parent);
+		record->triangleRemovedBy = std::move(state.triangleRemovedBy);
+	}
+	return flipcount;
+}
+
+/**
+ * Check the parameters, select the storage with fixed-size quadrics for the number of data entries and simplify the mesh.
+ *
+ * @return @c false if the simplification failed.
+ */
+static bool simplify(Mesh * mesh, const std::vector<uint32_t> & triangleCounts, float threshold, const CollapseOptions & collapseOptions,
+					 const weights_t & weights, uint32_t threadCount, std::vector<Mesh *> * levels, MergeRecord * record) {
+	if(mesh->getDrawMode() != Mesh::DRAW_TRIANGLES) {
+		WARN("Mesh simplification can only be done with triangle meshes.");
+		return false;
+	}
+	if(triangleCounts.empty() || !std::is_sorted(triangleCounts.rbegin(), triangleCounts.rend())) {
+		WARN("The requested numbers of triangles have to be given in decreasing order.");
+		return false;
+	}
+	const uint32_t newNumberOfTriangles = std::min(triangleCounts.back(), mesh->getPrimitiveCount());
+	Util::info<<"\nSimplifying mesh from "<<mesh->getPrimitiveCount()<<" to "<<newNumberOfTriangles<<" triangles; threshold: "<<threshold<<"; optPos: "<<collapseOptions.useOptimalPositioning<<"\n";
+	Util::info<<"Weights are: vertex="<<weights[0]<<" normal="<<weights[1]<<" color="<<weights[2]<<" tex0="<<weights[3]<<" boundary="<<weights[4]<<"\n";
+	Util::ProgressIndicator progress("Simplify progress",(mesh->getPrimitiveCount()-newNumberOfTriangles)+mesh->getPrimitiveCount()+3*mesh->getVertexCount(), 2);
+	Util::Timer timer;
+	timer.reset();
+
+	const AttributeData attributes(mesh->openVertexData(), weights);
+	threshold = attributes.hasPositions() ? threshold * weights[VERTEX_OFFSET] : 0.0f;
+	CollapseOptions options(collapseOptions);
+	options.checkNormals = attributes.hasPositions();
+
+	int flipcount;
+	switch(attributes.getDimension()) {
+		case 2:		flipcount = simplifyLevels<2>(mesh, attributes, triangleCounts, threshold, options, weights, threadCount, progress, levels, record);	break;
+		case 3:		flipcount = simplifyLevels<3>(mesh, attributes, triangleCounts, threshold, options, weights, threadCount, progress, levels, record);	break;
+		case 4:		flipcount = simplifyLevels<4>(mesh, attributes, triangleCounts, threshold, options, weights, threadCount, progress, levels, record);	break;
+		case 5:		flipcount = simplifyLevels<5>(mesh, attributes, triangleCounts, threshold, options, weights, threadCount, progress, levels, record);	break;
+		case 6:		flipcount = simplifyLevels<6>(mesh, attributes, triangleCounts, threshold, options, weights, threadCount, progress, levels, record);	break;
+		case 7:		flipcount = simplifyLevels<7>(mesh, attributes, triangleCounts, threshold, options, weights, threadCount, progress, levels, record);	break;
+		case 8:		flipcount = simplifyLevels<8>(mesh, attributes, triangleCounts, threshold, options, weights, threadCount, progress, levels, record);	break;
+		case 9:		flipcount = simplifyLevels<9>(mesh, attributes, triangleCounts, threshold, options, weights, threadCount, progress, levels, record);	break;
+		case 10:	flipcount = simplifyLevels<10>(mesh, attributes, triangleCounts, threshold, options, weights, threadCount, progress, levels, record);	break;
+		case 12:	flipcount = simplifyLevels<12>(mesh, attributes, triangleCounts, threshold, options, weights, threadCount, progress, levels, record);	break;
+		default:
+			WARN("Vertex data does not contain readable information, or weights prevent the data usage.");
+			return false;
+	}
 
 	timer.stop();
 	std::cout<<"time needed[ms]: "<< timer.getMilliseconds() <<"; "<<flipcount<<" flips\n";
+	return true;
+}
 
-	return returnMesh;
+Mesh * simplifyMesh(Mesh * mesh, uint32_t newNumberOfTriangles, float threshold, bool useOptimalPositioning, float maxAngle, const weights_t & weights, uint32_t threadCount) {
+	if(mesh->getPrimitiveCount() <= newNumberOfTriangles) {
+		WARN("Mesh already has less or equal as many triangles as requested.");
+		return mesh;
+	}
+	const CollapseOptions options{useOptimalPositioning, false, true, maxAngle};
+	std::vector<Mesh *> levels;
+	if(!simplify(mesh, std::vector<uint32_t>(1, newNumberOfTriangles), threshold, options, weights, threadCount, &levels, nullptr)) {
+		return mesh;
+	}
+	return levels.front();
+}
+
+std::vector<Util::Reference<Mesh>> createLODChain(Mesh * mesh, const std::vector<uint32_t> & triangleCounts, float threshold, bool useOptimalPositioning,
+												  float maxAngle, const weights_t & weights, uint32_t threadCount) {
+	const CollapseOptions options{useOptimalPositioning, false, true, maxAngle};
+	std::vector<Mesh *> levels;
+	simplify(mesh, triangleCounts, threshold, options, weights, threadCount, &levels, nullptr);
+	return std::vector<Util::Reference<Mesh>>(levels.begin(), levels.end());
+}
+
+// -----------------------------------------------------------------------------
+
+Util::Reference<ProgressiveMesh> ProgressiveMesh::create(Mesh * mesh, uint32_t minTriangleCount, float threshold, float maxAngle,
+														 const weights_t & weights, uint32_t threadCount) {
+	const CollapseOptions options{false, true, true, maxAngle};
+	MergeRecord record;
+	if(!simplify(mesh, std::vector<uint32_t>(1, minTriangleCount), threshold, options, weights, threadCount, nullptr, &record)) {
+		return nullptr;
+	}
+	const uint32_t vertexCount = mesh->getVertexCount();
+	const uint32_t triangleCount = mesh->getPrimitiveCount();
+	const uint32_t removedCount = static_cast<uint32_t>(record.removedVertices.size());
+	Util::Reference<ProgressiveMesh> progressiveMesh = new ProgressiveMesh;
+	progressiveMesh->baseVertexCount = vertexCount - removedCount;
+
+	// vertices: the remaining vertices in their original order, followed by the removed vertices in reverse order of their removal
+	std::vector<uint32_t> newIndexOfVertex(vertexCount, INVALID_INDEX);
+	std::vector<uint32_t> removalOfVertex(vertexCount, INVALID_INDEX);
+	for(uint32_t k = 0; k < removedCount; ++k) {
+		newIndexOfVertex[record.removedVertices[k]] = vertexCount - 1 - k;
+		removalOfVertex[record.removedVertices[k]] = k;
+	}
+	std::vector<uint32_t> oldIndexOfVertex(vertexCount);
+	for(uint32_t v = 0, next = 0; v < vertexCount; ++v) {
+		if(newIndexOfVertex[v] == INVALID_INDEX) {
+			newIndexOfVertex[v] = next++;
+		}
+		oldIndexOfVertex[newIndexOfVertex[v]] = v;
+	}
+	progressiveMesh->collapseMap.resize(vertexCount);
+	for(uint32_t v = 0; v < vertexCount; ++v) {
+		progressiveMesh->collapseMap[newIndexOfVertex[v]] = newIndexOfVertex[record.parent[v]];
+	}
+
+	// triangles: the remaining triangles, followed by the removed triangles in reverse order of their removal
+	std::vector<uint32_t> triangleOrder(triangleCount);
+	std::iota(triangleOrder.begin(), triangleOrder.end(), 0);
+	const auto getRemoval = [&](uint32_t triangle) {
+		return record.triangleRemovedBy[triangle] == INVALID_INDEX ? removedCount : removalOfVertex[record.triangleRemovedBy[triangle]];
+	};
+	std::stable_sort(triangleOrder.begin(), triangleOrder.end(), [&](uint32_t a, uint32_t b) {
+		return getRemoval(a) > getRemoval(b);
+	});
+	// triangleCounts[i]: number of triangles with baseVertexCount + i vertices, i.e. after undoing the last i removals
+	progressiveMesh->triangleCounts.assign(removedCount + 1, 0);
+	for(uint32_t t = 0; t < triangleCount; ++t) {
+		++progressiveMesh->triangleCounts[removedCount - getRemoval(t)];
+	}
+	std::partial_sum(progressiveMesh->triangleCounts.begin(), progressiveMesh->triangleCounts.end(), progressiveMesh->triangleCounts.begin());
+
+	const VertexDescription & desc = mesh->getVertexDescription();
+	progressiveMesh->mesh = new Mesh(desc, vertexCount, triangleCount * 3);
+	{
+		const MeshIndexData & oldIndexData = mesh->openIndexData();
+		MeshIndexData & newIndexData = progressiveMesh->mesh->openIndexData();
+		uint32_t * newIndex = newIndexData.data();
+		for(const auto & t : triangleOrder) {
+			for(uint_fast8_t c = 0; c < 3; ++c) {
+				*newIndex++ = newIndexOfVertex[oldIndexData[3 * t + c]];
+			}
+		}
+		newIndexData.updateIndexRange();
+
+		const MeshVertexData & oldVertexData = mesh->openVertexData();
+		MeshVertexData & newVertexData = progressiveMesh->mesh->openVertexData();
+		for(uint32_t v = 0; v < vertexCount; ++v) {
+			copyVertexRange(oldVertexData, oldIndexOfVertex[v], newVertexData, v, 1);
+		}
+		newVertexData.updateBoundingBox();
+	}
+	return progressiveMesh;
+}
+
+ProgressiveMesh::~ProgressiveMesh() = default;
+
+uint32_t ProgressiveMesh::getVertexCountForTriangles(uint32_t triangleCount) const {
+	// the largest vertex count whose level does not exceed the number of triangles
+	const auto it = std::upper_bound(triangleCounts.begin(), triangleCounts.end(), triangleCount);
+	return baseVertexCount + static_cast<uint32_t>(std::max<std::ptrdiff_t>(0, std::distance(triangleCounts.begin(), it) - 1));
+}
+
+uint32_t ProgressiveMesh::getIndices(uint32_t vertexCount, uint32_t * indices) const {
+	vertexCount = std::max(baseVertexCount, std::min(vertexCount, getMaxVertexCount()));
+	const uint32_t triangleCount = getTriangleCount(vertexCount);
+	const MeshIndexData & iData = mesh->openIndexData();
+	for(uint32_t i = 0; i < 3 * triangleCount; ++i) {
+		uint32_t index = iData[i];
+		while(index >= vertexCount) {
+			index = collapseMap[index];
+		}
+		indices[i] = index;
+	}
+	return triangleCount;
+}
+
+Mesh * ProgressiveMesh::createMesh(uint32_t triangleCount) const {
+	const uint32_t vertexCount = getVertexCountForTriangles(triangleCount);
+	auto newMesh = new Mesh(mesh->getVertexDescription(), vertexCount, 3 * getTriangleCount(vertexCount));
+	MeshIndexData & newIndexData = newMesh->openIndexData();
+	getIndices(vertexCount, newIndexData.data());
+	newIndexData.updateIndexRange();
+
+	const MeshVertexData & oldVertexData = mesh->openVertexData();
+	MeshVertexData & newVertexData = newMesh->openVertexData();
+	copyVertexRange(oldVertexData, 0, newVertexData, 0, vertexCount);
+	newVertexData.updateBoundingBox();
+	return newMesh;
+}
+
+size_t ProgressiveMesh::getMemoryUsage() const {
+	return mesh->getMainMemoryUsage() + (collapseMap.capacity() + triangleCounts.capacity()) * sizeof(uint32_t);
 }
 
 }
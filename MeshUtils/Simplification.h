@@ -11,8 +11,13 @@
 #ifndef RENDERING_MESHUTILS_SIMPLIFICATION_H
 #define RENDERING_MESHUTILS_SIMPLIFICATION_H
 
+#include <Util/ReferenceCounter.h>
+#include <Util/References.h>
+
 #include <array>
+#include <cstddef>
 #include <cstdint>
+#include <vector>
 
 namespace Rendering {
 class Mesh;
@@ -38,6 +43,10 @@ static const int BOUNDARY_OFFSET = 4;
  * @param useOptimalPositioning enables/disables calculation of optimal positioning for vertices
  * @param maxAngle maximum angle a face may rotate per merge step (value is arccos of angle [-1, 1])
  * @param weights weights for all attributes using indices defined above
+ * @param threadCount Number of threads used. A value of zero uses all hardware threads.
+ *        With more than one thread, the mesh is partitioned spatially into one cluster per thread.
+ *        The clusters are simplified concurrently while the vertices at their borders are locked,
+ *        then a final pass over the border simplifies the mesh to the requested number of triangles.
  * @return new simplified mesh, null if simplification failed
  * @author Jonas Knoll, Benjamin Eikel
  */
@@ -46,7 +55,88 @@ Mesh * simplifyMesh(Mesh * mesh,
 					float threshold, 
 					bool useOptimalPositioning, 
 					float maxAngle, 
-					const weights_t & weights);
+					const weights_t & weights,
+					uint32_t threadCount = 1);
+
+/**
+ * Simplify the given mesh to each of the given numbers of triangles
+ * in a single run: The simplification continues from one level to the
+ * next, so the levels are consistent and the mesh has to be analyzed only
+ * once. The original mesh is left unchanged.
+ *
+ * @param triangleCounts numbers of triangles in decreasing order (e.g. 50%, 25%, 12.5%, ... of the original number)
+ * @see simplifyMesh for the remaining parameters
+ * @return new simplified mesh for each number of triangles, empty if simplification failed
+ */
+std::vector<Util::Reference<Mesh>> createLODChain(Mesh * mesh,
+												  const std::vector<uint32_t> & triangleCounts,
+												  float threshold,
+												  bool useOptimalPositioning,
+												  float maxAngle,
+												  const weights_t & weights,
+												  uint32_t threadCount = 1);
+
+/**
+ * Progressive mesh: Vertex and index data ordered in a way that any number
+ * of vertices between the base and the original mesh can be selected.
+ * The vertices are merged by half-edge collapses, so the vertex data of
+ * the original mesh is kept and shared by all levels of detail.
+ *
+ * The vertices are ordered by the merge steps in reverse: The vertices of
+ * the base mesh come first, the vertex removed by the last merge follows.
+ * A mesh with @a n vertices consists of the first getTriangleCount(n)
+ * triangles, where every index @a i >= @a n is replaced by following the
+ * collapse map (i = collapseMap[i]) until it is less than @a n. Adding a
+ * vertex therefore is a vertex split that can be streamed to a client.
+ */
+class ProgressiveMesh : public Util::ReferenceCounter<ProgressiveMesh> {
+	public:
+		/*! (static factory)
+			Record the merges of a simplification of the given mesh down to @a minTriangleCount triangles.
+			@see simplifyMesh for the remaining parameters
+			@return the progressive mesh, null if simplification failed */
+		static Util::Reference<ProgressiveMesh> create(Mesh * mesh,
+													   uint32_t minTriangleCount,
+													   float threshold,
+													   float maxAngle,
+													   const weights_t & weights,
+													   uint32_t threadCount = 1);
+		~ProgressiveMesh();
+
+		//! Mesh with all vertices and triangles in progressive order.
+		Mesh * getMesh() const									{	return mesh.get();	}
+		uint32_t getBaseVertexCount() const						{	return baseVertexCount;	}
+		uint32_t getMaxVertexCount() const						{	return static_cast<uint32_t>(collapseMap.size());	}
+		//! The vertex each vertex is merged into; the vertex itself for the vertices of the base mesh.
+		const std::vector<uint32_t> & getCollapseMap() const	{	return collapseMap;	}
+		//! Number of triangles of the mesh with the given number of vertices (in [getBaseVertexCount(), getMaxVertexCount()]).
+		uint32_t getTriangleCount(uint32_t vertexCount) const	{	return triangleCounts[vertexCount - baseVertexCount];	}
+		//! Largest number of vertices whose mesh has at most the given number of triangles (at least getBaseVertexCount()).
+		uint32_t getVertexCountForTriangles(uint32_t triangleCount) const;
+
+		/**
+		 * Write the indices of the mesh with the given number of vertices.
+		 *
+		 * @param indices (out) space for at least 3 * getTriangleCount(vertexCount) indices
+		 * @return number of triangles written
+		 */
+		uint32_t getIndices(uint32_t vertexCount, uint32_t * indices) const;
+
+		//! Create a new mesh with at most the given number of triangles.
+		Mesh * createMesh(uint32_t triangleCount) const;
+
+		//! Return the amount of main memory occupied by the progressive mesh in bytes.
+		size_t getMemoryUsage() const;
+
+	private:
+		Util::Reference<Mesh> mesh;
+		uint32_t baseVertexCount;
+		std::vector<uint32_t> collapseMap;
+		//! Per number of vertices above baseVertexCount: number of triangles
+		std::vector<uint32_t> triangleCounts;
+
+		ProgressiveMesh() : ReferenceCounter_t(), baseVertexCount(0) {}
+};
 
 }
 }
@@ -0,0 +1,330 @@
+/*
+	This file is part of the Rendering library.
+	Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+	This library is subject to the terms of the Mozilla Public License, v. 2.0.
+	You should have received a copy of the MPL along with this library; see the
+	file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#include "TriangleBVH.h"
+#include "ParallelFor.h"
+#include "../Mesh/Mesh.h"
+#include "../Mesh/MeshIndexData.h"
+#include "../Mesh/MeshVertexData.h"
+#include "../Mesh/VertexAttributeAccessors.h"
+#include "../Mesh/VertexAttributeIds.h"
+
+#include <Geometry/Line.h>
+#include <Geometry/Vec3.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace Rendering {
+namespace MeshUtils {
+
+//! Maximal number of triangles in a leaf.
+static const uint32_t MAX_LEAF_SIZE = 4;
+//! Number of bins used for evaluating the surface area heuristic.
+static const uint32_t BIN_COUNT = 16;
+//! Below this depth, nodes are split at the median to bound the traversal stack.
+static const uint32_t MAX_SAH_DEPTH = 64;
+//! Size of the traversal stack; sufficient for MAX_SAH_DEPTH + 32 median splits.
+static const uint32_t STACK_SIZE = 128;
+
+struct TriangleBVH::BuildTriangle {
+	float min[3];
+	float max[3];
+	float center[3];
+	uint32_t id;
+};
+
+//! Bounding box used during construction.
+struct BuildBox {
+	float min[3];
+	float max[3];
+
+	BuildBox() {
+		std::fill(min, min + 3, std::numeric_limits<float>::max());
+		std::fill(max, max + 3, -std::numeric_limits<float>::max());
+	}
+	void include(const float * pMin, const float * pMax) {
+		for(uint_fast8_t a = 0; a < 3; ++a) {
+			min[a] = std::min(min[a], pMin[a]);
+			max[a] = std::max(max[a], pMax[a]);
+		}
+	}
+	float getHalfArea() const {
+		const float x = max[0] - min[0], y = max[1] - min[1], z = max[2] - min[2];
+		return (x < 0 || y < 0 || z < 0) ? 0.0f : x * y + y * z + z * x;
+	}
+};
+
+//! (static)
+Util::Reference<TriangleBVH> TriangleBVH::create(Mesh * mesh) {
+	if(mesh->getDrawMode() != Mesh::DRAW_TRIANGLES)
+		throw std::invalid_argument("TriangleBVH: Mesh is not a valid triangle mesh.");
+
+	MeshVertexData & vertices = mesh->openVertexData();
+	auto posAcc = PositionAttributeAccessor::create(vertices, VertexAttributeIds::POSITION);
+	std::vector<Geometry::Vec3> positions(vertices.getVertexCount());
+	for(uint32_t i = 0; i < positions.size(); ++i)
+		positions[i] = posAcc->getPosition(i);
+
+	const bool useIndices = mesh->isUsingIndexData();
+	const MeshIndexData & indices = mesh->openIndexData();
+	const uint32_t triangleCount = useIndices ? indices.getIndexCount() / 3 : vertices.getVertexCount() / 3;
+
+	Util::Reference<TriangleBVH> bvh = new TriangleBVH;
+	bvh->triangles.resize(triangleCount * 9);
+	std::vector<BuildTriangle> buildTriangles(triangleCount);
+	for(uint32_t t = 0; t < triangleCount; ++t) {
+		const Geometry::Vec3 & a = positions[useIndices ? indices[t * 3 + 0] : t * 3 + 0];
+		const Geometry::Vec3 & b = positions[useIndices ? indices[t * 3 + 1] : t * 3 + 1];
+		const Geometry::Vec3 & c = positions[useIndices ? indices[t * 3 + 2] : t * 3 + 2];
+		BuildTriangle & tri = buildTriangles[t];
+		for(uint_fast8_t axis = 0; axis < 3; ++axis) {
+			tri.min[axis] = std::min(a[axis], std::min(b[axis], c[axis]));
+			tri.max[axis] = std::max(a[axis], std::max(b[axis], c[axis]));
+			tri.center[axis] = (tri.min[axis] + tri.max[axis]) * 0.5f;
+			// stored temporarily by id; reordered in build()
+			bvh->triangles[t * 9 + axis] = a[axis];
+			bvh->triangles[t * 9 + 3 + axis] = b[axis] - a[axis];
+			bvh->triangles[t * 9 + 6 + axis] = c[axis] - a[axis];
+		}
+		tri.id = t;
+	}
+	bvh->build(buildTriangles);
+	return bvh;
+}
+
+//! (static)
+Util::Reference<TriangleBVH> TriangleBVH::get(Mesh * mesh) {
+	Util::Reference<TriangleBVH> bvh = mesh->_getTriangleBVH();
+	if(bvh.isNull()) {
+		bvh = create(mesh);
+		mesh->_setTriangleBVH(bvh.get());
+	}
+	return bvh;
+}
+
+void TriangleBVH::build(std::vector<BuildTriangle> & buildTriangles) {
+	nodes.clear();
+	nodes.reserve(2 * (buildTriangles.size() / MAX_LEAF_SIZE + 1));
+	nodes.push_back(Node());
+	buildNode(0, buildTriangles, 0, static_cast<uint32_t>(buildTriangles.size()), 0);
+	nodes.shrink_to_fit();
+
+	// Store the triangles in leaf order.
+	std::vector<float> sorted(triangles.size());
+	triangleIds.resize(buildTriangles.size());
+	for(uint32_t t = 0; t < buildTriangles.size(); ++t) {
+		const uint32_t id = buildTriangles[t].id;
+		std::copy(triangles.begin() + id * 9, triangles.begin() + id * 9 + 9, sorted.begin() + t * 9);
+		triangleIds[t] = id;
+	}
+	triangles.swap(sorted);
+}
+
+void TriangleBVH::buildNode(uint32_t nodeIndex, std::vector<BuildTriangle> & buildTriangles, uint32_t begin, uint32_t end, uint32_t depth) {
+	BuildBox bounds, centerBounds;
+	for(uint32_t t = begin; t < end; ++t) {
+		bounds.include(buildTriangles[t].min, buildTriangles[t].max);
+		centerBounds.include(buildTriangles[t].center, buildTriangles[t].center);
+	}
+	{
+		Node & node = nodes[nodeIndex];
+		std::copy(bounds.min, bounds.min + 3, node.bounds);
+		std::copy(bounds.max, bounds.max + 3, node.bounds + 3);
+		node.offset = begin;
+		node.count = static_cast<uint16_t>(end - begin);
+		node.axis = 0;
+	}
+	const uint32_t count = end - begin;
+	if(count <= MAX_LEAF_SIZE)
+		return;
+
+	// Find the best split using binned surface area heuristic.
+	uint32_t bestAxis = 3;
+	uint32_t bestBin = 0;
+	float bestCost = std::numeric_limits<float>::max();
+	if(depth < MAX_SAH_DEPTH) {
+		for(uint32_t axis = 0; axis < 3; ++axis) {
+			const float extent = centerBounds.max[axis] - centerBounds.min[axis];
+			if(extent <= 0)
+				continue;
+			const float scale = BIN_COUNT / extent;
+			BuildBox binBounds[BIN_COUNT];
+			uint32_t binCounts[BIN_COUNT] = {};
+			for(uint32_t t = begin; t < end; ++t) {
+				const uint32_t bin = std::min(BIN_COUNT - 1, static_cast<uint32_t>((buildTriangles[t].center[axis] - centerBounds.min[axis]) * scale));
+				binBounds[bin].include(buildTriangles[t].min, buildTriangles[t].max);
+				++binCounts[bin];
+			}
+			// Sweep from the right to get the costs of all right parts.
+			float rightCosts[BIN_COUNT];
+			BuildBox right;
+			uint32_t rightCount = 0;
+			for(uint32_t bin = BIN_COUNT - 1; bin > 0; --bin) {
+				right.include(binBounds[bin].min, binBounds[bin].max);
+				rightCount += binCounts[bin];
+				rightCosts[bin] = right.getHalfArea() * rightCount;
+			}
+			BuildBox left;
+			uint32_t leftCount = 0;
+			for(uint32_t bin = 0; bin < BIN_COUNT - 1; ++bin) {
+				left.include(binBounds[bin].min, binBounds[bin].max);
+				leftCount += binCounts[bin];
+				const float cost = left.getHalfArea() * leftCount + rightCosts[bin + 1];
+				if(leftCount > 0 && leftCount < count && cost < bestCost) {
+					bestCost = cost;
+					bestAxis = axis;
+					bestBin = bin;
+				}
+			}
+		}
+	}
+
+	uint32_t middle;
+	if(bestAxis < 3) {
+		// Splitting is not worth it for small nodes.
+		if(count <= std::numeric_limits<uint16_t>::max() && bestCost >= bounds.getHalfArea() * count && count <= 4 * MAX_LEAF_SIZE)
+			return;
+		const float scale = BIN_COUNT / (centerBounds.max[bestAxis] - centerBounds.min[bestAxis]);
+		const float minCenter = centerBounds.min[bestAxis];
+		middle = static_cast<uint32_t>(std::partition(buildTriangles.begin() + begin, buildTriangles.begin() + end,
+			[&](const BuildTriangle & tri) {
+				return std::min(BIN_COUNT - 1, static_cast<uint32_t>((tri.center[bestAxis] - minCenter) * scale)) <= bestBin;
+			}) - buildTriangles.begin());
+	} else {
+		// Median split along the largest extent (all centers are equal, or the tree is too deep).
+		bestAxis = 0;
+		for(uint32_t axis = 1; axis < 3; ++axis) {
+			if(centerBounds.max[axis] - centerBounds.min[axis] > centerBounds.max[bestAxis] - centerBounds.min[bestAxis])
+				bestAxis = axis;
+		}
+		middle = begin + count / 2;
+		std::nth_element(buildTriangles.begin() + begin, buildTriangles.begin() + middle, buildTriangles.begin() + end,
+			[&](const BuildTriangle & a, const BuildTriangle & b) {
+				return a.center[bestAxis] < b.center[bestAxis];
+			});
+	}
+
+	const uint32_t leftIndex = static_cast<uint32_t>(nodes.size());
+	nodes.push_back(Node());
+	buildNode(leftIndex, buildTriangles, begin, middle, depth + 1);
+	const uint32_t rightIndex = static_cast<uint32_t>(nodes.size());
+	nodes.push_back(Node());
+	buildNode(rightIndex, buildTriangles, middle, end, depth + 1);
+
+	Node & node = nodes[nodeIndex];
+	node.offset = rightIndex;
+	node.count = 0;
+	node.axis = static_cast<uint16_t>(bestAxis);
+}
+
+int32_t TriangleBVH::intersect(const float * origin, const float * direction, float & distance) const {
+	if(nodes.empty())
+		return -1;
+	float invDirection[3];
+	uint32_t dirIsNegative[3];
+	for(uint_fast8_t a = 0; a < 3; ++a) {
+		invDirection[a] = 1.0f / direction[a];
+		dirIsNegative[a] = invDirection[a] < 0 ? 1 : 0;
+	}
+
+	int32_t closest = -1;
+	float closestDist = std::numeric_limits<float>::infinity();
+	uint32_t stack[STACK_SIZE];
+	uint32_t stackSize = 0;
+	uint32_t current = 0;
+	while(true) {
+		const Node & node = nodes[current];
+		// Slab test.
+		float tMin = 0.0f;
+		float tMax = closestDist;
+		for(uint_fast8_t a = 0; a < 3; ++a) {
+			const float t0 = (node.bounds[a] - origin[a]) * invDirection[a];
+			const float t1 = (node.bounds[a + 3] - origin[a]) * invDirection[a];
+			tMin = std::max(tMin, std::min(t0, t1));
+			tMax = std::min(tMax, std::max(t0, t1));
+		}
+		if(tMin <= tMax) {
+			if(node.count > 0) {
+				// Möller-Trumbore ray/triangle intersection.
+				for(uint32_t t = node.offset; t < node.offset + node.count; ++t) {
+					const float * a = triangles.data() + t * 9;
+					const float * e1 = a + 3;
+					const float * e2 = a + 6;
+					const float p[3] = {	direction[1] * e2[2] - direction[2] * e2[1],
+											direction[2] * e2[0] - direction[0] * e2[2],
+											direction[0] * e2[1] - direction[1] * e2[0] };
+					const float det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+					if(std::abs(det) < std::numeric_limits<float>::min())
+						continue;
+					const float invDet = 1.0f / det;
+					const float s[3] = { origin[0] - a[0], origin[1] - a[1], origin[2] - a[2] };
+					const float u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) * invDet;
+					if(u < 0 || u > 1)
+						continue;
+					const float q[3] = {	s[1] * e1[2] - s[2] * e1[1],
+											s[2] * e1[0] - s[0] * e1[2],
+											s[0] * e1[1] - s[1] * e1[0] };
+					const float v = (direction[0] * q[0] + direction[1] * q[1] + direction[2] * q[2]) * invDet;
+					if(v < 0 || u + v > 1)
+						continue;
+					const float dist = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) * invDet;
+					const int32_t id = static_cast<int32_t>(triangleIds[t]);
+					// On equal distance, prefer the lower triangle index (like a linear search).
+					if(dist >= 0 && (dist < closestDist || (dist == closestDist && id < closest))) {
+						closestDist = dist;
+						closest = id;
+					}
+				}
+			} else {
+				// Visit the child nearer to the ray's origin first.
+				if(dirIsNegative[node.axis]) {
+					stack[stackSize++] = current + 1;
+					current = node.offset;
+				} else {
+					stack[stackSize++] = node.offset;
+					current = current + 1;
+				}
+				continue;
+			}
+		}
+		if(stackSize == 0)
+			break;
+		current = stack[--stackSize];
+	}
+	distance = closestDist;
+	return closest;
+}
+
+int32_t TriangleBVH::getFirstIntersection(const Geometry::Ray3 & ray, float * distance) const {
+	float dist;
+	const int32_t result = intersect(ray.getOrigin().getVec(), ray.getDirection().getVec(), dist);
+	if(distance != nullptr)
+		*distance = dist;
+	return result;
+}
+
+std::vector<int32_t> TriangleBVH::getFirstIntersections(const std::vector<Geometry::Ray3> & rays, uint32_t threadCount) const {
+	std::vector<int32_t> result(rays.size(), -1);
+	parallelFor(getWorkerCount(threadCount), 0, static_cast<uint32_t>(rays.size()), [&](uint32_t, uint32_t begin, uint32_t end) {
+		float dist;
+		for(uint32_t r = begin; r < end; ++r)
+			result[r] = intersect(rays[r].getOrigin().getVec(), rays[r].getDirection().getVec(), dist);
+	});
+	return result;
+}
+
+size_t TriangleBVH::getMemoryUsage() const {
+	return sizeof(TriangleBVH) + nodes.capacity() * sizeof(Node) + triangles.capacity() * sizeof(float)
+			+ triangleIds.capacity() * sizeof(uint32_t);
+}
+
+}
+}
@@ -0,0 +1,105 @@
+/*
+	This file is part of the Rendering library.
+	Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+	This library is subject to the terms of the Mozilla Public License, v. 2.0.
+	You should have received a copy of the MPL along with this library; see the
+	file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#ifndef RENDERING_MESHUTILS_TRIANGLEBVH_H
+#define RENDERING_MESHUTILS_TRIANGLEBVH_H
+
+#include <Util/ReferenceCounter.h>
+#include <Util/References.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Geometry {
+template<typename _T> class _Vec3;
+typedef _Vec3<float> Vec3;
+template<typename _T> class _Ray;
+typedef _Ray<Vec3> Ray3;
+}
+
+namespace Rendering {
+class Mesh;
+namespace MeshUtils {
+
+/**
+ * Bounding volume hierarchy over the triangles of a mesh for fast ray queries.
+ * The hierarchy is built using the surface area heuristic and is stored as a
+ * flat array of nodes in depth-first order, together with a copy of the
+ * triangle positions. Therefore, it stays valid when the mesh is changed, but
+ * it does not reflect the changes.
+ *
+ * Use get() to get the hierarchy cached at a mesh. The cached hierarchy is
+ * dropped when the mesh's vertex or index data is marked as changed.
+ *
+ * @author Sascha Brandt
+ * @ingroup mesh_accessor
+ */
+class TriangleBVH : public Util::ReferenceCounter<TriangleBVH> {
+	public:
+		/*! (static factory)
+			Build a new hierarchy for the triangles of the given mesh.
+			If the mesh is no triangle mesh, an std::invalid_argument exception is thrown. */
+		static Util::Reference<TriangleBVH> create(Mesh * mesh);
+
+		/*! (static)
+			Return the hierarchy cached at the given mesh.
+			If there is none, or the mesh has been changed since, a new hierarchy is built and cached.
+			If the mesh is no triangle mesh, an std::invalid_argument exception is thrown. */
+		static Util::Reference<TriangleBVH> get(Mesh * mesh);
+
+		/**
+		 * Find the first triangle hit by the given ray.
+		 *
+		 * @param ray the ray
+		 * @param distance (out) if not nullptr, the ray parameter of the intersection is stored here
+		 * @return -1 if no intersecting triangle was found, the triangle index otherwise.
+		 */
+		int32_t getFirstIntersection(const Geometry::Ray3 & ray, float * distance = nullptr) const;
+
+		/**
+		 * Find the first triangle hit by each of the given rays.
+		 *
+		 * @param rays the rays
+		 * @param threadCount Number of threads used. A value of zero uses all hardware threads.
+		 * @return For each ray, -1 if no intersecting triangle was found, the triangle index otherwise.
+		 */
+		std::vector<int32_t> getFirstIntersections(const std::vector<Geometry::Ray3> & rays, uint32_t threadCount = 1) const;
+
+		uint32_t getTriangleCount() const			{	return static_cast<uint32_t>(triangleIds.size());	}
+		uint32_t getNodeCount() const				{	return static_cast<uint32_t>(nodes.size());	}
+
+		//! Return the amount of main memory occupied by the hierarchy in bytes.
+		size_t getMemoryUsage() const;
+
+	private:
+		/*! Node of the hierarchy. The first child of an inner node directly
+			follows the node; the index of the second child is stored in @a offset. */
+		struct Node {
+			float bounds[6]; // minX, minY, minZ, maxX, maxY, maxZ
+			uint32_t offset; // leaf: first triangle; inner node: second child
+			uint16_t count; // leaf: number of triangles; inner node: 0
+			uint16_t axis; // inner node: split axis
+		};
+		std::vector<Node> nodes;
+		//! Per triangle in leaf order: first vertex and the two edges starting there.
+		std::vector<float> triangles;
+		//! Per triangle in leaf order: the index of the triangle in the mesh.
+		std::vector<uint32_t> triangleIds;
+
+		struct BuildTriangle;
+		TriangleBVH() : ReferenceCounter_t() {}
+		void build(std::vector<BuildTriangle> & buildTriangles);
+		void buildNode(uint32_t nodeIndex, std::vector<BuildTriangle> & buildTriangles, uint32_t begin, uint32_t end, uint32_t depth);
+		int32_t intersect(const float * origin, const float * direction, float & distance) const;
+};
+
+}
+}
+
+#endif /* RENDERING_MESHUTILS_TRIANGLEBVH_H */
@@ -0,0 +1,124 @@
+/*
+	This file is part of the Rendering library.
+	Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+	This library is subject to the terms of the Mozilla Public License, v. 2.0.
+	You should have received a copy of the MPL along with this library; see the
+	file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#include "AsyncMeshLoader.h"
+#include "Serialization.h"
+#include "../Mesh/MeshDataStrategy.h"
+#include "../MeshUtils/ParallelFor.h"
+#include <Util/IO/FileName.h>
+#include <exception>
+#include <utility>
+
+namespace Rendering {
+namespace Serialization {
+
+struct AsyncMeshLoader::Request {
+	Util::FileName url;
+	PostProcessing_t postProcessing;
+	Callback_t onCompletion;
+	std::promise<Util::Reference<Mesh>> promise;
+	//! Set by the worker; the worker does not touch the request after handing it over to the completion queue.
+	Util::Reference<Mesh> mesh;
+	std::exception_ptr exception;
+
+	Request(const Util::FileName & _url, PostProcessing_t _postProcessing, Callback_t _onCompletion) :
+			url(_url), postProcessing(std::move(_postProcessing)), onCompletion(std::move(_onCompletion)) {
+	}
+};
+
+AsyncMeshLoader::AsyncMeshLoader(uint32_t workerCount) : activeCount(0), stopped(false) {
+	workerCount = MeshUtils::getWorkerCount(workerCount);
+	workers.reserve(workerCount);
+	for(uint32_t i = 0; i < workerCount; ++i)
+		workers.emplace_back(&AsyncMeshLoader::run, this);
+}
+
+AsyncMeshLoader::~AsyncMeshLoader() {
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopped = true;
+	}
+	requestAvailable.notify_all();
+	for(auto & worker : workers)
+		worker.join();
+}
+
+AsyncMeshLoader::MeshFuture_t AsyncMeshLoader::loadMeshAsync(const Util::FileName & url, PostProcessing_t postProcessing, Callback_t onCompletion) {
+	std::unique_ptr<Request> request(new Request(url, std::move(postProcessing), std::move(onCompletion)));
+	MeshFuture_t future = request->promise.get_future().share();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		queuedRequests.emplace_back(std::move(request));
+	}
+	requestAvailable.notify_one();
+	return future;
+}
+
+void AsyncMeshLoader::run() {
+	while(true) {
+		std::unique_ptr<Request> request;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			requestAvailable.wait(lock, [this] { return stopped || !queuedRequests.empty(); });
+			if(stopped)
+				return;
+			request = std::move(queuedRequests.front());
+			queuedRequests.pop_front();
+			++activeCount;
+		}
+		try {
+			request->mesh = Serialization::loadMesh(request->url);
+			if(request->mesh.isNotNull() && request->postProcessing)
+				request->postProcessing(request->mesh.get());
+		} catch(...) {
+			request->mesh = nullptr;
+			request->exception = std::current_exception();
+		}
+		std::lock_guard<std::mutex> lock(mutex);
+		--activeCount;
+		completedRequests.emplace_back(std::move(request));
+	}
+}
+
+uint32_t AsyncMeshLoader::processCompleted(uint32_t maxCount) {
+	uint32_t count = 0;
+	for(; count < maxCount; ++count) {
+		std::unique_ptr<Request> request;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			if(completedRequests.empty())
+				break;
+			request = std::move(completedRequests.front());
+			completedRequests.pop_front();
+		}
+		Mesh * mesh = request->mesh.get();
+		if(request->exception) {
+			request->promise.set_exception(request->exception);
+		} else {
+			if(mesh != nullptr)
+				mesh->getDataStrategy()->prepare(mesh);
+			request->promise.set_value(request->mesh);
+		}
+		if(request->onCompletion)
+			request->onCompletion(mesh);
+	}
+	return count;
+}
+
+size_t AsyncMeshLoader::getPendingCount() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return queuedRequests.size() + activeCount + completedRequests.size();
+}
+
+size_t AsyncMeshLoader::getCompletedCount() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return completedRequests.size();
+}
+
+}
+}
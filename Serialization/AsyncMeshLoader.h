@@ -0,0 +1,110 @@
+/*
+	This file is part of the Rendering library.
+	Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+	This library is subject to the terms of the Mozilla Public License, v. 2.0.
+	You should have received a copy of the MPL along with this library; see the
+	file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#ifndef RENDERING_ASYNCMESHLOADER_H_
+#define RENDERING_ASYNCMESHLOADER_H_
+
+#include "../Mesh/Mesh.h"
+#include <Util/References.h>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Util {
+class FileName;
+}
+
+namespace Rendering {
+namespace Serialization {
+
+/**
+ * Loads meshes with a fixed number of worker threads.
+ * The workers read and parse the files (see Serialization::loadMesh()) and run
+ * an optional post-processing function on the loaded mesh. The finished meshes
+ * are collected in a completion queue, which has to be processed regularly on
+ * the thread owning the OpenGL context (e.g. once per frame) by calling
+ * processCompleted(). There, only the buffers are uploaded according to the
+ * mesh's data strategy, before the result is published.
+ *
+ * @code
+ * Serialization::AsyncMeshLoader loader;
+ * auto future = loader.loadMeshAsync(Util::FileName("level/part1.mmf"));
+ * ...
+ * // each frame
+ * loader.processCompleted(4);
+ * if(future.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+ * 	addToScene(future.get());
+ * @endcode
+ *
+ * @note The futures become ready within processCompleted(); waiting for them on
+ * the thread that calls processCompleted() blocks forever.
+ * @note The post-processing functions must not access OpenGL or meshes shared with other threads.
+ */
+class AsyncMeshLoader {
+	public:
+		//! Called by a worker thread for each successfully loaded mesh.
+		typedef std::function<void (Mesh *)> PostProcessing_t;
+		//! Called by processCompleted() after the mesh has been uploaded (the mesh is nullptr if loading failed).
+		typedef std::function<void (Mesh *)> Callback_t;
+		typedef std::shared_future<Util::Reference<Mesh>> MeshFuture_t;
+
+		/*! Start the worker threads.
+			\param workerCount Number of threads; zero selects the number of hardware threads.	*/
+		explicit AsyncMeshLoader(uint32_t workerCount = 0);
+
+		/*! Stop the worker threads after their current requests.
+			The futures of unfinished requests report a std::future_error (broken promise).	*/
+		~AsyncMeshLoader();
+
+		AsyncMeshLoader(const AsyncMeshLoader &) = delete;
+		AsyncMeshLoader & operator=(const AsyncMeshLoader &) = delete;
+
+		/*! Queue the file for loading.
+			The result is nullptr, if the file cannot be loaded. Exceptions thrown by the
+			loader or by @p postProcessing are reported through the future.	*/
+		MeshFuture_t loadMeshAsync(const Util::FileName & url,
+									PostProcessing_t postProcessing = PostProcessing_t(),
+									Callback_t onCompletion = Callback_t());
+
+		/*! Upload and publish at most @p maxCount finished meshes.
+			Has to be called by the thread owning the OpenGL context.
+			\return the number of processed requests	*/
+		uint32_t processCompleted(uint32_t maxCount = std::numeric_limits<uint32_t>::max());
+
+		//! Number of requests that have not been processed by processCompleted() yet.
+		size_t getPendingCount() const;
+		//! Number of finished requests waiting for processCompleted().
+		size_t getCompletedCount() const;
+		uint32_t getWorkerCount() const						{	return static_cast<uint32_t>(workers.size());	}
+
+	private:
+		struct Request;
+
+		void run();
+
+		std::vector<std::thread> workers;
+		mutable std::mutex mutex;
+		std::condition_variable requestAvailable;
+		std::deque<std::unique_ptr<Request>> queuedRequests;
+		std::deque<std::unique_ptr<Request>> completedRequests;
+		size_t activeCount; //!< nr of requests currently processed by workers
+		bool stopped;
+};
+
+}
+}
+
+#endif /* RENDERING_ASYNCMESHLOADER_H_ */
@@ -0,0 +1,146 @@
+/*
+	This file is part of the Rendering library.
+	Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+	This library is subject to the terms of the Mozilla Public License, v. 2.0.
+	You should have received a copy of the MPL along with this library; see the
+	file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#include "BlockCompression.h"
+#include <cstring>
+
+namespace Rendering {
+namespace Serialization {
+namespace BlockCompression {
+
+static const size_t MIN_MATCH = 4;
+static const size_t MAX_OFFSET = 65535;
+//! The last match has to start at least 12 bytes before the end of the block.
+static const size_t MATCH_START_LIMIT = 12;
+//! The last 5 bytes of a block are always literals.
+static const size_t LAST_LITERALS = 5;
+static const uint32_t HASH_BITS = 16;
+
+static inline uint32_t read32(const uint8_t * p) {
+	uint32_t value;
+	std::memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+static inline uint32_t hash(uint32_t sequence) {
+	return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+static void writeLength(std::vector<uint8_t> & out, size_t length) {
+	while(length >= 255) {
+		out.push_back(255);
+		length -= 255;
+	}
+	out.push_back(static_cast<uint8_t>(length));
+}
+
+static void writeSequence(std::vector<uint8_t> & out, const uint8_t * literals, size_t literalCount, size_t offset, size_t matchLength) {
+	const size_t matchCode = matchLength - MIN_MATCH;
+	out.push_back(static_cast<uint8_t>(((literalCount < 15 ? literalCount : 15) << 4) | (matchCode < 15 ? matchCode : 15)));
+	if(literalCount >= 15)
+		writeLength(out, literalCount - 15);
+	out.insert(out.end(), literals, literals + literalCount);
+	out.push_back(static_cast<uint8_t>(offset));
+	out.push_back(static_cast<uint8_t>(offset >> 8));
+	if(matchCode >= 15)
+		writeLength(out, matchCode - 15);
+}
+
+std::vector<uint8_t> compress(const uint8_t * source, size_t size) {
+	std::vector<uint8_t> out;
+	out.reserve(size + size / 255 + 16);
+	size_t anchor = 0;
+	if(size > MATCH_START_LIMIT) {
+		// last position at which a match is found + 1; 0 marks an empty entry
+		std::vector<uint32_t> table(1u << HASH_BITS, 0);
+		const size_t matchStartLimit = size - MATCH_START_LIMIT;
+		const size_t matchEndLimit = size - LAST_LITERALS;
+		size_t pos = 0;
+		while(pos < matchStartLimit) {
+			const uint32_t sequence = read32(source + pos);
+			uint32_t & entry = table[hash(sequence)];
+			const size_t candidate = entry;
+			entry = static_cast<uint32_t>(pos + 1);
+			if(candidate == 0 || pos - (candidate - 1) > MAX_OFFSET || read32(source + candidate - 1) != sequence) {
+				// skip faster through incompressible data
+				pos += 1 + ((pos - anchor) >> 6);
+				continue;
+			}
+			const size_t match = candidate - 1;
+			size_t length = MIN_MATCH;
+			while(pos + length < matchEndLimit && source[match + length] == source[pos + length])
+				++length;
+			writeSequence(out, source + anchor, pos - anchor, pos - match, length);
+			pos += length;
+			anchor = pos;
+		}
+	}
+	// last literals
+	const size_t literalCount = size - anchor;
+	out.push_back(static_cast<uint8_t>((literalCount < 15 ? literalCount : 15) << 4));
+	if(literalCount >= 15)
+		writeLength(out, literalCount - 15);
+	out.insert(out.end(), source + anchor, source + size);
+	return out;
+}
+
+//! Read an extended length; return false on an overflow of the input.
+static inline bool readLength(const uint8_t * source, size_t sourceSize, size_t & pos, size_t & length) {
+	uint8_t value;
+	do {
+		if(pos >= sourceSize)
+			return false;
+		value = source[pos++];
+		length += value;
+	} while(value == 255);
+	return true;
+}
+
+bool decompress(const uint8_t * source, size_t sourceSize, uint8_t * destination, size_t size) {
+	size_t in = 0;
+	size_t out = 0;
+	while(in < sourceSize) {
+		const uint8_t token = source[in++];
+		size_t literalCount = token >> 4;
+		if(literalCount == 15 && !readLength(source, sourceSize, in, literalCount))
+			return false;
+		if(literalCount > sourceSize - in || literalCount > size - out)
+			return false;
+		std::memcpy(destination + out, source + in, literalCount);
+		in += literalCount;
+		out += literalCount;
+		if(in == sourceSize) // the last sequence has no match
+			break;
+
+		if(sourceSize - in < 2)
+			return false;
+		const size_t offset = source[in] | (static_cast<size_t>(source[in + 1]) << 8);
+		in += 2;
+		size_t length = token & 0x0f;
+		if(length == 15 && !readLength(source, sourceSize, in, length))
+			return false;
+		length += MIN_MATCH;
+		if(offset == 0 || offset > out || length > size - out)
+			return false;
+		const uint8_t * match = destination + out - offset;
+		uint8_t * target = destination + out;
+		if(offset >= length) {
+			std::memcpy(target, match, length);
+		} else {
+			// overlapping copy repeats the last offset bytes
+			for(size_t i = 0; i < length; ++i)
+				target[i] = match[i];
+		}
+		out += length;
+	}
+	return out == size;
+}
+
+}
+}
+}
@@ -0,0 +1,41 @@
+/*
+	This file is part of the Rendering library.
+	Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+	This library is subject to the terms of the Mozilla Public License, v. 2.0.
+	You should have received a copy of the MPL along with this library; see the
+	file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#ifndef RENDERING_BLOCKCOMPRESSION_H_
+#define RENDERING_BLOCKCOMPRESSION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Rendering {
+namespace Serialization {
+
+/**
+ * Fast lossless compression of memory blocks using the LZ4 block format
+ * (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md).
+ * The blocks can be decompressed by any LZ4 implementation (LZ4_decompress_safe)
+ * and vice versa. The compression ratio is moderate, but decompression is
+ * mainly bounded by the memory bandwidth.
+ */
+namespace BlockCompression {
+
+/*! Compress @p size bytes from @p source.
+	\return the compressed block, which may be larger than the input for incompressible data */
+std::vector<uint8_t> compress(const uint8_t * source, size_t size);
+
+/*! Decompress the block @p source of @p sourceSize bytes into @p destination,
+	which has to hold the @p size bytes of the original data.
+	\return @c false if the block is corrupt or does not decompress to exactly @p size bytes */
+bool decompress(const uint8_t * source, size_t sourceSize, uint8_t * destination, size_t size);
+
+}
+}
+}
+
+#endif /* RENDERING_BLOCKCOMPRESSION_H_ */
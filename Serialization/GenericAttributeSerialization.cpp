@@ -7,23 +7,42 @@
 	file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
 */
 #include "GenericAttributeSerialization.h"
+#include "MeshBlobContainer.h"
 #include "Serialization.h"
+#include "StreamerMMF.h"
 #include "../Mesh/Mesh.h"
 #include <Util/GenericAttribute.h>
 #include <Util/GenericAttributeSerialization.h>
 #include <Util/Encoding.h>
 #include <Util/IO/FileLocator.h>
+#include <Util/Macros.h>
+#include <memory>
 
 namespace Rendering {
 namespace Serialization {
 
 static const bool renderingAttrStreamerInitialized = initGenericAttributeSerialization();
 
+static MeshBlobContainer * getBlobContainer(const Util::GenericAttributeMap * context) {
+	static const Util::StringIdentifier CONTEXT_BLOB_CONTAINER(CONTEXT_MESH_BLOB_CONTAINER);
+	if(context == nullptr || !context->contains(CONTEXT_BLOB_CONTAINER))
+		return nullptr;
+	auto containerAttribute = context->getValue<MeshBlobContainerAttribute_t>(CONTEXT_BLOB_CONTAINER);
+	return containerAttribute == nullptr ? nullptr : &containerAttribute->get();
+}
+
 std::pair<std::string, std::string> serializeGAMesh(const std::pair<const Util::GenericAttribute *, const Util::GenericAttributeMap *> & attributeAndContext) {
 	auto meshAttribute = dynamic_cast<const MeshAttribute_t *>(attributeAndContext.first);
 	const auto & mesh = meshAttribute->get();
 	const auto & filename = mesh->getFileName();
 	if(filename.empty()) {
+		MeshBlobContainer * container = getBlobContainer(attributeAndContext.second);
+		if(container != nullptr && container->isWritable()) {
+			const std::string reference = container->addMesh(mesh);
+			if(!reference.empty())
+				return std::make_pair(GATypeNameMesh, reference);
+			WARN("serializeGAMesh: Storing the mesh in the MeshBlobContainer failed; embedding it instead.");
+		}
 		std::ostringstream meshStream;
 		if(saveMesh(mesh, "mmf", meshStream)) {
 			const std::string streamString = meshStream.str();
@@ -40,9 +59,17 @@ MeshAttribute_t * unserializeGAMesh(const std::pair<std::string, const Util::Gen
 	static const Util::StringIdentifier CONTEXT_FILE_LOCATOR("FileLocator");
 	const std::string & s = contentAndContext.first;
 	Mesh * mesh = nullptr;
-	if(s.compare(0, embeddedMeshPrefix.length(), embeddedMeshPrefix) == 0) {
-		const std::vector<uint8_t> meshData = Util::decodeBase64(s.substr(embeddedMeshPrefix.length()));
-		mesh = loadMesh("mmf", std::string(meshData.begin(), meshData.end()));
+	if(MeshBlobContainer::isReference(s)) {
+		MeshBlobContainer * container = getBlobContainer(contentAndContext.second);
+		if(container != nullptr && container->isReadable())
+			mesh = container->loadMesh(s);
+		else
+			WARN("unserializeGAMesh: No readable MeshBlobContainer in the context.");
+	} else if(s.compare(0, embeddedMeshPrefix.length(), embeddedMeshPrefix) == 0) {
+		// read the decoded data in place instead of copying it into a stream
+		std::shared_ptr<std::vector<uint8_t>> meshData = std::make_shared<std::vector<uint8_t>>(Util::decodeBase64(s.substr(embeddedMeshPrefix.length())));
+		if(!meshData->empty())
+			mesh = StreamerMMF::loadMeshFromMemory(std::shared_ptr<uint8_t>(meshData, meshData->data()), meshData->size());
 	} else {
 		auto filename = Util::FileName(s);
 		if(contentAndContext.second->contains(CONTEXT_FILE_LOCATOR)) {
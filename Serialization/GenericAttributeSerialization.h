@@ -15,22 +15,31 @@ namespace Util {
 class GenericAttribute;
 class GenericAttributeMap;
 template<class ObjType> class ReferenceAttribute;
+template<typename Type> class WrapperAttribute;
 }
 namespace Rendering {
 class Mesh;
 namespace Serialization {
+class MeshBlobContainer;
 
 /*! Adds a handler for Util::_CounterAttribute<Mesh> to Util::GenericAttributeSerialization.
 	Should be called at least once before a GenericAttribute is serialized which
 	may contain a Mesh.
 	\note Texture-Serialization may be added here when needed.
 	\note The return value is always true and can be used for static initialization.
+	\note Unnamed meshes are embedded base64-encoded, unless the context contains a
+		MeshBlobContainer (see CONTEXT_MESH_BLOB_CONTAINER).
 */
 bool initGenericAttributeSerialization();
 
 typedef Util::ReferenceAttribute<Mesh> MeshAttribute_t;
 const std::string GATypeNameMesh("Mesh");
 const std::string embeddedMeshPrefix("$[mmf_b64]");
+typedef Util::WrapperAttribute<MeshBlobContainer &> MeshBlobContainerAttribute_t;
+/*! Key of a MeshBlobContainerAttribute_t in the context map. When serializing, unnamed
+	meshes are appended to the container instead of being embedded; when unserializing,
+	the references to the container are resolved. */
+const std::string CONTEXT_MESH_BLOB_CONTAINER("MeshBlobContainer");
 std::pair<std::string, std::string> serializeGAMesh(const std::pair<const Util::GenericAttribute *,
 																	const Util::GenericAttributeMap *> & attributeAndContext);
 MeshAttribute_t * unserializeGAMesh(const std::pair<std::string,
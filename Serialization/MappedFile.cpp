@@ -0,0 +1,82 @@
+/*
+	This file is part of the Rendering library.
+	Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+	This library is subject to the terms of the Mozilla Public License, v. 2.0.
+	You should have received a copy of the MPL along with this library; see the
+	file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#ifndef WIN32
+#define WIN32
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Rendering {
+namespace Serialization {
+
+#ifdef _WIN32
+
+//! (static)
+std::shared_ptr<MappedFile> MappedFile::open(const std::string & path) {
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(file == INVALID_HANDLE_VALUE)
+		return nullptr;
+	LARGE_INTEGER fileSize;
+	if(!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+		CloseHandle(file);
+		return nullptr;
+	}
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	CloseHandle(file);
+	if(mapping == nullptr)
+		return nullptr;
+	// the view keeps the mapping object alive
+	void * view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+	CloseHandle(mapping);
+	if(view == nullptr)
+		return nullptr;
+	return std::shared_ptr<MappedFile>(new MappedFile(static_cast<uint8_t *>(view), static_cast<size_t>(fileSize.QuadPart)));
+}
+
+MappedFile::~MappedFile() {
+	UnmapViewOfFile(mappedData);
+}
+
+#else
+
+//! (static)
+std::shared_ptr<MappedFile> MappedFile::open(const std::string & path) {
+	const int file = ::open(path.c_str(), O_RDONLY);
+	if(file < 0)
+		return nullptr;
+	struct stat fileStatus;
+	if(fstat(file, &fileStatus) != 0 || !S_ISREG(fileStatus.st_mode) || fileStatus.st_size == 0) {
+		::close(file);
+		return nullptr;
+	}
+	const size_t fileSize = static_cast<size_t>(fileStatus.st_size);
+	// MAP_PRIVATE: writing to the memory creates private copies of the pages
+	void * view = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+	::close(file);
+	if(view == MAP_FAILED)
+		return nullptr;
+	return std::shared_ptr<MappedFile>(new MappedFile(static_cast<uint8_t *>(view), fileSize));
+}
+
+MappedFile::~MappedFile() {
+	munmap(mappedData, mappedSize);
+}
+
+#endif
+
+}
+}
@@ -0,0 +1,62 @@
+/*
+	This file is part of the Rendering library.
+	Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+	This library is subject to the terms of the Mozilla Public License, v. 2.0.
+	You should have received a copy of the MPL along with this library; see the
+	file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#ifndef RENDERING_MAPPEDFILE_H_
+#define RENDERING_MAPPEDFILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace Rendering {
+namespace Serialization {
+
+/**
+ * Private memory mapping of a whole file.
+ * The pages of the file are only read when they are accessed, and they can be
+ * dropped by the operating system under memory pressure. The mapped memory is
+ * writable, but changes are copied on write: they are only visible to this
+ * process and never reach the file.
+ * Use getMemory() to keep the mapping alive while parts of it are referenced,
+ * e.g. as local data of a mesh (see MeshVertexData::setExternalData()).
+ *
+ * \note The file must not be truncated while it is mapped.
+ */
+class MappedFile {
+	public:
+		/*! (static factory)
+			Map the file with the given path of the local file system.
+			\return the mapping, or nullptr if the file cannot be mapped	*/
+		static std::shared_ptr<MappedFile> open(const std::string & path);
+
+		~MappedFile();
+
+		MappedFile(const MappedFile &) = delete;
+		MappedFile & operator=(const MappedFile &) = delete;
+
+		uint8_t * data() const							{	return mappedData;	}
+		size_t size() const								{	return mappedSize;	}
+
+		/*! Return a pointer to the mapped memory at the given offset, which keeps the mapping alive.
+			\note @p mapping must be the result of open().	*/
+		static std::shared_ptr<uint8_t> getMemory(const std::shared_ptr<MappedFile> & mapping, size_t offset) {
+			return std::shared_ptr<uint8_t>(mapping, mapping->data() + offset);
+		}
+
+	private:
+		MappedFile(uint8_t * _data, size_t _size) : mappedData(_data), mappedSize(_size) {}
+
+		uint8_t * mappedData;
+		size_t mappedSize;
+};
+
+}
+}
+
+#endif /* RENDERING_MAPPEDFILE_H_ */
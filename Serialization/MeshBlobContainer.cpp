@@ -0,0 +1,96 @@
+/*
+	This file is part of the Rendering library.
+	Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+	This library is subject to the terms of the Mozilla Public License, v. 2.0.
+	You should have received a copy of the MPL along with this library; see the
+	file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#include "MeshBlobContainer.h"
+#include "MappedFile.h"
+#include "StreamerMMF.h"
+#include "../Mesh/Mesh.h"
+#include <Util/Macros.h>
+#include <cstdlib>
+#include <ostream>
+#include <utility>
+
+namespace Rendering {
+namespace Serialization {
+
+static const std::string meshBlobPrefix("$[mmf_blob]");
+
+MeshBlobContainer::MeshBlobContainer(std::ostream & _output) : output(&_output), data(), size(0), failed(false) {
+}
+
+MeshBlobContainer::MeshBlobContainer(std::shared_ptr<uint8_t> _data, size_t _size) : output(nullptr), data(std::move(_data)), size(_size), failed(false) {
+}
+
+//! (static)
+std::unique_ptr<MeshBlobContainer> MeshBlobContainer::openFile(const std::string & path) {
+	std::shared_ptr<MappedFile> file = MappedFile::open(path);
+	if(!file)
+		return nullptr;
+	return std::unique_ptr<MeshBlobContainer>(new MeshBlobContainer(MappedFile::getMemory(file, 0), file->size()));
+}
+
+//! (static)
+bool MeshBlobContainer::isReference(const std::string & s) {
+	return s.compare(0, meshBlobPrefix.length(), meshBlobPrefix) == 0;
+}
+
+std::string MeshBlobContainer::addMesh(Mesh * mesh) {
+	if(!isWritable() || mesh == nullptr) {
+		WARN("MeshBlobContainer::addMesh: The container is not writable.");
+		return "";
+	}
+	// the chunks of the mesh are aligned relative to its beginning; align the mesh itself
+	// so that the chunks can be referenced without copying when the container is mapped
+	static const char padding[StreamerMMF::MMF_CHUNK_ALIGNMENT] = {};
+	const size_t paddingSize = (StreamerMMF::MMF_CHUNK_ALIGNMENT - size % StreamerMMF::MMF_CHUNK_ALIGNMENT) % StreamerMMF::MMF_CHUNK_ALIGNMENT;
+	output->write(padding, paddingSize);
+	const size_t offset = size + paddingSize;
+
+	const std::streampos begin = output->tellp();
+	StreamerMMF streamer;
+	const bool written = begin != std::streampos(-1) && streamer.saveMesh(mesh, *output) && output->good();
+	const std::streampos end = output->tellp();
+	if(begin == std::streampos(-1) || end == std::streampos(-1)) {
+		// the position of the following meshes is unknown
+		WARN("MeshBlobContainer::addMesh: Writing the mesh failed; the container is no longer writable.");
+		failed = true;
+		return "";
+	}
+	// partially written data stays in the stream; keep the offsets of the following meshes valid
+	const size_t meshSize = static_cast<size_t>(end - begin);
+	size = offset + meshSize;
+	if(!written) {
+		WARN("MeshBlobContainer::addMesh: Writing the mesh failed.");
+		return "";
+	}
+	return meshBlobPrefix + std::to_string(offset) + ':' + std::to_string(meshSize);
+}
+
+Mesh * MeshBlobContainer::loadMesh(const std::string & reference) const {
+	if(!isReference(reference)) {
+		WARN("MeshBlobContainer::loadMesh: Invalid reference '" + reference + "'.");
+		return nullptr;
+	}
+	if(data == nullptr) {
+		WARN("MeshBlobContainer::loadMesh: The container is not readable.");
+		return nullptr;
+	}
+	const char * begin = reference.c_str() + meshBlobPrefix.length();
+	char * separator = nullptr;
+	const unsigned long long offset = std::strtoull(begin, &separator, 10);
+	char * end = nullptr;
+	const unsigned long long meshSize = separator != begin && *separator == ':' ? std::strtoull(separator + 1, &end, 10) : 0;
+	if(end == nullptr || *end != '\0' || end == separator + 1 || offset > size || meshSize > size - offset) {
+		WARN("MeshBlobContainer::loadMesh: Invalid reference '" + reference + "'.");
+		return nullptr;
+	}
+	return StreamerMMF::loadMeshFromMemory(std::shared_ptr<uint8_t>(data, data.get() + offset), static_cast<size_t>(meshSize));
+}
+
+}
+}
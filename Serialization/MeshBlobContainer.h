@@ -0,0 +1,89 @@
+/*
+	This file is part of the Rendering library.
+	Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+	This library is subject to the terms of the Mozilla Public License, v. 2.0.
+	You should have received a copy of the MPL along with this library; see the
+	file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#ifndef RENDERING_MESHBLOBCONTAINER_H_
+#define RENDERING_MESHBLOBCONTAINER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+
+namespace Rendering {
+class Mesh;
+namespace Serialization {
+class MappedFile;
+
+/**
+ * Binary side-channel for meshes embedded into serialized GenericAttributes.
+ * Meshes are stored back to back as .mmf-data (e.g. in a sidecar file next to a
+ * scene file); the serialized attribute only contains a short reference of the
+ * form "$[mmf_blob]offset:size". The meshes are neither base64-encoded nor copied
+ * through intermediate strings.
+ *
+ * The container is passed to the GenericAttribute serialization through the
+ * context map (see CONTEXT_MESH_BLOB_CONTAINER):
+ * @code
+ * std::ofstream blobFile("scene.blob", std::ios::binary);
+ * Serialization::MeshBlobContainer container(blobFile);
+ * Util::GenericAttributeMap context;
+ * context.setValue(Serialization::CONTEXT_MESH_BLOB_CONTAINER,
+ * 				new Serialization::MeshBlobContainerAttribute_t(container));
+ * const std::string s = Util::GenericAttributeSerialization::serialize(attribute, &context);
+ * ...
+ * auto container = Serialization::MeshBlobContainer::openFile("scene.blob");
+ * @endcode
+ *
+ * When reading, the meshes' aligned vertex and index data reference the container's
+ * memory (see StreamerMMF::loadMeshFromMemory()).
+ */
+class MeshBlobContainer {
+	public:
+		//! Create a container that appends the meshes to the given output stream.
+		explicit MeshBlobContainer(std::ostream & output);
+		//! Create a container reading the meshes from the given memory.
+		MeshBlobContainer(std::shared_ptr<uint8_t> data, size_t size);
+
+		/*! (static factory)
+			Map the container file with the given path of the local file system for reading.
+			\return the container, or nullptr if the file cannot be mapped	*/
+		static std::unique_ptr<MeshBlobContainer> openFile(const std::string & path);
+
+		MeshBlobContainer(const MeshBlobContainer &) = delete;
+		MeshBlobContainer & operator=(const MeshBlobContainer &) = delete;
+
+		/*! Append the mesh to the output stream.
+			If the position of the output stream cannot be determined after a failure,
+			the container refuses all further meshes.
+			\return the reference to be stored instead of the mesh, or an empty string on failure	*/
+		std::string addMesh(Mesh * mesh);
+
+		/*! Load the mesh for a reference created by addMesh().
+			\return the mesh, or nullptr if the reference is invalid or the container cannot be read	*/
+		Mesh * loadMesh(const std::string & reference) const;
+
+		//! Return true iff the string is a reference to a mesh in a container.
+		static bool isReference(const std::string & s);
+
+		bool isReadable() const								{	return data != nullptr;	}
+		bool isWritable() const								{	return output != nullptr && !failed;	}
+		//! Number of bytes written to the output stream or readable from memory.
+		size_t getSize() const								{	return size;	}
+
+	private:
+		std::ostream * output;
+		std::shared_ptr<uint8_t> data;
+		size_t size;
+		bool failed;
+};
+
+}
+}
+
+#endif /* RENDERING_MESHBLOBCONTAINER_H_ */
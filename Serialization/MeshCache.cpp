@@ -0,0 +1,234 @@
+/*
+	This file is part of the Rendering library.
+	Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+	This library is subject to the terms of the Mozilla Public License, v. 2.0.
+	You should have received a copy of the MPL along with this library; see the
+	file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#include "MeshCache.h"
+#include "MappedFile.h"
+#include "Serialization.h"
+#include "StreamerMMF.h"
+#include "../MeshUtils/MeshUtils.h"
+#include <Util/IO/FileName.h>
+#include <Util/IO/FileUtils.h>
+#include <Util/Macros.h>
+#include <Util/Utils.h>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace Rendering {
+namespace Serialization {
+
+static bool isLocalFile(const Util::FileName & url) {
+	return url.getFSName().empty() || url.getFSName() == "file";
+}
+
+static unsigned long getProcessId() {
+#ifdef _WIN32
+	return static_cast<unsigned long>(_getpid());
+#else
+	return static_cast<unsigned long>(getpid());
+#endif
+}
+
+//! 64 bit FNV-1a hash; identifies the source of a cache file more reliably than its 32 bit name.
+static uint64_t calcHash64(const uint8_t * data, size_t size) {
+	uint64_t hash = 14695981039346656037ull;
+	for(size_t i = 0; i < size; ++i) {
+		hash ^= data[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+static std::string getKeyFile(const std::string & cacheFile) {
+	return cacheFile + ".key";
+}
+
+//! Return the content of a key file, or an empty string if it cannot be read.
+static std::string readKeyFile(const std::string & path) {
+	std::ifstream input(path, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+}
+
+static bool haveSameContent(Mesh * mesh1, Mesh * mesh2) {
+	return mesh1->getDrawMode() == mesh2->getDrawMode() && mesh1->isUsingIndexData() == mesh2->isUsingIndexData() &&
+			MeshUtils::compareMeshes(mesh1, mesh2);
+}
+
+//! (static)
+MeshCache & MeshCache::getInstance() {
+	static MeshCache instance;
+	return instance;
+}
+
+MeshCache::MeshCache() : meshCount(0), sharedCount(0), cacheFileCount(0) {
+}
+
+Util::Reference<Mesh> MeshCache::getSharedMesh(Mesh * mesh) {
+	if(mesh == nullptr)
+		return nullptr;
+	const uint32_t hash = MeshUtils::calculateHash(mesh);
+	std::lock_guard<std::mutex> lock(mutex);
+	auto & candidates = meshes[hash];
+	for(const auto & candidate : candidates) {
+		if(haveSameContent(candidate.get(), mesh)) {
+			if(candidate.get() != mesh)
+				++sharedCount;
+			return candidate;
+		}
+	}
+	candidates.emplace_back(mesh);
+	++meshCount;
+	return mesh;
+}
+
+std::string MeshCache::getCacheFile(const Util::FileName & url, const std::string & processingOptions, std::string & sourceKey) const {
+	const std::string directory = getCacheDirectory();
+	if(directory.empty())
+		return "";
+
+	// local files are mapped to avoid copying them
+	uint32_t contentHash;
+	uint64_t contentHash64;
+	size_t contentSize;
+	std::shared_ptr<MappedFile> file = isLocalFile(url) ? MappedFile::open(url.getPath()) : nullptr;
+	if(file) {
+		contentHash = Util::calcHash(file->data(), file->size());
+		contentHash64 = calcHash64(file->data(), file->size());
+		contentSize = file->size();
+	} else {
+		const std::vector<uint8_t> content = Util::FileUtils::loadFile(url);
+		if(content.empty())
+			return "";
+		contentHash = Util::calcHash(content.data(), content.size());
+		contentHash64 = calcHash64(content.data(), content.size());
+		contentSize = content.size();
+	}
+	const uint32_t optionsHash = Util::calcHash(reinterpret_cast<const uint8_t *>(processingOptions.data()), processingOptions.size());
+
+	std::ostringstream key;
+	key << std::hex << contentHash64 << ' ' << std::dec << contentSize << '\n' << processingOptions;
+	sourceKey = key.str();
+
+	std::ostringstream s;
+	s << directory << '/' << std::hex << contentHash << '_' << contentSize << '_' << optionsHash << '.' << StreamerMMF::fileExtension;
+	return s.str();
+}
+
+Util::Reference<Mesh> MeshCache::loadMesh(const Util::FileName & url, const std::string & processingOptions, const Processing_t & processing) {
+	std::string sourceKey;
+	const std::string cacheFile = getCacheFile(url, processingOptions, sourceKey);
+	Util::Reference<Mesh> mesh;
+	// the file name is only a 32 bit hash; the key file identifies the source to detect collisions
+	if(!cacheFile.empty() && readKeyFile(getKeyFile(cacheFile)) == sourceKey) {
+		mesh = StreamerMMF::loadMeshMapped(cacheFile);
+		if(mesh.isNotNull()) {
+			mesh->setFileName(url);
+			std::lock_guard<std::mutex> lock(mutex);
+			++cacheFileCount;
+		}
+	}
+	if(mesh.isNull()) {
+		mesh = Serialization::loadMesh(url);
+		if(mesh.isNull())
+			return nullptr;
+		if(processing)
+			processing(mesh.get());
+		if(!cacheFile.empty()) {
+			// write to temporary files first, so that concurrent imports never read a partial file;
+			// the names are unique among the threads of all processes sharing the cache directory
+			std::ostringstream tmpSuffix;
+			tmpSuffix << ".tmp" << getProcessId() << '_' << std::this_thread::get_id();
+			const std::string tmpFile = cacheFile + tmpSuffix.str();
+			const std::string keyFile = getKeyFile(cacheFile);
+			const std::string tmpKeyFile = keyFile + tmpSuffix.str();
+			bool success;
+			{
+				std::ofstream output(tmpFile, std::ios::binary);
+				StreamerMMF streamer;
+				success = output.good() && streamer.saveMesh(mesh.get(), output) && output.good();
+			}
+			if(success) {
+				std::ofstream output(tmpKeyFile, std::ios::binary);
+				success = output.write(sourceKey.data(), sourceKey.size()).good();
+			}
+			if(!success || std::rename(tmpKeyFile.c_str(), keyFile.c_str()) != 0 || std::rename(tmpFile.c_str(), cacheFile.c_str()) != 0) {
+				WARN("MeshCache: Could not write cache file '" + cacheFile + "'.");
+				std::remove(tmpFile.c_str());
+				std::remove(tmpKeyFile.c_str());
+				std::remove(keyFile.c_str());
+			}
+		}
+	}
+	return getSharedMesh(mesh.get());
+}
+
+void MeshCache::setCacheDirectory(const std::string & path) {
+	if(!path.empty() && !Util::FileUtils::isDir(Util::FileName::createDirName(path)))
+		Util::FileUtils::createDir(Util::FileName::createDirName(path), true);
+	std::lock_guard<std::mutex> lock(mutex);
+	cacheDirectory = path;
+}
+
+std::string MeshCache::getCacheDirectory() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return cacheDirectory;
+}
+
+size_t MeshCache::removeUnusedMeshes() {
+	std::lock_guard<std::mutex> lock(mutex);
+	size_t count = 0;
+	for(auto it = meshes.begin(); it != meshes.end();) {
+		auto & candidates = it->second;
+		for(size_t i = 0; i < candidates.size();) {
+			if(candidates[i]->countReferences() == 1) {
+				candidates[i] = candidates.back();
+				candidates.pop_back();
+				++count;
+			} else {
+				++i;
+			}
+		}
+		it = candidates.empty() ? meshes.erase(it) : std::next(it);
+	}
+	meshCount -= count;
+	return count;
+}
+
+void MeshCache::clear() {
+	std::lock_guard<std::mutex> lock(mutex);
+	meshes.clear();
+	meshCount = 0;
+	sharedCount = 0;
+	cacheFileCount = 0;
+}
+
+size_t MeshCache::getMeshCount() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return meshCount;
+}
+
+size_t MeshCache::getSharedCount() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return sharedCount;
+}
+
+size_t MeshCache::getCacheFileCount() const {
+	std::lock_guard<std::mutex> lock(mutex);
+	return cacheFileCount;
+}
+
+}
+}
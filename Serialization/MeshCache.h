@@ -0,0 +1,105 @@
+/*
+	This file is part of the Rendering library.
+	Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+	This library is subject to the terms of the Mozilla Public License, v. 2.0.
+	You should have received a copy of the MPL along with this library; see the
+	file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#ifndef RENDERING_MESHCACHE_H_
+#define RENDERING_MESHCACHE_H_
+
+#include "../Mesh/Mesh.h"
+#include <Util/References.h>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Util {
+class FileName;
+}
+
+namespace Rendering {
+namespace Serialization {
+
+/**
+ * Cache for sharing meshes with identical content.
+ * - Meshes with the same vertex description, draw mode and data (see
+ *   MeshUtils::calculateHash() and MeshUtils::compareMeshes()) are replaced by a
+ *   single shared instance, so that they also share their buffers on the GPU.
+ * - If a cache directory is set, loadMesh() stores the loaded and processed meshes
+ *   as .mmf-files keyed by the hash of the source file and the processing options.
+ *   A .key-file next to each cached file stores a stronger hash of the source and the
+ *   options, so that a collision of the file names is not mistaken for a cache hit.
+ *   Subsequent imports of the same file load the cached file and skip parsing and
+ *   processing entirely.
+ *
+ * The cache keeps the shared meshes alive until they are removed with
+ * removeUnusedMeshes() or clear(). All functions are thread-safe.
+ *
+ * \note Shared meshes must not be modified, as all their users are affected.
+ */
+class MeshCache {
+	public:
+		//! Called for each newly loaded mesh before it is stored in the cache directory.
+		typedef std::function<void (Mesh *)> Processing_t;
+
+		//! (static) The process-wide cache.
+		static MeshCache & getInstance();
+
+		MeshCache();
+
+		MeshCache(const MeshCache &) = delete;
+		MeshCache & operator=(const MeshCache &) = delete;
+
+		/*! Return the shared instance of a mesh with the same content as the given mesh.
+			If there is none, the given mesh becomes the shared instance.	*/
+		Util::Reference<Mesh> getSharedMesh(Mesh * mesh);
+
+		/*! Load the mesh with the given file name and return its shared instance.
+			If a cache directory is set, a cached copy of the processed mesh is used if available.
+			\param processingOptions Description of the processing that is applied; part of the cache key.
+			\param processing Applied to the mesh after loading it from the source file.
+			\return the mesh, or nullptr if the file cannot be loaded	*/
+		Util::Reference<Mesh> loadMesh(const Util::FileName & url, const std::string & processingOptions = "",
+										const Processing_t & processing = Processing_t());
+
+		/*! Set the directory of the local file system used for storing processed meshes.
+			An empty path disables the on-disk cache (default).	*/
+		void setCacheDirectory(const std::string & path);
+		std::string getCacheDirectory() const;
+
+		//! Remove the shared meshes that are not referenced outside the cache.
+		//! \return the number of removed meshes
+		size_t removeUnusedMeshes();
+		//! Remove all shared meshes and reset the counters.
+		void clear();
+
+		//! Number of shared meshes.
+		size_t getMeshCount() const;
+		//! Number of meshes replaced by a shared instance.
+		size_t getSharedCount() const;
+		//! Number of meshes loaded from the cache directory.
+		size_t getCacheFileCount() const;
+
+	private:
+		/*! Return the cache file for the source file content and options, or an empty string if there is no cache directory.
+			\param sourceKey Set to the identity of the source content and options, which is stored next to the cache file.	*/
+		std::string getCacheFile(const Util::FileName & url, const std::string & processingOptions, std::string & sourceKey) const;
+
+		mutable std::mutex mutex;
+		std::unordered_map<uint32_t, std::vector<Util::Reference<Mesh>>> meshes; //!< content hash -> meshes
+		std::string cacheDirectory;
+		size_t meshCount;
+		size_t sharedCount;
+		size_t cacheFileCount;
+};
+
+}
+}
+
+#endif /* RENDERING_MESHCACHE_H_ */
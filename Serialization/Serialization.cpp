@@ -83,6 +83,14 @@ Mesh * loadMesh(const Util::FileName & url) {
 		WARN("Unsupported file extension \"" + url.getEnding() + "\".");
 		return nullptr;
 	}
+	// local .mmf-files are memory mapped to avoid copying the data
+	if(dynamic_cast<StreamerMMF *>(loader.get()) != nullptr && (url.getFSName().empty() || url.getFSName() == "file")) {
+		Mesh * mesh = StreamerMMF::loadMeshMapped(url.getPath());
+		if(mesh != nullptr) {
+			mesh->setFileName(url);
+			return mesh;
+		}
+	}
 	auto stream = Util::FileUtils::openForReading(url);
 	if(!stream) {
 		WARN("Error opening stream for reading. Path: " + url.toString());
@@ -243,12 +251,22 @@ Util::GenericAttributeList * loadGeneric(const Util::FileName & url) {
 		WARN("Unsupported file extension \"" + url.getEnding() + "\".");
 		return nullptr;
 	}
-	auto stream = Util::FileUtils::openForReading(url);
-	if(!stream) {
-		WARN("Error opening stream for reading. Path: " + url.toString());
-		return nullptr;
+	Util::GenericAttributeList * descList = nullptr;
+	// local .obj- and .xyz-files are memory mapped to avoid copying the data
+	if(url.getFSName().empty() || url.getFSName() == "file") {
+		if(auto objLoader = dynamic_cast<StreamerOBJ *>(loader.get()))
+			descList = objLoader->loadGenericMapped(url.getPath());
+		else if(auto xyzLoader = dynamic_cast<StreamerXYZ *>(loader.get()))
+			descList = xyzLoader->loadGenericMapped(url.getPath());
+	}
+	if(descList == nullptr) {
+		auto stream = Util::FileUtils::openForReading(url);
+		if(!stream) {
+			WARN("Error opening stream for reading. Path: " + url.toString());
+			return nullptr;
+		}
+		descList = loader->loadGeneric(*stream);
 	}
-	Util::GenericAttributeList * descList = loader->loadGeneric(*stream);
 	for (const auto & elem : *descList) {
 		Util::GenericAttributeMap * desc = dynamic_cast<Util::GenericAttributeMap *>(elem.get());
 		if(desc->getValue(DESCRIPTION_FILE) == nullptr) {
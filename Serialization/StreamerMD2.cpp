@@ -12,9 +12,12 @@
 #include "Serialization.h"
 #include "../Mesh/VertexAttributeIds.h"
 #include "../Mesh/VertexDescription.h"
+#include "../MeshUtils/CompactKeyFrames.h"
 #include "../MeshUtils/MeshUtils.h"
 #include <Geometry/Matrix4x4.h>
 #include <Util/GenericAttribute.h>
+#include <limits>
+#include <vector>
 
 using namespace Util;
 using namespace std;
@@ -29,6 +32,7 @@ const char * const StreamerMD2::DESCRIPTION_TYPE_KEYFRAME_ANIMATION = "keyFrameA
 const Util::StringIdentifier StreamerMD2::DESCRIPTION_TEXTURE_FILES("textureFiles");
 const Util::StringIdentifier StreamerMD2::DESCRIPTION_MESH_INDEX_DATA("meshIndexData");
 const Util::StringIdentifier StreamerMD2::DESCRIPTION_KEYFRAMES_DATA("meshFrameData");
+const Util::StringIdentifier StreamerMD2::DESCRIPTION_COMPACT_KEYFRAMES_DATA("compactKeyFrames");
 
 const Util::StringIdentifier StreamerMD2::DESCRIPTION_ANIMATIONS("animations");
 /*
@@ -211,7 +215,7 @@ const float StreamerMD2::normals[162][3] =
 
 
 StreamerMD2::StreamerMD2() :
-	AbstractRenderingStreamer() {
+	AbstractRenderingStreamer(), storeFullFrames(false) {
 	//init animation fps data
 	standardAnimationFps.insert(make_pair("stand", 9));
 	standardAnimationFps.insert(make_pair("run", 10));
@@ -237,42 +241,52 @@ StreamerMD2::StreamerMD2() :
 
 Util::GenericAttributeList * StreamerMD2::loadGeneric(std::istream & input) {
 
-	auto md2Header = new MD2Header;
+	MD2Header md2Header;
 
-	input.read(reinterpret_cast<char *>(md2Header), sizeof(MD2Header));
+	input.read(reinterpret_cast<char *>(&md2Header), sizeof(MD2Header));
 
-	if( (md2Header->magic != MD2IDENT) && (md2Header->version != MD2VERSION) )
+	if( (md2Header.magic != MD2IDENT) && (md2Header.version != MD2VERSION) )
 	{
 		WARN("Not a valid *.md2 model file!");
 		return nullptr;
 	}
 
-	auto md2Triangles = new MD2Triangle[md2Header->numTriangles];
-	auto md2TexCoords = new MD2TexCoord[md2Header->numTexCoords];
-	auto md2Skins = new MD2Skin[md2Header->numSkins];
-	auto md2Frames = new MD2Frame[md2Header->numFrames];
-	auto md2FrameData = new MD2FrameData[md2Header->numFrames];
+	std::vector<MD2Triangle> md2Triangles(md2Header.numTriangles);
+	std::vector<MD2TexCoord> md2TexCoords(md2Header.numTexCoords);
+	std::vector<MD2Skin> md2Skins(md2Header.numSkins);
+	std::vector<MD2Frame> md2Frames(md2Header.numFrames);
+	std::vector<std::vector<MD2Vertex>> md2FrameVertices(md2Header.numFrames);
 
 	//frame data
-	input.seekg(md2Header->offsetFrames);
-	for(int i = 0; i < md2Header->numFrames; ++i)
+	input.seekg(md2Header.offsetFrames);
+	for(int i = 0; i < md2Header.numFrames; ++i)
 	{
 		input.read(reinterpret_cast<char *>(&md2Frames[i]), sizeof(MD2Frame));
-		md2FrameData[i].pVertices = new MD2Vertex[md2Header->numVertices];
-		input.read(reinterpret_cast<char *>(md2FrameData[i].pVertices), sizeof( MD2Vertex ) * md2Header->numVertices);
+		md2FrameVertices[i].resize(md2Header.numVertices);
+		input.read(reinterpret_cast<char *>(md2FrameVertices[i].data()), sizeof( MD2Vertex ) * md2Header.numVertices);
 	}
 
 	//skins
-	input.seekg(md2Header->offsetSkins);
-	input.read(reinterpret_cast<char *>(md2Skins), sizeof(MD2Skin) * md2Header->numSkins);
+	input.seekg(md2Header.offsetSkins);
+	input.read(reinterpret_cast<char *>(md2Skins.data()), sizeof(MD2Skin) * md2Header.numSkins);
 
 	//tex coords
-	input.seekg(md2Header->offsetTexCoords);
-	input.read(reinterpret_cast<char *>(md2TexCoords), sizeof(MD2TexCoord) * md2Header->numTexCoords);
+	input.seekg(md2Header.offsetTexCoords);
+	input.read(reinterpret_cast<char *>(md2TexCoords.data()), sizeof(MD2TexCoord) * md2Header.numTexCoords);
 
 	//triangles
-	input.seekg(md2Header->offsetTriangles);
-	input.read(reinterpret_cast<char *>(md2Triangles), sizeof(MD2Triangle) * md2Header->numTriangles);
+	input.seekg(md2Header.offsetTriangles);
+	input.read(reinterpret_cast<char *>(md2Triangles.data()), sizeof(MD2Triangle) * md2Header.numTriangles);
+
+	for(const auto & triangle : md2Triangles) {
+		for(int nVertex=0; nVertex < 3; ++nVertex) {
+			if(static_cast<uint16_t>(triangle.vertexIndices[nVertex]) >= md2Header.numVertices
+					|| static_cast<uint16_t>(triangle.textureIndices[nVertex]) >= md2Header.numTexCoords) {
+				WARN("Invalid vertex index in *.md2 model file!");
+				return nullptr;
+			}
+		}
+	}
 
 	auto description = new Util::GenericAttributeMap;
 
@@ -280,17 +294,17 @@ Util::GenericAttributeList * StreamerMD2::loadGeneric(std::istream & input) {
 
 	//texture files
 	std::vector<std::string> textureFiles;
-	for (int i = 0; i < md2Header->numSkins; i++) {
+	for (int i = 0; i < md2Header.numSkins; i++) {
 		textureFiles.push_back(md2Skins[i].path);
 	}
 	description->setValue(DESCRIPTION_TEXTURE_FILES, new StreamerMD2::textureFilesWrapper(textureFiles));
 
 	//index data
 	MeshIndexData indexData;
-	indexData.allocate(md2Header->numTriangles *3);
+	indexData.allocate(md2Header.numTriangles *3);
 	{
 		uint32_t nVertex=0;
-		for(int nTriangle=0; nTriangle < md2Header->numTriangles; nTriangle++) {
+		for(int nTriangle=0; nTriangle < md2Header.numTriangles; nTriangle++) {
 			 //reversed order
 			indexData[nVertex+0] = nVertex+2;
 			indexData[nVertex+1] = nVertex+1;
@@ -301,8 +315,8 @@ Util::GenericAttributeList * StreamerMD2::loadGeneric(std::istream & input) {
 	indexData.updateIndexRange();
 	description->setValue(DESCRIPTION_MESH_INDEX_DATA, new StreamerMD2::indexDataWrapper(indexData));
 
-	float dSkinResX = static_cast<float>(md2Header->skinWidth);
-	float dSkinResY = static_cast<float>(md2Header->skinHeight);
+	float dSkinResX = static_cast<float>(md2Header.skinWidth);
+	float dSkinResY = static_cast<float>(md2Header.skinHeight);
 
 	VertexDescription vertexDescription;
 	vertexDescription.appendPosition3D();
@@ -311,18 +325,37 @@ Util::GenericAttributeList * StreamerMD2::loadGeneric(std::istream & input) {
 
 	//keyframe data
 	auto framesData = new StreamerMD2::framesDataWrapper();
-	framesData->ref().resize( md2Header->numFrames);
+	if(storeFullFrames)
+		framesData->ref().resize( md2Header.numFrames);
+
+	// the corners of the triangles are animated by the md2 vertices; the md2 vertices
+	// that are not referenced by a triangle are skipped, so the keyframe vertices are numbered
+	// in the order of their first use
+	static const uint32_t UNUSED = std::numeric_limits<uint32_t>::max();
+	std::vector<uint32_t> keyVertexOfMD2Vertex(md2Header.numVertices, UNUSED);
+	std::vector<uint32_t> keyVertexIndices;
+	keyVertexIndices.reserve(md2Header.numTriangles * 3);
+	uint32_t keyVertexCount = 0;
+	for(int nTriangle=0; nTriangle < md2Header.numTriangles; nTriangle++) {
+		for(int nVertex=0; nVertex < 3; ++nVertex) {
+			uint32_t & keyVertex = keyVertexOfMD2Vertex[static_cast<uint16_t>(md2Triangles[nTriangle].vertexIndices[nVertex])];
+			if(keyVertex == UNUSED)
+				keyVertex = keyVertexCount++;
+			keyVertexIndices.push_back(keyVertex);
+		}
+	}
+	Util::Reference<MeshUtils::CompactKeyFrames> compactFrames;
 
-	for(int nFrame=0; nFrame < md2Header->numFrames; nFrame++) {
+	for(int nFrame=0; nFrame < md2Header.numFrames; nFrame++) {
 		MeshVertexData vData;
-		vData.allocate(md2Header->numTriangles * 3, vertexDescription);
+		vData.allocate(md2Header.numTriangles * 3, vertexDescription);
 		float * vertexData = reinterpret_cast<float *> (vData.data());
 
-		for(int nTriangle=0; nTriangle < md2Header->numTriangles; nTriangle++) {
+		for(int nTriangle=0; nTriangle < md2Header.numTriangles; nTriangle++) {
 			for(int nVertex=0; nVertex < 3; ++nVertex){
 				const short vertexIndex = md2Triangles[nTriangle].vertexIndices[nVertex];
 
-				MD2Vertex curVertex = md2FrameData[nFrame].pVertices[vertexIndex];
+				MD2Vertex curVertex = md2FrameVertices[nFrame][vertexIndex];
 
 				//geom
 				*vertexData = curVertex.vertex[0] * md2Frames[nFrame].scale[0] + md2Frames[nFrame].translate[0];
@@ -359,12 +392,18 @@ Util::GenericAttributeList * StreamerMD2::loadGeneric(std::istream & input) {
 		transMat.rotate_deg(90, Geometry::Vec3(0, 0, 1));
 		MeshUtils::transform(vData,transMat);
 
-		framesData->ref()[nFrame].swap(vData);
+		if(compactFrames.isNull())
+			compactFrames = new MeshUtils::CompactKeyFrames(MeshVertexData(vData), keyVertexIndices);
+		compactFrames->addFrame(vData);
+		if(storeFullFrames)
+			framesData->ref()[nFrame].swap(vData);
 	}
 	description->setValue(DESCRIPTION_KEYFRAMES_DATA, framesData);
+	if(compactFrames.isNotNull())
+		description->setValue(DESCRIPTION_COMPACT_KEYFRAMES_DATA, new StreamerMD2::compactFramesWrapper(compactFrames));
 
 	//animations
-	description->setValue(DESCRIPTION_ANIMATIONS, new StreamerMD2::animationDataWrapper(extractAnimationData(md2Header, md2Frames)));
+	description->setValue(DESCRIPTION_ANIMATIONS, new StreamerMD2::animationDataWrapper(extractAnimationData(&md2Header, md2Frames.data())));
 
 	auto descriptionList = new Util::GenericAttributeList;
 	descriptionList->push_back(description);
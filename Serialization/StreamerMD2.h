@@ -12,6 +12,7 @@
 #define LoaderMD2_H
 
 #include "AbstractRenderingStreamer.h"
+#include <Util/References.h>
 #include <Util/StringIdentifier.h>
 #include <map>
 #include <vector>
@@ -23,6 +24,9 @@ template<typename Type> class WrapperAttribute;
 namespace Rendering {
 class MeshIndexData;
 class MeshVertexData;
+namespace MeshUtils {
+class CompactKeyFrames;
+}
 namespace Serialization {
 
 struct MD2Header
@@ -92,12 +96,15 @@ class StreamerMD2 : public AbstractRenderingStreamer {
 		typedef Util::WrapperAttribute<MeshIndexData> indexDataWrapper;
 		typedef Util::WrapperAttribute<std::vector<MeshVertexData> > framesDataWrapper;
 		typedef Util::WrapperAttribute<std::map<std::string, std::vector<int> > > animationDataWrapper;
+		typedef Util::WrapperAttribute<Util::Reference<MeshUtils::CompactKeyFrames> > compactFramesWrapper;
 
 		//additional descriptions
 		static const char * const DESCRIPTION_TYPE_KEYFRAME_ANIMATION;
 		static const Util::StringIdentifier DESCRIPTION_TEXTURE_FILES;
 		static const Util::StringIdentifier DESCRIPTION_MESH_INDEX_DATA;
 		static const Util::StringIdentifier DESCRIPTION_KEYFRAMES_DATA;
+		//! The frames as MeshUtils::CompactKeyFrames (see compactFramesWrapper); always present.
+		static const Util::StringIdentifier DESCRIPTION_COMPACT_KEYFRAMES_DATA;
 
 		static const Util::StringIdentifier DESCRIPTION_ANIMATIONS;
 		/*
@@ -128,6 +135,12 @@ class StreamerMD2 : public AbstractRenderingStreamer {
 
 		Util::GenericAttributeList * loadGeneric(std::istream & input) override;
 
+		/*! If true, DESCRIPTION_KEYFRAMES_DATA additionally contains the full vertex data of
+			every frame. Otherwise, it is empty and only the compact frames
+			(DESCRIPTION_COMPACT_KEYFRAMES_DATA) are loaded (default: false). */
+		void setStoreFullFrames(bool b)						{	storeFullFrames = b;	}
+		bool getStoreFullFrames() const						{	return storeFullFrames;	}
+
 		static uint8_t queryCapabilities(const std::string & extension);
 		static const char * const fileExtension;
 
@@ -136,6 +149,7 @@ class StreamerMD2 : public AbstractRenderingStreamer {
 		std::map<std::string, std::vector<int> > extractAnimationData(MD2Header * md2Header, MD2Frame * md2Frames);
 		int getFpsByAnimationName(const std::string & name);
 		std::map<std::string, int> standardAnimationFps;
+		bool storeFullFrames;
 
 
 };
@@ -9,12 +9,22 @@
 	file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
 */
 #include "StreamerMMF.h"
+#include "BlockCompression.h"
+#include "MappedFile.h"
 #include "Serialization.h"
 #include "../Mesh/Mesh.h"
+#include "../Mesh/VertexAttributeAccessors.h"
 #include "../Mesh/VertexAttributeIds.h"
 #include "../Mesh/VertexDescription.h"
+#include "../MeshUtils/MeshUtils.h"
+#include "../GLHeader.h"
+#include "../Helper.h"
 #include <Util/GenericAttribute.h>
+#include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
 #include <vector>
 
 /// \todo Show compile error when using a machine without LITTLE-ENDIANness
@@ -26,24 +36,102 @@ namespace Serialization {
 const char * const StreamerMMF::fileExtension = "mmf";
 
 uint32_t StreamerMMF::Reader::read_uint32() {
-	uint32_t x;
-	in.read(reinterpret_cast<char *> (&x), 4);
+	uint32_t x = MMF_END;
+	read(reinterpret_cast<uint8_t *> (&x), 4);
+	return x;
+}
+
+uint64_t StreamerMMF::Reader::read_uint64() {
+	uint64_t x = 0;
+	read(reinterpret_cast<uint8_t *> (&x), 8);
 	return x;
 }
 
 void StreamerMMF::Reader::read(uint8_t * data,size_t count) {
-	in.read(reinterpret_cast<char *> (data), count);
+	if(failed || count > size - position) {
+		failed = true;
+	} else if(in != nullptr) {
+		in->read(reinterpret_cast<char *> (data), count);
+		failed = !in->good();
+		position += count;
+	} else if(count > 0) {
+		std::memcpy(data, memory.get() + position, count);
+		position += count;
+	}
+}
+
+void StreamerMMF::Reader::skip(size_t count) {
+	if(failed || count > size - position) {
+		failed = true;
+	} else if(in != nullptr) {
+		in->seekg(count, std::ios_base::cur);
+		failed = !in->good();
+		position += count;
+	} else {
+		position += count;
+	}
 }
 
-void StreamerMMF::Reader::skip(uint32_t size) {
-	in.seekg(std::ios_base::cur+size);
+std::shared_ptr<uint8_t> StreamerMMF::Reader::reference(size_t count, size_t alignment) {
+	if(in != nullptr || failed || count > size - position ||
+			reinterpret_cast<uintptr_t>(memory.get() + position) % alignment != 0) {
+		return nullptr;
+	}
+	std::shared_ptr<uint8_t> data(memory, memory.get() + position);
+	position += count;
+	return data;
 }
 
 //!	(static)
 Mesh * StreamerMMF::loadMesh(std::istream & input) {
+	Reader reader(input);
+	return readMesh(reader);
+}
 
-//	std::cout << "\nloadMMF...";
+//!	(static)
+Mesh * StreamerMMF::loadMeshMapped(const std::string & path) {
+	std::shared_ptr<MappedFile> file = MappedFile::open(path);
+	if(!file)
+		return nullptr;
+	return loadMeshFromMemory(MappedFile::getMemory(file, 0), file->size());
+}
+
+//!	(static)
+Mesh * StreamerMMF::loadMeshFromMemory(std::shared_ptr<uint8_t> data, size_t size) {
+	Reader reader(std::move(data), size);
+	Util::Reference<Mesh> mesh = readMesh(reader);
+	if(!reader.good())
+		return nullptr;
+	return mesh.detachAndDecrease();
+}
+
+//!	(static)
+bool StreamerMMF::readSubMeshes(std::istream & input, std::vector<SubMesh> & subMeshes) {
 	Reader reader(input);
+	std::vector<Chunk> chunks;
+	if(reader.read_uint32() != MMF_HEADER || reader.read_uint32() < 0x02 || !readDirectory(reader, chunks))
+		return false;
+	for(const auto & chunk : chunks) {
+		if(chunk.type == MMF_SUBMESH_DATA) {
+			subMeshes.clear();
+			return readChunk(reader, chunk, [&subMeshes](Reader & in) { readSubMeshData(subMeshes, in); });
+		}
+	}
+	return false;
+}
+
+//!	(static)
+Mesh * StreamerMMF::loadSubMesh(std::istream & input, uint32_t subMeshIndex) {
+	Reader reader(input);
+	Util::Reference<Mesh> mesh = readMesh(reader, subMeshIndex);
+	if(!reader.good())
+		return nullptr;
+	return mesh.detachAndDecrease();
+}
+
+//!	(internal,static)
+Mesh * StreamerMMF::readMesh(Reader & reader, uint32_t subMeshIndex) {
+	static const std::string warningPrefix("LoaderMMF::loadMesh: ");
 
 	uint32_t format = reader.read_uint32();
 	if(format!=MMF_HEADER)    {
@@ -55,18 +143,88 @@ Mesh * StreamerMMF::loadMesh(std::istream & input) {
 		WARN(std::string("can't read mesh, version to high: ") + Util::StringUtils::toString(version));
 		return nullptr;
 	}
+	if(version < 0x02) {
+		if(subMeshIndex != WHOLE_MESH) {
+			WARN(warningPrefix + "no sub-meshes in version 1 files.");
+			return nullptr;
+		}
+		return readBlocks(reader);
+	}
+
+	std::vector<Chunk> chunks;
+	if(!readDirectory(reader, chunks)) {
+		WARN(warningPrefix + "invalid chunk directory.");
+		return nullptr;
+	}
+	Util::Reference<Mesh> mesh = new Mesh;
+	std::vector<SubMesh> subMeshes;
+	const SubMesh * part = nullptr;
+	for(const auto & chunk : chunks) {
+		bool success = true;
+		switch(chunk.type) {
+			case StreamerMMF::MMF_SUBMESH_DATA:
+				if(subMeshIndex == WHOLE_MESH)
+					continue;
+				success = readChunk(reader, chunk, [&subMeshes](Reader & in) { readSubMeshData(subMeshes, in); });
+				if(!success)
+					break;
+				if(subMeshIndex >= subMeshes.size()) {
+					WARN(warningPrefix + "invalid sub-mesh " + Util::StringUtils::toString(subMeshIndex));
+					reader.failed = true;
+					return nullptr;
+				}
+				part = &subMeshes[subMeshIndex];
+				break;
+			case StreamerMMF::MMF_VERTEX_DATA:
+			case StreamerMMF::MMF_INDEX_DATA:
+			case StreamerMMF::MMF_PACKED_INDEX_DATA:
+				if(subMeshIndex != WHOLE_MESH && part == nullptr) {
+					WARN(warningPrefix + "no sub-mesh table found before the mesh data.");
+					return nullptr;
+				}
+				success = readChunk(reader, chunk, [&](Reader & in) {
+					if(chunk.type == StreamerMMF::MMF_VERTEX_DATA)
+						readVertexData(mesh.get(), in, version, part);
+					else
+						readIndexData(mesh.get(), in, chunk.type == StreamerMMF::MMF_PACKED_INDEX_DATA, part);
+				});
+				break;
+			default:
+				WARN(warningPrefix + "unknown chunk found.");
+				continue;
+		}
+		if(!success) {
+			WARN(warningPrefix + "invalid chunk found.");
+			reader.failed = true;
+			return nullptr;
+		}
+	}
+	if(subMeshIndex != WHOLE_MESH && part == nullptr) {
+		WARN(warningPrefix + "no sub-mesh table found.");
+		return nullptr;
+	}
+	return mesh.detachAndDecrease();
+}
+
+//!	(internal,static)
+Mesh * StreamerMMF::readBlocks(Reader & reader) {
+
+//	std::cout << "\nloadMMF...";
 
 	auto mesh = new Mesh;
 	uint32_t blockType = reader.read_uint32();
-	while(blockType != StreamerMMF::MMF_END && input.good()) {
+	while(blockType != StreamerMMF::MMF_END && reader.good()) {
 		// blocksize is discarded.
 		uint32_t blockSize = reader.read_uint32();
 		switch(blockType) {
 			case StreamerMMF::MMF_VERTEX_DATA:
-				readVertexData(mesh, reader);
+				readVertexData(mesh, reader, 0x01);
 				break;
 			case StreamerMMF::MMF_INDEX_DATA:
-				readIndexData(mesh, reader);
+				readIndexData(mesh, reader, false);
+				break;
+			case StreamerMMF::MMF_PACKED_INDEX_DATA:
+				readIndexData(mesh, reader, true);
 				break;
 			default:
 				WARN("LoaderMMF::loadMesh: unknown data block found.");
@@ -82,7 +240,89 @@ Mesh * StreamerMMF::loadMesh(std::istream & input) {
 }
 
 //!	(internal,static)
-void StreamerMMF::readVertexData(Mesh * mesh, Reader & in) {
+bool StreamerMMF::readDirectory(Reader & in, std::vector<Chunk> & chunks) {
+	const uint32_t chunkCount = in.read_uint32();
+	in.read_uint32(); // reserved
+	if(!in.good() || chunkCount > in.size / (4 * sizeof(uint64_t)))
+		return false;
+	uint64_t end = 4 * sizeof(uint32_t) + static_cast<uint64_t>(chunkCount) * 4 * sizeof(uint64_t);
+	for(uint32_t i = 0; i < chunkCount && in.good(); ++i) {
+		Chunk chunk;
+		chunk.type = in.read_uint32();
+		chunk.compression = in.read_uint32();
+		chunk.offset = in.read_uint64();
+		chunk.storedSize = in.read_uint64();
+		chunk.size = in.read_uint64();
+		// the chunks are read one after another
+		if(chunk.offset < end || chunk.storedSize > UINT64_MAX - chunk.offset)
+			return false;
+		end = chunk.offset + chunk.storedSize;
+		chunks.push_back(chunk);
+	}
+	return in.good();
+}
+
+//!	(internal,static)
+bool StreamerMMF::readChunk(Reader & in, const Chunk & chunk, const std::function<void (Reader &)> & parse) {
+	if(chunk.offset < in.position || chunk.offset - in.position > in.size - in.position ||
+			chunk.storedSize > in.size - chunk.offset || chunk.storedSize > SIZE_MAX || chunk.size > SIZE_MAX) {
+		return false;
+	}
+	in.skip(static_cast<size_t>(chunk.offset - in.position));
+	if(!in.good())
+		return false;
+
+	if(chunk.compression == MMF_COMPRESSION_NONE) {
+		if(chunk.size != chunk.storedSize)
+			return false;
+		// the chunk is read directly from the underlying stream or memory
+		Reader chunkReader(in);
+		chunkReader.size = chunk.offset + chunk.storedSize;
+		parse(chunkReader);
+		if(!chunkReader.good())
+			return false;
+		if(in.in != nullptr) {
+			chunkReader.skip(chunkReader.size - chunkReader.position);
+			if(!chunkReader.good())
+				return false;
+		}
+		in.position = chunkReader.size;
+		return true;
+	} else if(chunk.compression == MMF_COMPRESSION_LZ4) {
+		// an LZ4 block is at most 255 times smaller than the data
+		if(chunk.size / 255 > chunk.storedSize)
+			return false;
+		const size_t size = static_cast<size_t>(chunk.size);
+		std::shared_ptr<uint8_t> data(new uint8_t[size], std::default_delete<uint8_t[]>());
+		std::vector<uint8_t> frameBuffer;
+		const size_t end = in.position + static_cast<size_t>(chunk.storedSize);
+		size_t decoded = 0;
+		while(decoded < size) {
+			const uint32_t frameSize = in.read_uint32();
+			const uint32_t compressedSize = in.read_uint32();
+			if(!in.good() || frameSize > size - decoded || in.position > end || compressedSize > end - in.position)
+				return false;
+			std::shared_ptr<uint8_t> frame = in.reference(compressedSize, 1);
+			if(!frame) {
+				frameBuffer.resize(compressedSize);
+				in.read(frameBuffer.data(), compressedSize);
+			}
+			if(!in.good() || !BlockCompression::decompress(frame ? frame.get() : frameBuffer.data(), compressedSize, data.get() + decoded, frameSize))
+				return false;
+			decoded += frameSize;
+		}
+		if(in.position != end)
+			return false;
+		Reader chunkReader(std::move(data), size);
+		parse(chunkReader);
+		return chunkReader.good();
+	}
+	WARN("LoaderMMF::loadMesh: unknown compression.");
+	return false;
+}
+
+//!	(internal,static)
+void StreamerMMF::readVertexData(Mesh * mesh, Reader & in, uint32_t version, const SubMesh * part) {
 	static const std::string warningPrefix("LoaderMMF::readVertexData: ");
 
 	VertexDescription vd;
@@ -129,12 +369,12 @@ void StreamerMMF::readVertexData(Mesh * mesh, Reader & in) {
 		}
 
 
-		while(extLength >= 8) {
+		while(extLength >= 8 && in.good()) {
 			uint32_t extBlockType=in.read_uint32();
 			uint32_t extBlockSize=in.read_uint32();
 			extLength-=8;
 
-			if(extLength>extBlockSize) {
+			if(extBlockSize>extLength) {
 				WARN(warningPrefix+"Error in vertex block");
 				FAIL();
 			}
@@ -161,19 +401,55 @@ void StreamerMMF::readVertexData(Mesh * mesh, Reader & in) {
 //        vd.setData(index, numValues, glType);
 
 	}
-	const uint32_t count = in.read_uint32();
+	uint32_t count = in.read_uint32();
+	if(version >= 0x02)
+		in.skip(in.read_uint32()); // padding
+	if(part != nullptr) {
+		if(part->minIndex > part->maxIndex || part->maxIndex >= count) {
+			WARN(warningPrefix+"Invalid sub-mesh.");
+			in.failed = true;
+		}
+		in.skip(static_cast<size_t>(part->minIndex) * vd.getVertexSize());
+		count = part->maxIndex - part->minIndex + 1;
+	}
+	if(static_cast<size_t>(vd.getVertexSize()) * count > in.size - in.position)
+		in.failed = true;
+	if(!in.good())
+		return;
 	MeshVertexData & vertices = mesh->openVertexData();
-	vertices.allocate(count,vd);
 
-	in.read( vertices.data(), vertices.dataSize());
+	// reference mapped data directly if the values are aligned
+	size_t alignment = 1;
+	for(const auto & attr : vd.getAttributes())
+		alignment = std::max<size_t>(alignment, getGLTypeSize(attr.getDataType()));
+	std::shared_ptr<uint8_t> memory = in.reference(static_cast<size_t>(vd.getVertexSize()) * count, alignment);
+	if(memory) {
+		vertices.setExternalData(count, vd, std::move(memory));
+	} else {
+		vertices.allocate(count, vd, false);
+		in.read( vertices.data(), vertices.dataSize());
+	}
 
 	vertices.updateBoundingBox();
 }
 
 //!	(internal,static)
-void StreamerMMF::readIndexData(Mesh * mesh, Reader & in) {
-	const uint32_t count = in.read_uint32();
+void StreamerMMF::readIndexData(Mesh * mesh, Reader & in, bool packed, const SubMesh * part) {
+	uint32_t count = in.read_uint32();
 	const uint32_t triangleMode = in.read_uint32();
+	const uint32_t indexType = packed ? in.read_uint32() : GL_UNSIGNED_INT;
+	if(part != nullptr) {
+		if(part->firstIndex > count || part->indexCount > count - part->firstIndex) {
+			WARN("LoaderMMF::readIndexData: Invalid sub-mesh.");
+			in.failed = true;
+		}
+		in.skip(static_cast<size_t>(part->firstIndex) * getGLTypeSize(indexType));
+		count = part->indexCount;
+	}
+	if(static_cast<size_t>(getGLTypeSize(indexType)) * count > in.size - in.position)
+		in.failed = true;
+	if(!in.good())
+		return;
 	mesh->setGLDrawMode(triangleMode);
 
 	// As the use of index data is not stored explicitly in a .mmf-file,
@@ -183,13 +459,51 @@ void StreamerMMF::readIndexData(Mesh * mesh, Reader & in) {
 	}else{
 		mesh->setUseIndexData(true);
 		MeshIndexData & indices=mesh->openIndexData();
-		indices.allocate(count);
-
-		in.read(reinterpret_cast<uint8_t*>(indices.data()), indices.dataSize());
+		std::shared_ptr<uint8_t> memory;
+		if(indexType == GL_UNSIGNED_INT && part == nullptr)
+			memory = in.reference(count * sizeof(uint32_t), sizeof(uint32_t));
+
+		if(memory) {
+			indices.setExternalData(count, std::shared_ptr<uint32_t>(memory, reinterpret_cast<uint32_t *>(memory.get())));
+		} else if(indexType == GL_UNSIGNED_INT) {
+			indices.allocate(count, false);
+			in.read(reinterpret_cast<uint8_t*>(indices.data()), indices.dataSize());
+		} else {
+			indices.allocate(count, false);
+			const uint32_t indexSize = getGLTypeSize(indexType);
+			std::vector<uint8_t> packedIndices((count * indexSize + 3) / 4 * 4); // including the padding
+			in.read(packedIndices.data(), part == nullptr ? packedIndices.size() : count * indexSize);
+			indices.readPacked(indexType, packedIndices.data());
+			indices.setIndexType(indexType);
+		}
+		if(part != nullptr) {
+			// make the indices relative to the sub-mesh's vertices
+			for(uint32_t i = 0; i < count; ++i)
+				indices[i] -= part->minIndex;
+		}
 		indices.updateIndexRange();
 	}
 }
 
+//!	(internal,static)
+void StreamerMMF::readSubMeshData(std::vector<SubMesh> & subMeshes, Reader & in) {
+	const uint32_t count = in.read_uint32();
+	if(!in.good() || count > (in.size - in.position) / (10 * sizeof(uint32_t))) {
+		in.failed = true;
+		return;
+	}
+	subMeshes.resize(count);
+	for(auto & subMesh : subMeshes) {
+		subMesh.firstIndex = in.read_uint32();
+		subMesh.indexCount = in.read_uint32();
+		subMesh.minIndex = in.read_uint32();
+		subMesh.maxIndex = in.read_uint32();
+		float bounds[6];
+		in.read(reinterpret_cast<uint8_t *>(bounds), sizeof(bounds));
+		subMesh.bounds = Geometry::Box(bounds[0], bounds[3], bounds[1], bounds[4], bounds[2], bounds[5]);
+	}
+}
+
 //! ---|> GenericLoader
 Util::GenericAttributeList * StreamerMMF::loadGeneric(std::istream & input) {
 	Mesh * m = loadMesh(input);
@@ -202,15 +516,113 @@ Util::GenericAttributeList * StreamerMMF::loadGeneric(std::istream & input) {
 	return l;
 }
 
-//!	(static)
+//! Data of a chunk to be saved: a header followed by data that is not copied.
+struct SaveChunk {
+	uint32_t type;
+	std::string header;
+	const uint8_t * data;
+	size_t dataSize;
+	uint32_t compression;
+	std::vector<uint8_t> compressedData;
+
+	SaveChunk(uint32_t _type, std::string _header, const uint8_t * _data, size_t _dataSize) :
+		type(_type), header(std::move(_header)), data(_data), dataSize(_dataSize), compression(StreamerMMF::MMF_COMPRESSION_NONE) {}
+
+	size_t getSize() const			{	return header.size() + dataSize;	}
+	size_t getStoredSize() const	{	return compression == StreamerMMF::MMF_COMPRESSION_NONE ? getSize() : compressedData.size();	}
+
+	static void append(std::vector<uint8_t> & out, uint32_t x) {
+		const uint8_t * bytes = reinterpret_cast<const uint8_t *>(&x);
+		out.insert(out.end(), bytes, bytes + 4);
+	}
+
+	//! Compress the data in frames; the data is kept uncompressed if the size is not reduced.
+	void compress() {
+		std::vector<uint8_t> raw(header.begin(), header.end());
+		raw.insert(raw.end(), data, data + dataSize);
+		std::vector<uint8_t> frames;
+		for(size_t offset = 0; offset < raw.size() && frames.size() < raw.size(); offset += StreamerMMF::MMF_FRAME_SIZE) {
+			const size_t frameSize = std::min<size_t>(StreamerMMF::MMF_FRAME_SIZE, raw.size() - offset);
+			const std::vector<uint8_t> frame = BlockCompression::compress(raw.data() + offset, frameSize);
+			append(frames, static_cast<uint32_t>(frameSize));
+			append(frames, static_cast<uint32_t>(frame.size()));
+			frames.insert(frames.end(), frame.begin(), frame.end());
+		}
+		if(frames.size() < raw.size()) {
+			compression = StreamerMMF::MMF_COMPRESSION_LZ4;
+			compressedData.swap(frames);
+		}
+	}
+
+	void write(std::ostream & out) const {
+		if(compression == StreamerMMF::MMF_COMPRESSION_NONE) {
+			out.write(header.c_str(), header.size());
+			out.write(reinterpret_cast<const char *>(data), dataSize);
+		} else {
+			out.write(reinterpret_cast<const char *>(compressedData.data()), compressedData.size());
+		}
+	}
+};
+
+static uint64_t alignChunk(uint64_t offset) {
+	return (offset + StreamerMMF::MMF_CHUNK_ALIGNMENT - 1) / StreamerMMF::MMF_CHUNK_ALIGNMENT * StreamerMMF::MMF_CHUNK_ALIGNMENT;
+}
+
+//! Split the triangles into groups of @p triangleCount triangles.
+static std::vector<StreamerMMF::SubMesh> createSubMeshes(Mesh * mesh, uint32_t triangleCount) {
+	std::vector<StreamerMMF::SubMesh> subMeshes;
+	MeshIndexData & indices = mesh->openIndexData();
+	auto positions = PositionAttributeAccessor::create(mesh->openVertexData());
+	const uint32_t groupSize = 3 * triangleCount;
+	for(uint32_t first = 0; first < indices.getIndexCount(); first += groupSize) {
+		StreamerMMF::SubMesh subMesh;
+		subMesh.firstIndex = first;
+		subMesh.indexCount = std::min(groupSize, indices.getIndexCount() - first);
+		const uint32_t * begin = indices.data() + first;
+		const auto minMax = std::minmax_element(begin, begin + subMesh.indexCount);
+		subMesh.minIndex = *minMax.first;
+		subMesh.maxIndex = *minMax.second;
+		subMesh.bounds.invalidate();
+		for(const uint32_t * index = begin; index != begin + subMesh.indexCount; ++index)
+			subMesh.bounds.include(positions->getPosition(*index));
+		subMeshes.push_back(subMesh);
+	}
+	return subMeshes;
+}
+
 bool StreamerMMF::saveMesh(Mesh * mesh, std::ostream & output) {
-	/// Header
-	write(output, MMF_HEADER);
-	write(output, MMF_VERSION);
+	std::vector<SaveChunk> chunks;
 
-	/// VertexData
+	/// SubMeshData
 	MeshVertexData & vertices = mesh->openVertexData();
 	const VertexDescription & vd = vertices.getVertexDescription();
+	const MeshIndexData & indices = mesh->openIndexData();
+	if(subMeshTriangleCount > 0 && mesh->isUsingIndexData() && mesh->getDrawMode() == Mesh::DRAW_TRIANGLES &&
+			indices.getIndexCount() > 0 && vd.hasAttribute(VertexAttributeIds::POSITION)) {
+		std::ostringstream subMeshOut;
+		const std::vector<SubMesh> subMeshes = createSubMeshes(mesh, subMeshTriangleCount);
+		write(subMeshOut, static_cast<uint32_t>(subMeshes.size()));
+		for(const auto & subMesh : subMeshes) {
+			write(subMeshOut, subMesh.firstIndex);
+			write(subMeshOut, subMesh.indexCount);
+			write(subMeshOut, subMesh.minIndex);
+			write(subMeshOut, subMesh.maxIndex);
+			const float bounds[6] = {	subMesh.bounds.getMinX(), subMesh.bounds.getMinY(), subMesh.bounds.getMinZ(),
+										subMesh.bounds.getMaxX(), subMesh.bounds.getMaxY(), subMesh.bounds.getMaxZ()	};
+			subMeshOut.write(reinterpret_cast<const char *>(bounds), sizeof(bounds));
+		}
+		chunks.push_back(SaveChunk(MMF_SUBMESH_DATA, subMeshOut.str(), nullptr, 0));
+	}
+
+	/// VertexData
+	// the file format stores interleaved vertices
+	std::unique_ptr<MeshVertexData> interleavedVertices;
+	if(!vd.isInterleaved()) {
+		VertexDescription interleavedVd(vd);
+		interleavedVd.setInterleaved(true);
+		interleavedVertices.reset(MeshUtils::convertVertices(vertices, interleavedVd));
+	}
+	const MeshVertexData & savedVertices = interleavedVertices ? *interleavedVertices : vertices;
 
 	// prepare header
 	std::ostringstream headerOut;
@@ -247,25 +659,58 @@ bool StreamerMMF::saveMesh(Mesh * mesh, std::ostream & output) {
 	}
 	write(headerOut,MMF_END);
 	write(headerOut,vertices.getVertexCount());
-	const std::string & header=headerOut.str();
+	// align the vertex data
+	const uint32_t paddingSize = (MMF_CHUNK_ALIGNMENT - (static_cast<uint32_t>(headerOut.tellp()) + 4) % MMF_CHUNK_ALIGNMENT) % MMF_CHUNK_ALIGNMENT;
+	write(headerOut,paddingSize);
+	headerOut << std::string(paddingSize, '\0');
+	chunks.push_back(SaveChunk(MMF_VERTEX_DATA, headerOut.str(), savedVertices.data(), savedVertices.dataSize()));
+
+	/// IndexData
+	// the stored index range of the mesh may be outdated, but the mesh is not changed
+	const uint32_t indexType = indices.getRequiredIndexType();
+	std::ostringstream indexHeaderOut;
+	write(indexHeaderOut, indices.getIndexCount());
+	write(indexHeaderOut, mesh->getGLDrawMode());
+	std::vector<uint8_t> packedIndices;
+	if(indexType == GL_UNSIGNED_INT || indices.empty()) {
+		chunks.push_back(SaveChunk(MMF_INDEX_DATA, indexHeaderOut.str(), reinterpret_cast<const uint8_t *>(indices.data()), indices.dataSize()));
+	} else {
+		packedIndices.resize((indices.getIndexCount() * getGLTypeSize(indexType) + 3) / 4 * 4, 0);
+		indices.writePacked(indexType, packedIndices.data());
+		write(indexHeaderOut, indexType);
+		chunks.push_back(SaveChunk(MMF_PACKED_INDEX_DATA, indexHeaderOut.str(), packedIndices.data(), packedIndices.size()));
+	}
 
-	// write data
-	write(output, MMF_VERTEX_DATA);
-	write(output,vertices.dataSize()+header.length()); // dataSize
-	output.write(header.c_str(),header.length());		// header
-	output.write(reinterpret_cast<char *> (vertices.data()), vertices.dataSize()); // data
+	if(compression) {
+		for(auto & chunk : chunks)
+			chunk.compress();
+	}
 
-	/// IndexData Header
-	MeshIndexData & indices = mesh->openIndexData();
-	write(output, MMF_INDEX_DATA);
-	write(output, indices.dataSize()+sizeof(uint32_t)+sizeof(uint32_t)); // indexData length +indexCount +triangleMode
-	write(output, indices.getIndexCount());
-	write(output, mesh->getGLDrawMode());
-	output.write(reinterpret_cast<char *> (indices.data()), indices.dataSize());
-
-	/// final END
-	write(output, MMF_END);
-	return true;
+	/// Header and chunk directory
+	write(output, MMF_HEADER);
+	write(output, MMF_VERSION);
+	write(output, static_cast<uint32_t>(chunks.size()));
+	write(output, 0); // reserved
+	uint64_t position = 4 * sizeof(uint32_t) + chunks.size() * 4 * sizeof(uint64_t);
+	uint64_t offset = alignChunk(position);
+	for(const auto & chunk : chunks) {
+		write(output, chunk.type);
+		write(output, chunk.compression);
+		write64(output, offset);
+		write64(output, chunk.getStoredSize());
+		write64(output, chunk.getSize());
+		offset = alignChunk(offset + chunk.getStoredSize());
+	}
+
+	/// Chunks
+	static const char padding[MMF_CHUNK_ALIGNMENT] = {};
+	for(const auto & chunk : chunks) {
+		output.write(padding, alignChunk(position) - position);
+		position = alignChunk(position);
+		chunk.write(output);
+		position += chunk.getStoredSize();
+	}
+	return output.good();
 }
 
 
@@ -275,6 +720,11 @@ void StreamerMMF::write(std::ostream & out, uint32_t x) {
 	out.write(reinterpret_cast<char *> (&x), 4);
 }
 
+//!	(internal,static)
+void StreamerMMF::write64(std::ostream & out, uint64_t x) {
+	out.write(reinterpret_cast<char *> (&x), 8);
+}
+
 uint8_t StreamerMMF::queryCapabilities(const std::string & extension) {
 	if(extension == fileExtension) {
 		return CAP_LOAD_MESH | CAP_LOAD_GENERIC | CAP_SAVE_MESH;
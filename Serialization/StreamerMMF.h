@@ -12,10 +12,16 @@
 #define RENDERING_STREAMERMMF_H_
 
 #include "AbstractRenderingStreamer.h"
+#include <Geometry/Box.h>
 #include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
 
 namespace Rendering {
 namespace Serialization {
+class MappedFile;
 
 /**
 
@@ -24,8 +30,11 @@ namespace Serialization {
 
 	Fileformat: binary little endian
 
+	Version 1
+	---------
+
 	MMF-File ::=    Header (char[4] "mmf"+chr(13) ),
-					uint32 version (currently 0x01),
+					uint32 version (0x01),
 					DataBlock * (one VertexBlock and one IndexBlock),
 					EndMarker (uint32 0xFFFFFFFF)
 
@@ -76,21 +85,104 @@ namespace Serialization {
 					uint32 indexCount -- the number of indices in the following datablock,
 					uint32 (=GLuint) indexMode -- the meaning of the indices (GL_TRIANGLES, GL_TRIANGLE_STRIP, ...),
 					uint8* indexData -- the index data
+
+	DataBlock ::=   PackedIndexBlock -- used instead of an IndexBlock if the indices fit into 8 or 16 bit
+
+	PackedIndexBlock ::=  PackedIndex-dataType (uint32 0x02),
+					uint32 dataSize,
+					uint32 indexCount -- the number of indices in the following datablock,
+					uint32 (=GLuint) indexMode -- the meaning of the indices (GL_TRIANGLES, GL_TRIANGLE_STRIP, ...),
+					uint32 (=GLuint) indexType -- GL_UNSIGNED_BYTE or GL_UNSIGNED_SHORT,
+					uint8* indexData -- the index data, filled up with zeros until 32bit alignment is reached
+
+	Note: The PackedIndexBlock is written for all meshes whose indices fit into 16 bit, which are most
+	meshes. Readers not knowing this block cannot load such files. Moreover, saveMesh() always writes
+	version 2 (see below), which older versions of this library reject. Hence, all files written by
+	this version of the library require a reader supporting version 2.
+
+	Version 2
+	---------
+
+	Version 2 stores the blocks as chunks at 64 byte aligned positions, so that the data
+	can be used directly from a memory mapped file. A chunk directory at the beginning
+	of the file allows readers to skip the chunks they do not need. Each chunk may be
+	compressed.
+
+	MMF-File ::=    Header (char[4] "mmf"+chr(13) ),
+					uint32 version (currently 0x02),
+					uint32 chunkCount,
+					uint32 reserved (0),
+					ChunkDirectoryEntry[chunkCount] -- ordered by offset,
+					Chunk* -- each starting at a multiple of 64 bytes (the gaps are filled with zeros)
+
+	ChunkDirectoryEntry ::=
+					uint32 dataType -- the type of the block stored in the chunk (see below),
+					uint32 compression -- 0x00: none, 0x01: LZ4 (MMF_COMPRESSION_LZ4),
+					uint64 offset -- position of the chunk in the file,
+					uint64 storedSize -- nr of bytes stored in the file,
+					uint64 size -- nr of bytes of the uncompressed data
+
+	Chunk ::=       uint8 data[storedSize] -- the data of a VertexBlock, IndexBlock, PackedIndexBlock or SubMeshBlock
+					(without the dataType and dataSize values)
+
+	Chunk ::=       CompressedChunk
+
+	CompressedChunk ::= CompressedFrame* -- frames of at most 1 MiB uncompressed data, which can be decoded one after another
+
+	CompressedFrame ::=
+					uint32 size -- nr of bytes of the uncompressed data,
+					uint32 compressedSize,
+					uint8 data[compressedSize] -- LZ4 block (see BlockCompression)
+
+	In version 2, the vertex data in the VertexBlock is preceded by padding:
+
+	VertexBlock ::= VertexAttributeDescription *,
+					EndMarker (uint32 0xFFFFFFFF),
+					uint32 vertexCount,
+					uint32 paddingSize,
+					uint8 padding[paddingSize] -- zeros, so that the vertex data starts at a multiple of 64 bytes in the chunk,
+					uint8* vertexData
+
+	SubMeshBlock ::= uint32 subMeshCount, -- stored in a chunk with the SubMesh-dataType (0x03)
+					SubMesh[subMeshCount]
+
+	SubMesh ::=     uint32 firstIndex, uint32 indexCount -- range of the index data,
+					uint32 minIndex, uint32 maxIndex -- range of the vertices used by the indices,
+					float bounds[6] -- bounding box (minX, minY, minZ, maxX, maxY, maxZ)
+
+	The SubMeshBlock is optional and stored before the vertex data. It allows loading single
+	parts of a mesh (see loadSubMesh()); the triangles are split into consecutive groups.
 */
 class StreamerMMF : public AbstractRenderingStreamer {
 	public:
-		const static uint32_t MMF_VERSION = 0x01;
+		const static uint32_t MMF_VERSION = 0x02;
 		const static uint32_t MMF_HEADER = 0x0d666d6d; // = "mmf "
 
 		const static uint32_t MMF_VERTEX_DATA = 0x00;
 		const static uint32_t MMF_INDEX_DATA = 0x01;
+		const static uint32_t MMF_PACKED_INDEX_DATA = 0x02;
+		const static uint32_t MMF_SUBMESH_DATA = 0x03;
 		const static uint32_t MMF_END = 0xFFFFFFFF;
 
+		const static uint32_t MMF_COMPRESSION_NONE = 0x00;
+		const static uint32_t MMF_COMPRESSION_LZ4 = 0x01;
+		const static uint32_t MMF_CHUNK_ALIGNMENT = 64;
+		const static uint32_t MMF_FRAME_SIZE = 1 << 20;
+
 		const static uint32_t MMF_CUSTOM_ATTR_ID = 0xFF;
 		const static uint32_t MMF_VERTEX_ATTR_EXT_NAME = 0x03;
 
+		//! Part of a mesh as stored in the SubMeshBlock.
+		struct SubMesh {
+			uint32_t firstIndex;
+			uint32_t indexCount;
+			uint32_t minIndex;
+			uint32_t maxIndex;
+			Geometry::Box bounds;
+		};
+
 		StreamerMMF() :
-			AbstractRenderingStreamer() {
+			AbstractRenderingStreamer(), compression(false), subMeshTriangleCount(0) {
 		}
 		virtual ~StreamerMMF() {
 		}
@@ -99,23 +191,80 @@ class StreamerMMF : public AbstractRenderingStreamer {
 		Mesh * loadMesh(std::istream & input) override;
 		bool saveMesh(Mesh * mesh, std::ostream & output) override;
 
+		/*! Load a mesh from a memory mapped file of the local file system.
+			The vertex data and 32 bit indices are not copied, but reference the mapping
+			if they are aligned in the file. The operating system reads the data on first
+			access and copies it on write, so the file itself is never changed.
+			\return the mesh, or nullptr if the file cannot be mapped or is no valid .mmf-file */
+		static Mesh * loadMeshMapped(const std::string & path);
+		/*! Load a mesh from memory holding a .mmf-file (e.g. a part of a larger mapped file).
+			Like loadMeshMapped(), aligned vertex data and 32 bit indices reference the memory,
+			which is kept alive by the mesh as long as needed.
+			\return the mesh, or nullptr if the memory contains no valid .mmf-file */
+		static Mesh * loadMeshFromMemory(std::shared_ptr<uint8_t> data, size_t size);
+
+		/*! Read the SubMeshBlock of a version 2 file. Only the header and the SubMeshBlock are read.
+			\return @c false if the file contains no SubMeshBlock or cannot be read */
+		static bool readSubMeshes(std::istream & input, std::vector<SubMesh> & subMeshes);
+		/*! Load only the vertices and indices of the sub-mesh with the given index (see readSubMeshes()).
+			The indices are relative to the sub-mesh's minIndex. Uncompressed chunks are not read
+			completely, but the data of the other sub-meshes is skipped.
+			\return the mesh, or nullptr if the file contains no such sub-mesh or cannot be read */
+		static Mesh * loadSubMesh(std::istream & input, uint32_t subMeshIndex);
+
+		//! Compress the chunks of saved files, if their size is reduced (default: false).
+		void setCompression(bool b)							{	compression = b;	}
+		bool getCompression() const							{	return compression;	}
+		/*! If not zero, saved files contain a SubMeshBlock splitting the triangles into
+			groups of the given number of triangles (default: 0). */
+		void setSubMeshTriangleCount(uint32_t count)		{	subMeshTriangleCount = count;	}
+		uint32_t getSubMeshTriangleCount() const			{	return subMeshTriangleCount;	}
+
 		static uint8_t queryCapabilities(const std::string & extension);
 		static const char * const fileExtension;
 
 	private:
+		bool compression;
+		uint32_t subMeshTriangleCount;
+
+		//! Reads from a stream or from memory (e.g. a memory mapped file) up to a given size.
 		struct Reader{
-			Reader(std::istream & _in) : in(_in){}
-			std::istream & in;
+			Reader(std::istream & _in) : in(&_in), memory(), size(SIZE_MAX), position(0), failed(false){}
+			Reader(std::shared_ptr<uint8_t> _memory, size_t _size) : in(nullptr), memory(std::move(_memory)), size(_size), position(0), failed(false){}
+			std::istream * in;
+			std::shared_ptr<uint8_t> memory;
+			size_t size;
+			size_t position; //!< nr of bytes read or skipped
+			bool failed;
 			uint32_t read_uint32();
+			uint64_t read_uint64();
 			void read(uint8_t * data,size_t count);
-			void skip(uint32_t size);
-
+			void skip(size_t count);
+			bool good() const										{	return !failed;	}
+			/*! Return the next @p count bytes of the memory without copying them, if they
+				are aligned to @p alignment bytes; otherwise nothing is read and nullptr is returned. */
+			std::shared_ptr<uint8_t> reference(size_t count, size_t alignment);
+		};
+		struct Chunk{
+			uint32_t type;
+			uint32_t compression;
+			uint64_t offset;
+			uint64_t storedSize;
+			uint64_t size;
 		};
-		static void readVertexData(Mesh * mesh, Reader & in);
-		static void readIndexData(Mesh * mesh, Reader & in);
+		static const uint32_t WHOLE_MESH = 0xFFFFFFFF;
 
+		static Mesh * readMesh(Reader & in, uint32_t subMeshIndex = WHOLE_MESH);
+		static Mesh * readBlocks(Reader & in);
+		static bool readDirectory(Reader & in, std::vector<Chunk> & chunks);
+		//! Call @p parse with a reader for the (decompressed) data of the chunk, which follows the current position of @p in.
+		static bool readChunk(Reader & in, const Chunk & chunk, const std::function<void (Reader &)> & parse);
+		static void readVertexData(Mesh * mesh, Reader & in, uint32_t version, const SubMesh * part = nullptr);
+		static void readIndexData(Mesh * mesh, Reader & in, bool packed, const SubMesh * part = nullptr);
+		static void readSubMeshData(std::vector<SubMesh> & subMeshes, Reader & in);
 
 		static void write(std::ostream & out, uint32_t x);
+		static void write64(std::ostream & out, uint64_t x);
 };
 
 }
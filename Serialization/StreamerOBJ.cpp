@@ -9,17 +9,25 @@
 	file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
 */
 #include "StreamerOBJ.h"
+#include "MappedFile.h"
 #include "Serialization.h"
+#include "TextParsing.h"
 #include "../Mesh/Mesh.h"
 #include "../Mesh/VertexAttributeIds.h"
 #include "../Mesh/VertexDescription.h"
 #include "../MeshUtils/MeshUtils.h"
+#include "../MeshUtils/ParallelFor.h"
 #include "../GLHeader.h"
 #include <Util/GenericAttribute.h>
+#include <Util/Macros.h>
 #include <Util/StringUtils.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <list>
-#include <map>
-#include <set>
+#include <sstream>
+#include <unordered_map>
+#include <vector>
 
 using namespace Util;
 
@@ -28,148 +36,226 @@ namespace Serialization {
 
 const char * const StreamerOBJ::fileExtension = "obj";
 
-struct Vertex {
+//! Chunks are not smaller than this, so that small files are parsed by a single thread.
+static const size_t MIN_CHUNK_SIZE = 1 << 20;
+//! Meshes with fewer vertices are created by a single thread.
+static const size_t MIN_PARALLEL_VERTICES = 1 << 16;
 
-	Vertex() :
-		data(), index(0) {
+using namespace TextParsing;
+
+//! Vertex of a face as given in the file.
+struct ObjCorner {
+	//! Indices of position, texture coordinate and normal (0 if not given).
+	int64_t index[3];
+	//! Bit i is set, if index[i] is relative to the first element of the chunk (negative index in the file).
+	uint8_t relative;
+};
+
+//! Group ("g", "s") or material ("usemtl") statement in between the faces.
+struct ObjEvent {
+	enum type_t { GROUP, MATERIAL } type;
+	uint32_t faceCount; //!< nr of faces of the chunk before the event
+	std::string material;
+};
+
+//! Result of tokenizing a part of the file.
+struct ObjChunk {
+	std::vector<float> positions;
+	std::vector<float> texCoords;
+	std::vector<float> normals;
+	std::vector<ObjCorner> corners;
+	std::vector<uint32_t> faceEnds; //!< end of each face in corners
+	std::vector<ObjEvent> events;
+	std::vector<std::string> mtlFiles;
+	std::string unknownKeywords;
+};
+
+static std::string trimmedLine(const char * cursor, const char * lineEnd) {
+	return StringUtils::trim(std::string(cursor, lineEnd));
+}
+
+static void parseChunk(const char * cursor, const char * end, ObjChunk & chunk) {
+	while(cursor < end) {
+		const char * lineEnd = static_cast<const char *>(std::memchr(cursor, '\n', end - cursor));
+		if(lineEnd == nullptr)
+			lineEnd = end;
+		const char * c = skipBlanks(cursor, lineEnd);
+		cursor = lineEnd + 1;
+		if(c == lineEnd)
+			continue;
+		if(*c == 'v') {
+			++c;
+			if(c < lineEnd && (*c == ' ' || *c == '\t')) {
+				for(int i = 0; i < 3; ++i)
+					chunk.positions.push_back(parseFloat(c, lineEnd));
+			} else if(c < lineEnd && *c == 't') {
+				++c;
+				for(int i = 0; i < 2; ++i)
+					chunk.texCoords.push_back(parseFloat(c, lineEnd));
+			} else if(c < lineEnd && *c == 'n') {
+				++c;
+				for(int i = 0; i < 3; ++i)
+					chunk.normals.push_back(parseFloat(c, lineEnd));
+			}
+		} else if(*c == 'f') {
+			++c;
+			const size_t localCount[3] = { chunk.positions.size() / 3, chunk.texCoords.size() / 2, chunk.normals.size() / 3 };
+			int64_t v = parseInt(c, lineEnd);
+			while(v != 0) {
+				ObjCorner corner;
+				corner.index[0] = v;
+				corner.index[1] = 0;
+				corner.index[2] = 0;
+				if(c < lineEnd && *c == '/') {
+					++c;
+					corner.index[1] = parseInt(c, lineEnd);
+					if(c < lineEnd && *c == '/') {
+						++c;
+						corner.index[2] = parseInt(c, lineEnd);
+					}
+				}
+				corner.relative = 0;
+				for(uint_fast8_t i = 0; i < 3; ++i) {
+					if(corner.index[i] < 0) {
+						// -1 is the last element before the face
+						corner.index[i] += static_cast<int64_t>(localCount[i]) + 1;
+						corner.relative |= 1 << i;
+					}
+				}
+				chunk.corners.push_back(corner);
+				v = parseInt(c, lineEnd);
+			}
+			chunk.faceEnds.push_back(static_cast<uint32_t>(chunk.corners.size()));
+		} else if(static_cast<size_t>(lineEnd - c) >= 6 && std::strncmp(c, "mtllib", 6) == 0) {
+			chunk.mtlFiles.push_back(trimmedLine(c + 6, lineEnd));
+		} else if(*c == 'g' || *c == 's') {
+			chunk.events.push_back({ObjEvent::GROUP, static_cast<uint32_t>(chunk.faceEnds.size()), std::string()});
+		} else if(static_cast<size_t>(lineEnd - c) >= 6 && std::strncmp(c, "usemtl", 6) == 0) {
+			chunk.events.push_back({ObjEvent::MATERIAL, static_cast<uint32_t>(chunk.faceEnds.size()), trimmedLine(c + 6, lineEnd)});
+		} else if(*c != '#' && *c != 'o') {
+			if(chunk.unknownKeywords.find(*c) == std::string::npos)
+				chunk.unknownKeywords += *c;
+		}
 	}
+}
 
-	Vertex(const Vertex & other) :
-		data(other.data), index(other.index) {
+template<size_t n>
+struct ObjValueHash {
+	size_t operator()(const std::array<uint32_t, n> & key) const {
+		uint64_t hash = 0;
+		for(const auto & value : key)
+			hash = (hash ^ value) * 0x9e3779b97f4a7c15ull;
+		return static_cast<size_t>(hash ^ (hash >> 32));
 	}
+};
 
-	Vertex(float pos[3], float nor[3], float tex[2]) :
-		data(), index(0) {
-		size_t size = 3;
-		if (nor != nullptr) {
-			size += 3;
-		}
-		if (tex != nullptr) {
-			size += 2;
-		}
-		data.reserve(size);
-		data.push_back(pos[0]);
-		data.push_back(pos[1]);
-		data.push_back(pos[2]);
-		if (nor != nullptr) {
-			data.push_back(nor[0]);
-			data.push_back(nor[1]);
-			data.push_back(nor[2]);
-		}
-		if (tex != nullptr) {
-			// Texture offsets are ignored here.
-			data.push_back(tex[0]);
-			data.push_back(tex[1]);
+/*! Map each element of @p values (with @a n floats each) to the first element with the same value.
+	Element 0 is the dummy element for missing indices, as the first index in the file is 1. */
+template<size_t n>
+static std::vector<uint32_t> findEqualValues(const std::vector<float> & values) {
+	const uint32_t count = static_cast<uint32_t>(values.size() / n);
+	std::vector<uint32_t> firstIndex(count + 1, 0);
+	std::unordered_map<std::array<uint32_t, n>, uint32_t, ObjValueHash<n>> valueMap;
+	valueMap.reserve(count);
+	for(uint32_t i = 0; i < count; ++i) {
+		std::array<uint32_t, n> key;
+		for(size_t j = 0; j < n; ++j) {
+			const float value = values[i * n + j] + 0.0f; // -0 == +0
+			std::memcpy(&key[j], &value, sizeof(uint32_t));
 		}
+		firstIndex[i + 1] = valueMap.emplace(key, i + 1).first->second;
 	}
+	return firstIndex;
+}
 
-	Vertex & operator=(const Vertex & other) {
-		data = other.data;
-		index = other.index;
-		return *this;
+//! Indices of position, texture coordinate and normal of a vertex; 0 if not available.
+struct ObjVertexKey {
+	uint32_t index[3];
+	bool operator==(const ObjVertexKey & other) const {
+		return index[0] == other.index[0] && index[1] == other.index[1] && index[2] == other.index[2];
 	}
+};
 
-	bool operator<(const Vertex & other) const {
-		// Do not compare index here.
-		return data < other.data;
+struct ObjVertexKeyHash {
+	size_t operator()(const ObjVertexKey & key) const {
+		const uint64_t hash = ((static_cast<uint64_t>(key.index[0]) * 0x9e3779b97f4a7c15ull) ^ key.index[1]) * 0xc2b2ae3d27d4eb4full ^ key.index[2];
+		return static_cast<size_t>(hash ^ (hash >> 29));
 	}
-
-	std::vector<float> data;
-	uint32_t index;
 };
 
-static void triangulate(std::list<uint32_t> & l) {
-	if (l.size() <= 3) {
-		if(l.size() < 3) {
-			WARN("cannot triangulate list with < 3 entries");
-			l.clear();
-		}
-		return;
+//! Collects the faces of the current group.
+struct ObjMeshBuilder {
+	ObjMeshBuilder() : started(false), hasTexCoords(false), hasNormals(false) {}
+	bool started;
+	bool hasTexCoords;
+	bool hasNormals;
+	std::unordered_map<ObjVertexKey, uint32_t, ObjVertexKeyHash> vertexMap;
+	std::vector<ObjVertexKey> vertices;
+	std::vector<uint32_t> indices;
+
+	uint32_t addVertex(const ObjVertexKey & key) {
+		const auto result = vertexMap.emplace(key, static_cast<uint32_t>(vertices.size()));
+		if(result.second)
+			vertices.push_back(key);
+		return result.first->second;
 	}
-	// Copy list.
-	std::list<uint32_t> old(l);
-	l.clear();
-
-	uint32_t a, b, c;
-	a = old.front();
-	old.pop_front();
-	b = old.front();
-	old.pop_front();
-	c = old.front();
-	old.pop_front();
-	l.push_back(a);
-	l.push_back(b);
-	l.push_back(c);
-	while (!old.empty()) {
-		b = c;
-		c = old.front();
-		old.pop_front();
-		l.push_back(a);
-		l.push_back(b);
-		l.push_back(c);
+	void clear() {
+		started = false;
+		vertexMap.clear();
+		vertices.clear();
+		indices.clear();
 	}
-}
+};
 
+static Mesh * createMesh(const ObjMeshBuilder & builder, const std::vector<float> & positions,
+						const std::vector<float> & texCoords, const std::vector<float> & normals, uint32_t workerCount) {
+	if(builder.vertices.empty() || builder.indices.empty())
+		return nullptr;
+	VertexDescription vertexDesc;
+	vertexDesc.appendAttribute(VertexAttributeIds::POSITION, 3, GL_FLOAT, false);
+	if(builder.hasTexCoords)
+		vertexDesc.appendAttribute(VertexAttributeIds::TEXCOORD0, 2, GL_FLOAT, false);
+	if(builder.hasNormals)
+		vertexDesc.appendAttribute(VertexAttributeIds::NORMAL, 3, GL_FLOAT, false);
 
-static Mesh * createMesh(VertexDescription * vertexDesc, const std::list<uint32_t> & faces, const std::set<Vertex> & vertexSet) {
 	Util::Reference<Mesh> mesh = new Mesh;
 
-
-	// Create index data.
-	std::size_t indexCount = faces.size();
-
 	MeshIndexData & indices = mesh->openIndexData();
-	indices.allocate(indexCount);
-	uint32_t * indexData = indices.data();
-
-
-	// Mapping is done because one face list may reference only a small subset of the vertices.
-	std::map<uint32_t, uint32_t> indexMap;
-
-	uint32_t newIndex = 0;
-	for(const auto & face : faces) {
-		auto find = indexMap.lower_bound(face);
-		if(find == indexMap.end() || indexMap.key_comp()(face, find->first)) {
-			find = indexMap.insert(find, std::make_pair(face, newIndex));
-			++newIndex;
-		}
-		*indexData = find->second;
-		++indexData;
-	}
+	indices.allocate(builder.indices.size());
+	std::copy(builder.indices.begin(), builder.indices.end(), indices.data());
 	indices.updateIndexRange();
 
-	// Create vertex data.
 	MeshVertexData & vertices = mesh->openVertexData();
-	vertices.allocate(indexMap.size(), *vertexDesc);
-
-	const uint16_t posOffset = vertexDesc->getAttribute(VertexAttributeIds::POSITION).getOffset();
-	const uint16_t texOffset = vertexDesc->getAttribute(VertexAttributeIds::TEXCOORD0).getOffset();
-	const uint16_t norOffset = vertexDesc->getAttribute(VertexAttributeIds::NORMAL).getOffset();
-
+	vertices.allocate(builder.vertices.size(), vertexDesc);
+	const size_t vertexSize = vertexDesc.getVertexSize();
+	const uint16_t posOffset = vertexDesc.getAttribute(VertexAttributeIds::POSITION).getOffset();
+	const uint16_t texOffset = vertexDesc.getAttribute(VertexAttributeIds::TEXCOORD0).getOffset();
+	const uint16_t norOffset = vertexDesc.getAttribute(VertexAttributeIds::NORMAL).getOffset();
 	uint8_t * data = vertices.data();
-	for(const auto & vertex : vertexSet) {
-		auto find = indexMap.find(vertex.index);
-		if (find != indexMap.end()) {
-			// Copy position.
-			auto end = std::next(vertex.data.begin(), 3);
-			std::copy(vertex.data.begin(), end, reinterpret_cast<float *> (data + (find->second * vertexDesc->getVertexSize()) + posOffset));
-
-			const bool texAvail = vertex.data.size() == 5 || vertex.data.size() == 8;
-			const bool norAvail = vertex.data.size() == 6 || vertex.data.size() == 8;
-			if(norAvail) {
-				// Copy normal.
-				auto begin = end;
-				std::advance(end, 3);
-				std::copy(begin, end, reinterpret_cast<float *> (data + (find->second * vertexDesc->getVertexSize()) + norOffset));
+	// threads are only worth it for large meshes
+	if(builder.vertices.size() < MIN_PARALLEL_VERTICES)
+		workerCount = 1;
+	MeshUtils::parallelFor(workerCount, 0, static_cast<uint32_t>(builder.vertices.size()), [&](uint32_t, uint32_t begin, uint32_t end) {
+		for(uint32_t i = begin; i < end; ++i) {
+			const ObjVertexKey & key = builder.vertices[i];
+			uint8_t * vertex = data + i * vertexSize;
+			std::copy_n(positions.data() + 3 * (key.index[0] - 1), 3, reinterpret_cast<float *>(vertex + posOffset));
+			if(builder.hasTexCoords) {
+				float * tex = reinterpret_cast<float *>(vertex + texOffset);
+				if(key.index[1] != 0)
+					std::copy_n(texCoords.data() + 2 * (key.index[1] - 1), 2, tex);
+				else
+					std::fill_n(tex, 2, 0.0f);
 			}
-			if(texAvail) {
-				// Copy texture coordinate.
-				auto begin = end;
-				std::advance(end, 2);
-				std::copy(begin, end, reinterpret_cast<float *> (data + (find->second * vertexDesc->getVertexSize()) + texOffset));
+			if(builder.hasNormals) {
+				float * nor = reinterpret_cast<float *>(vertex + norOffset);
+				if(key.index[2] != 0)
+					std::copy_n(normals.data() + 3 * (key.index[2] - 1), 3, nor);
+				else
+					std::fill_n(nor, 3, 0.0f);
 			}
 		}
-	}
+	});
 	vertices.updateBoundingBox();
 
 	MeshUtils::shrinkMesh(mesh.get());
@@ -181,157 +267,149 @@ static Mesh * createMesh(VertexDescription * vertexDesc, const std::list<uint32_
 	return mesh.detachAndDecrease();
 }
 
-Util::GenericAttributeList * StreamerOBJ::loadGeneric(std::istream & input) {
-	auto descriptionList = new Util::GenericAttributeList;
-
-	std::set<Vertex> vertices;
-
-
-	// Insert initial items, because first index for OBJ is 1.
-	std::vector<float> positions(3, 0.0f);
-	std::vector<float> normals(3, 0.0f);
-	std::vector<float> texcoords(2, 0.0f);
+template<typename T>
+static void appendAll(std::vector<T> & target, const std::vector<ObjChunk> & chunks, std::vector<T> ObjChunk::* member) {
+	size_t size = 0;
+	for(const auto & chunk : chunks)
+		size += (chunk.*member).size();
+	target.reserve(size);
+	for(const auto & chunk : chunks)
+		target.insert(target.end(), (chunk.*member).begin(), (chunk.*member).end());
+}
 
-	std::list<uint32_t> faces;
+Util::GenericAttributeList * StreamerOBJ::parse(const char * data, size_t size) {
+	const uint32_t workerCount = MeshUtils::getWorkerCount(threadCount);
+
+	// split the data into chunks of whole lines
+	const size_t chunkCount = std::max<size_t>(1, std::min<size_t>(workerCount, size / MIN_CHUNK_SIZE));
+	std::vector<const char *> chunkBegins(chunkCount + 1, data + size);
+	chunkBegins[0] = data;
+	for(size_t i = 1; i < chunkCount; ++i) {
+		const char * begin = std::max(chunkBegins[i - 1], data + i * (size / chunkCount));
+		const char * lineEnd = static_cast<const char *>(std::memchr(begin, '\n', data + size - begin));
+		chunkBegins[i] = lineEnd == nullptr ? data + size : lineEnd + 1;
+	}
+	std::vector<ObjChunk> chunks(chunkCount);
+	MeshUtils::parallelFor(workerCount, 0, static_cast<uint32_t>(chunkCount), [&](uint32_t, uint32_t begin, uint32_t end) {
+		for(uint32_t i = begin; i < end; ++i)
+			parseChunk(chunkBegins[i], chunkBegins[i + 1], chunks[i]);
+	});
+
+	std::vector<float> positions;
+	std::vector<float> texCoords;
+	std::vector<float> normals;
+	appendAll(positions, chunks, &ObjChunk::positions);
+	appendAll(texCoords, chunks, &ObjChunk::texCoords);
+	appendAll(normals, chunks, &ObjChunk::normals);
+	const int64_t totalCount[3] = {
+		static_cast<int64_t>(positions.size() / 3), static_cast<int64_t>(texCoords.size() / 2), static_cast<int64_t>(normals.size() / 3)
+	};
+	// vertices are merged if their values are equal, even if they are given more than once in the file
+	const std::vector<uint32_t> firstIndices[3] = {
+		findEqualValues<3>(positions), findEqualValues<2>(texCoords), findEqualValues<3>(normals)
+	};
 
+	auto descriptionList = new Util::GenericAttributeList;
 	std::string currentMtl;
-	std::list<std::string> mtlFiles;
-
-	VertexDescription * vertexDesc = nullptr;
-
-	char chars[256];
-
-	while (input.getline(chars, 256)) {
-		char * cursor = chars;
-		StringUtils::stepWhitespaces(&cursor);
-		if (*cursor == 'v') {
-			++cursor;
-			if (*cursor == ' ') {
-				++cursor;
-				float pos[3];
-				pos[0] = strtof(cursor, &cursor);
-				pos[1] = strtof(cursor, &cursor);
-				pos[2] = strtof(cursor, &cursor);
-				positions.insert(positions.end(), pos, pos + 3);
-			} else if (*cursor == 't') {
-				++cursor;
-				float texCoord[2];
-				texCoord[0] = strtof(cursor, &cursor);
-				texCoord[1] = strtof(cursor, &cursor);
-				texcoords.insert(texcoords.end(), texCoord, texCoord + 2);
-			} else if (*cursor == 'n') {
-				++cursor;
-				float normal[3];
-				normal[0] = strtof(cursor, &cursor);
-				normal[1] = strtof(cursor, &cursor);
-				normal[2] = strtof(cursor, &cursor);
-				normals.insert(normals.end(), normal, normal + 3);
-			}
-		} else if (*cursor == 'f') {
-			++cursor;
-			int32_t v = 0, vt = 0, vn = 0;
-			v = strtol(cursor, &cursor, 10);
-			std::list<uint32_t> vertexIndexList;
-			while (v != 0) {
-				if (*cursor == '/') {
-					++cursor;
-					vt = strtol(cursor, &cursor, 10);
-					if (*cursor == '/') {
-						++cursor;
-						vn = strtol(cursor, &cursor, 10);
-					}
-				}
-				if (!vertexDesc) {
-					vertexDesc = new VertexDescription;
-					vertexDesc->appendAttribute(VertexAttributeIds::POSITION, 3, GL_FLOAT,false);
-					if (vt != 0) {
-						vertexDesc->appendAttribute(VertexAttributeIds::TEXCOORD0, 2, GL_FLOAT,false);
-					}
-					if (vn != 0) {
-						vertexDesc->appendAttribute(VertexAttributeIds::NORMAL, 3, GL_FLOAT,false);
-					}
-				}
-
-				float * tex = nullptr;
-				float * nor = nullptr;
-				if(v < 0)
-					v = positions.size()/3 + v;
-				if(vt < 0)
-					vt = texcoords.size()/2 + vt;
-				if(vn < 0)
-					vn = normals.size()/3 + vn;
-				
-				if (vt != 0) {
-					tex = &texcoords[2 * vt];
-				}
-				if (vn != 0) {
-					nor = &normals[3 * vn];
-				}
-				uint32_t index;
-				Vertex vertex(&positions[3 * v], nor, tex);
-				auto iter = vertices.lower_bound(vertex);
-				if (iter != vertices.end() && !(vertices.key_comp()(vertex, *iter))) {
-					index = iter->index;
-				} else {
-					vertex.index = vertices.size();
-					vertices.insert(iter, vertex);
-					index = vertex.index;
+	ObjMeshBuilder builder;
+	uint32_t invalidFaces = 0;
+	uint32_t degeneratedFaces = 0;
+	auto finishMesh = [&]() {
+		Mesh * mesh = createMesh(builder, positions, texCoords, normals, workerCount);
+		builder.clear();
+		if(mesh) {
+			Util::GenericAttributeMap * d = Serialization::createMeshDescription(mesh);
+			d->setString(Serialization::DESCRIPTION_MATERIAL_NAME, currentMtl);
+			descriptionList->push_back(d);
+		}
+	};
+	auto processEvent = [&](const ObjEvent & event) {
+		if(event.type == ObjEvent::GROUP) {
+			if(builder.started)
+				finishMesh();
+		} else {
+			if(builder.started)
+				finishMesh();
+			currentMtl = event.material;
+		}
+	};
+
+	std::string unknownKeywords;
+	int64_t base[3] = {0, 0, 0};
+	std::vector<ObjVertexKey> faceKeys;
+	std::vector<uint32_t> faceVertices;
+	for(const auto & chunk : chunks) {
+		auto eventIt = chunk.events.begin();
+		uint32_t cornerBegin = 0;
+		for(uint32_t face = 0; face < chunk.faceEnds.size(); ++face) {
+			for(; eventIt != chunk.events.end() && eventIt->faceCount <= face; ++eventIt)
+				processEvent(*eventIt);
+			const uint32_t cornerEnd = chunk.faceEnds[face];
+			// resolve the indices
+			faceKeys.clear();
+			bool valid = true;
+			for(uint32_t c = cornerBegin; c < cornerEnd && valid; ++c) {
+				const ObjCorner & corner = chunk.corners[c];
+				ObjVertexKey key;
+				for(uint_fast8_t i = 0; i < 3 && valid; ++i) {
+					const bool relative = (corner.relative & (1 << i)) != 0;
+					const int64_t index = relative ? base[i] + corner.index[i] : corner.index[i];
+					if(index == 0 && !relative && i > 0)
+						key.index[i] = 0;
+					else if(index < 1 || index > totalCount[i])
+						valid = false;
+					else
+						key.index[i] = firstIndices[i][static_cast<size_t>(index)];
 				}
-
-				vertexIndexList.push_back(index);
-
-				v = strtoul(cursor, &cursor, 10);
+				faceKeys.push_back(key);
 			}
-			triangulate(vertexIndexList);
-			while (!vertexIndexList.empty()) {
-				// Append one triangle.
-				for (uint_fast8_t i = 0; i < 3; ++i) {
-					faces.push_back(vertexIndexList.front());
-					vertexIndexList.pop_front();
-				}
+			cornerBegin = cornerEnd;
+			if(!valid) {
+				++invalidFaces;
+				continue;
 			}
-		} else if (StringUtils::beginsWith(cursor, "mtllib")) {
-			cursor += 6;
-			mtlFiles.push_back(StringUtils::trim(cursor));
-		} else if (*cursor == 'g' || *cursor == 's') {
-			if (!vertexDesc)
+			// the first face of a mesh defines its vertex attributes
+			if(!builder.started && !faceKeys.empty()) {
+				builder.started = true;
+				builder.hasTexCoords = faceKeys.front().index[1] != 0;
+				builder.hasNormals = faceKeys.front().index[2] != 0;
+			}
+			if(faceKeys.size() < 3) {
+				++degeneratedFaces;
 				continue;
-
-			Mesh * mesh = createMesh(vertexDesc, faces, vertices);
-			vertexDesc = nullptr;
-			faces.clear();
-			if(mesh) {
-				Util::GenericAttributeMap * d = Serialization::createMeshDescription(mesh);
-				d->setString(Serialization::DESCRIPTION_MATERIAL_NAME, currentMtl);
-				descriptionList->push_back(d);
 			}
-		} else if (StringUtils::beginsWith(cursor, "usemtl")) {
-
-			if (vertexDesc) {
-				Mesh * mesh = createMesh(vertexDesc, faces, vertices);
-				vertexDesc = nullptr;
-				faces.clear();
-				if(mesh) {
-					Util::GenericAttributeMap * d = Serialization::createMeshDescription(mesh);
-					d->setString(Serialization::DESCRIPTION_MATERIAL_NAME, currentMtl);
-					descriptionList->push_back(d);
-				}
+			faceVertices.clear();
+			for(const auto & key : faceKeys)
+				faceVertices.push_back(builder.addVertex(key));
+			// triangle fan
+			for(size_t i = 2; i < faceVertices.size(); ++i) {
+				builder.indices.push_back(faceVertices[0]);
+				builder.indices.push_back(faceVertices[i - 1]);
+				builder.indices.push_back(faceVertices[i]);
 			}
-			cursor += 6;
-			currentMtl = StringUtils::trim(cursor);
-		} else if (*cursor != '#' && *cursor != '\0' && *cursor != '\n' && *cursor != '\r' && *cursor != 'o') {
-			WARN(std::string("Unknown OBJ keyword \"") + *cursor + "\".");
+		}
+		for(; eventIt != chunk.events.end(); ++eventIt)
+			processEvent(*eventIt);
+		base[0] += chunk.positions.size() / 3;
+		base[1] += chunk.texCoords.size() / 2;
+		base[2] += chunk.normals.size() / 3;
+		for(const auto & keyword : chunk.unknownKeywords) {
+			if(unknownKeywords.find(keyword) == std::string::npos)
+				unknownKeywords += keyword;
 		}
 	}
+	finishMesh();
 
-	Mesh * mesh = createMesh(vertexDesc, faces, vertices);
-	faces.clear();
-	if(mesh) {
-		Util::GenericAttributeMap * d = Serialization::createMeshDescription(mesh);
-		d->setString(Serialization::DESCRIPTION_MATERIAL_NAME, currentMtl);
-		descriptionList->push_back(d);
-	}
+	for(const auto & keyword : unknownKeywords)
+		WARN(std::string("Unknown OBJ keyword \"") + keyword + "\".");
+	if(degeneratedFaces > 0)
+		WARN("cannot triangulate " + StringUtils::toString(degeneratedFaces) + " faces with < 3 entries");
+	if(invalidFaces > 0)
+		WARN("skipped " + StringUtils::toString(invalidFaces) + " faces with invalid indices");
 
+	std::list<std::string> mtlFiles;
+	for(const auto & chunk : chunks)
+		mtlFiles.insert(mtlFiles.end(), chunk.mtlFiles.begin(), chunk.mtlFiles.end());
 	// Traverse list in reverse order to get right order again when using push_front below.
 	for(auto it = mtlFiles.rbegin(); it != mtlFiles.rend(); ++it) {
 		auto mtlFileDesc = new Util::GenericAttributeMap;
@@ -344,6 +422,20 @@ Util::GenericAttributeList * StreamerOBJ::loadGeneric(std::istream & input) {
 	return descriptionList;
 }
 
+Util::GenericAttributeList * StreamerOBJ::loadGeneric(std::istream & input) {
+	std::ostringstream buffer;
+	buffer << input.rdbuf();
+	const std::string data = buffer.str();
+	return parse(data.data(), data.size());
+}
+
+Util::GenericAttributeList * StreamerOBJ::loadGenericMapped(const std::string & path) {
+	const auto mapping = MappedFile::open(path);
+	if(!mapping)
+		return nullptr;
+	return parse(reinterpret_cast<const char *>(mapping->data()), mapping->size());
+}
+
 uint8_t StreamerOBJ::queryCapabilities(const std::string & extension) {
 	if(extension == fileExtension) {
 		return CAP_LOAD_GENERIC;
@@ -12,22 +12,44 @@
 #define RENDERING_STREAMEROBJ_H_
 
 #include "AbstractRenderingStreamer.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
 
 namespace Rendering {
 namespace Serialization {
 
+/**
+ * Loader for Wavefront .obj files.
+ * The data is split into line-aligned chunks that are tokenized concurrently.
+ * Vertices with equal position, texture coordinate and normal are merged.
+ * A new mesh is started for each group ("g"), smoothing group ("s") and material ("usemtl").
+ */
 class StreamerOBJ : public AbstractRenderingStreamer {
 	public:
 		StreamerOBJ() :
-			AbstractRenderingStreamer() {
+			AbstractRenderingStreamer(), threadCount(0) {
 		}
 		virtual ~StreamerOBJ() {
 		}
 
 		Util::GenericAttributeList * loadGeneric(std::istream & input) override;
 
+		/*! Load a file of the local file system through a memory mapping instead of copying its content.
+			\return the descriptions, or nullptr if the file cannot be mapped */
+		Util::GenericAttributeList * loadGenericMapped(const std::string & path);
+
+		//! Number of threads used for parsing; zero (default) selects the number of hardware threads.
+		void setThreadCount(uint32_t count)				{	threadCount = count;	}
+		uint32_t getThreadCount() const					{	return threadCount;	}
+
 		static uint8_t queryCapabilities(const std::string & extension);
 		static const char * const fileExtension;
+
+	private:
+		uint32_t threadCount;
+
+		Util::GenericAttributeList * parse(const char * data, size_t size);
 };
 }
 }
@@ -11,6 +11,8 @@
 #include "StreamerPLY.h"
 #include "Serialization.h"
 #include "../Mesh/Mesh.h"
+#include "../Mesh/MeshIndexData.h"
+#include "../Mesh/MeshVertexData.h"
 #include "../Mesh/VertexAttributeIds.h"
 #include "../Mesh/VertexDescription.h"
 #include "../GLHeader.h"
@@ -18,9 +20,13 @@
 #include <Geometry/Convert.h>
 #include <Util/Graphics/Color.h>
 #include <Util/GenericAttribute.h>
+#include <Util/Macros.h>
 #include <Util/StringUtils.h>
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <iterator>
 #include <map>
 #include <sstream>
 #include <vector>
@@ -211,6 +217,37 @@ class PLY_Element {
 		const Property & getProperty(int16_t index) const {
 			return entries[index];
 		}
+
+		size_t getPropertyCount() const {
+			return entries.size();
+		}
+
+		bool isBinary() const {
+			return sourceFormat == BINARY_BIG_ENDIAN || sourceFormat == BINARY_LITLLE_ENDIAN;
+		}
+
+		bool isBigEndian() const {
+			return sourceFormat == BINARY_BIG_ENDIAN;
+		}
+
+		//! Return the offset of the property in a binary row without lists.
+		size_t getPropertyOffset(int16_t index) const {
+			size_t offset = 0;
+			for(int16_t i = 0; i < index; ++i)
+				offset += getDataSize(entries[i].dataType);
+			return offset;
+		}
+
+		//! Return the size of a binary row, or 0 if the row contains lists (or undefined types).
+		size_t getRowSize() const {
+			size_t size = 0;
+			for(const auto & entry : entries) {
+				if(entry.isList() || entry.dataType == TYPE_UNDEFINED)
+					return 0;
+				size += getDataSize(entry.dataType);
+			}
+			return size;
+		}
 		/**
 		 * // dataSize <64 !!!!!!!
 		 */
@@ -379,17 +416,382 @@ class PLY_Element {
 
 //-------------------------------------------------------------------------------------------------
 
-Mesh * StreamerPLY::loadMesh(std::istream & input) {
-	int cursor=0;
+//! Attributes of the mesh created for a vertex element and the properties they are read from.
+struct PLY_VertexLayout {
+	VertexDescription description;
+	int xIndex, yIndex, zIndex;
+	int nxIndex, nyIndex, nzIndex;
+	int sIndex, tIndex;
+	int redIndex, greenIndex, blueIndex, alphaIndex;
+	bool useVertexNormals, useTex0, useVertexColor;
+	int posOffset, normalsOffset, colorOffset, tex0Offset;
+};
+
+static PLY_VertexLayout createVertexLayout(const PLY_Element & e) {
+	PLY_VertexLayout layout;
+	VertexDescription & vFormat = layout.description;
+	const VertexAttribute & posAttr = vFormat.appendPosition3D();
+
+	layout.xIndex=e.getPropertyIndex("x");
+	layout.yIndex=e.getPropertyIndex("y");
+	layout.zIndex=e.getPropertyIndex("z");
+
+	layout.nxIndex=e.getPropertyIndex("nx");
+	layout.nyIndex=e.getPropertyIndex("ny");
+	layout.nzIndex=e.getPropertyIndex("nz");
+
+	layout.useVertexNormals=false;
+	VertexAttribute normalAttr;
+	if(layout.nxIndex>=0&&layout.nyIndex>=0&&layout.nzIndex>=0) {
+		layout.useVertexNormals=true;
+		normalAttr = vFormat.appendNormalByte();
+	}
+	layout.useTex0=false;
+	VertexAttribute tex0Attr;
+	layout.sIndex=e.getPropertyIndex("s");
+	layout.tIndex=e.getPropertyIndex("t");
+	if(layout.sIndex>=0&&layout.tIndex>=0) {
+		layout.useTex0=true;
+		tex0Attr = vFormat.appendTexCoord();
+	}
+	if(!layout.useTex0) {
+		layout.sIndex=e.getPropertyIndex("u");
+		layout.tIndex=e.getPropertyIndex("v");
+		if(layout.sIndex>=0&&layout.tIndex>=0) {
+			layout.useTex0=true;
+			tex0Attr = vFormat.appendTexCoord();
+		}
+	}
+	layout.useVertexColor=false;
+	VertexAttribute colorAttr;
+	layout.redIndex=e.getPropertyIndex("red");
+	layout.greenIndex=e.getPropertyIndex("green");
+	layout.blueIndex=e.getPropertyIndex("blue");
+	layout.alphaIndex=e.getPropertyIndex("alpha");
+	if(layout.redIndex>=0&&layout.greenIndex>=0&&layout.blueIndex>=0) {
+		layout.useVertexColor=true;
+		colorAttr = vFormat.appendColorRGBAByte();
+	}
+	layout.posOffset=posAttr.getOffset();
+	layout.normalsOffset=normalAttr.getOffset();
+	layout.colorOffset=colorAttr.getOffset();
+	layout.tex0Offset=tex0Attr.getOffset();
+	return layout;
+}
+
+// ---- Bulk conversion of binary data
+
+template<typename Source, bool swap>
+static inline Source loadValue(const uint8_t * data) {
+	uint8_t bytes[sizeof(Source)];
+	for(size_t i = 0; i < sizeof(Source); ++i)
+		bytes[i] = swap ? data[sizeof(Source) - 1 - i] : data[i];
+	Source value;
+	std::memcpy(&value, bytes, sizeof(Source));
+	return value;
+}
+
+//! Convert @p count values of type @a Source, which are @p sourceStride bytes apart, and store them @p targetStride bytes apart.
+template<typename Source, bool swap, typename Converter>
+static void convertColumn(const uint8_t * source, size_t sourceStride, uint8_t * target, size_t targetStride, uint32_t count, Converter convert) {
+	for(uint32_t i = 0; i < count; ++i) {
+		const auto value = convert(loadValue<Source, swap>(source + i * sourceStride));
+		std::memcpy(target + i * targetStride, &value, sizeof(value));
+	}
+}
+
+template<typename Source, typename Converter>
+static void convertColumn(bool swap, const uint8_t * source, size_t sourceStride, uint8_t * target, size_t targetStride, uint32_t count, Converter convert) {
+	if(swap)
+		convertColumn<Source, true>(source, sourceStride, target, targetStride, count, convert);
+	else
+		convertColumn<Source, false>(source, sourceStride, target, targetStride, count, convert);
+}
+
+//! The type of the source values is only dispatched once per column.
+template<typename Converter>
+static void convertColumn(uint8_t sourceType, bool swap, const uint8_t * source, size_t sourceStride, uint8_t * target, size_t targetStride, uint32_t count, Converter convert) {
+	switch(sourceType) {
+		case PLY_Element::TYPE_CHAR:
+			convertColumn<int8_t>(swap, source, sourceStride, target, targetStride, count, convert);
+			break;
+		case PLY_Element::TYPE_UCHAR:
+			convertColumn<uint8_t>(swap, source, sourceStride, target, targetStride, count, convert);
+			break;
+		case PLY_Element::TYPE_SHORT:
+			convertColumn<int16_t>(swap, source, sourceStride, target, targetStride, count, convert);
+			break;
+		case PLY_Element::TYPE_USHORT:
+			convertColumn<uint16_t>(swap, source, sourceStride, target, targetStride, count, convert);
+			break;
+		case PLY_Element::TYPE_INT:
+			convertColumn<int32_t>(swap, source, sourceStride, target, targetStride, count, convert);
+			break;
+		case PLY_Element::TYPE_UINT:
+			convertColumn<uint32_t>(swap, source, sourceStride, target, targetStride, count, convert);
+			break;
+		case PLY_Element::TYPE_FLOAT:
+			convertColumn<float>(swap, source, sourceStride, target, targetStride, count, convert);
+			break;
+		case PLY_Element::TYPE_DOUBLE:
+			convertColumn<double>(swap, source, sourceStride, target, targetStride, count, convert);
+			break;
+		default:
+			FAIL();
+	}
+}
+
+struct PLY_ToFloat {
+	template<typename T> float operator()(T value) const { return static_cast<float>(value); }
+};
+struct PLY_ToByte {
+	template<typename T> GLbyte operator()(T value) const { return static_cast<GLbyte>(value); }
+};
+struct PLY_ToUByte {
+	template<typename T> GLubyte operator()(T value) const { return static_cast<GLubyte>(value); }
+};
+struct PLY_ToNormalByte {
+	template<typename T> GLbyte operator()(T value) const { return Geometry::Convert::toSigned<int8_t>(static_cast<float>(value)); }
+};
+struct PLY_ToIndex {
+	template<typename T> uint32_t operator()(T value) const { return static_cast<uint32_t>(value); }
+};
+struct PLY_ToCount {
+	template<typename T> int64_t operator()(T value) const { return static_cast<int64_t>(value); }
+};
+
+//! Conversion of a property (or a run of properties) from a binary row into a vertex.
+struct PLY_CopyOp {
+	enum kind_t { COPY, TO_FLOAT, TO_BYTE, TO_UBYTE, TO_NORMAL_BYTE } kind;
+	uint8_t sourceType;
+	size_t sourceOffset;
+	size_t targetOffset; //!< offset in the vertex, or in the float color for toFloatColor
+	size_t size; //!< nr of bytes to copy (COPY only)
+	bool toFloatColor;
+};
+
+/*! Plan for converting the binary rows of a vertex element, which is compiled once per element:
+	properties with the same type as the target are copied (and merged into contiguous runs),
+	all other properties are converted column by column. */
+struct PLY_VertexPlan {
+	std::vector<PLY_CopyOp> ops;
+	size_t rowSize;
+	bool swap;
+	//! If set, the colors are given as floats and converted by Util::Color4ub.
+	bool floatColor;
+	bool floatAlpha;
+	size_t colorOffset;
+
+	void add(PLY_CopyOp::kind_t kind, const PLY_Element & e, int index, size_t targetOffset, bool toFloatColor = false) {
+		const uint8_t type = e.getProperty(index).dataType;
+		PLY_CopyOp op{kind, type, e.getPropertyOffset(index), targetOffset, 0, toFloatColor};
+		const bool sameType = (kind == PLY_CopyOp::TO_FLOAT && type == PLY_Element::TYPE_FLOAT)
+								|| (kind == PLY_CopyOp::TO_BYTE && type == PLY_Element::TYPE_CHAR)
+								|| (kind == PLY_CopyOp::TO_UBYTE && type == PLY_Element::TYPE_UCHAR);
+		if(sameType && !toFloatColor && (!swap || PLY_Element::getDataSize(type) == 1)) {
+			op.kind = PLY_CopyOp::COPY;
+			op.size = PLY_Element::getDataSize(type);
+			// extend a run of consecutive properties
+			for(auto & other : ops) {
+				if(other.kind == PLY_CopyOp::COPY && other.sourceOffset + other.size == op.sourceOffset && other.targetOffset + other.size == op.targetOffset) {
+					other.size += op.size;
+					return;
+				}
+			}
+		}
+		ops.push_back(op);
+	}
+
+	//! The rows can be read directly into the vertex data, if they have the same layout.
+	bool isIdentity(size_t vertexSize) const {
+		return !floatColor && rowSize == vertexSize && ops.size() == 1 && ops.front().kind == PLY_CopyOp::COPY
+				&& ops.front().sourceOffset == 0 && ops.front().targetOffset == 0 && ops.front().size == rowSize;
+	}
 
+	void convert(const uint8_t * source, uint32_t count, uint8_t * target, size_t vertexSize, std::vector<float> & colors) const {
+		if(floatColor)
+			colors.assign(count * 4, 1.0f);
+		uint8_t * colorTarget = reinterpret_cast<uint8_t *>(colors.data());
+		for(const auto & op : ops) {
+			const uint8_t * sourceColumn = source + op.sourceOffset;
+			if(op.toFloatColor) {
+				convertColumn(op.sourceType, swap, sourceColumn, rowSize, colorTarget + op.targetOffset, 4 * sizeof(float), count, PLY_ToFloat());
+				continue;
+			}
+			uint8_t * targetColumn = target + op.targetOffset;
+			switch(op.kind) {
+				case PLY_CopyOp::COPY:
+					for(uint32_t i = 0; i < count; ++i)
+						std::memcpy(targetColumn + i * vertexSize, sourceColumn + i * rowSize, op.size);
+					break;
+				case PLY_CopyOp::TO_FLOAT:
+					convertColumn(op.sourceType, swap, sourceColumn, rowSize, targetColumn, vertexSize, count, PLY_ToFloat());
+					break;
+				case PLY_CopyOp::TO_BYTE:
+					convertColumn(op.sourceType, swap, sourceColumn, rowSize, targetColumn, vertexSize, count, PLY_ToByte());
+					break;
+				case PLY_CopyOp::TO_UBYTE:
+					convertColumn(op.sourceType, swap, sourceColumn, rowSize, targetColumn, vertexSize, count, PLY_ToUByte());
+					break;
+				case PLY_CopyOp::TO_NORMAL_BYTE:
+					convertColumn(op.sourceType, swap, sourceColumn, rowSize, targetColumn, vertexSize, count, PLY_ToNormalByte());
+					break;
+			}
+		}
+		if(floatColor) {
+			for(uint32_t i = 0; i < count; ++i) {
+				const float * c = colors.data() + 4 * i;
+				const Util::Color4ub color(Util::Color4f(c[0], c[1], c[2], c[3]));
+				uint8_t * colorData = target + i * vertexSize + colorOffset;
+				colorData[0] = color.getR();
+				colorData[1] = color.getG();
+				colorData[2] = color.getB();
+				colorData[3] = color.getA();
+			}
+		}
+	}
+};
+
+static PLY_VertexPlan createVertexPlan(const PLY_Element & e, const PLY_VertexLayout & layout) {
+	PLY_VertexPlan plan;
+	plan.rowSize = e.getRowSize();
+	plan.swap = e.isBigEndian();
+	plan.floatColor = false;
+	plan.floatAlpha = false;
+	plan.colorOffset = layout.colorOffset;
+	plan.add(PLY_CopyOp::TO_FLOAT, e, layout.xIndex, layout.posOffset);
+	plan.add(PLY_CopyOp::TO_FLOAT, e, layout.yIndex, layout.posOffset + sizeof(float));
+	plan.add(PLY_CopyOp::TO_FLOAT, e, layout.zIndex, layout.posOffset + 2 * sizeof(float));
+	if(layout.useVertexNormals) {
+		const auto kind = e.getProperty(layout.nxIndex).dataType == PLY_Element::TYPE_CHAR ? PLY_CopyOp::TO_BYTE : PLY_CopyOp::TO_NORMAL_BYTE;
+		plan.add(kind, e, layout.nxIndex, layout.normalsOffset);
+		plan.add(kind, e, layout.nyIndex, layout.normalsOffset + 1);
+		plan.add(kind, e, layout.nzIndex, layout.normalsOffset + 2);
+	}
+	if(layout.useVertexColor) {
+		const int channels[] = {layout.redIndex, layout.greenIndex, layout.blueIndex};
+		if(e.getProperty(layout.redIndex).dataType == PLY_Element::TYPE_FLOAT) {
+			plan.floatColor = true;
+			for(size_t i = 0; i < 3; ++i)
+				plan.add(PLY_CopyOp::TO_FLOAT, e, channels[i], i * sizeof(float), true);
+			if(layout.alphaIndex > 0)
+				plan.add(PLY_CopyOp::TO_FLOAT, e, layout.alphaIndex, 3 * sizeof(float), true);
+		} else {
+			for(size_t i = 0; i < 3; ++i)
+				plan.add(PLY_CopyOp::TO_UBYTE, e, channels[i], layout.colorOffset + i);
+			if(layout.alphaIndex > 0)
+				plan.add(PLY_CopyOp::TO_UBYTE, e, layout.alphaIndex, layout.colorOffset + 3);
+		}
+	}
+	if(layout.useTex0) {
+		plan.add(PLY_CopyOp::TO_FLOAT, e, layout.sIndex, layout.tex0Offset);
+		plan.add(PLY_CopyOp::TO_FLOAT, e, layout.tIndex, layout.tex0Offset + sizeof(float));
+	}
+	return plan;
+}
+
+//! Number of rows converted at once, so that the source data stays in the cache.
+static const uint32_t PLY_BLOCK_SIZE = 1 << 16;
+//! Larger faces are considered as corrupt data.
+static const int64_t PLY_MAX_FACE_SIZE = 1 << 16;
+
+/*! Read the rows of a binary vertex element from the stream directly into the vertex data.
+	\return @c false if the stream ends too early */
+static bool readBinaryVertices(std::istream & input, const PLY_Element & e, MeshVertexData & vertices) {
+	const PLY_VertexLayout layout = createVertexLayout(e);
+	const uint32_t numVertices = e.count;
+	vertices.allocate(numVertices, layout.description);
+	const size_t vertexSize = layout.description.getVertexSize();
+	const PLY_VertexPlan plan = createVertexPlan(e, layout);
+	if(layout.useVertexColor && layout.alphaIndex <= 0 && !plan.floatColor) {
+		// default alpha
+		for(uint32_t i = 0; i < numVertices; ++i)
+			vertices.data()[i * vertexSize + layout.colorOffset + 3] = 255;
+	}
+	if(plan.isIdentity(vertexSize)) {
+		input.read(reinterpret_cast<char *>(vertices.data()), static_cast<std::streamsize>(vertices.dataSize()));
+		return static_cast<size_t>(input.gcount()) == vertices.dataSize();
+	}
+	std::vector<uint8_t> block(plan.rowSize * std::min(numVertices, PLY_BLOCK_SIZE));
+	std::vector<float> colors;
+	for(uint32_t first = 0; first < numVertices; first += PLY_BLOCK_SIZE) {
+		const uint32_t count = std::min(PLY_BLOCK_SIZE, numVertices - first);
+		input.read(reinterpret_cast<char *>(block.data()), static_cast<std::streamsize>(count * plan.rowSize));
+		if(static_cast<size_t>(input.gcount()) != count * plan.rowSize)
+			return false;
+		plan.convert(block.data(), count, vertices.data() + first * vertexSize, vertexSize, colors);
+	}
+	return true;
+}
+
+/*! Read the faces of a binary element that consists only of the "vertex_indices" list.
+	Triangles and quads are stored, of other polygons only the first triangle.
+	\return @c false if the stream ends too early */
+static bool readBinaryFaces(std::istream & input, const PLY_Element & e, MeshIndexData & indices) {
+	const PLY_Element::Property & property = e.getProperty(0);
+	const bool swap = e.isBigEndian();
+	const size_t countSize = PLY_Element::getDataSize(property.countType);
+	const size_t indexSize = PLY_Element::getDataSize(property.dataType);
+	std::streambuf * buffer = input.rdbuf();
+	std::vector<uint32_t> faceIndices;
+	faceIndices.reserve(3 * static_cast<size_t>(e.count));
+	std::vector<uint8_t> row;
+	bool complete = true;
+	for(int j = 0; j < e.count; ++j) {
+		uint8_t countData[8];
+		if(buffer->sgetn(reinterpret_cast<char *>(countData), countSize) != static_cast<std::streamsize>(countSize)) {
+			complete = false;
+			break;
+		}
+		int64_t numPoints;
+		convertColumn(property.countType, swap, countData, countSize, reinterpret_cast<uint8_t *>(&numPoints), sizeof(numPoints), 1, PLY_ToCount());
+		if(numPoints <= 0)
+			continue;
+		if(numPoints > PLY_MAX_FACE_SIZE) {
+			complete = false;
+			break;
+		}
+		row.resize(numPoints * indexSize);
+		if(buffer->sgetn(reinterpret_cast<char *>(row.data()), row.size()) != static_cast<std::streamsize>(row.size())) {
+			complete = false;
+			break;
+		}
+		if(numPoints < 3)
+			continue;
+		uint32_t p[4];
+		convertColumn(property.dataType, swap, row.data(), indexSize, reinterpret_cast<uint8_t *>(p), sizeof(uint32_t), numPoints == 4 ? 4 : 3, PLY_ToIndex());
+		faceIndices.insert(faceIndices.end(), p, p + 3);
+		if(numPoints == 4) {
+			faceIndices.push_back(p[2]);
+			faceIndices.push_back(p[3]);
+			faceIndices.push_back(p[0]);
+		}
+	}
+	indices.allocate(faceIndices.size());
+	std::copy(faceIndices.begin(), faceIndices.end(), indices.data());
+	indices.updateIndexRange();
+	return complete;
+}
+
+//! Read the rest of the stream for the elements that are not read directly.
+static void readRemainingData(std::istream & input, std::vector<char> & buffer) {
+	const std::streampos start = input.tellg();
 	input.seekg(0, std::ios::end);
-	// Use the stream position as size for the new buffer
-	std::vector<char> buffer(input.tellg());
-	input.seekg(0, std::ios::beg);
-	input.read(buffer.data(), buffer.size());
+	const std::streampos end = input.tellg();
+	if(start >= 0 && end >= start) {
+		input.seekg(start);
+		buffer.resize(static_cast<size_t>(end - start));
+		input.read(buffer.data(), buffer.size());
+	} else { // not seekable
+		input.clear();
+		buffer.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+	}
+}
 
+Mesh * StreamerPLY::loadMesh(std::istream & input) {
 	// ---- read header ---
-	if( ! Util::StringUtils::beginsWith(buffer.data(), "ply") ) {
+	std::string line;
+	if( !std::getline(input, line) || !Util::StringUtils::beginsWith(line.c_str(), "ply") ) {
 		std::cerr <<" PLYFileLoader Error: Invalid ply header\n";
 		return nullptr;
 	}
@@ -398,11 +800,13 @@ Mesh * StreamerPLY::loadMesh(std::istream & input) {
 
 	std::vector<PLY_Element> elements;
 
-	while (Util::StringUtils::nextLine(buffer.data(), cursor)) {
-		std::string line=Util::StringUtils::getLine(buffer.data() + cursor);
-		if(Util::StringUtils::beginsWith(buffer.data() + cursor,"comment"))
+	bool headerComplete = false;
+	while (std::getline(input, line)) {
+		if(!line.empty() && line.back() == '\r')
+			line.pop_back();
+		if(Util::StringUtils::beginsWith(line.c_str(),"comment"))
 			continue;
-		else if(Util::StringUtils::beginsWith(buffer.data() + cursor,"element")) {
+		else if(Util::StringUtils::beginsWith(line.c_str(),"element")) {
 			std::istringstream s(line,std::istringstream::in);
 			std::string dummy;
 			std::string elemType;
@@ -410,7 +814,7 @@ Mesh * StreamerPLY::loadMesh(std::istream & input) {
 			s>>dummy>>elemType>>count;
 			elements.emplace_back(elemType, format, count);
 
-		} else if(Util::StringUtils::beginsWith(buffer.data() + cursor,"property")) {
+		} else if(Util::StringUtils::beginsWith(line.c_str(),"property")) {
 			std::istringstream s(line,std::istringstream::in);
 			std::string dummy;
 			std::string dataType;
@@ -429,9 +833,10 @@ Mesh * StreamerPLY::loadMesh(std::istream & input) {
 					elements.back().addProperty(dataType,name);
 				}
 			}
-		} else if(Util::StringUtils::beginsWith(buffer.data() + cursor,"end_header")) {
+		} else if(Util::StringUtils::beginsWith(line.c_str(),"end_header")) {
+			headerComplete = true;
 			break;
-		} else if(Util::StringUtils::beginsWith(buffer.data() + cursor,"format")) {
+		} else if(Util::StringUtils::beginsWith(line.c_str(),"format")) {
 			std::istringstream is(line,std::istringstream::in);
 			std::string dummy;
 			std::string sformat;
@@ -439,137 +844,112 @@ Mesh * StreamerPLY::loadMesh(std::istream & input) {
 			format=PLY_Element::getFormatId(sformat);
 		} else {
 			// ignore unknown Lines
-			// std::cout <<"#"<<line<<"\n";
 		}
 	}
-//    std::cout << "\nFormat: "<<format<< " "<<formatVersion<<"\n";
-
-//    std::cout << "\nCursor at "<<(void*)cursor<<(char)buffer[cursor]<<(char)buffer[cursor+1];
-	Util::StringUtils::nextLine(buffer.data(), cursor);
-//    std::cout << "\nCursor at "<<(void*)cursor<<(char)buffer[cursor]<<(char)buffer[cursor+1];
-	if(cursor >= static_cast<int>(buffer.size())) return nullptr;
+	if(!headerComplete || input.peek() == std::char_traits<char>::eof()) return nullptr;
 
 
 	// ---- Read Data -----
 
-	auto mesh = new Mesh;
+	Util::Reference<Mesh> mesh = new Mesh;
 
-	bool useVertexColor=false;
-	bool useVertexNormals=false;
-	bool useTex0=false;
+	// Binary elements are read directly from the stream. The remaining data is only read into
+	// a buffer, if an element cannot be read directly.
+	std::vector<char> buffer;
+	bool buffered = false;
+	int cursor=0;
 
 	for(auto & e : elements) {
-		
+		if(!buffered && e.isBinary()) {
+			const size_t rowSize = e.getRowSize();
+			if(e.name=="vertex" && rowSize > 0 && e.getPropertyIndex("x") >= 0 && e.getPropertyIndex("y") >= 0 && e.getPropertyIndex("z") >= 0) {
+				MeshVertexData & vertices=mesh->openVertexData();
+				if(!readBinaryVertices(input, e, vertices)) {
+					WARN("PLY: Unexpected end of vertex data.");
+					return nullptr;
+				}
+				vertices.updateBoundingBox();
+				continue;
+			} else if(e.name=="face" && e.getPropertyCount() == 1 && e.getPropertyIndex("vertex_indices") == 0
+						&& e.getProperty(0).isList() && e.getProperty(0).dataType != PLY_Element::TYPE_UNDEFINED
+						&& e.getProperty(0).countType != PLY_Element::TYPE_UNDEFINED) {
+				if(!readBinaryFaces(input, e, mesh->openIndexData()))
+					WARN("PLY: Unexpected end of face data.");
+				continue;
+			} else if(e.name!="vertex" && e.name!="face" && rowSize > 0) {
+				// skip other elements
+				input.ignore(static_cast<std::streamsize>(rowSize * e.count));
+				continue;
+			}
+		}
+		if(!buffered) {
+			readRemainingData(input, buffer);
+			buffered = true;
+		}
+
 		if(e.name=="vertex") {
 			uint32_t numVertices=e.count;
 
-			VertexDescription vFormat;
-			const VertexAttribute & posAttr = vFormat.appendPosition3D();
-
-			int xIndex=e.getPropertyIndex("x");
-			int yIndex=e.getPropertyIndex("y");
-			int zIndex=e.getPropertyIndex("z");
-
-			int nxIndex=e.getPropertyIndex("nx");
-			int nyIndex=e.getPropertyIndex("ny");
-			int nzIndex=e.getPropertyIndex("nz");
-
-			VertexAttribute normalAttr;
-			if(nxIndex>=0&&nyIndex>=0&&nzIndex>=0) {
-				useVertexNormals=true;
-				normalAttr = vFormat.appendNormalByte();
-			}
-			VertexAttribute tex0Attr;
-			int sIndex=e.getPropertyIndex("s");
-			int tIndex=e.getPropertyIndex("t");
-			if(sIndex>=0&&tIndex>=0) {
-				useTex0=true;
-				tex0Attr = vFormat.appendTexCoord();
-			}
-			if(!useTex0) {
-				sIndex=e.getPropertyIndex("u");
-				tIndex=e.getPropertyIndex("v");
-				if(sIndex>=0&&tIndex>=0) {
-					useTex0=true;
-					tex0Attr = vFormat.appendTexCoord();
-				}
-			}
-			VertexAttribute colorAttr;
-			int redIndex=e.getPropertyIndex("red");
-			int greenIndex=e.getPropertyIndex("green");
-			int blueIndex=e.getPropertyIndex("blue");
-			int alphaIndex=e.getPropertyIndex("alpha");
-//#ifdef PLY_LOADER_USE_VERTEX_NORMALS
-			if(redIndex>=0&&greenIndex>=0&&blueIndex>=0) {
-				useVertexColor=true;
-				colorAttr = vFormat.appendColorRGBAByte();
-			}
-//#endif
-			int vertexSize=vFormat.getVertexSize();
-			const int posOffset=posAttr.getOffset();
-			const int normalsOffset=normalAttr.getOffset();
-			const int colorOffset=colorAttr.getOffset();
-			const int tex0Offset=tex0Attr.getOffset();
+			const PLY_VertexLayout layout = createVertexLayout(e);
+			const int vertexSize=layout.description.getVertexSize();
 			MeshVertexData & vertices=mesh->openVertexData();
-			vertices.allocate(numVertices,vFormat);
+			vertices.allocate(numVertices,layout.description);
 
 			uint8_t * vCursor= vertices.data();
 			for(uint32_t j=0;j<numVertices;++j) {
-//				std::cout << "<"<<j;
 				int rowSize=e.parseData(reinterpret_cast<uint8_t *>(buffer.data() + cursor));
 				cursor+=rowSize;
 //
-				*((reinterpret_cast<float *>(vCursor+posOffset))+0)=e.getProperty(xIndex).getCurrentValue<float>();
-				*((reinterpret_cast<float *>(vCursor+posOffset))+1)=e.getProperty(yIndex).getCurrentValue<float>();
-				*((reinterpret_cast<float *>(vCursor+posOffset))+2)=e.getProperty(zIndex).getCurrentValue<float>();
-				if(useVertexNormals) {
+				*((reinterpret_cast<float *>(vCursor+layout.posOffset))+0)=e.getProperty(layout.xIndex).getCurrentValue<float>();
+				*((reinterpret_cast<float *>(vCursor+layout.posOffset))+1)=e.getProperty(layout.yIndex).getCurrentValue<float>();
+				*((reinterpret_cast<float *>(vCursor+layout.posOffset))+2)=e.getProperty(layout.zIndex).getCurrentValue<float>();
+				if(layout.useVertexNormals) {
 
 					GLbyte nx,ny,nz;
-					if(e.getProperty(nxIndex).dataType==PLY_Element::TYPE_CHAR){
-						nx=e.getProperty(nxIndex).getCurrentValue<GLbyte>();
-						ny=e.getProperty(nyIndex).getCurrentValue<GLbyte>();
-						nz=e.getProperty(nzIndex).getCurrentValue<GLbyte>();
-//                        normal=Geometry::Vec3(values[indices[nxIndex]],values[indices[nyIndex]],values[indices[nzIndex]]);
+					if(e.getProperty(layout.nxIndex).dataType==PLY_Element::TYPE_CHAR){
+						nx=e.getProperty(layout.nxIndex).getCurrentValue<GLbyte>();
+						ny=e.getProperty(layout.nyIndex).getCurrentValue<GLbyte>();
+						nz=e.getProperty(layout.nzIndex).getCurrentValue<GLbyte>();
 					}else{
-						nx= Geometry::Convert::toSigned<int8_t>(e.getProperty(nxIndex).getCurrentValue<float>());
-						ny= Geometry::Convert::toSigned<int8_t>(e.getProperty(nyIndex).getCurrentValue<float>());
-						nz= Geometry::Convert::toSigned<int8_t>(e.getProperty(nzIndex).getCurrentValue<float>());
+						nx= Geometry::Convert::toSigned<int8_t>(e.getProperty(layout.nxIndex).getCurrentValue<float>());
+						ny= Geometry::Convert::toSigned<int8_t>(e.getProperty(layout.nyIndex).getCurrentValue<float>());
+						nz= Geometry::Convert::toSigned<int8_t>(e.getProperty(layout.nzIndex).getCurrentValue<float>());
 					}
-					*((reinterpret_cast<GLbyte *>(vCursor+normalsOffset))+0)=nx;
-					*((reinterpret_cast<GLbyte *>(vCursor+normalsOffset))+1)=ny;
-					*((reinterpret_cast<GLbyte *>(vCursor+normalsOffset))+2)=nz;
+					*((reinterpret_cast<GLbyte *>(vCursor+layout.normalsOffset))+0)=nx;
+					*((reinterpret_cast<GLbyte *>(vCursor+layout.normalsOffset))+1)=ny;
+					*((reinterpret_cast<GLbyte *>(vCursor+layout.normalsOffset))+2)=nz;
 				}
-				if(useVertexColor) {
+				if(layout.useVertexColor) {
 					Util::Color4ub color;
-					if(e.getProperty(redIndex).dataType == PLY_Element::TYPE_FLOAT) {
+					if(e.getProperty(layout.redIndex).dataType == PLY_Element::TYPE_FLOAT) {
 						Util::Color4f floatColor;
-						floatColor.setR(e.getProperty(redIndex).getCurrentValue<float>());
-						floatColor.setG(e.getProperty(greenIndex).getCurrentValue<float>());
-						floatColor.setB(e.getProperty(blueIndex).getCurrentValue<float>());
-						if(alphaIndex > 0) {
-							floatColor.setA(e.getProperty(alphaIndex).getCurrentValue<float>());
+						floatColor.setR(e.getProperty(layout.redIndex).getCurrentValue<float>());
+						floatColor.setG(e.getProperty(layout.greenIndex).getCurrentValue<float>());
+						floatColor.setB(e.getProperty(layout.blueIndex).getCurrentValue<float>());
+						if(layout.alphaIndex > 0) {
+							floatColor.setA(e.getProperty(layout.alphaIndex).getCurrentValue<float>());
 						} else {
 							floatColor.setA(1.0f);
 						}
 						color = Util::Color4ub(floatColor);
 					} else { // most likely = TYPE_UCHAR
-						color.setR(e.getProperty(redIndex).getCurrentValue<GLubyte>());
-						color.setG(e.getProperty(greenIndex).getCurrentValue<GLubyte>());
-						color.setB(e.getProperty(blueIndex).getCurrentValue<GLubyte>());
-						if(alphaIndex > 0) {
-							color.setA(e.getProperty(alphaIndex).getCurrentValue<GLubyte>());
+						color.setR(e.getProperty(layout.redIndex).getCurrentValue<GLubyte>());
+						color.setG(e.getProperty(layout.greenIndex).getCurrentValue<GLubyte>());
+						color.setB(e.getProperty(layout.blueIndex).getCurrentValue<GLubyte>());
+						if(layout.alphaIndex > 0) {
+							color.setA(e.getProperty(layout.alphaIndex).getCurrentValue<GLubyte>());
 						} else {
 							color.setA(255);
 						}
 					}
-					*((reinterpret_cast<GLubyte *> (vCursor + colorOffset)) + 0) = color.getR();
-					*((reinterpret_cast<GLubyte *> (vCursor + colorOffset)) + 1) = color.getG();
-					*((reinterpret_cast<GLubyte *> (vCursor + colorOffset)) + 2) = color.getB();
-					*((reinterpret_cast<GLubyte *> (vCursor + colorOffset)) + 3) = color.getA();
+					*((reinterpret_cast<GLubyte *> (vCursor + layout.colorOffset)) + 0) = color.getR();
+					*((reinterpret_cast<GLubyte *> (vCursor + layout.colorOffset)) + 1) = color.getG();
+					*((reinterpret_cast<GLubyte *> (vCursor + layout.colorOffset)) + 2) = color.getB();
+					*((reinterpret_cast<GLubyte *> (vCursor + layout.colorOffset)) + 3) = color.getA();
 				}
-				if(useTex0){
-					*((reinterpret_cast<float *>(vCursor+tex0Offset))+0)=e.getProperty(sIndex).getCurrentValue<float>();
-					*((reinterpret_cast<float *>(vCursor+tex0Offset))+1)=e.getProperty(tIndex).getCurrentValue<float>();
+				if(layout.useTex0){
+					*((reinterpret_cast<float *>(vCursor+layout.tex0Offset))+0)=e.getProperty(layout.sIndex).getCurrentValue<float>();
+					*((reinterpret_cast<float *>(vCursor+layout.tex0Offset))+1)=e.getProperty(layout.tIndex).getCurrentValue<float>();
 				}
 				if(cursor > static_cast<int>(buffer.size())) {
 					std::cerr <<"!!! Buffer overrun!";
@@ -651,7 +1031,7 @@ Mesh * StreamerPLY::loadMesh(std::istream & input) {
 		}
 	}
 
-	return mesh;
+	return mesh.detachAndDecrease();
 }
 
 /**
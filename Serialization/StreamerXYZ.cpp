@@ -7,59 +7,198 @@
 	file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
 */
 #include "StreamerXYZ.h"
+#include "MappedFile.h"
 #include "Serialization.h"
+#include "TextParsing.h"
 #include "../Mesh/Mesh.h"
 #include "../Mesh/VertexDescription.h"
 #include "../MeshUtils/MeshBuilder.h"
+#include "../MeshUtils/ParallelFor.h"
 #include <Geometry/Vec3.h>
 #include <Geometry/PointOctree.h>
 #include <Util/GenericAttribute.h>
 #include <Util/IO/FileUtils.h>
 #include <Util/Macros.h>
+#include <algorithm>
+#include <cstring>
 #include <istream>
 #include <random>
 #include <limits>
+#include <stdexcept>
 
 namespace Rendering {
 namespace Serialization {
 
 const char * const StreamerXYZ::fileExtension = "xyz";
 
-Mesh * StreamerXYZ::loadMesh(std::istream & input, std::size_t numPoints) {
-	VertexDescription vertexDesc;
-	vertexDesc.appendPosition3D();
-	vertexDesc.appendColorRGBAByte();
+using namespace TextParsing;
 
-	struct Point {
-		float x, y, z;
-		uint8_t r, g, b, a;
-		Point(float _x, float _y, float _z,
-			  uint8_t _r, uint8_t _g, uint8_t _b) :
-			x(_x), y(_y), z(_z),
-			r(_r), g(_g), b(_b), a(255) {
-		}
-	};
-	if(sizeof(Point) != vertexDesc.getVertexSize()) {
-		WARN("Different vertex sizes.");
-		FAIL();
-	}
-	std::vector<Point> points;
+//! Size of the blocks read from streams (longer lines enlarge the block).
+static const size_t XYZ_BLOCK_SIZE = 1 << 22;
+//! Size of the blocks parsed at once from memory mapped files.
+static const size_t XYZ_MAPPED_BLOCK_SIZE = 1 << 26;
+//! Blocks are split into parts of at least this size for parsing them concurrently.
+static const size_t XYZ_MIN_PART_SIZE = 1 << 20;
+//! Number of bits per axis of the grid cells used by clusterPointsSpatially().
+static const uint32_t XYZ_MORTON_BITS = 7;
 
+//! Vertex layout of the created meshes.
+struct XYZPoint {
 	float x, y, z;
-	uint16_t r, g, b;
-	while(input.good()) {
-		input >> x >> y >> z >> r >> g >> b;
-		points.emplace_back(x, y, z, r, g, b);
-		
-		if(numPoints != 0 && points.size() >= numPoints) {
+	uint8_t r, g, b, a;
+};
+
+/*! Parse a line "x y z [r g b]"; missing color values are 255.
+	\return @c false if the line does not start with three numbers (e.g. empty lines and comments) */
+static bool parsePoint(const char * cursor, const char * lineEnd, XYZPoint & point) {
+	float position[3];
+	for(auto & value : position) {
+		const char * numberStart = cursor;
+		value = parseFloat(cursor, lineEnd);
+		if(cursor == numberStart)
+			return false;
+	}
+	point.x = position[0];
+	point.y = position[1];
+	point.z = position[2];
+	uint8_t color[3] = {255, 255, 255};
+	for(auto & value : color) {
+		const char * numberStart = cursor;
+		const int64_t number = parseInt(cursor, lineEnd);
+		if(cursor == numberStart)
 			break;
+		value = static_cast<uint8_t>(std::max<int64_t>(0, std::min<int64_t>(255, number)));
+	}
+	point.r = color[0];
+	point.g = color[1];
+	point.b = color[2];
+	point.a = 255;
+	return true;
+}
+
+//! Return the end of the line starting at @p cursor (the position of the line break or @p end).
+static const char * findLineEnd(const char * cursor, const char * end) {
+	const void * lineBreak = std::memchr(cursor, '\n', static_cast<size_t>(end - cursor));
+	return lineBreak != nullptr ? static_cast<const char *>(lineBreak) : end;
+}
+
+/*! Parse the lines in [cursor, end) and append at most @p maxCount points.
+	\return the position behind the line of the last appended point, or @p end */
+static const char * parseLines(const char * cursor, const char * end, std::vector<XYZPoint> & points, size_t maxCount) {
+	for(size_t count = 0; cursor < end && count < maxCount;) {
+		const char * lineEnd = findLineEnd(cursor, end);
+		XYZPoint point;
+		if(parsePoint(cursor, lineEnd, point)) {
+			points.push_back(point);
+			++count;
+		}
+		cursor = lineEnd < end ? lineEnd + 1 : end;
+	}
+	return cursor;
+}
+
+/*! Parse the complete lines in [begin, end) with up to @p workerCount threads and append at most @p maxCount points.
+	\return the position behind the line of the last appended point, or @p end */
+static const char * parseBlock(const char * begin, const char * end, uint32_t workerCount, std::vector<XYZPoint> & points, size_t maxCount) {
+	const size_t size = static_cast<size_t>(end - begin);
+	workerCount = static_cast<uint32_t>(std::min<size_t>(workerCount, size / XYZ_MIN_PART_SIZE));
+	// every point needs at least six bytes ("0 0 0\n"), so a block with fewer points is not parsed completely
+	if(workerCount <= 1 || maxCount < size / 6)
+		return parseLines(begin, end, points, maxCount);
+
+	std::vector<const char *> partBegins(workerCount + 1, end);
+	partBegins[0] = begin;
+	for(uint32_t i = 1; i < workerCount; ++i) {
+		const char * cursor = std::max(partBegins[i - 1], begin + size / workerCount * i);
+		const char * lineEnd = findLineEnd(cursor, end);
+		partBegins[i] = lineEnd < end ? lineEnd + 1 : end;
+	}
+	std::vector<std::vector<XYZPoint>> parts(workerCount);
+	MeshUtils::parallelFor(workerCount, 0, workerCount, [&](uint32_t, uint32_t first, uint32_t last) {
+		for(uint32_t i = first; i < last; ++i) {
+			parts[i].reserve(static_cast<size_t>(partBegins[i + 1] - partBegins[i]) / 24);
+			parseLines(partBegins[i], partBegins[i + 1], parts[i], std::numeric_limits<size_t>::max());
+		}
+	});
+	for(uint32_t i = 0; i < workerCount; ++i) {
+		if(parts[i].size() > maxCount) // find the end of the last requested point
+			return parseLines(partBegins[i], partBegins[i + 1], points, maxCount);
+		points.insert(points.end(), parts[i].begin(), parts[i].end());
+		maxCount -= parts[i].size();
+	}
+	return end;
+}
+
+//! Provides the input in blocks of complete lines, either from a stream or from memory (e.g. a memory mapped file).
+struct XYZBlockReader {
+	std::istream * input;
+	std::vector<char> buffer;
+	const char * memory;
+	size_t size; //!< nr of bytes of the memory or in the buffer
+	size_t blockEnd; //!< end of the current block in the memory or buffer
+	bool finished; //!< the stream has been read completely
+
+	XYZBlockReader(std::istream & _input, size_t blockSize) : input(&_input), buffer(blockSize), memory(nullptr), size(0), blockEnd(0), finished(false) {}
+	XYZBlockReader(const char * _memory, size_t _size) : input(nullptr), memory(_memory), size(_size), blockEnd(0), finished(true) {}
+
+	/*! Provide the next block [begin, end); the previous block is released.
+		\return @c false if there is no more data */
+	bool next(const char *& begin, const char *& end) {
+		if(memory != nullptr) {
+			begin = memory + blockEnd;
+			if(size - blockEnd > XYZ_MAPPED_BLOCK_SIZE) {
+				const char * lineEnd = findLineEnd(begin + XYZ_MAPPED_BLOCK_SIZE, memory + size);
+				blockEnd = lineEnd < memory + size ? static_cast<size_t>(lineEnd + 1 - memory) : size;
+			} else {
+				blockEnd = size;
+			}
+			end = memory + blockEnd;
+			return begin < end;
 		}
+		// keep the incomplete line at the end of the previous block
+		std::memmove(buffer.data(), buffer.data() + blockEnd, size - blockEnd);
+		size -= blockEnd;
+		blockEnd = 0;
+		while(blockEnd == 0) {
+			if(!finished) {
+				if(size == buffer.size())
+					buffer.resize(2 * buffer.size());
+				input->read(buffer.data() + size, static_cast<std::streamsize>(buffer.size() - size));
+				size += static_cast<size_t>(input->gcount());
+				finished = !input->good();
+			}
+			if(finished) {
+				blockEnd = size;
+				break;
+			}
+			const auto lastLineBreak = std::find(buffer.rbegin() + static_cast<std::ptrdiff_t>(buffer.size() - size), buffer.rend(), '\n');
+			blockEnd = static_cast<size_t>(buffer.rend() - lastLineBreak);
+		}
+		begin = buffer.data();
+		end = begin + blockEnd;
+		return blockEnd > 0;
+	}
+
+	//! Nr of bytes of a stream that have been read, but do not belong to the current block or previous blocks.
+	size_t getPendingBytes() const {
+		return memory != nullptr ? 0 : size - blockEnd;
+	}
+};
+
+static Mesh * createMesh(const XYZPoint * points, size_t count) {
+	VertexDescription vertexDesc;
+	vertexDesc.appendPosition3D();
+	vertexDesc.appendColorRGBAByte();
+	if(sizeof(XYZPoint) != vertexDesc.getVertexSize()) {
+		WARN("Different vertex sizes.");
+		FAIL();
 	}
 
-	auto mesh = new Mesh(vertexDesc, points.size(), 0);
+	auto mesh = new Mesh(vertexDesc, static_cast<uint32_t>(count), 0);
 
 	MeshVertexData & vd = mesh->openVertexData();
-	std::copy(points.data(), points.data() + points.size(), reinterpret_cast<Point *>(vd.data()));
+	if(count > 0)
+		std::memcpy(vd.data(), points, count * sizeof(XYZPoint));
 	vd.markAsChanged();
 	vd.updateBoundingBox();
 
@@ -68,16 +207,67 @@ Mesh * StreamerXYZ::loadMesh(std::istream & input, std::size_t numPoints) {
 	return mesh;
 }
 
-Util::GenericAttributeList * StreamerXYZ::loadGeneric(std::istream & input) {
+//! Create meshes of StreamerXYZ::MAX_POINTS_PER_MESH points and remove their points; if @p complete is set, the remaining points form another mesh.
+static void appendMeshes(Util::GenericAttributeList & list, std::vector<XYZPoint> & points, bool complete) {
+	size_t first = 0;
+	while(points.size() - first >= StreamerXYZ::MAX_POINTS_PER_MESH || (complete && first < points.size())) {
+		const size_t count = std::min<size_t>(points.size() - first, StreamerXYZ::MAX_POINTS_PER_MESH);
+		list.push_back(Serialization::createMeshDescription(createMesh(points.data() + first, count)));
+		first += count;
+	}
+	points.erase(points.begin(), points.begin() + static_cast<std::ptrdiff_t>(first));
+}
+
+static Util::GenericAttributeList * loadBlocks(XYZBlockReader & reader, uint32_t workerCount) {
 	auto list = new Util::GenericAttributeList;
-	while(input.good()) {
-		Mesh * mesh = loadMesh(input, 1000000);
-		Util::GenericAttributeMap * desc = Serialization::createMeshDescription(mesh);
-		list->push_back(desc);
+	std::vector<XYZPoint> points;
+	const char * begin;
+	const char * end;
+	while(reader.next(begin, end)) {
+		parseBlock(begin, end, workerCount, points, std::numeric_limits<size_t>::max());
+		appendMeshes(*list, points, false);
 	}
+	appendMeshes(*list, points, true);
 	return list;
 }
 
+Mesh * StreamerXYZ::loadMesh(std::istream & input, std::size_t numPoints) {
+	if(numPoints == 0)
+		numPoints = std::numeric_limits<size_t>::max();
+	const uint32_t workerCount = MeshUtils::getWorkerCount(threadCount);
+	std::vector<XYZPoint> points;
+	// do not read much more than needed, as the rest has to be read again
+	const size_t expectedLineSize = 64;
+	XYZBlockReader reader(input, std::max<size_t>(4096, std::min(XYZ_BLOCK_SIZE / expectedLineSize, numPoints) * expectedLineSize));
+	const char * begin;
+	const char * end;
+	while(points.size() < numPoints && reader.next(begin, end)) {
+		const char * stop = parseBlock(begin, end, workerCount, points, numPoints - points.size());
+		// return the data behind the last point to the stream
+		const size_t unusedBytes = static_cast<size_t>(end - stop) + reader.getPendingBytes();
+		if(points.size() == numPoints && unusedBytes > 0) {
+			input.clear();
+			input.seekg(-static_cast<std::streamoff>(unusedBytes), std::ios::cur);
+			if(!input.good())
+				WARN("StreamerXYZ: The input cannot be positioned behind the loaded points.");
+		}
+	}
+	return createMesh(points.data(), points.size());
+}
+
+Util::GenericAttributeList * StreamerXYZ::loadGeneric(std::istream & input) {
+	XYZBlockReader reader(input, XYZ_BLOCK_SIZE);
+	return loadBlocks(reader, MeshUtils::getWorkerCount(threadCount));
+}
+
+Util::GenericAttributeList * StreamerXYZ::loadGenericMapped(const std::string & path) {
+	const auto mapping = MappedFile::open(path);
+	if(!mapping)
+		return nullptr;
+	XYZBlockReader reader(reinterpret_cast<const char *>(mapping->data()), mapping->size());
+	return loadBlocks(reader, MeshUtils::getWorkerCount(threadCount));
+}
+
 uint8_t StreamerXYZ::queryCapabilities(const std::string & extension) {
 	if(extension == fileExtension) {
 		return CAP_LOAD_MESH | CAP_LOAD_GENERIC;
@@ -86,14 +276,9 @@ uint8_t StreamerXYZ::queryCapabilities(const std::string & extension) {
 	}
 }
 
-//! (static)
-void StreamerXYZ::clusterPoints( const Util::FileName & inputFile, size_t numberOfClusters ){
-	auto input = Util::FileUtils::openForReading(inputFile);
-	FAIL_IF(!input->good());
-
-	std::vector<std::unique_ptr<std::ostream> > outputHolder;
-	std::vector<std::ostream* > outputs;
-	
+//! Open the files "<inputFile without ending>_<i>.xyz" for writing.
+static void openClusterFiles(const Util::FileName & inputFile, size_t numberOfClusters,
+								std::vector<std::unique_ptr<std::ostream>> & outputHolder, std::vector<std::ostream *> & outputs) {
 	std::string baseFileName;
 	{
 		Util::FileName f(inputFile);
@@ -107,6 +292,16 @@ void StreamerXYZ::clusterPoints( const Util::FileName & inputFile, size_t number
 		outputHolder.emplace_back(Util::FileUtils::openForWriting(Util::FileName(outFileName.str())));
 		outputs.push_back(outputHolder.back().get());
 	}
+}
+
+//! (static)
+void StreamerXYZ::clusterPoints( const Util::FileName & inputFile, size_t numberOfClusters ){
+	auto input = Util::FileUtils::openForReading(inputFile);
+	FAIL_IF(!input->good());
+
+	std::vector<std::unique_ptr<std::ostream> > outputHolder;
+	std::vector<std::ostream* > outputs;
+	openClusterFiles(inputFile, numberOfClusters, outputHolder, outputs);
 	clusterPoints(*input,outputs);
 }
 
@@ -252,5 +447,125 @@ void StreamerXYZ::clusterPoints( std::istream & input, std::vector<std::ostream*
 	std::cout << "Done.\n";
 	
 }
+
+//! Spread the lower ten bits of @p v, so that there are two zero bits in between each of them.
+static uint32_t spreadBits(uint32_t v) {
+	v &= 0x3ff;
+	v = (v | (v << 16)) & 0x030000ff;
+	v = (v | (v << 8)) & 0x0300f00f;
+	v = (v | (v << 4)) & 0x030c30c3;
+	v = (v | (v << 2)) & 0x09249249;
+	return v;
+}
+
+//! Maps positions to the cells of a regular grid of 2^XYZ_MORTON_BITS cells per axis, enumerated in Morton order.
+struct XYZMortonGrid {
+	float origin[3];
+	float scale;
+
+	explicit XYZMortonGrid(const Geometry::Box & bounds) : origin{bounds.getMinX(), bounds.getMinY(), bounds.getMinZ()},
+			scale(bounds.getExtentMax() > 0 ? static_cast<float>(1u << XYZ_MORTON_BITS) / bounds.getExtentMax() : 0.0f) {
+	}
+	uint32_t getCell(const XYZPoint & point) const {
+		const float position[3] = {point.x, point.y, point.z};
+		uint32_t code = 0;
+		for(uint32_t axis = 0; axis < 3; ++axis) {
+			const float cell = (position[axis] - origin[axis]) * scale;
+			const uint32_t index = cell > 0 ? std::min(static_cast<uint32_t>(cell), (1u << XYZ_MORTON_BITS) - 1) : 0;
+			code |= spreadBits(index) << axis;
+		}
+		return code;
+	}
+};
+
+/*! Read the input from its beginning and call @p process(lineBegin, lineEnd, point) for each point.
+	@p lineEnd is behind the line break, if there is one. */
+template<typename Function>
+static void forEachPoint(std::istream & input, Function process) {
+	input.clear();
+	input.seekg(0, std::ios::beg);
+	if(!input.good())
+		throw std::invalid_argument("StreamerXYZ: The input cannot be read repeatedly.");
+	XYZBlockReader reader(input, XYZ_BLOCK_SIZE);
+	const char * begin;
+	const char * end;
+	while(reader.next(begin, end)) {
+		for(const char * cursor = begin; cursor < end;) {
+			const char * lineEnd = findLineEnd(cursor, end);
+			const char * nextLine = lineEnd < end ? lineEnd + 1 : end;
+			XYZPoint point;
+			if(parsePoint(cursor, lineEnd, point))
+				process(cursor, nextLine, point);
+			cursor = nextLine;
+		}
+	}
+}
+
+//! (static)
+void StreamerXYZ::clusterPointsSpatially( const Util::FileName & inputFile, size_t numberOfClusters ){
+	auto input = Util::FileUtils::openForReading(inputFile);
+	FAIL_IF(!input->good());
+
+	std::vector<std::unique_ptr<std::ostream> > outputHolder;
+	std::vector<std::ostream* > outputs;
+	openClusterFiles(inputFile, numberOfClusters, outputHolder, outputs);
+	clusterPointsSpatially(*input,outputs);
+}
+
+//! (static)
+void StreamerXYZ::clusterPointsSpatially( std::istream & input, std::vector<std::ostream*> & outputs ){
+	if(outputs.empty())
+		throw std::invalid_argument("StreamerXYZ::clusterPointsSpatially: No outputs given.");
+
+	// 1. pass: bounding box
+	Geometry::Box bounds;
+	bounds.invalidate();
+	uint64_t pointCount = 0;
+	forEachPoint(input, [&](const char *, const char *, const XYZPoint & point) {
+		bounds.include(Geometry::Vec3(point.x, point.y, point.z));
+		++pointCount;
+	});
+	if(pointCount == 0)
+		return;
+	const XYZMortonGrid grid(bounds);
+
+	// 2. pass: nr of points per cell
+	const uint32_t cellCount = 1u << (3 * XYZ_MORTON_BITS);
+	std::vector<uint64_t> histogram(cellCount, 0);
+	forEachPoint(input, [&](const char *, const char *, const XYZPoint & point) {
+		++histogram[grid.getCell(point)];
+	});
+
+	// split the cells in Morton order into ranges of about pointCount / numClusters points
+	const uint64_t numClusters = outputs.size();
+	std::vector<uint32_t> cellClusters(cellCount);
+	uint64_t pointsBefore = 0;
+	for(uint32_t cell = 0; cell < cellCount; ++cell) {
+		// a cell belongs to the cluster containing its middle point
+		const uint64_t middle = pointsBefore + histogram[cell] / 2;
+		cellClusters[cell] = static_cast<uint32_t>(std::min(numClusters - 1, middle * numClusters / pointCount));
+		pointsBefore += histogram[cell];
+	}
+	histogram.clear();
+	histogram.shrink_to_fit();
+
+	// 3. pass: copy the lines to the outputs
+	static const size_t OUTPUT_BUFFER_SIZE = 1 << 16;
+	std::vector<std::string> buffers(outputs.size());
+	forEachPoint(input, [&](const char * lineBegin, const char * lineEnd, const XYZPoint & point) {
+		const uint32_t cluster = cellClusters[grid.getCell(point)];
+		std::string & buffer = buffers[cluster];
+		buffer.append(lineBegin, lineEnd);
+		if(buffer.back() != '\n')
+			buffer.push_back('\n');
+		if(buffer.size() >= OUTPUT_BUFFER_SIZE) {
+			outputs[cluster]->write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+			buffer.clear();
+		}
+	});
+	for(size_t i = 0; i < outputs.size(); ++i)
+		outputs[i]->write(buffers[i].data(), static_cast<std::streamsize>(buffers[i].size()));
+}
+
 }
 }
@@ -10,6 +10,9 @@
 #define RENDERING_STREAMERXYZ_H_
 
 #include "AbstractRenderingStreamer.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
 #include <vector>
 namespace Util{
 class FileName;
@@ -18,10 +21,18 @@ class FileName;
 namespace Rendering {
 namespace Serialization {
 
+/**
+ * Loader for .xyz point clouds (one point "x y z [r g b]" per line).
+ * The input is read in blocks of complete lines, which are parsed concurrently,
+ * so that only a fixed amount of text is held in memory at any time.
+ */
 class StreamerXYZ : public AbstractRenderingStreamer {
 	public:
+		//! Maximum number of points of the meshes created by loadGeneric().
+		static const uint32_t MAX_POINTS_PER_MESH = 1000000;
+
 		StreamerXYZ() :
-			AbstractRenderingStreamer() {
+			AbstractRenderingStreamer(), threadCount(0) {
 		}
 		virtual ~StreamerXYZ() {
 		}
@@ -29,18 +40,41 @@ class StreamerXYZ : public AbstractRenderingStreamer {
 		Mesh * loadMesh(std::istream & input) override {
 			return loadMesh(input, 0);
 		}
+		/*! Load at most @p numPoints points (all points, if zero).
+			If the input is seekable, it is positioned behind the line of the last loaded point afterwards. */
 		Mesh * loadMesh(std::istream & input, std::size_t numPoints);
+		//! Load the points split into meshes of at most MAX_POINTS_PER_MESH points.
 		Util::GenericAttributeList * loadGeneric(std::istream & input) override;
-		
-		
+
+		/*! Load a file of the local file system through a memory mapping instead of copying its content.
+			\return the descriptions, or nullptr if the file cannot be mapped */
+		Util::GenericAttributeList * loadGenericMapped(const std::string & path);
+
+		//! Number of threads used for parsing; zero (default) selects the number of hardware threads.
+		void setThreadCount(uint32_t count)				{	threadCount = count;	}
+		uint32_t getThreadCount() const					{	return threadCount;	}
+
 		/*! Distributes the points in the given xyz-input file into @p numberOfClusters many .xyz-files
 			in the same directory (having a number postfix).
 			This function should handle files of arbitrary size.	*/		
 		static void clusterPoints( const Util::FileName & inputFile, size_t numberOfClusters );
 		static void clusterPoints( std::istream & input, std::vector<std::ostream*> & outputs );
 
+		/*! Like clusterPoints(), but the points are sorted along a Morton order (Z-order curve)
+			of a regular grid over their bounding box, which is split into ranges holding
+			about the same number of points. So the clusters are spatially coherent and
+			balanced up to the number of points in a single grid cell.
+			The input is read three times in blocks of a fixed size, so the required memory
+			does not depend on the number of points.	*/
+		static void clusterPointsSpatially( const Util::FileName & inputFile, size_t numberOfClusters );
+		//! \note @p input must be seekable.
+		static void clusterPointsSpatially( std::istream & input, std::vector<std::ostream*> & outputs );
+
 		static uint8_t queryCapabilities(const std::string & extension);
 		static const char * const fileExtension;
+
+	private:
+		uint32_t threadCount;
 };
 
 }
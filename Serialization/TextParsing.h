@@ -0,0 +1,157 @@
+/*
+	This file is part of the Rendering library.
+	Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+	This library is subject to the terms of the Mozilla Public License, v. 2.0.
+	You should have received a copy of the MPL along with this library; see the
+	file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+#ifndef RENDERING_TEXTPARSING_H_
+#define RENDERING_TEXTPARSING_H_
+
+#include <cfloat>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace Rendering {
+namespace Serialization {
+
+/**
+ * Fast parsing of numbers in text based file formats (e.g. .obj, .xyz).
+ * The functions work on a range of memory [cursor, end), which need not be
+ * terminated, and never cross a line break.
+ */
+namespace TextParsing {
+
+inline bool isBlank(char c) {
+	return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+inline bool isDigit(char c) {
+	return c >= '0' && c <= '9';
+}
+
+inline const char * skipBlanks(const char * cursor, const char * end) {
+	while(cursor < end && isBlank(*cursor))
+		++cursor;
+	return cursor;
+}
+
+//! Parse the number at @p cursor with strtof, which needs a terminated copy of it.
+inline float parseFloatSlow(const char *& cursor, const char * end) {
+	char buffer[128];
+	size_t length = 0;
+	while(cursor + length < end && length < sizeof(buffer) - 1 && !isBlank(cursor[length]) && cursor[length] != '\n') {
+		buffer[length] = cursor[length];
+		++length;
+	}
+	buffer[length] = '\0';
+	char * numberEnd;
+	const float value = std::strtof(buffer, &numberEnd);
+	if(numberEnd == buffer)
+		return 0.0f;
+	cursor += numberEnd - buffer;
+	return value;
+}
+
+/*! Parse a decimal floating point number within the current line like strtof (with the same result).
+	Numbers with up to 15 significant digits and small exponents are converted directly;
+	the rare other cases fall back to strtof.
+	\return the value, or 0 if there is no number (then @p cursor is not changed) */
+inline float parseFloat(const char *& cursor, const char * end) {
+	static const double powersOf10[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+	const char * start = skipBlanks(cursor, end);
+	const char * c = start;
+	bool negative = false;
+	if(c < end && (*c == '-' || *c == '+')) {
+		negative = (*c == '-');
+		++c;
+	}
+	uint64_t mantissa = 0;
+	int32_t significantDigits = 0;
+	int32_t exponent = 0;
+	bool hasDigits = false;
+	for(; c < end && isDigit(*c); ++c) {
+		hasDigits = true;
+		mantissa = mantissa * 10 + static_cast<uint64_t>(*c - '0');
+		if(mantissa != 0)
+			++significantDigits;
+	}
+	if(c < end && *c == '.') {
+		for(++c; c < end && isDigit(*c); ++c) {
+			hasDigits = true;
+			mantissa = mantissa * 10 + static_cast<uint64_t>(*c - '0');
+			if(mantissa != 0)
+				++significantDigits;
+			--exponent;
+		}
+	}
+	if(!hasDigits || significantDigits > 15) // e.g. "inf", "nan" or too many digits
+		return parseFloatSlow(cursor = start, end);
+	if(c < end && (*c == 'e' || *c == 'E')) {
+		const char * e = c + 1;
+		bool negativeExponent = false;
+		if(e < end && (*e == '-' || *e == '+')) {
+			negativeExponent = (*e == '-');
+			++e;
+		}
+		if(e < end && isDigit(*e)) {
+			int32_t value = 0;
+			for(; e < end && isDigit(*e); ++e) {
+				if(value < 10000)
+					value = value * 10 + (*e - '0');
+			}
+			exponent += negativeExponent ? -value : value;
+			c = e;
+		}
+	}
+	if(c < end && (*c == 'x' || *c == 'X')) // hexadecimal
+		return parseFloatSlow(cursor = start, end);
+	if(mantissa == 0) {
+		cursor = c;
+		return negative ? -0.0f : 0.0f;
+	}
+	if(exponent < -22 || exponent > 22)
+		return parseFloatSlow(cursor = start, end);
+	// both the mantissa and the power of ten are exact, so the result is correctly rounded to double
+	double value = static_cast<double>(mantissa);
+	value = exponent < 0 ? value / powersOf10[-exponent] : value * powersOf10[exponent];
+	// rounding to float again is only wrong, if the double is exactly in the middle of two floats
+	uint64_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	if(value < FLT_MIN || value > FLT_MAX || (bits & 0x1fffffff) == 0x10000000)
+		return parseFloatSlow(cursor = start, end);
+	cursor = c;
+	return negative ? -static_cast<float>(value) : static_cast<float>(value);
+}
+
+/*! Parse an integer within the current line like strtol.
+	\return the value, or 0 if there is no number (then @p cursor is not changed) */
+inline int64_t parseInt(const char *& cursor, const char * end) {
+	const char * c = skipBlanks(cursor, end);
+	bool negative = false;
+	if(c < end && (*c == '-' || *c == '+')) {
+		negative = (*c == '-');
+		++c;
+	}
+	if(c >= end || !isDigit(*c))
+		return 0;
+	int64_t value = 0;
+	for(; c < end && isDigit(*c); ++c) {
+		if(value < (int64_t(1) << 40))
+			value = value * 10 + (*c - '0');
+	}
+	cursor = c;
+	return negative ? -value : value;
+}
+
+}
+
+}
+}
+
+#endif /* RENDERING_TEXTPARSING_H_ */
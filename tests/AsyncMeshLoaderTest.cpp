@@ -0,0 +1,102 @@
+/*
+ This file is part of the Rendering library.
+ Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+ This library is subject to the terms of the Mozilla Public License, v. 2.0.
+ You should have received a copy of the MPL along with this library; see the
+ file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <catch2/catch.hpp>
+#include <Rendering/Mesh/Mesh.h>
+#include <Rendering/Mesh/MeshDataStrategy.h>
+#include <Rendering/Mesh/MeshVertexData.h>
+#include <Rendering/Mesh/VertexDescription.h>
+#include <Rendering/Serialization/AsyncMeshLoader.h>
+#include <Rendering/Serialization/StreamerMMF.h>
+
+#include <Util/IO/FileName.h>
+#include <Util/References.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Rendering;
+
+//! Records the threads that prepare meshes for display.
+class RecordingStrategy : public MeshDataStrategy {
+	public:
+		std::vector<std::thread::id> preparingThreads;
+
+		void assureLocalVertexData(Mesh *) override {}
+		void assureLocalIndexData(Mesh *) override {}
+		void prepare(Mesh *) override {
+			preparingThreads.push_back(std::this_thread::get_id());
+		}
+		void displayMesh(RenderingContext &, Mesh *, uint32_t, uint32_t) override {}
+};
+
+TEST_CASE("AsyncMeshLoaderTest_loadMeshAsync", "[AsyncMeshLoaderTest]") {
+	const std::string fileName("AsyncMeshLoaderTest.mmf");
+	{
+		VertexDescription vd;
+		vd.appendPosition3D();
+		Util::Reference<Mesh> mesh = new Mesh(vd, 100, 0);
+		mesh->setUseIndexData(false);
+		std::ofstream output(fileName, std::ios::binary);
+		Serialization::StreamerMMF streamer;
+		REQUIRE(streamer.saveMesh(mesh.get(), output));
+	}
+
+	RecordingStrategy strategy;
+	std::mutex mutex;
+	std::vector<std::thread::id> postProcessingThreads;
+	uint32_t callbackCount = 0;
+
+	Serialization::AsyncMeshLoader loader(2);
+	REQUIRE(loader.getWorkerCount() == 2);
+	std::vector<Serialization::AsyncMeshLoader::MeshFuture_t> futures;
+	for(uint32_t i = 0; i < 8; ++i) {
+		futures.push_back(loader.loadMeshAsync(Util::FileName(fileName),
+			[&](Mesh * mesh) {
+				mesh->setDataStrategy(&strategy);
+				std::lock_guard<std::mutex> lock(mutex);
+				postProcessingThreads.push_back(std::this_thread::get_id());
+			},
+			[&](Mesh * mesh) {
+				REQUIRE(mesh != nullptr);
+				++callbackCount;
+			}));
+	}
+	auto missing = loader.loadMeshAsync(Util::FileName("AsyncMeshLoaderTest_missing.mmf"));
+
+	while(loader.getPendingCount() > 0) {
+		loader.processCompleted(3);
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	REQUIRE(loader.getCompletedCount() == 0);
+	REQUIRE(callbackCount == 8);
+	for(auto & future : futures) {
+		REQUIRE(future.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+		REQUIRE(future.get().isNotNull());
+		REQUIRE(future.get()->getVertexCount() == 100);
+	}
+	REQUIRE(missing.get().isNull());
+
+	// parsing is done by the workers, uploading by the calling thread
+	REQUIRE(postProcessingThreads.size() == 8);
+	for(const auto & id : postProcessingThreads)
+		REQUIRE(id != std::this_thread::get_id());
+	REQUIRE(strategy.preparingThreads.size() == 8);
+	for(const auto & id : strategy.preparingThreads)
+		REQUIRE(id == std::this_thread::get_id());
+
+	futures.clear();
+	std::remove(fileName.c_str());
+}
@@ -0,0 +1,149 @@
+/*
+ This file is part of the Rendering library.
+ Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+ This library is subject to the terms of the Mozilla Public License, v. 2.0.
+ You should have received a copy of the MPL along with this library; see the
+ file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <catch2/catch.hpp>
+#include <Rendering/Mesh/Mesh.h>
+#include <Rendering/Mesh/MeshIndexData.h>
+#include <Rendering/Mesh/MeshVertexData.h>
+#include <Rendering/Mesh/VertexDescription.h>
+#include <Rendering/Serialization/GenericAttributeSerialization.h>
+#include <Rendering/Serialization/MeshBlobContainer.h>
+
+#include <Util/GenericAttribute.h>
+#include <Util/References.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Rendering;
+
+static Mesh * createTestMesh(uint32_t vertexCount) {
+	VertexDescription vd;
+	vd.appendPosition3D();
+	Mesh * mesh = new Mesh(vd, vertexCount, vertexCount);
+	float * positions = reinterpret_cast<float *>(mesh->openVertexData().data());
+	for(uint32_t i = 0; i < vertexCount * 3; ++i)
+		positions[i] = static_cast<float>(i);
+	uint32_t * indices = mesh->openIndexData().data();
+	for(uint32_t i = 0; i < vertexCount; ++i)
+		indices[i] = vertexCount - 1 - i;
+	mesh->openVertexData().markAsChanged();
+	mesh->openIndexData().markAsChanged();
+	return mesh;
+}
+
+static std::shared_ptr<uint8_t> copyToMemory(const std::string & data) {
+	std::shared_ptr<uint8_t> memory(new uint8_t[data.size()], std::default_delete<uint8_t[]>());
+	std::memcpy(memory.get(), data.data(), data.size());
+	return memory;
+}
+
+TEST_CASE("MeshBlobContainerTest_addMesh", "[MeshBlobContainerTest]") {
+	std::ostringstream output;
+	std::vector<std::string> references;
+	{
+		Serialization::MeshBlobContainer container(output);
+		REQUIRE(container.isWritable());
+		for(uint32_t i = 1; i <= 3; ++i) {
+			Util::Reference<Mesh> mesh = createTestMesh(i * 7);
+			references.push_back(container.addMesh(mesh.get()));
+			REQUIRE(Serialization::MeshBlobContainer::isReference(references.back()));
+		}
+		REQUIRE(container.getSize() == output.str().size());
+	}
+
+	const std::string data = output.str();
+	Serialization::MeshBlobContainer container(copyToMemory(data), data.size());
+	REQUIRE(container.isReadable());
+	// load in a different order
+	for(uint32_t i = 3; i >= 1; --i) {
+		Util::Reference<Mesh> mesh = container.loadMesh(references[i - 1]);
+		REQUIRE(mesh.isNotNull());
+		REQUIRE(mesh->getVertexCount() == i * 7);
+		REQUIRE(mesh->getIndexCount() == i * 7);
+		REQUIRE(reinterpret_cast<const float *>(mesh->openVertexData().data())[4] == 4.0f);
+		REQUIRE(mesh->openIndexData()[0] == i * 7 - 1);
+	}
+	REQUIRE(container.loadMesh("$[mmf_blob]0:100000") == nullptr);
+	REQUIRE(container.loadMesh("$[mmf_blob]12") == nullptr);
+}
+
+//! Output buffer that fails as soon as its capacity is exceeded.
+class LimitedBuffer : public std::streambuf {
+		std::vector<char> buffer;
+	public:
+		explicit LimitedBuffer(size_t capacity) : buffer(capacity) {
+			setp(buffer.data(), buffer.data() + buffer.size());
+		}
+	protected:
+		pos_type seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode) override {
+			return offset == 0 && dir == std::ios_base::cur ? pos_type(pptr() - pbase()) : pos_type(off_type(-1));
+		}
+};
+
+TEST_CASE("MeshBlobContainerTest_failedWrite", "[MeshBlobContainerTest]") {
+	LimitedBuffer buffer(64);
+	std::ostream output(&buffer);
+	Serialization::MeshBlobContainer container(output);
+	Util::Reference<Mesh> mesh = createTestMesh(100);
+	REQUIRE(container.addMesh(mesh.get()).empty());
+	// the position of further meshes would be unknown
+	REQUIRE_FALSE(container.isWritable());
+	Util::Reference<Mesh> smallMesh = createTestMesh(1);
+	REQUIRE(container.addMesh(smallMesh.get()).empty());
+}
+
+TEST_CASE("MeshBlobContainerTest_serializeGAMesh", "[MeshBlobContainerTest]") {
+	Serialization::initGenericAttributeSerialization();
+	Util::Reference<Mesh> mesh = createTestMesh(10);
+	const Serialization::MeshAttribute_t meshAttribute(mesh.get());
+
+	// without container, the mesh is embedded
+	Util::GenericAttributeMap emptyContext;
+	const auto embedded = Serialization::serializeGAMesh(std::make_pair(&meshAttribute, &emptyContext));
+	REQUIRE(embedded.second.compare(0, Serialization::embeddedMeshPrefix.size(), Serialization::embeddedMeshPrefix) == 0);
+	std::unique_ptr<Serialization::MeshAttribute_t> embeddedMesh(Serialization::unserializeGAMesh(std::make_pair(embedded.second, &emptyContext)));
+	REQUIRE(embeddedMesh);
+	REQUIRE(embeddedMesh->get()->getVertexCount() == 10);
+
+	std::ostringstream output;
+	std::string reference;
+	{
+		Serialization::MeshBlobContainer container(output);
+		Util::GenericAttributeMap context;
+		context.setValue(Serialization::CONTEXT_MESH_BLOB_CONTAINER, new Serialization::MeshBlobContainerAttribute_t(container));
+		reference = Serialization::serializeGAMesh(std::make_pair(&meshAttribute, &context)).second;
+	}
+	REQUIRE(Serialization::MeshBlobContainer::isReference(reference));
+	REQUIRE(reference.size() < 32);
+
+	const std::string data = output.str();
+	Serialization::MeshBlobContainer container(copyToMemory(data), data.size());
+	Util::GenericAttributeMap context;
+	context.setValue(Serialization::CONTEXT_MESH_BLOB_CONTAINER, new Serialization::MeshBlobContainerAttribute_t(container));
+	std::unique_ptr<Serialization::MeshAttribute_t> loadedMesh(Serialization::unserializeGAMesh(std::make_pair(reference, &context)));
+	REQUIRE(loadedMesh);
+	REQUIRE(loadedMesh->get()->getVertexCount() == 10);
+	REQUIRE(loadedMesh->get()->openIndexData()[0] == 9);
+
+	// if the container cannot store the mesh, it is embedded
+	LimitedBuffer buffer(64);
+	std::ostream limitedOutput(&buffer);
+	Serialization::MeshBlobContainer limitedContainer(limitedOutput);
+	Util::GenericAttributeMap limitedContext;
+	limitedContext.setValue(Serialization::CONTEXT_MESH_BLOB_CONTAINER, new Serialization::MeshBlobContainerAttribute_t(limitedContainer));
+	const auto fallback = Serialization::serializeGAMesh(std::make_pair(&meshAttribute, &limitedContext));
+	REQUIRE(fallback.second == embedded.second);
+}
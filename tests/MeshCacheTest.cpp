@@ -0,0 +1,135 @@
+/*
+ This file is part of the Rendering library.
+ Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+ This library is subject to the terms of the Mozilla Public License, v. 2.0.
+ You should have received a copy of the MPL along with this library; see the
+ file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <catch2/catch.hpp>
+#include <Rendering/Mesh/Mesh.h>
+#include <Rendering/Mesh/MeshVertexData.h>
+#include <Rendering/Mesh/VertexDescription.h>
+#include <Rendering/Serialization/MeshCache.h>
+#include <Rendering/Serialization/StreamerMMF.h>
+
+#include <Util/IO/FileName.h>
+#include <Util/IO/FileUtils.h>
+#include <Util/References.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <list>
+#include <string>
+
+using namespace Rendering;
+
+static Mesh * createPointMesh(float offset) {
+	VertexDescription vd;
+	vd.appendPosition3D();
+	Mesh * mesh = new Mesh(vd, 16, 0);
+	mesh->setUseIndexData(false);
+	mesh->setDrawMode(Mesh::DRAW_POINTS);
+	float * positions = reinterpret_cast<float *>(mesh->openVertexData().data());
+	for(uint32_t i = 0; i < 16 * 3; ++i)
+		positions[i] = offset + static_cast<float>(i);
+	mesh->openVertexData().markAsChanged();
+	return mesh;
+}
+
+TEST_CASE("MeshCacheTest_getSharedMesh", "[MeshCacheTest]") {
+	Serialization::MeshCache cache;
+	Util::Reference<Mesh> mesh1 = createPointMesh(0.0f);
+	Util::Reference<Mesh> mesh2 = createPointMesh(0.0f);
+	Util::Reference<Mesh> mesh3 = createPointMesh(1.0f);
+
+	REQUIRE(cache.getSharedMesh(mesh1.get()) == mesh1);
+	REQUIRE(cache.getSharedMesh(mesh2.get()) == mesh1);
+	REQUIRE(cache.getSharedMesh(mesh3.get()) == mesh3);
+	REQUIRE(cache.getSharedMesh(mesh1.get()) == mesh1);
+	REQUIRE(cache.getMeshCount() == 2);
+	REQUIRE(cache.getSharedCount() == 1);
+
+	// the same data with another draw mode is no duplicate
+	Util::Reference<Mesh> lines = createPointMesh(0.0f);
+	lines->setDrawMode(Mesh::DRAW_LINES);
+	REQUIRE(cache.getSharedMesh(lines.get()) == lines);
+
+	lines = nullptr;
+	mesh3 = nullptr;
+	REQUIRE(cache.removeUnusedMeshes() == 2);
+	REQUIRE(cache.getMeshCount() == 1);
+
+	cache.clear();
+	REQUIRE(cache.getMeshCount() == 0);
+	REQUIRE(cache.getSharedCount() == 0);
+	REQUIRE(cache.getCacheFileCount() == 0);
+}
+
+TEST_CASE("MeshCacheTest_loadMesh", "[MeshCacheTest]") {
+	const std::string fileName("MeshCacheTest.mmf");
+	const std::string cacheDirectory("MeshCacheTest_cache");
+	{
+		Util::Reference<Mesh> mesh = createPointMesh(0.0f);
+		std::ofstream output(fileName, std::ios::binary);
+		Serialization::StreamerMMF streamer;
+		REQUIRE(streamer.saveMesh(mesh.get(), output));
+	}
+
+	uint32_t processingCount = 0;
+	const auto processing = [&processingCount](Mesh * mesh) {
+		++processingCount;
+		mesh->setDrawMode(Mesh::DRAW_LINES);
+	};
+	Util::Reference<Mesh> processed;
+	{
+		Serialization::MeshCache cache;
+		cache.setCacheDirectory(cacheDirectory);
+		processed = cache.loadMesh(Util::FileName(fileName), "lines", processing);
+		REQUIRE(processed.isNotNull());
+		REQUIRE(processingCount == 1);
+		REQUIRE(cache.getCacheFileCount() == 0);
+		// loading the file again shares the mesh
+		REQUIRE(cache.loadMesh(Util::FileName(fileName), "lines", processing) == processed);
+		REQUIRE(cache.getCacheFileCount() == 1);
+		REQUIRE(processingCount == 1);
+	}
+	{
+		// a new cache (e.g. in another process) uses the processed file
+		Serialization::MeshCache cache;
+		cache.setCacheDirectory(cacheDirectory);
+		Util::Reference<Mesh> mesh = cache.loadMesh(Util::FileName(fileName), "lines", processing);
+		REQUIRE(mesh.isNotNull());
+		REQUIRE(cache.getCacheFileCount() == 1);
+		REQUIRE(processingCount == 1);
+		REQUIRE(mesh->getDrawMode() == Mesh::DRAW_LINES);
+		REQUIRE(mesh->getVertexCount() == 16);
+		REQUIRE(mesh->getFileName() == Util::FileName(fileName));
+
+		// other options are processed again
+		cache.loadMesh(Util::FileName(fileName), "other", processing);
+		REQUIRE(processingCount == 2);
+	}
+	{
+		// a cache file of another source with the same name (a hash collision) is not used
+		std::list<Util::FileName> files;
+		REQUIRE(Util::FileUtils::getFilesInDir(Util::FileName::createDirName(cacheDirectory), files, Util::FileUtils::DIR_FILES));
+		for(const auto & file : files) {
+			const std::string path = file.getPath();
+			if(path.size() > 4 && path.compare(path.size() - 4, 4, ".key") == 0) {
+				std::ofstream keyFile(path, std::ios::binary);
+				keyFile << "another source";
+			}
+		}
+		Serialization::MeshCache cache;
+		cache.setCacheDirectory(cacheDirectory);
+		REQUIRE(cache.loadMesh(Util::FileName(fileName), "lines", processing).isNotNull());
+		REQUIRE(cache.getCacheFileCount() == 0);
+		REQUIRE(processingCount == 3);
+	}
+
+	std::remove(fileName.c_str());
+	Util::FileUtils::remove(Util::FileName::createDirName(cacheDirectory), true);
+}
@@ -0,0 +1,96 @@
+/*
+ This file is part of the Rendering library.
+ Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+ 
+ This library is subject to the terms of the Mozilla Public License, v. 2.0.
+ You should have received a copy of the MPL along with this library; see the
+ file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <catch2/catch.hpp>
+#include <Rendering/Mesh/Mesh.h>
+#include <Rendering/Mesh/MeshIndexData.h>
+#include <Rendering/Mesh/MeshVertexData.h>
+#include <Rendering/Mesh/VertexDescription.h>
+#include <Rendering/Serialization/StreamerMMF.h>
+#include <Rendering/GLHeader.h>
+
+#include <Util/References.h>
+
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+using namespace Rendering;
+
+TEST_CASE("MeshIndexDataTest_indexType", "[MeshIndexDataTest]") {
+	MeshIndexData indices;
+	indices.allocate(6);
+	for(uint32_t i=0; i<6; ++i)
+		indices[i] = 5 - i;
+	indices.updateIndexRange();
+	REQUIRE(indices.getIndexType() == GL_UNSIGNED_SHORT);
+
+	indices.setIndexType(GL_UNSIGNED_BYTE);
+	REQUIRE(indices.getIndexType() == GL_UNSIGNED_BYTE);
+	indices[0] = 300;
+	indices.updateIndexRange();
+	REQUIRE(indices.getIndexType() == GL_UNSIGNED_SHORT);
+	indices[0] = 70000;
+	indices.updateIndexRange();
+	REQUIRE(indices.getIndexType() == GL_UNSIGNED_INT);
+	REQUIRE_THROWS_AS(indices.setIndexType(GL_FLOAT), std::invalid_argument);
+
+	{ // packed conversion
+		indices[0] = 5;
+		std::vector<uint8_t> packed(6 * sizeof(uint16_t));
+		indices.writePacked(GL_UNSIGNED_SHORT, packed.data());
+		MeshIndexData copy;
+		copy.allocate(6);
+		copy.readPacked(GL_UNSIGNED_SHORT, packed.data());
+		for(uint32_t i=0; i<6; ++i)
+			REQUIRE(copy[i] == indices[i]);
+	}
+	{ // upload as 16 bit and download again
+		indices.updateIndexRange();
+		REQUIRE(indices.upload());
+		REQUIRE(indices.getUploadedIndexType() == GL_UNSIGNED_SHORT);
+		std::vector<uint32_t> downloaded;
+		indices.downloadTo(downloaded);
+		REQUIRE(downloaded.size() == 6);
+		for(uint32_t i=0; i<6; ++i)
+			REQUIRE(downloaded[i] == indices[i]);
+		indices.removeGlBuffer();
+	}
+}
+
+TEST_CASE("MeshIndexDataTest_serialization", "[MeshIndexDataTest]") {
+	VertexDescription vd;
+	vd.appendPosition3D();
+	for(const uint32_t vertexCount : {200u, 1000u, 100000u}) {
+		Util::Reference<Mesh> mesh = new Mesh(vd, vertexCount, 3 * (vertexCount - 2));
+		MeshIndexData & indices = mesh->openIndexData();
+		indices.setIndexType(GL_UNSIGNED_BYTE);
+		for(uint32_t i=0; i<vertexCount - 2; ++i) {
+			indices[3 * i + 0] = i;
+			indices[3 * i + 1] = i + 1;
+			indices[3 * i + 2] = i + 2;
+		}
+		indices.updateIndexRange();
+		const uint32_t expectedType = vertexCount <= 256 ? GL_UNSIGNED_BYTE : (vertexCount <= 65536 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT);
+		REQUIRE(indices.getIndexType() == expectedType);
+
+		std::stringstream stream;
+		Serialization::StreamerMMF streamer;
+		REQUIRE(streamer.saveMesh(mesh.get(), stream));
+		Util::Reference<Mesh> loaded = streamer.loadMesh(stream);
+		REQUIRE(loaded.isNotNull());
+		const MeshIndexData & loadedIndices = loaded->openIndexData();
+		REQUIRE(loadedIndices.getIndexCount() == indices.getIndexCount());
+		REQUIRE(loadedIndices.getIndexType() == expectedType);
+		for(uint32_t i=0; i<indices.getIndexCount(); ++i)
+			REQUIRE(loadedIndices[i] == indices[i]);
+		REQUIRE(loaded->getVertexCount() == vertexCount);
+	}
+}
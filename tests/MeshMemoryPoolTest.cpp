@@ -0,0 +1,85 @@
+/*
+ This file is part of the Rendering library.
+ Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+ This library is subject to the terms of the Mozilla Public License, v. 2.0.
+ You should have received a copy of the MPL along with this library; see the
+ file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <catch2/catch.hpp>
+#include <Rendering/Mesh/Mesh.h>
+#include <Rendering/Mesh/MeshIndexData.h>
+#include <Rendering/Mesh/MeshMemoryPool.h>
+#include <Rendering/Mesh/MeshVertexData.h>
+#include <Rendering/Mesh/VertexDescription.h>
+
+#include <Util/References.h>
+
+#include <cstdint>
+#include <memory>
+
+using namespace Rendering;
+
+TEST_CASE("MeshMemoryPoolTest_pool", "[MeshMemoryPoolTest]") {
+	REQUIRE(MeshMemoryPool::getBlockSize(1) == 64);
+	REQUIRE(MeshMemoryPool::getBlockSize(65) == 80);
+	REQUIRE(MeshMemoryPool::getBlockSize(128) == 128);
+	REQUIRE(MeshMemoryPool::getBlockSize(129) == 160);
+	REQUIRE(MeshMemoryPool::getBlockSize(1000000) == 1048576);
+	REQUIRE(MeshMemoryPool::getBlockSize(MeshMemoryPool::MAX_POOLED_SIZE + 1) == MeshMemoryPool::MAX_POOLED_SIZE + 1);
+
+	MeshMemoryPool pool;
+	void * block1 = pool.allocate(1000);
+	void * block2 = pool.allocate(3000);
+	REQUIRE(reinterpret_cast<uintptr_t>(block1) % MeshMemoryResource::ALIGNMENT == 0);
+	REQUIRE(reinterpret_cast<uintptr_t>(block2) % MeshMemoryResource::ALIGNMENT == 0);
+	REQUIRE(pool.getBytesInUse() == 1024 + 3072);
+	REQUIRE(pool.getStatistics().size() == 2);
+	REQUIRE(pool.getStatistics().front().bytesRequested == 1000);
+
+	// freed blocks are reused for requests of the same size class
+	pool.deallocate(block1, 1000);
+	REQUIRE(pool.getBytesInUse() == 3072);
+	REQUIRE(pool.getBytesCached() == 1024);
+	REQUIRE(pool.allocate(900) == block1);
+	REQUIRE(pool.getBytesCached() == 0);
+	pool.deallocate(block1, 900);
+	pool.deallocate(block2, 3000);
+	REQUIRE(pool.getBytesInUse() == 0);
+	REQUIRE(pool.release() == 1024 + 3072);
+	REQUIRE(pool.getStatistics().empty());
+
+	// blocks exceeding the cache limit are freed
+	pool.setCacheLimit(2048);
+	block1 = pool.allocate(1024);
+	block2 = pool.allocate(3072);
+	pool.deallocate(block1, 1024);
+	pool.deallocate(block2, 3072);
+	REQUIRE(pool.getBytesCached() == 1024);
+}
+
+TEST_CASE("MeshMemoryPoolTest_meshData", "[MeshMemoryPoolTest]") {
+	auto pool = std::make_shared<MeshMemoryPool>();
+	MeshMemoryResource::setDefault(pool);
+
+	VertexDescription vd;
+	vd.appendPosition3D();
+	Util::Reference<Mesh> mesh = new Mesh(vd, 100, 300);
+	REQUIRE(reinterpret_cast<uintptr_t>(mesh->openVertexData().data()) % MeshMemoryResource::ALIGNMENT == 0);
+	REQUIRE(pool->getBytesInUse() == MeshMemoryPool::getBlockSize(1200) + MeshMemoryPool::getBlockSize(1200));
+	// the new data is initialized
+	REQUIRE(mesh->openVertexData().data()[1199] == 0);
+	REQUIRE(mesh->openIndexData()[299] == UINT32_MAX);
+
+	Util::Reference<Mesh> clone = mesh->clone();
+	REQUIRE(pool->getBytesInUse() == 4 * MeshMemoryPool::getBlockSize(1200));
+	clone = nullptr;
+	REQUIRE(pool->getBytesCached() == 2 * MeshMemoryPool::getBlockSize(1200));
+
+	// the data keeps using its pool after the default resource is changed
+	MeshMemoryResource::setDefault(nullptr);
+	REQUIRE(MeshMemoryResource::getDefault() != pool);
+	mesh = nullptr;
+	REQUIRE(pool->getBytesInUse() == 0);
+}
@@ -0,0 +1,645 @@
+/*
+ This file is part of the Rendering library.
+ Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+ 
+ This library is subject to the terms of the Mozilla Public License, v. 2.0.
+ You should have received a copy of the MPL along with this library; see the
+ file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <catch2/catch.hpp>
+#include <Rendering/Mesh/Mesh.h>
+#include <Rendering/Mesh/MeshIndexData.h>
+#include <Rendering/Mesh/MeshVertexData.h>
+#include <Rendering/Mesh/VertexDescription.h>
+#include <Rendering/Mesh/VertexAttributeAccessors.h>
+#include <Rendering/MeshUtils/CompactKeyFrames.h>
+#include <Rendering/MeshUtils/MeshUtils.h>
+#include <Rendering/MeshUtils/Simplification.h>
+#include <Rendering/MeshUtils/TriangleBVH.h>
+
+#include <Geometry/Box.h>
+#include <Geometry/Line.h>
+#include <Geometry/LineTriangleIntersection.h>
+#include <Geometry/Matrix4x4.h>
+#include <Geometry/Triangle.h>
+#include <Geometry/Vec4.h>
+
+#include <Util/Timer.h>
+#include <Util/References.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace Rendering;
+
+static Mesh * createMeshWithDuplicates(uint32_t vertexCount, uint32_t distinctPositions) {
+	std::uniform_int_distribution<uint32_t> positionDist(0, distinctPositions - 1);
+	std::default_random_engine engine(0);
+
+	VertexDescription vd;
+	vd.appendPosition3D();
+	vd.appendNormalByte();
+	Mesh * mesh = new Mesh(vd, vertexCount, vertexCount);
+	MeshVertexData & vData = mesh->openVertexData();
+	MeshIndexData & iData = mesh->openIndexData();
+	auto posAcc = PositionAttributeAccessor::create(vData);
+	auto nrmAcc = NormalAttributeAccessor::create(vData);
+	for(uint32_t i=0; i<vertexCount; ++i) {
+		const uint32_t p = positionDist(engine);
+		posAcc->setPosition(i, Geometry::Vec3(p % 100, (p / 100) % 100, p / 10000));
+		nrmAcc->setNormal(i, Geometry::Vec3(0,1,0));
+		iData[i] = (i * 7919) % vertexCount;
+	}
+	vData.updateBoundingBox();
+	iData.updateIndexRange();
+	return mesh;
+}
+
+static Mesh * createHeightField(uint32_t size) {
+	std::uniform_real_distribution<float> heightDist(-0.2f, 0.2f);
+	std::default_random_engine engine(0);
+
+	VertexDescription vd;
+	vd.appendPosition3D();
+	Mesh * mesh = new Mesh(vd, size * size, (size - 1) * (size - 1) * 6);
+	auto posAcc = PositionAttributeAccessor::create(mesh->openVertexData());
+	for(uint32_t i=0; i<size * size; ++i)
+		posAcc->setPosition(i, Geometry::Vec3(i % size, heightDist(engine), i / size));
+	MeshIndexData & iData = mesh->openIndexData();
+	uint32_t index = 0;
+	for(uint32_t y=0; y+1<size; ++y) {
+		for(uint32_t x=0; x+1<size; ++x) {
+			const uint32_t v = y * size + x;
+			iData[index++] = v;			iData[index++] = v + size;		iData[index++] = v + 1;
+			iData[index++] = v + 1;		iData[index++] = v + size;		iData[index++] = v + size + 1;
+		}
+	}
+	mesh->openVertexData().updateBoundingBox();
+	iData.updateIndexRange();
+	return mesh;
+}
+
+TEST_CASE("MeshUtilsTest_eliminateDuplicateVertices", "[MeshUtilsTest]") {
+	std::cout << std::endl;
+	const uint32_t vertexCount = 1000000;
+	Util::Reference<Mesh> original = createMeshWithDuplicates(vertexCount, 50000);
+	const std::size_t vertexSize = original->getVertexDescription().getVertexSize();
+	Util::Timer t;
+
+	// reference: distinct vertices ordered by raw data
+	std::set<std::vector<uint8_t>> distinct;
+	{
+		const MeshVertexData & vData = original->openVertexData();
+		for(uint32_t i=0; i<vertexCount; ++i)
+			distinct.emplace(vData[i], vData[i] + vertexSize);
+	}
+
+	Util::Reference<Mesh> single = original->clone();
+	t.reset();
+	MeshUtils::eliminateDuplicateVertices(single.get());
+	std::cout << "eliminateDuplicateVertices (1 thread): " << t.getMilliseconds() << " ms" << std::endl;
+
+	Util::Reference<Mesh> parallel = original->clone();
+	t.reset();
+	MeshUtils::eliminateDuplicateVertices(parallel.get(), 4);
+	std::cout << "eliminateDuplicateVertices (4 threads): " << t.getMilliseconds() << " ms" << std::endl;
+
+	REQUIRE(single->getVertexCount() == distinct.size());
+	REQUIRE(single->getIndexCount() == vertexCount);
+	{
+		const MeshVertexData & vData = single->openVertexData();
+		uint32_t i = 0;
+		for(const auto & vertex : distinct)
+			REQUIRE(std::memcmp(vData[i++], vertex.data(), vertexSize) == 0);
+		const MeshVertexData & oldVData = original->openVertexData();
+		const MeshIndexData & oldIData = original->openIndexData();
+		const MeshIndexData & iData = single->openIndexData();
+		for(uint32_t i=0; i<vertexCount; ++i)
+			REQUIRE(std::memcmp(vData[iData[i]], oldVData[oldIData[i]], vertexSize) == 0);
+	}
+
+	REQUIRE(parallel->getVertexCount() == single->getVertexCount());
+	REQUIRE(std::memcmp(parallel->openVertexData().data(), single->openVertexData().data(), single->openVertexData().dataSize()) == 0);
+	REQUIRE(std::memcmp(parallel->openIndexData().data(), single->openIndexData().data(), single->openIndexData().dataSize()) == 0);
+}
+
+TEST_CASE("MeshUtilsTest_mergeCloseVertices", "[MeshUtilsTest]") {
+	std::cout << std::endl;
+	const uint32_t vertexCount = 1000000;
+	Util::Reference<Mesh> original = createMeshWithDuplicates(vertexCount, 50000);
+	{
+		// move every vertex slightly
+		std::uniform_real_distribution<float> jitterDist(-0.01f, 0.01f);
+		std::default_random_engine engine(0);
+		auto posAcc = PositionAttributeAccessor::create(original->openVertexData());
+		for(uint32_t i=0; i<vertexCount; ++i)
+			posAcc->setPosition(i, posAcc->getPosition(i) + Geometry::Vec3(jitterDist(engine), jitterDist(engine), jitterDist(engine)));
+		original->openVertexData().updateBoundingBox();
+	}
+	Util::Timer t;
+
+	Util::Reference<Mesh> single = original->clone();
+	t.reset();
+	const uint32_t merged = MeshUtils::mergeCloseVertices(single.get(), 0.05f);
+	std::cout << "mergeCloseVertices (1 thread): " << t.getMilliseconds() << " ms" << std::endl;
+
+	Util::Reference<Mesh> parallel = original->clone();
+	t.reset();
+	REQUIRE(MeshUtils::mergeCloseVertices(parallel.get(), 0.05f, 4) == merged);
+	std::cout << "mergeCloseVertices (4 threads): " << t.getMilliseconds() << " ms" << std::endl;
+
+	REQUIRE(single->getVertexCount() <= 50000);
+	REQUIRE(single->getVertexCount() + merged == vertexCount);
+	REQUIRE(std::memcmp(parallel->openVertexData().data(), single->openVertexData().data(), single->openVertexData().dataSize()) == 0);
+	REQUIRE(std::memcmp(parallel->openIndexData().data(), single->openIndexData().data(), single->openIndexData().dataSize()) == 0);
+}
+
+TEST_CASE("MeshUtilsTest_triangleBVH", "[MeshUtilsTest]") {
+	std::cout << std::endl;
+	std::uniform_real_distribution<float> coordinateDist(-10.0f, 10.0f);
+	std::uniform_real_distribution<float> offsetDist(-0.5f, 0.5f);
+	std::default_random_engine engine(0);
+	const uint32_t triangleCount = 100000;
+
+	VertexDescription vd;
+	vd.appendPosition3D();
+	Util::Reference<Mesh> mesh = new Mesh(vd, triangleCount * 3, triangleCount * 3);
+	{
+		auto posAcc = PositionAttributeAccessor::create(mesh->openVertexData());
+		MeshIndexData & iData = mesh->openIndexData();
+		for(uint32_t i=0; i<triangleCount*3; i+=3) {
+			const Geometry::Vec3 center(coordinateDist(engine), coordinateDist(engine), coordinateDist(engine));
+			for(uint32_t j=0; j<3; ++j) {
+				posAcc->setPosition(i+j, center + Geometry::Vec3(offsetDist(engine), offsetDist(engine), offsetDist(engine)));
+				iData[i+j] = i+j;
+			}
+		}
+		mesh->openVertexData().updateBoundingBox();
+	}
+
+	std::vector<Geometry::Ray3> rays;
+	for(uint32_t i=0; i<1000; ++i)
+		rays.emplace_back(Geometry::Vec3(coordinateDist(engine), coordinateDist(engine), coordinateDist(engine)), Geometry::Vec3(coordinateDist(engine), coordinateDist(engine), coordinateDist(engine)));
+
+	Util::Timer t;
+	std::vector<int32_t> expected;
+	{
+		auto posAcc = PositionAttributeAccessor::create(mesh->openVertexData());
+		for(const auto & ray : rays) {
+			float tLine, uTri, vTri;
+			int32_t closest = -1;
+			float closestDist = std::numeric_limits<float>::infinity();
+			for(uint32_t i=0; i<triangleCount*3; i+=3) {
+				Geometry::Triangle<Geometry::Vec3> triangle(posAcc->getPosition(i), posAcc->getPosition(i+1), posAcc->getPosition(i+2));
+				if(Geometry::Intersection::getLineTriangleIntersection(ray, triangle, tLine, uTri, vTri) && tLine >= 0 && tLine < closestDist) {
+					closestDist = tLine;
+					closest = i/3;
+				}
+			}
+			expected.push_back(closest);
+		}
+	}
+	std::cout << "linear search: " << t.getMilliseconds() << " ms" << std::endl;
+
+	t.reset();
+	auto bvh = MeshUtils::TriangleBVH::get(mesh.get());
+	std::cout << "TriangleBVH build: " << t.getMilliseconds() << " ms" << std::endl;
+	REQUIRE(MeshUtils::TriangleBVH::get(mesh.get()) == bvh);
+
+	t.reset();
+	const std::vector<int32_t> result = MeshUtils::getFirstTrianglesIntersectingRays(mesh.get(), rays, 4);
+	std::cout << "TriangleBVH queries: " << t.getMilliseconds() << " ms" << std::endl;
+	REQUIRE(result == expected);
+	REQUIRE(MeshUtils::getFirstTriangleIntersectingRay(mesh.get(), rays.front()) == expected.front());
+
+	mesh->openVertexData().markAsChanged();
+	REQUIRE(MeshUtils::TriangleBVH::get(mesh.get()) != bvh);
+}
+
+//! Return the first triangle of the mesh hit by the ray by testing all triangles, or -1.
+static int32_t findFirstTriangle(Mesh * mesh, const Geometry::Ray3 & ray) {
+	auto posAcc = PositionAttributeAccessor::create(mesh->openVertexData());
+	const MeshIndexData & iData = mesh->openIndexData();
+	int32_t closest = -1;
+	float closestDist = std::numeric_limits<float>::infinity();
+	for(uint32_t i=0; i<iData.getIndexCount(); i+=3) {
+		Geometry::Triangle<Geometry::Vec3> triangle(posAcc->getPosition(iData[i]), posAcc->getPosition(iData[i+1]), posAcc->getPosition(iData[i+2]));
+		float tLine, uTri, vTri;
+		if(Geometry::Intersection::getLineTriangleIntersection(ray, triangle, tLine, uTri, vTri) && tLine >= 0 && tLine < closestDist) {
+			closestDist = tLine;
+			closest = static_cast<int32_t>(i/3);
+		}
+	}
+	return closest;
+}
+
+TEST_CASE("MeshUtilsTest_triangleBVHRevision", "[MeshUtilsTest]") {
+	Util::Reference<Mesh> mesh = createHeightField(20);
+	{ // shuffle the triangles
+		MeshIndexData & iData = mesh->openIndexData();
+		std::vector<std::array<uint32_t, 3>> triangles(iData.getIndexCount() / 3);
+		std::copy(iData.data(), iData.data() + iData.getIndexCount(), triangles.front().data());
+		std::shuffle(triangles.begin(), triangles.end(), std::default_random_engine(0));
+		std::copy(triangles.front().data(), triangles.front().data() + iData.getIndexCount(), iData.data());
+		iData.markAsChanged();
+	}
+	std::vector<Geometry::Ray3> rays;
+	for(uint32_t i=0; i<20; ++i)
+		rays.emplace_back(Geometry::Vec3(0.35f + 0.9f * i, 1.0f, 18.35f - 0.9f * i), Geometry::Vec3(0.0f, -1.0f, 0.0f));
+	for(const auto & ray : rays)
+		REQUIRE(MeshUtils::getFirstTriangleIntersectingRay(mesh.get(), ray) == findFirstTriangle(mesh.get(), ray));
+
+	// the index data is replaced by newly created data; the cached BVH must not be used
+	MeshUtils::optimizeIndices(mesh.get());
+	for(const auto & ray : rays)
+		REQUIRE(MeshUtils::getFirstTriangleIntersectingRay(mesh.get(), ray) == findFirstTriangle(mesh.get(), ray));
+}
+
+TEST_CASE("MeshUtilsTest_simplifyMesh", "[MeshUtilsTest]") {
+	std::cout << std::endl;
+	Util::Reference<Mesh> original = createHeightField(300);
+	const MeshUtils::Simplification::weights_t weights{{1.0f, 0.0f, 0.0f, 0.0f, 0.0f}};
+	const uint32_t targetCount = 10000;
+	Util::Timer t;
+
+	t.reset();
+	Util::Reference<Mesh> single = MeshUtils::Simplification::simplifyMesh(original.get(), targetCount, 0.0f, true, 0.5f, weights);
+	std::cout << "simplifyMesh (1 thread): " << t.getMilliseconds() << " ms" << std::endl;
+
+	t.reset();
+	Util::Reference<Mesh> parallel = MeshUtils::Simplification::simplifyMesh(original.get(), targetCount, 0.0f, true, 0.5f, weights, 4);
+	std::cout << "simplifyMesh (4 threads): " << t.getMilliseconds() << " ms" << std::endl;
+
+	for(const auto & mesh : {single, parallel}) {
+		REQUIRE(mesh.get() != original.get());
+		REQUIRE(mesh->getPrimitiveCount() <= targetCount);
+		REQUIRE(mesh->getPrimitiveCount() + 2 >= targetCount);
+		const MeshIndexData & iData = mesh->openIndexData();
+		REQUIRE(iData.getMaxIndex() < mesh->getVertexCount());
+		for(uint32_t i=0; i<iData.getIndexCount(); i+=3) {
+			REQUIRE(iData[i] != iData[i+1]);
+			REQUIRE(iData[i+1] != iData[i+2]);
+			REQUIRE(iData[i] != iData[i+2]);
+		}
+	}
+}
+
+TEST_CASE("MeshUtilsTest_simplifyMeshLevels", "[MeshUtilsTest]") {
+	Util::Reference<Mesh> original = createHeightField(100);
+	const MeshUtils::Simplification::weights_t weights{{1.0f, 0.0f, 0.0f, 0.0f, 0.0f}};
+	const uint32_t triangleCount = original->getPrimitiveCount();
+
+	const std::vector<uint32_t> triangleCounts{triangleCount / 2, triangleCount / 4, triangleCount / 8};
+	const auto levels = MeshUtils::Simplification::createLODChain(original.get(), triangleCounts, 0.0f, true, 0.5f, weights);
+	REQUIRE(levels.size() == triangleCounts.size());
+	for(uint32_t l = 0; l < levels.size(); ++l) {
+		REQUIRE(levels[l]->getPrimitiveCount() <= triangleCounts[l]);
+		REQUIRE(levels[l]->getPrimitiveCount() + 2 >= triangleCounts[l]);
+	}
+
+	const auto progressiveMesh = MeshUtils::Simplification::ProgressiveMesh::create(original.get(), triangleCount / 8, 0.0f, 0.5f, weights);
+	REQUIRE(progressiveMesh.isNotNull());
+	REQUIRE(progressiveMesh->getMaxVertexCount() == original->getVertexCount());
+	REQUIRE(progressiveMesh->getTriangleCount(progressiveMesh->getMaxVertexCount()) == triangleCount);
+	REQUIRE(progressiveMesh->getTriangleCount(progressiveMesh->getBaseVertexCount()) <= triangleCount / 8);
+	for(const auto & targetCount : triangleCounts) {
+		Util::Reference<Mesh> mesh = progressiveMesh->createMesh(targetCount);
+		REQUIRE(mesh->getPrimitiveCount() <= targetCount);
+		const MeshIndexData & iData = mesh->openIndexData();
+		REQUIRE(iData.getMaxIndex() < mesh->getVertexCount());
+		for(uint32_t i=0; i<iData.getIndexCount(); i+=3) {
+			REQUIRE(iData[i] != iData[i+1]);
+			REQUIRE(iData[i+1] != iData[i+2]);
+			REQUIRE(iData[i] != iData[i+2]);
+		}
+	}
+}
+
+TEST_CASE("MeshUtilsTest_calculateNormals", "[MeshUtilsTest]") {
+	std::cout << std::endl;
+	Util::Reference<Mesh> original = createHeightField(500);
+	{ // float normals are written directly
+		VertexDescription vd = original->getVertexDescription();
+		vd.appendNormalFloat();
+		std::unique_ptr<MeshVertexData> newVertices(MeshUtils::convertVertices(original->openVertexData(), vd));
+		original->openVertexData().swap(*newVertices.get());
+	}
+	Util::Timer t;
+
+	Util::Reference<Mesh> single = original->clone();
+	t.reset();
+	MeshUtils::calculateNormals(single.get());
+	std::cout << "calculateNormals (1 thread): " << t.getMilliseconds() << " ms" << std::endl;
+
+	Util::Reference<Mesh> parallel = original->clone();
+	t.reset();
+	MeshUtils::calculateNormals(parallel.get(), 4);
+	std::cout << "calculateNormals (4 threads): " << t.getMilliseconds() << " ms" << std::endl;
+
+	auto singleAcc = NormalAttributeAccessor::create(single->openVertexData());
+	auto parallelAcc = NormalAttributeAccessor::create(parallel->openVertexData());
+	for(uint32_t i=0; i<single->getVertexCount(); ++i) {
+		const Geometry::Vec3 n = singleAcc->getNormal(i);
+		REQUIRE(std::abs(n.length() - 1.0f) < 1.0e-4f);
+		REQUIRE(std::abs(n.y()) > 0.5f);
+		REQUIRE((n - parallelAcc->getNormal(i)).length() < 1.0e-4f);
+	}
+}
+
+TEST_CASE("MeshUtilsTest_optimizeIndices", "[MeshUtilsTest]") {
+	std::cout << std::endl;
+	Util::Reference<Mesh> mesh = createHeightField(300);
+	{ // shuffle the triangles
+		MeshIndexData & iData = mesh->openIndexData();
+		std::vector<std::array<uint32_t, 3>> triangles(iData.getIndexCount() / 3);
+		std::copy(iData.data(), iData.data() + iData.getIndexCount(), triangles.front().data());
+		std::shuffle(triangles.begin(), triangles.end(), std::default_random_engine(0));
+		std::copy(triangles.front().data(), triangles.front().data() + iData.getIndexCount(), iData.data());
+	}
+	const MeshUtils::VertexCacheStatistics before = MeshUtils::calculateVertexCacheStatistics(mesh.get());
+	std::cout << "before: ACMR " << before.acmr << " ATVR " << before.atvr << std::endl;
+	Util::Timer t;
+	MeshUtils::optimizeIndices(mesh.get());
+	const MeshUtils::VertexCacheStatistics optimized = MeshUtils::calculateVertexCacheStatistics(mesh.get());
+	std::cout << "optimizeIndices: " << t.getMilliseconds() << " ms; ACMR " << optimized.acmr << " ATVR " << optimized.atvr << std::endl;
+	MeshUtils::optimizeOverdraw(mesh.get(), 1.05f);
+	MeshUtils::optimizeVertexFetch(mesh.get());
+	const MeshUtils::VertexCacheStatistics after = MeshUtils::calculateVertexCacheStatistics(mesh.get());
+	std::cout << "optimizeOverdraw/optimizeVertexFetch: ACMR " << after.acmr << " ATVR " << after.atvr << std::endl;
+
+	REQUIRE(optimized.acmr < 0.7f);
+	REQUIRE(optimized.atvr < 1.5f);
+	REQUIRE(after.acmr < 0.75f);
+	REQUIRE(mesh->getIndexCount() == 299 * 299 * 6);
+	const MeshIndexData & iData = mesh->openIndexData();
+	REQUIRE(iData[0] == 0);
+	REQUIRE(iData.getMaxIndex() < mesh->getVertexCount());
+	// the vertices are numbered in the order of their first use
+	uint32_t next = 0;
+	for(uint32_t i=0; i<iData.getIndexCount(); ++i) {
+		REQUIRE(iData[i] <= next);
+		if(iData[i] == next)
+			++next;
+	}
+}
+
+TEST_CASE("MeshUtilsTest_compressVertices", "[MeshUtilsTest]") {
+	Util::Reference<Mesh> original = createHeightField(100);
+	{
+		VertexDescription vd = original->getVertexDescription();
+		vd.appendNormalFloat();
+		vd.appendTexCoord();
+		std::unique_ptr<MeshVertexData> newVertices(MeshUtils::convertVertices(original->openVertexData(), vd));
+		original->openVertexData().swap(*newVertices.get());
+		MeshUtils::calculateNormals(original.get());
+		auto posAcc = PositionAttributeAccessor::create(original->openVertexData());
+		auto texAcc = TexCoordAttributeAccessor::create(original->openVertexData());
+		for(uint32_t i=0; i<original->getVertexCount(); ++i) {
+			const Geometry::Vec3 p = posAcc->getPosition(i);
+			texAcc->setCoordinate(i, Geometry::Vec2(p.x() / 50.0f, p.z() / 50.0f));
+		}
+	}
+	Util::Reference<Mesh> mesh = original->clone();
+	const VertexDescription compactVd = MeshUtils::createCompactVertexDescription(mesh->getVertexDescription());
+	REQUIRE(compactVd.getVertexSize() == 16);
+	REQUIRE(compactVd.getAttribute(VertexAttributeIds::NORMAL).getNumValues() == 2);
+	const Geometry::Matrix4x4 decode = MeshUtils::compressVertices(mesh.get(), compactVd);
+	REQUIRE(mesh->getVertexDescription() == compactVd);
+	REQUIRE(mesh->getVertexCount() == original->getVertexCount());
+
+	// positions are quantized relative to the bounding box with a step size of 99 / 65535
+	auto originalPosAcc = PositionAttributeAccessor::create(original->openVertexData());
+	auto originalNormalAcc = NormalAttributeAccessor::create(original->openVertexData());
+	auto originalTexAcc = TexCoordAttributeAccessor::create(original->openVertexData());
+	auto posAcc = PositionAttributeAccessor::create(mesh->openVertexData());
+	auto normalAcc = NormalAttributeAccessor::create(mesh->openVertexData());
+	auto texAcc = TexCoordAttributeAccessor::create(mesh->openVertexData());
+	for(uint32_t i=0; i<mesh->getVertexCount(); ++i) {
+		REQUIRE(decode.transformPosition(posAcc->getPosition(i)).distance(originalPosAcc->getPosition(i)) < 2.0e-3f);
+		REQUIRE(normalAcc->getNormal(i).distance(originalNormalAcc->getNormal(i)) < 1.0e-3f);
+		const Geometry::Vec2 uv = texAcc->getCoordinate(i);
+		const Geometry::Vec2 originalUv = originalTexAcc->getCoordinate(i);
+		REQUIRE(std::abs(uv.x() - originalUv.x()) < 2.0e-3f);
+		REQUIRE(std::abs(uv.y() - originalUv.y()) < 2.0e-3f);
+	}
+	REQUIRE(mesh->getBoundingBox().getMaxX() <= 1.0f);
+
+	// normals calculated from the quantized positions stay valid
+	MeshUtils::calculateNormals(mesh.get());
+	for(uint32_t i=0; i<mesh->getVertexCount(); ++i)
+		REQUIRE(normalAcc->getNormal(i).distance(originalNormalAcc->getNormal(i)) < 1.0e-2f);
+}
+
+TEST_CASE("MeshUtilsTest_compactKeyFrames", "[MeshUtilsTest]") {
+	VertexDescription vd;
+	vd.appendPosition3D();
+	vd.appendNormalFloat();
+	vd.appendTexCoord();
+	const uint32_t vertexCount = 300;
+	const uint32_t keyVertexCount = 100;
+	std::vector<uint32_t> keyVertexIndices(vertexCount);
+	for(uint32_t v = 0; v < vertexCount; ++v)
+		keyVertexIndices[v] = (v * 7) % keyVertexCount;
+
+	// vertex layout: position, normal, tex coord
+	auto createFrame = [&](float time) {
+		MeshVertexData frame;
+		frame.allocate(vertexCount, vd);
+		for(uint32_t v = 0; v < vertexCount; ++v) {
+			const float k = static_cast<float>(keyVertexIndices[v]);
+			float * vertex = reinterpret_cast<float *>(frame[v]);
+			vertex[0] = k + time * std::sin(k);
+			vertex[1] = -k + time * 2.0f;
+			vertex[2] = 0.5f * k;
+			vertex[3] = std::cos(time);
+			vertex[4] = std::sin(time);
+			vertex[5] = 0.0f;
+			vertex[6] = static_cast<float>(v);
+			vertex[7] = 1.0f;
+		}
+		frame.updateBoundingBox();
+		return frame;
+	};
+
+	const uint32_t frameCount = 10;
+	Util::Reference<MeshUtils::CompactKeyFrames> keyFrames = new MeshUtils::CompactKeyFrames(createFrame(0.0f), keyVertexIndices);
+	for(uint32_t f = 0; f < frameCount; ++f)
+		keyFrames->addFrame(createFrame(static_cast<float>(f)));
+	REQUIRE(keyFrames->getFrameCount() == frameCount);
+	REQUIRE(keyFrames->getKeyVertexCount() == keyVertexCount);
+	REQUIRE(keyFrames->getMemoryUsage() < 3 * createFrame(0.0f).dataSize());
+
+	MeshVertexData target(keyFrames->getBaseFrame());
+	for(uint32_t f = 0; f + 1 < frameCount; ++f) {
+		keyFrames->interpolate(f, f + 1, 0.25f, target);
+		const MeshVertexData frame1 = createFrame(static_cast<float>(f));
+		const MeshVertexData frame2 = createFrame(static_cast<float>(f + 1));
+		for(uint32_t v = 0; v < vertexCount; ++v) {
+			const float * vertex = reinterpret_cast<const float *>(target[v]);
+			const float * vertex1 = reinterpret_cast<const float *>(frame1[v]);
+			const float * vertex2 = reinterpret_cast<const float *>(frame2[v]);
+			for(uint32_t c = 0; c < 3; ++c)
+				REQUIRE(std::abs(vertex[c] - (0.75f * vertex1[c] + 0.25f * vertex2[c])) < 1.0e-3f);
+			for(uint32_t c = 3; c < 6; ++c)
+				REQUIRE(std::abs(vertex[c] - (0.75f * vertex1[c] + 0.25f * vertex2[c])) < 1.0e-2f);
+			REQUIRE(vertex[6] == static_cast<float>(v));
+			REQUIRE(vertex[7] == 1.0f);
+		}
+		Geometry::Box bounds(frame1.getBoundingBox());
+		bounds.include(frame2.getBoundingBox());
+		REQUIRE(std::abs(target.getBoundingBox().getMaxX() - bounds.getMaxX()) < 1.0e-3f);
+		REQUIRE(std::abs(target.getBoundingBox().getMinY() - bounds.getMinY()) < 1.0e-3f);
+	}
+}
+
+TEST_CASE("MeshUtilsTest_convertVertexLayout", "[MeshUtilsTest]") {
+	Util::Reference<Mesh> interleaved = createMeshWithDuplicates(999, 500);
+	Util::Reference<Mesh> separate = interleaved->clone();
+	MeshVertexData & vData = separate->openVertexData();
+	MeshUtils::convertVertexLayout(vData, false);
+
+	const VertexDescription & vd = vData.getVertexDescription();
+	const VertexAttribute & posAttr = vd.getAttribute(VertexAttributeIds::POSITION);
+	const VertexAttribute & normalAttr = vd.getAttribute(VertexAttributeIds::NORMAL);
+	REQUIRE_FALSE(vd.isInterleaved());
+	REQUIRE_FALSE(vd == interleaved->getVertexDescription());
+	REQUIRE(vData.getAttributeOffset(posAttr) == 0);
+	REQUIRE(vData.getAttributeStride(posAttr) == 3 * sizeof(float));
+	// the normals start at the next aligned position after 999 positions
+	REQUIRE(vData.getAttributeOffset(normalAttr) == 12000);
+	REQUIRE(vData.getAttributeStride(normalAttr) == 4);
+	REQUIRE(vData.dataSize() == 16000);
+	REQUIRE(vData.getBoundingBox() == interleaved->getBoundingBox());
+
+	auto posAcc = PositionAttributeAccessor::create(vData);
+	auto interleavedPosAcc = PositionAttributeAccessor::create(interleaved->openVertexData());
+	for(uint32_t i=0; i<vData.getVertexCount(); ++i)
+		REQUIRE(posAcc->getPosition(i) == interleavedPosAcc->getPosition(i));
+
+	// vertex processing works on both layouts
+	MeshUtils::calculateNormals(separate.get());
+	MeshUtils::calculateNormals(interleaved.get());
+	MeshUtils::convertVertexLayout(vData, true);
+	REQUIRE(vData.getVertexDescription() == interleaved->getVertexDescription());
+	REQUIRE(vData.dataSize() == interleaved->openVertexData().dataSize());
+	REQUIRE(std::equal(vData.data(), vData.data() + vData.dataSize(), interleaved->openVertexData().data()));
+}
+
+TEST_CASE("MeshUtilsTest_nonInterleavedVertices", "[MeshUtilsTest]") {
+	Util::Reference<Mesh> interleaved = createMeshWithDuplicates(999, 500);
+	Util::Reference<Mesh> separate = interleaved->clone();
+	MeshUtils::convertVertexLayout(separate->openVertexData(), false);
+
+	// the results have to be equal to the ones of the interleaved mesh after converting them back
+	auto equalVertices = [](const MeshVertexData & expected, const MeshVertexData & vertices) {
+		MeshVertexData converted(vertices);
+		MeshUtils::convertVertexLayout(converted, true);
+		return converted.getVertexDescription() == expected.getVertexDescription() && converted.dataSize() == expected.dataSize()
+				&& std::equal(converted.data(), converted.data() + converted.dataSize(), expected.data());
+	};
+
+	{	// extract
+		std::unique_ptr<MeshVertexData> expected(MeshUtils::extractVertexData(interleaved.get(), 100, 200));
+		std::unique_ptr<MeshVertexData> extracted(MeshUtils::extractVertexData(separate.get(), 100, 200));
+		REQUIRE_FALSE(extracted->getVertexDescription().isInterleaved());
+		REQUIRE(equalVertices(*expected.get(), *extracted.get()));
+
+		const std::vector<uint32_t> indices{998, 0, 500, 3};
+		expected.reset(MeshUtils::extractVertices(interleaved.get(), indices));
+		extracted.reset(MeshUtils::extractVertices(separate.get(), indices));
+		REQUIRE(equalVertices(*expected.get(), *extracted.get()));
+	}
+	{	// copy between meshes of different sizes, whose streams start at different offsets
+		Util::Reference<Mesh> expected = createMeshWithDuplicates(500, 100);
+		Util::Reference<Mesh> target = expected->clone();
+		MeshUtils::convertVertexLayout(target->openVertexData(), false);
+		MeshUtils::copyVertices(interleaved.get(), expected.get(), 10, 400, 100);
+		MeshUtils::copyVertices(separate.get(), target.get(), 10, 400, 100);
+		REQUIRE(equalVertices(expected->openVertexData(), target->openVertexData()));
+	}
+	{	// eliminate duplicates
+		MeshUtils::eliminateDuplicateVertices(interleaved.get());
+		MeshUtils::eliminateDuplicateVertices(separate.get());
+		REQUIRE_FALSE(separate->getVertexDescription().isInterleaved());
+		REQUIRE(separate->getVertexCount() == interleaved->getVertexCount());
+		REQUIRE(equalVertices(interleaved->openVertexData(), separate->openVertexData()));
+		const MeshIndexData & iData = separate->openIndexData();
+		REQUIRE(std::equal(iData.data(), iData.data() + iData.getIndexCount(), interleaved->openIndexData().data()));
+	}
+}
+
+TEST_CASE("MeshUtilsTest_transformSpeed", "[MeshUtilsTest]") {
+	std::cout << std::endl;
+	const uint32_t vertexCount = 1000000;
+	std::uniform_real_distribution<float> coordinateDist(-100.0f, 100.0f);
+	std::default_random_engine engine(0);
+
+	VertexDescription vd;
+	vd.appendPosition3D();
+	vd.appendNormalFloat();
+	vd.appendTexCoord();
+	MeshVertexData vData;
+	vData.allocate(vertexCount, vd);
+	{
+		auto posAcc = PositionAttributeAccessor::create(vData);
+		auto nrmAcc = NormalAttributeAccessor::create(vData);
+		for(uint32_t i=0; i<vertexCount; ++i) {
+			posAcc->setPosition(i, Geometry::Vec3(coordinateDist(engine), coordinateDist(engine), coordinateDist(engine)));
+			nrmAcc->setNormal(i, Geometry::Vec3(0, 1, 0));
+		}
+	}
+	Geometry::Matrix4x4 mat;
+	mat.translate(1.0f, 2.0f, 3.0f);
+	mat.scale(2.0f);
+
+	const auto printSpeed = [vertexCount](const std::string & name, double milliseconds) {
+		std::cout << name << ": " << milliseconds << " ms (" << vertexCount / milliseconds / 1000.0 << " M vertices/s)" << std::endl;
+	};
+	Util::Timer t;
+
+	// reference: vertex by vertex
+	MeshVertexData reference(vData);
+	auto refPosAcc = PositionAttributeAccessor::create(reference);
+	auto refNrmAcc = NormalAttributeAccessor::create(reference);
+	t.reset();
+	for(uint32_t i=0; i<vertexCount; ++i) {
+		refPosAcc->setPosition(i, mat.transformPosition(refPosAcc->getPosition(i)));
+		refNrmAcc->setNormal(i, (mat * Geometry::Vec4(refNrmAcc->getNormal(i), 0)).xyz());
+	}
+	printSpeed("transform (per vertex)", t.getMilliseconds());
+	t.reset();
+	Geometry::Box referenceBox;
+	referenceBox.invalidate();
+	for(uint32_t i=0; i<vertexCount; ++i)
+		referenceBox.include(refPosAcc->getPosition(i));
+	printSpeed("bounding box (per vertex)", t.getMilliseconds());
+
+	t.reset();
+	MeshUtils::transformCoordinates(vData, VertexAttributeIds::POSITION, mat, 0, vertexCount);
+	MeshUtils::transformNormals(vData, VertexAttributeIds::NORMAL, mat, 0, vertexCount);
+	printSpeed("transform (blocks)", t.getMilliseconds());
+	t.reset();
+	vData.updateBoundingBox();
+	printSpeed("updateBoundingBox (blocks)", t.getMilliseconds());
+
+	auto posAcc = PositionAttributeAccessor::create(vData);
+	auto nrmAcc = NormalAttributeAccessor::create(vData);
+	for(uint32_t i=0; i<vertexCount; ++i) {
+		REQUIRE(posAcc->getPosition(i).distance(refPosAcc->getPosition(i)) < 1.0e-3f);
+		REQUIRE(nrmAcc->getNormal(i).distance(refNrmAcc->getNormal(i)) < 1.0e-5f);
+	}
+	const Geometry::Box & box = vData.getBoundingBox();
+	REQUIRE(box.getMin().distance(referenceBox.getMin()) < 1.0e-3f);
+	REQUIRE(box.getMax().distance(referenceBox.getMax()) < 1.0e-3f);
+}
@@ -0,0 +1,130 @@
+/*
+ This file is part of the Rendering library.
+ Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+ This library is subject to the terms of the Mozilla Public License, v. 2.0.
+ You should have received a copy of the MPL along with this library; see the
+ file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <catch2/catch.hpp>
+#include <Rendering/Mesh/MeshVertexData.h>
+#include <Rendering/MeshUtils/CompactKeyFrames.h>
+#include <Rendering/Serialization/StreamerMD2.h>
+
+#include <Util/GenericAttribute.h>
+#include <Util/References.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Rendering;
+using namespace Rendering::Serialization;
+
+template<typename value_t>
+static void append(std::string & data, const value_t & value) {
+	data.append(reinterpret_cast<const char *>(&value), sizeof(value_t));
+}
+
+//! Create a model with two frames of a triangle, which does not use the second of four vertices.
+static std::string createModel(short firstVertexIndex) {
+	MD2Header header;
+	std::memset(&header, 0, sizeof(MD2Header));
+	header.magic = ('2' << 24) + ('P' << 16) + ('D' << 8) + 'I';
+	header.version = 8;
+	header.skinWidth = 64;
+	header.skinHeight = 64;
+	header.framesize = sizeof(MD2Frame) + 4 * sizeof(MD2Vertex);
+	header.numSkins = 1;
+	header.numVertices = 4;
+	header.numTexCoords = 3;
+	header.numTriangles = 1;
+	header.numFrames = 2;
+	header.offsetSkins = sizeof(MD2Header);
+	header.offsetTexCoords = header.offsetSkins + sizeof(MD2Skin);
+	header.offsetTriangles = header.offsetTexCoords + 3 * sizeof(MD2TexCoord);
+	header.offsetFrames = header.offsetTriangles + sizeof(MD2Triangle);
+	header.offsetGlCommands = header.offsetFrames + 2 * header.framesize;
+	header.offsetEnd = header.offsetGlCommands;
+
+	std::string data;
+	append(data, header);
+	MD2Skin skin;
+	std::memset(&skin, 0, sizeof(MD2Skin));
+	std::strcpy(skin.path, "skin.png");
+	append(data, skin);
+	append(data, MD2TexCoord{0, 0});
+	append(data, MD2TexCoord{64, 0});
+	append(data, MD2TexCoord{0, 64});
+	append(data, MD2Triangle{{firstVertexIndex, 2, 3}, {0, 1, 2}});
+	for(uint_fast8_t f = 0; f < 2; ++f) {
+		MD2Frame frame;
+		std::memset(&frame, 0, sizeof(MD2Frame));
+		frame.scale[0] = frame.scale[1] = frame.scale[2] = 0.5f;
+		frame.translate[2] = f;
+		std::strcpy(frame.name, f == 0 ? "stand01" : "stand02");
+		append(data, frame);
+		append(data, MD2Vertex{{0, 0, 0}, 0});
+		append(data, MD2Vertex{{9, 9, 9}, 0});
+		append(data, MD2Vertex{{10, 0, 0}, 1});
+		append(data, MD2Vertex{{0, 10, 0}, 2});
+	}
+	return data;
+}
+
+TEST_CASE("StreamerMD2Test_loadGeneric", "[StreamerMD2Test]") {
+	StreamerMD2 streamer;
+	streamer.setStoreFullFrames(true);
+	std::istringstream input(createModel(0));
+	std::unique_ptr<Util::GenericAttributeList> descriptions(streamer.loadGeneric(input));
+	REQUIRE(descriptions.get() != nullptr);
+	REQUIRE(descriptions->size() == 1);
+	auto description = dynamic_cast<Util::GenericAttributeMap *>(descriptions->begin()->get());
+	auto frames = dynamic_cast<StreamerMD2::framesDataWrapper *>(description->getValue(StreamerMD2::DESCRIPTION_KEYFRAMES_DATA));
+	auto compactFrames = dynamic_cast<StreamerMD2::compactFramesWrapper *>(description->getValue(StreamerMD2::DESCRIPTION_COMPACT_KEYFRAMES_DATA));
+	REQUIRE(frames != nullptr);
+	REQUIRE(compactFrames != nullptr);
+	REQUIRE(frames->ref().size() == 2);
+
+	// the unused md2 vertex is skipped
+	const Util::Reference<MeshUtils::CompactKeyFrames> & keyFrames = compactFrames->ref();
+	REQUIRE(keyFrames->getKeyVertexCount() == 3);
+	REQUIRE(keyFrames->getFrameCount() == 2);
+
+	MeshVertexData target(keyFrames->getBaseFrame());
+	keyFrames->interpolate(1, 1, 0.0f, target);
+	const MeshVertexData & frame = frames->ref()[1];
+	for(uint32_t v = 0; v < 3; ++v) {
+		const float * expected = reinterpret_cast<const float *>(frame[v]);
+		const float * position = reinterpret_cast<const float *>(target[v]);
+		for(uint_fast8_t c = 0; c < 3; ++c)
+			REQUIRE(std::abs(position[c] - expected[c]) < 1.0e-3f);
+	}
+}
+
+TEST_CASE("StreamerMD2Test_compactFramesOnly", "[StreamerMD2Test]") {
+	StreamerMD2 streamer;
+	REQUIRE_FALSE(streamer.getStoreFullFrames());
+	std::istringstream input(createModel(0));
+	std::unique_ptr<Util::GenericAttributeList> descriptions(streamer.loadGeneric(input));
+	REQUIRE(descriptions.get() != nullptr);
+	auto description = dynamic_cast<Util::GenericAttributeMap *>(descriptions->begin()->get());
+	auto frames = dynamic_cast<StreamerMD2::framesDataWrapper *>(description->getValue(StreamerMD2::DESCRIPTION_KEYFRAMES_DATA));
+	auto compactFrames = dynamic_cast<StreamerMD2::compactFramesWrapper *>(description->getValue(StreamerMD2::DESCRIPTION_COMPACT_KEYFRAMES_DATA));
+	REQUIRE(frames != nullptr);
+	REQUIRE(frames->ref().empty());
+	REQUIRE(compactFrames != nullptr);
+	REQUIRE(compactFrames->ref()->getFrameCount() == 2);
+}
+
+TEST_CASE("StreamerMD2Test_invalidIndex", "[StreamerMD2Test]") {
+	StreamerMD2 streamer;
+	std::istringstream input(createModel(4));
+	std::unique_ptr<Util::GenericAttributeList> descriptions(streamer.loadGeneric(input));
+	REQUIRE(descriptions.get() == nullptr);
+}
@@ -0,0 +1,156 @@
+/*
+ This file is part of the Rendering library.
+ Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+ This library is subject to the terms of the Mozilla Public License, v. 2.0.
+ You should have received a copy of the MPL along with this library; see the
+ file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <catch2/catch.hpp>
+#include <Rendering/Mesh/Mesh.h>
+#include <Rendering/Mesh/MeshIndexData.h>
+#include <Rendering/Mesh/MeshVertexData.h>
+#include <Rendering/Mesh/VertexDescription.h>
+#include <Rendering/Serialization/StreamerMMF.h>
+
+#include <Util/References.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+using namespace Rendering;
+
+static Mesh * createTestMesh(uint32_t vertexCount) {
+	VertexDescription vd;
+	vd.appendPosition3D();
+	vd.appendNormalFloat();
+	auto mesh = new Mesh(vd, vertexCount, 3 * vertexCount);
+	MeshVertexData & vertices = mesh->openVertexData();
+	float * values = reinterpret_cast<float *>(vertices.data());
+	for(uint32_t i = 0; i < vertexCount * 6; ++i)
+		values[i] = static_cast<float>(i % 97) * 0.5f;
+	MeshIndexData & indices = mesh->openIndexData();
+	for(uint32_t i = 0; i < 3 * vertexCount; ++i)
+		indices[i] = (i * 7) % vertexCount;
+	indices.updateIndexRange();
+	vertices.updateBoundingBox();
+	return mesh;
+}
+
+TEST_CASE("StreamerMMFTest_loadMeshMapped", "[StreamerMMFTest]") {
+	const std::string fileName("StreamerMMFTest.mmf");
+	Util::Reference<Mesh> mesh = createTestMesh(1000);
+	{
+		std::ofstream output(fileName, std::ios::binary);
+		Serialization::StreamerMMF streamer;
+		REQUIRE(streamer.saveMesh(mesh.get(), output));
+	}
+
+	Util::Reference<Mesh> loaded = Serialization::StreamerMMF::loadMeshMapped(fileName);
+	REQUIRE(loaded.isNotNull());
+	REQUIRE(loaded->getVertexCount() == mesh->getVertexCount());
+	REQUIRE(loaded->getIndexCount() == mesh->getIndexCount());
+	REQUIRE(loaded->getBoundingBox() == mesh->getBoundingBox());
+
+	MeshVertexData & vertices = loaded->openVertexData();
+	MeshIndexData & indices = loaded->openIndexData();
+	REQUIRE(vertices.hasExternalData());
+	// 16 bit indices are unpacked into local memory
+	REQUIRE_FALSE(indices.hasExternalData());
+	REQUIRE(vertices.dataSize() == mesh->openVertexData().dataSize());
+	REQUIRE(std::memcmp(vertices.data(), mesh->openVertexData().data(), vertices.dataSize()) == 0);
+	REQUIRE(std::memcmp(indices.data(), mesh->openIndexData().data(), indices.dataSize()) == 0);
+
+	// modifications are private to the loaded mesh
+	vertices.data()[0] = 0xff;
+	indices[0] = 42;
+	Util::Reference<Mesh> reloaded = Serialization::StreamerMMF::loadMeshMapped(fileName);
+	REQUIRE(reloaded.isNotNull());
+	REQUIRE(std::memcmp(reloaded->openVertexData().data(), mesh->openVertexData().data(), vertices.dataSize()) == 0);
+	REQUIRE(reloaded->openIndexData()[0] == mesh->openIndexData()[0]);
+
+	// a copy owns its data
+	Util::Reference<Mesh> copy = loaded->clone();
+	REQUIRE_FALSE(copy->openVertexData().hasExternalData());
+	REQUIRE(copy->openIndexData()[0] == 42);
+
+	loaded = nullptr;
+	reloaded = nullptr;
+	std::remove(fileName.c_str());
+	REQUIRE(Serialization::StreamerMMF::loadMeshMapped(fileName) == nullptr);
+}
+
+TEST_CASE("StreamerMMFTest_loadMeshMapped32BitIndices", "[StreamerMMFTest]") {
+	const std::string fileName("StreamerMMFTest32.mmf");
+	Util::Reference<Mesh> mesh = createTestMesh(70000);
+	REQUIRE(mesh->openIndexData().getMaxIndex() > 65535);
+	{
+		std::ofstream output(fileName, std::ios::binary);
+		Serialization::StreamerMMF streamer;
+		REQUIRE(streamer.saveMesh(mesh.get(), output));
+	}
+
+	Util::Reference<Mesh> loaded = Serialization::StreamerMMF::loadMeshMapped(fileName);
+	REQUIRE(loaded.isNotNull());
+	REQUIRE(loaded->getVertexCount() == mesh->getVertexCount());
+	REQUIRE(loaded->getIndexCount() == mesh->getIndexCount());
+
+	MeshVertexData & vertices = loaded->openVertexData();
+	MeshIndexData & indices = loaded->openIndexData();
+	REQUIRE(vertices.hasExternalData());
+	REQUIRE(indices.hasExternalData());
+	REQUIRE(indices.getMaxIndex() == mesh->openIndexData().getMaxIndex());
+	REQUIRE(std::memcmp(vertices.data(), mesh->openVertexData().data(), vertices.dataSize()) == 0);
+	REQUIRE(std::memcmp(indices.data(), mesh->openIndexData().data(), indices.dataSize()) == 0);
+
+	loaded = nullptr;
+	std::remove(fileName.c_str());
+}
+
+TEST_CASE("StreamerMMFTest_chunks", "[StreamerMMFTest]") {
+	Util::Reference<Mesh> mesh = createTestMesh(10000);
+	for(const bool compression : {false, true}) {
+		std::stringstream stream;
+		Serialization::StreamerMMF streamer;
+		streamer.setCompression(compression);
+		streamer.setSubMeshTriangleCount(1000);
+		REQUIRE(streamer.saveMesh(mesh.get(), stream));
+		const std::string data = stream.str();
+		if(compression)
+			REQUIRE(data.size() < mesh->openVertexData().dataSize());
+
+		std::stringstream input(data);
+		Util::Reference<Mesh> loaded = streamer.loadMesh(input);
+		REQUIRE(loaded.isNotNull());
+		REQUIRE(loaded->openVertexData().dataSize() == mesh->openVertexData().dataSize());
+		REQUIRE(std::memcmp(loaded->openVertexData().data(), mesh->openVertexData().data(), mesh->openVertexData().dataSize()) == 0);
+		REQUIRE(std::memcmp(loaded->openIndexData().data(), mesh->openIndexData().data(), mesh->openIndexData().dataSize()) == 0);
+
+		std::vector<Serialization::StreamerMMF::SubMesh> subMeshes;
+		std::stringstream tableInput(data);
+		REQUIRE(Serialization::StreamerMMF::readSubMeshes(tableInput, subMeshes));
+		REQUIRE(subMeshes.size() == 10);
+		const MeshIndexData & indices = mesh->openIndexData();
+		for(uint32_t i = 0; i < subMeshes.size(); ++i) {
+			const auto & subMesh = subMeshes[i];
+			REQUIRE(subMesh.firstIndex == i * 3000);
+			REQUIRE(subMesh.indexCount == 3000);
+			std::stringstream partInput(data);
+			Util::Reference<Mesh> part = Serialization::StreamerMMF::loadSubMesh(partInput, i);
+			REQUIRE(part.isNotNull());
+			REQUIRE(part->getVertexCount() == subMesh.maxIndex - subMesh.minIndex + 1);
+			REQUIRE(std::memcmp(part->openVertexData().data(), mesh->openVertexData()[subMesh.minIndex], part->openVertexData().dataSize()) == 0);
+			const MeshIndexData & partIndices = part->openIndexData();
+			REQUIRE(partIndices.getIndexCount() == subMesh.indexCount);
+			for(uint32_t j = 0; j < subMesh.indexCount; ++j)
+				REQUIRE(partIndices[j] + subMesh.minIndex == indices[subMesh.firstIndex + j]);
+		}
+		std::stringstream invalidInput(data);
+		REQUIRE(Serialization::StreamerMMF::loadSubMesh(invalidInput, 10) == nullptr);
+	}
+}
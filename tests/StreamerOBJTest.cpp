@@ -0,0 +1,126 @@
+/*
+ This file is part of the Rendering library.
+ Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+ This library is subject to the terms of the Mozilla Public License, v. 2.0.
+ You should have received a copy of the MPL along with this library; see the
+ file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <catch2/catch.hpp>
+#include <Rendering/Mesh/Mesh.h>
+#include <Rendering/Mesh/MeshIndexData.h>
+#include <Rendering/Mesh/MeshVertexData.h>
+#include <Rendering/Mesh/VertexAttributeIds.h>
+#include <Rendering/Mesh/VertexDescription.h>
+#include <Rendering/Serialization/Serialization.h>
+#include <Rendering/Serialization/StreamerOBJ.h>
+
+#include <Util/GenericAttribute.h>
+#include <Util/References.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Rendering;
+
+static std::vector<Util::Reference<Mesh>> loadMeshes(const std::string & data, uint32_t threadCount, std::vector<std::string> & materials) {
+	Serialization::StreamerOBJ streamer;
+	streamer.setThreadCount(threadCount);
+	std::istringstream input(data);
+	std::unique_ptr<Util::GenericAttributeList> descriptions(streamer.loadGeneric(input));
+	std::vector<Util::Reference<Mesh>> meshes;
+	for(const auto & entry : *descriptions) {
+		auto description = dynamic_cast<Util::GenericAttributeMap *>(entry.get());
+		auto wrapper = dynamic_cast<Serialization::MeshWrapper_t *>(description->getValue(Serialization::DESCRIPTION_DATA));
+		if(wrapper != nullptr) {
+			meshes.push_back(wrapper->get());
+			materials.push_back(description->getString(Serialization::DESCRIPTION_MATERIAL_NAME));
+		} else {
+			materials.push_back(description->getString(Serialization::DESCRIPTION_FILE));
+		}
+	}
+	return meshes;
+}
+
+TEST_CASE("StreamerOBJTest_loadGeneric", "[StreamerOBJTest]") {
+	const std::string data =
+		"mtllib test.mtl\n"
+		"# a quad and a triangle\n"
+		"v 0 0 0\n"
+		"v 1.0 0 0\n"
+		"v 1 1e0 0\n"
+		"v 0 1 -0.5\n"
+		"v 0 1 -0.5\n"
+		"vt 0 0\n"
+		"vt 1 1\n"
+		"usemtl first\n"
+		"f 1/1 2/2 3/1 4/2\r\n"
+		"usemtl second\n"
+		"f -5 -2 -1\n";
+	std::vector<std::string> materials;
+	const auto meshes = loadMeshes(data, 1, materials);
+	REQUIRE(meshes.size() == 2);
+	REQUIRE(materials == std::vector<std::string>({"test.mtl", "first", "second"}));
+
+	// the quad is split into two triangles
+	const Mesh * quad = meshes[0].get();
+	REQUIRE(quad->getVertexCount() == 4);
+	REQUIRE(quad->getIndexCount() == 6);
+	REQUIRE(quad->getVertexDescription().hasAttribute(VertexAttributeIds::TEXCOORD0));
+	const std::vector<uint32_t> quadIndices({0, 1, 2, 0, 2, 3});
+	for(uint32_t i = 0; i < 6; ++i)
+		REQUIRE(quad->_getIndexData()[i] == quadIndices[i]);
+
+	// vertices 4 and 5 are equal
+	const Mesh * triangle = meshes[1].get();
+	REQUIRE(triangle->getVertexCount() == 2);
+	REQUIRE(triangle->getIndexCount() == 3);
+	REQUIRE(triangle->_getIndexData()[2] == 1);
+	REQUIRE_FALSE(triangle->getVertexDescription().hasAttribute(VertexAttributeIds::TEXCOORD0));
+	const float * positions = reinterpret_cast<const float *>(triangle->_getVertexData().data());
+	REQUIRE(positions[3] == 0.0f);
+	REQUIRE(positions[4] == 1.0f);
+	REQUIRE(positions[5] == -0.5f);
+}
+
+TEST_CASE("StreamerOBJTest_chunks", "[StreamerOBJTest]") {
+	// large enough to be split into several chunks
+	std::ostringstream data;
+	const uint32_t gridSize = 300;
+	const int64_t vertexCount = gridSize * gridSize;
+	for(uint32_t y = 0; y < gridSize; ++y) {
+		for(uint32_t x = 0; x < gridSize; ++x)
+			data << "v " << x * 0.1 << ' ' << y * 0.1 << ' ' << (x * y % 7) * 0.123456789 << '\n';
+	}
+	data << "vn 0 0 1\n";
+	for(uint32_t y = 0; y + 1 < gridSize; ++y) {
+		if(y % 100 == 0)
+			data << "g part" << y << '\n';
+		for(uint32_t x = 0; x + 1 < gridSize; ++x) {
+			const uint32_t i = y * gridSize + x + 1;
+			if(x % 2 == 0)
+				data << "f " << i << "//1 " << i + 1 << "//1 " << i + gridSize + 1 << "//1 " << i + gridSize << "//1\n";
+			else // relative indices
+				data << "f " << i - vertexCount - 1 << "//-1 " << i - vertexCount << "//-1 " << i + gridSize - vertexCount << "//-1\n";
+		}
+	}
+	std::vector<std::string> materials;
+	const auto expected = loadMeshes(data.str(), 1, materials);
+	REQUIRE(expected.size() == 3);
+	const auto meshes = loadMeshes(data.str(), 4, materials);
+	REQUIRE(meshes.size() == expected.size());
+	for(size_t i = 0; i < meshes.size(); ++i) {
+		const MeshVertexData & vertices = meshes[i]->_getVertexData();
+		const MeshIndexData & indices = meshes[i]->_getIndexData();
+		REQUIRE(vertices.getVertexDescription() == expected[i]->getVertexDescription());
+		REQUIRE(vertices.dataSize() == expected[i]->_getVertexData().dataSize());
+		REQUIRE(std::memcmp(vertices.data(), expected[i]->_getVertexData().data(), vertices.dataSize()) == 0);
+		REQUIRE(indices.getIndexCount() == expected[i]->getIndexCount());
+		REQUIRE(std::memcmp(indices.data(), expected[i]->_getIndexData().data(), indices.dataSize()) == 0);
+	}
+}
@@ -0,0 +1,97 @@
+/*
+ This file is part of the Rendering library.
+ Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+ This library is subject to the terms of the Mozilla Public License, v. 2.0.
+ You should have received a copy of the MPL along with this library; see the
+ file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <catch2/catch.hpp>
+#include <Rendering/Mesh/Mesh.h>
+#include <Rendering/Mesh/MeshIndexData.h>
+#include <Rendering/Mesh/MeshVertexData.h>
+#include <Rendering/Mesh/VertexAttributeIds.h>
+#include <Rendering/Mesh/VertexDescription.h>
+#include <Rendering/Serialization/StreamerPLY.h>
+
+#include <Util/References.h>
+
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Rendering;
+
+static const char * const PLY_PROPERTIES =
+	"element vertex 4\n"
+	"property float x\n"
+	"property float y\n"
+	"property float z\n"
+	"property short ignored\n"
+	"property uchar red\n"
+	"property uchar green\n"
+	"property uchar blue\n"
+	"element face 1\n"
+	"property list uchar int vertex_indices\n"
+	"end_header\n";
+
+static void writeBigEndian(std::ostream & output, const void * value, size_t size) {
+	const uint8_t * bytes = reinterpret_cast<const uint8_t *>(value);
+	for(size_t i = size; i > 0; --i)
+		output.put(static_cast<char>(bytes[i - 1]));
+}
+
+TEST_CASE("StreamerPLYTest_loadMesh", "[StreamerPLYTest]") {
+	const std::vector<float> positions({0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0.5f});
+
+	std::ostringstream ascii;
+	ascii << "ply\nformat ascii 1.0\n" << PLY_PROPERTIES;
+	for(uint32_t i = 0; i < 4; ++i)
+		ascii << positions[i * 3] << ' ' << positions[i * 3 + 1] << ' ' << positions[i * 3 + 2] << " 7 " << i * 10 << ' ' << i * 20 << " 255\n";
+	ascii << "4 0 1 2 3\n";
+
+	std::ostringstream binary;
+	binary << "ply\r\nformat binary_big_endian 1.0\n" << PLY_PROPERTIES;
+	for(uint32_t i = 0; i < 4; ++i) {
+		writeBigEndian(binary, &positions[i * 3], 4);
+		writeBigEndian(binary, &positions[i * 3 + 1], 4);
+		writeBigEndian(binary, &positions[i * 3 + 2], 4);
+		const int16_t ignored = 7;
+		writeBigEndian(binary, &ignored, 2);
+		binary.put(static_cast<char>(i * 10)).put(static_cast<char>(i * 20)).put(static_cast<char>(255));
+	}
+	binary.put(4);
+	for(int32_t i = 0; i < 4; ++i)
+		writeBigEndian(binary, &i, 4);
+
+	for(const std::string & data : {ascii.str(), binary.str()}) {
+		Serialization::StreamerPLY streamer;
+		std::istringstream input(data);
+		Util::Reference<Mesh> mesh = streamer.loadMesh(input);
+		REQUIRE(mesh.isNotNull());
+		REQUIRE(mesh->getVertexCount() == 4);
+		REQUIRE(mesh->getVertexDescription().hasAttribute(VertexAttributeIds::COLOR));
+		REQUIRE_FALSE(mesh->getVertexDescription().hasAttribute(VertexAttributeIds::NORMAL));
+
+		// the quad is split into two triangles
+		const MeshIndexData & indices = mesh->openIndexData();
+		REQUIRE(indices.getIndexCount() == 6);
+		const std::vector<uint32_t> quadIndices({0, 1, 2, 2, 3, 0});
+		for(uint32_t i = 0; i < 6; ++i)
+			REQUIRE(indices[i] == quadIndices[i]);
+
+		const MeshVertexData & vertices = mesh->openVertexData();
+		const size_t colorOffset = mesh->getVertexDescription().getAttribute(VertexAttributeIds::COLOR).getOffset();
+		for(uint32_t i = 0; i < 4; ++i) {
+			REQUIRE(std::memcmp(vertices[i], &positions[i * 3], 3 * sizeof(float)) == 0);
+			const uint8_t * color = vertices[i] + colorOffset;
+			REQUIRE(color[0] == i * 10);
+			REQUIRE(color[1] == i * 20);
+			REQUIRE(color[2] == 255);
+			REQUIRE(color[3] == 255);
+		}
+	}
+}
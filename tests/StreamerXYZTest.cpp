@@ -0,0 +1,85 @@
+/*
+ This file is part of the Rendering library.
+ Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+ This library is subject to the terms of the Mozilla Public License, v. 2.0.
+ You should have received a copy of the MPL along with this library; see the
+ file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <catch2/catch.hpp>
+#include <Rendering/Mesh/Mesh.h>
+#include <Rendering/Mesh/MeshVertexData.h>
+#include <Rendering/Serialization/StreamerXYZ.h>
+
+#include <Util/References.h>
+
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Rendering;
+
+TEST_CASE("StreamerXYZTest_loadMesh", "[StreamerXYZTest]") {
+	const std::string data =
+		"# comment\n"
+		"0 0 0 10 20 30\n"
+		"\n"
+		"1.5\t-2e1 3 255 0 7\r\n"
+		"4 5 6\n"
+		"7 8 9 1 2 3";
+	Serialization::StreamerXYZ streamer;
+	std::stringstream input(data);
+	Util::Reference<Mesh> first = streamer.loadMesh(input, 2);
+	REQUIRE(first.isNotNull());
+	REQUIRE(first->getVertexCount() == 2);
+	REQUIRE(first->getDrawMode() == Mesh::DRAW_POINTS);
+
+	const uint8_t * vertex = first->openVertexData()[1];
+	const float * position = reinterpret_cast<const float *>(vertex);
+	REQUIRE(position[0] == 1.5f);
+	REQUIRE(position[1] == -20.0f);
+	REQUIRE(position[2] == 3.0f);
+	REQUIRE(vertex[12] == 255);
+	REQUIRE(vertex[13] == 0);
+	REQUIRE(vertex[14] == 7);
+	REQUIRE(vertex[15] == 255);
+
+	// the input continues behind the loaded points
+	Util::Reference<Mesh> rest = streamer.loadMesh(input);
+	REQUIRE(rest->getVertexCount() == 2);
+	const uint8_t * white = rest->openVertexData()[0];
+	REQUIRE(reinterpret_cast<const float *>(white)[0] == 4.0f);
+	REQUIRE(white[12] == 255);
+	REQUIRE(white[13] == 255);
+	REQUIRE(rest->openVertexData()[1][12] == 1);
+}
+
+TEST_CASE("StreamerXYZTest_clusterPointsSpatially", "[StreamerXYZTest]") {
+	std::stringstream input;
+	const uint32_t gridSize = 20;
+	for(uint32_t x = 0; x < gridSize; ++x) {
+		for(uint32_t y = 0; y < gridSize; ++y) {
+			for(uint32_t z = 0; z < gridSize; ++z)
+				input << x << ' ' << y << ' ' << z << " 1 2 3\n";
+		}
+	}
+	std::vector<std::unique_ptr<std::ostringstream>> outputHolder;
+	std::vector<std::ostream *> outputs;
+	for(uint32_t i = 0; i < 8; ++i) {
+		outputHolder.emplace_back(new std::ostringstream);
+		outputs.push_back(outputHolder.back().get());
+	}
+	Serialization::StreamerXYZ::clusterPointsSpatially(input, outputs);
+
+	// the grid is split into octants
+	for(const auto & output : outputHolder) {
+		std::istringstream clusterInput(output->str());
+		Serialization::StreamerXYZ streamer;
+		Util::Reference<Mesh> cluster = streamer.loadMesh(clusterInput);
+		REQUIRE(cluster->getVertexCount() == gridSize * gridSize * gridSize / 8);
+		REQUIRE(cluster->getBoundingBox().getExtentMax() == static_cast<float>(gridSize / 2 - 1));
+	}
+}
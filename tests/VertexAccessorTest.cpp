@@ -11,17 +11,23 @@
 #include <Rendering/Mesh/MeshVertexData.h>
 #include <Rendering/Mesh/MeshIndexData.h>
 #include <Rendering/Mesh/VertexDescription.h>
+#include <Rendering/Mesh/StridedAttributeView.h>
 #include <Rendering/Mesh/VertexAccessor.h>
 #include <Rendering/Mesh/VertexAttributeAccessors.h>
+#include <Rendering/Mesh/VertexAttributeIds.h>
+#include <Rendering/GLHeader.h>
 
 #include <Util/Timer.h>
 #include <Util/References.h>
+#include <Util/StringIdentifier.h>
 
 #include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <random>
+#include <stdexcept>
 #include <vector>
 
 using namespace Rendering;
@@ -207,4 +213,148 @@ TEST_CASE("VertexAccessorTest_compareSpeed", "[VertexAccessorTest]") {
     }
     std::cout << "VertexAccessor (GPU;dynamic:location): " << t.getMilliseconds() << " ms" << std::endl;    
   }
-}
\ No newline at end of file
+}
+
+TEST_CASE("VertexAccessorTest_batchAccess", "[VertexAccessorTest]") {
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+	std::default_random_engine engine(0);
+	const uint32_t count = 100;
+	std::vector<float> values(4 * count);
+	for(auto & v : values)
+		v = dist(engine);
+	for(uint32_t i = 0; i < count; ++i) {
+		// unit normals; colors in [0,1]
+		float * n = values.data() + 4 * i;
+		const float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		n[0] /= length, n[1] /= length, n[2] /= length, n[3] = std::abs(n[3]);
+	}
+	// the batch functions have to produce the same values as the single value functions
+	const auto compare = [&](const std::vector<float> & batch, const std::vector<float> & single) {
+		REQUIRE(batch.size() == single.size());
+		for(size_t i = 0; i < batch.size(); ++i)
+			REQUIRE(std::abs(batch[i] - single[i]) < 1.0e-6f);
+	};
+
+	std::vector<std::function<void(VertexDescription&)>> positionFormats = {
+		[](VertexDescription & vd) { vd.appendPosition3D(); },
+		[](VertexDescription & vd) { vd.appendPosition4DHalf(); },
+		[](VertexDescription & vd) { vd.appendPositionQuantized(); },
+	};
+	for(const auto & format : positionFormats) {
+		VertexDescription vd;
+		format(vd);
+		MeshVertexData vData;
+		vData.allocate(count, vd);
+		auto acc = PositionAttributeAccessor::create(vData);
+		std::vector<float> positions;
+		for(uint32_t i = 0; i < count; ++i)
+			positions.insert(positions.end(), values.begin() + 4 * i, values.begin() + 4 * i + 3);
+		acc->setPositions(0, count, positions.data());
+		std::vector<float> batch(3 * count), single;
+		acc->getPositions(0, count, batch.data());
+		for(uint32_t i = 0; i < count; ++i) {
+			const Geometry::Vec3 p = acc->getPosition(i);
+			single.insert(single.end(), p.getVec(), p.getVec() + 3);
+			acc->setPosition(i, Geometry::Vec3(positions[3 * i], positions[3 * i + 1], positions[3 * i + 2]));
+		}
+		compare(batch, single);
+		acc->getPositions(0, count, batch.data());
+		compare(batch, single);
+		REQUIRE_THROWS(acc->getPositions(1, count, batch.data()));
+	}
+
+	std::vector<std::function<void(VertexDescription&)>> normalFormats = {
+		[](VertexDescription & vd) { vd.appendNormalFloat(); },
+		[](VertexDescription & vd) { vd.appendNormalByte(); },
+		[](VertexDescription & vd) { vd.appendNormalOctahedral(); },
+	};
+	for(const auto & format : normalFormats) {
+		VertexDescription vd;
+		format(vd);
+		MeshVertexData vData;
+		vData.allocate(count, vd);
+		auto acc = NormalAttributeAccessor::create(vData);
+		std::vector<float> normals;
+		for(uint32_t i = 0; i < count; ++i)
+			normals.insert(normals.end(), values.begin() + 4 * i, values.begin() + 4 * i + 3);
+		acc->setNormals(0, count, normals.data());
+		std::vector<float> batch(3 * count), single;
+		acc->getNormals(0, count, batch.data());
+		for(uint32_t i = 0; i < count; ++i) {
+			const Geometry::Vec3 n = acc->getNormal(i);
+			single.insert(single.end(), n.getVec(), n.getVec() + 3);
+			acc->setNormal(i, Geometry::Vec3(normals[3 * i], normals[3 * i + 1], normals[3 * i + 2]));
+		}
+		compare(batch, single);
+		acc->getNormals(0, count, batch.data());
+		compare(batch, single);
+	}
+
+	std::vector<std::function<void(VertexDescription&)>> colorFormats = {
+		[](VertexDescription & vd) { vd.appendColorRGBFloat(); },
+		[](VertexDescription & vd) { vd.appendColorRGBAFloat(); },
+		[](VertexDescription & vd) { vd.appendColorRGBAByte(); },
+	};
+	for(const auto & format : colorFormats) {
+		VertexDescription vd;
+		format(vd);
+		MeshVertexData vData;
+		vData.allocate(count, vd);
+		auto acc = ColorAttributeAccessor::create(vData);
+		std::vector<float> colors(values);
+		for(auto & c : colors)
+			c = std::abs(c);
+		acc->setColors(0, count, colors.data());
+		std::vector<float> batch(4 * count), single;
+		acc->getColors(0, count, batch.data());
+		for(uint32_t i = 0; i < count; ++i) {
+			const Util::Color4f c = acc->getColor4f(i);
+			single.insert(single.end(), {c.getR(), c.getG(), c.getB(), c.getA()});
+			acc->setColor(i, Util::Color4f(colors[4 * i], colors[4 * i + 1], colors[4 * i + 2], colors[4 * i + 3]));
+		}
+		compare(batch, single);
+		acc->getColors(0, count, batch.data());
+		compare(batch, single);
+	}
+}
+
+TEST_CASE("VertexAccessorTest_stridedAttributeView", "[VertexAccessorTest]") {
+	VertexDescription vd;
+	vd.appendPosition3D();
+	vd.appendNormalByte();
+	MeshVertexData vData;
+	vData.allocate(10, vd);
+	auto acc = PositionAttributeAccessor::create(vData);
+	for(uint32_t i = 0; i < vData.getVertexCount(); ++i)
+		acc->setPosition(i, Geometry::Vec3(i, 2.0f * i, 3.0f * i));
+
+	auto positions = StridedAttributeView<float>::create(vData, VertexAttributeIds::POSITION, 3);
+	REQUIRE(positions.size() == 10);
+	REQUIRE(positions.getStride() == vd.getVertexSize());
+	REQUIRE(positions.end() - positions.begin() == 10);
+	for(float * p : positions)
+		p[1] += 1.0f;
+	for(uint32_t i = 0; i < vData.getVertexCount(); ++i) {
+		REQUIRE(positions[i][0] == static_cast<float>(i));
+		REQUIRE(acc->getPosition(i).y() == 2.0f * i + 1.0f);
+	}
+
+	REQUIRE(StridedAttributeView<int8_t>::isCompatible(vd.getAttribute(VertexAttributeIds::NORMAL), 3));
+	REQUIRE_THROWS_AS(StridedAttributeView<float>::create(vData, VertexAttributeIds::NORMAL), std::invalid_argument);
+	REQUIRE_THROWS_AS(StridedAttributeView<float>::create(vData, VertexAttributeIds::POSITION, 4), std::invalid_argument);
+}
+
+TEST_CASE("VertexAccessorTest_normalizedShortFloats", "[VertexAccessorTest]") {
+	static const Util::StringIdentifier NORMALIZED("normalized");
+	static const Util::StringIdentifier INTEGER("integer");
+	VertexDescription vd;
+	vd.appendAttribute(NORMALIZED, 2, GL_UNSIGNED_SHORT, true);
+	vd.appendAttribute(INTEGER, 2, GL_UNSIGNED_SHORT, false, false);
+	MeshVertexData vData;
+	vData.allocate(1, vd);
+
+	auto acc = FloatAttributeAccessor::create(vData, NORMALIZED);
+	acc->setValue(0, 0.5f);
+	REQUIRE(std::abs(acc->getValue(0) - 0.5f) < 1.0e-4f);
+	REQUIRE_THROWS_AS(FloatAttributeAccessor::create(vData, INTEGER), std::invalid_argument);
+}
@@ -0,0 +1,71 @@
+/*
+ This file is part of the Rendering library.
+ Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+ This library is subject to the terms of the Mozilla Public License, v. 2.0.
+ You should have received a copy of the MPL along with this library; see the
+ file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+#include <catch2/catch.hpp>
+#include <Rendering/Mesh/MeshVertexData.h>
+#include <Rendering/Mesh/VertexAttribute.h>
+#include <Rendering/Mesh/VertexAttributeIds.h>
+#include <Rendering/Mesh/VertexDescription.h>
+#include <Rendering/GLHeader.h>
+
+#include <Util/StringIdentifier.h>
+
+#include <cstdint>
+
+using namespace Rendering;
+
+TEST_CASE("VertexDescriptionTest_lookup", "[VertexDescriptionTest]") {
+	VertexDescription vd;
+	vd.appendPosition3D();
+	vd.appendNormalByte();
+	vd.appendColorRGBAByte();
+	for(uint_fast8_t unit = 0; unit < 8; ++unit)
+		vd.appendTexCoord(unit);
+	REQUIRE(vd.getAttribute(VertexAttributeIds::POSITION).getOffset() == 0);
+	REQUIRE(vd.getAttribute(VertexAttributeIds::NORMAL).getOffset() == 12);
+	REQUIRE(vd.getAttribute(VertexAttributeIds::COLOR).getOffset() == 16);
+	for(uint_fast8_t unit = 0; unit < 8; ++unit)
+		REQUIRE(vd.getAttribute(VertexAttributeIds::getTextureCoordinateIdentifier(unit)).getOffset() == 20 + 8 * unit);
+	REQUIRE(vd.getAttribute(Util::StringIdentifier("unknown")).empty());
+	REQUIRE(!vd.hasAttribute(Util::StringIdentifier("unknown")));
+
+	// the first of several attributes with the same name is found
+	vd.appendAttribute(VertexAttributeIds::COLOR, 3, GL_FLOAT, false);
+	REQUIRE(vd.getAttribute(VertexAttributeIds::COLOR).getDataType() == GL_UNSIGNED_BYTE);
+
+	// the lookup data is updated with the attributes
+	vd.updateAttribute(VertexAttribute(4, GL_FLOAT, VertexAttributeIds::NORMAL, false));
+	REQUIRE(vd.getAttribute(VertexAttributeIds::NORMAL).getDataType() == GL_FLOAT);
+	REQUIRE(vd.getAttribute(VertexAttributeIds::COLOR).getOffset() == 28);
+}
+
+TEST_CASE("VertexDescriptionTest_intern", "[VertexDescriptionTest]") {
+	VertexDescription vd1;
+	vd1.appendPosition3D();
+	vd1.appendNormalFloat();
+	VertexDescription vd2;
+	vd2.appendPosition3D();
+	REQUIRE(!(vd1 == vd2));
+	vd2.appendNormalFloat();
+	REQUIRE(vd1 == vd2);
+	REQUIRE(vd1.getHash() == vd2.getHash());
+	REQUIRE(&VertexDescription::intern(vd1) == &VertexDescription::intern(vd2));
+	REQUIRE(VertexDescription::intern(vd1) == vd1);
+
+	vd2.setInterleaved(false);
+	REQUIRE(!(vd1 == vd2));
+	REQUIRE(&VertexDescription::intern(vd1) != &VertexDescription::intern(vd2));
+
+	MeshVertexData vData1;
+	vData1.allocate(4, vd1);
+	MeshVertexData vData2;
+	vData2.allocate(4, vd1);
+	REQUIRE(&vData1.getVertexDescription() == &vData2.getVertexDescription());
+	REQUIRE(&vData1.getVertexDescription() == &VertexDescription::intern(vd1));
+}
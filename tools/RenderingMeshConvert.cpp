@@ -0,0 +1,360 @@
+/*
+	This file is part of the Rendering library.
+	Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+
+	This library is subject to the terms of the Mozilla Public License, v. 2.0.
+	You should have received a copy of the MPL along with this library; see the
+	file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+*/
+
+/**
+ * RenderingMeshConvert: Convert mesh files (.obj, .ply, .md2, .ngc, .mvbo, .xyz, ...)
+ * into .mmf files. The files are converted in parallel; each file is processed by a
+ * single thread. For every file, one line with its throughput is reported.
+ * Input files differing only in their ending (e.g. foo.obj and foo.ply) keep their
+ * ending in the output name (foo.obj.mmf and foo.ply.mmf).
+ */
+
+#include <Rendering/Mesh/Mesh.h>
+#include <Rendering/Mesh/MeshIndexData.h>
+#include <Rendering/Mesh/MeshVertexData.h>
+#include <Rendering/Mesh/VertexDescription.h>
+#include <Rendering/MeshUtils/CompactKeyFrames.h>
+#include <Rendering/MeshUtils/MeshUtils.h>
+#include <Rendering/MeshUtils/ParallelFor.h>
+#include <Rendering/Serialization/Serialization.h>
+#include <Rendering/Serialization/StreamerMD2.h>
+#include <Rendering/Serialization/StreamerMMF.h>
+
+#include <Util/GenericAttribute.h>
+#include <Util/IO/FileName.h>
+#include <Util/IO/FileUtils.h>
+#include <Util/References.h>
+#include <Util/Util.h>
+
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Rendering;
+
+struct ConvertOptions {
+	std::string outputDir; //!< empty: next to the input file
+	uint32_t jobCount = 0;
+	bool recursive = false;
+	bool eliminateDuplicates = false;
+	bool optimizeIndices = false;
+	bool quantize = false;
+	bool compress = false;
+};
+
+struct ConvertJob {
+	Util::FileName input;
+	std::string outputBase; //!< path of the output without ending
+};
+
+struct ConvertResult {
+	bool success = false;
+	std::string message;
+	uint32_t meshCount = 0;
+	uint64_t vertexCount = 0;
+	uint64_t triangleCount = 0;
+	uint64_t inputSize = 0;
+	uint64_t outputSize = 0;
+	double seconds = 0.0;
+};
+
+static const char * const SUPPORTED_ENDINGS[] = {"obj", "ply", "md2", "ngc", "mvbo", "xyz"};
+
+static void printUsage() {
+	std::cout << "Usage: RenderingMeshConvert [options] <file or directory>...\n"
+			  << "Convert meshes into .mmf files.\n"
+			  << "Options:\n"
+			  << "  -o <dir>         directory of the output files (default: next to the input files)\n"
+			  << "  -j <count>       number of files converted in parallel (default: hardware threads)\n"
+			  << "  -r               search the given directories recursively\n"
+			  << "  --dedup          eliminate duplicate vertices\n"
+			  << "  --optimize       optimize the indices for the vertex cache\n"
+			  << "  --quantize       store normals, colors and texture coordinates in compact formats\n"
+			  << "  --compress       compress the chunks of the .mmf files\n";
+}
+
+static bool isSupported(const Util::FileName & file) {
+	std::string ending = file.getEnding();
+	for(auto & c : ending)
+		c = static_cast<char>(std::tolower(c));
+	for(const auto & supported : SUPPORTED_ENDINGS) {
+		if(ending == supported)
+			return true;
+	}
+	return false;
+}
+
+static std::string removeEnding(const Util::FileName & file) {
+	Util::FileName f(file);
+	f.setEnding("");
+	std::string path = f.getDir() + f.getFile();
+	if(!path.empty() && path.back() == '.')
+		path.pop_back();
+	return path;
+}
+
+//! Collect the supported files of the given path (file or directory) and determine their output names.
+static void collectJobs(const std::string & path, const ConvertOptions & options, std::vector<ConvertJob> & jobs) {
+	const Util::FileName pathName(path);
+	if(!Util::FileUtils::isDir(Util::FileName::createDirName(path))) {
+		ConvertJob job;
+		job.input = pathName;
+		job.outputBase = options.outputDir.empty() ? removeEnding(pathName) : options.outputDir + '/' + removeEnding(Util::FileName(pathName.getFile()));
+		jobs.push_back(job);
+		return;
+	}
+	const Util::FileName dirName = Util::FileName::createDirName(path);
+	std::list<Util::FileName> files;
+	uint8_t flags = Util::FileUtils::DIR_FILES;
+	if(options.recursive)
+		flags |= Util::FileUtils::DIR_RECURSIVE;
+	if(!Util::FileUtils::getFilesInDir(dirName, files, flags)) {
+		std::cerr << "Cannot read directory \"" << path << "\".\n";
+		return;
+	}
+	const std::string baseDir = dirName.getDir();
+	for(const auto & file : files) {
+		if(!isSupported(file))
+			continue;
+		ConvertJob job;
+		job.input = file;
+		if(options.outputDir.empty()) {
+			job.outputBase = removeEnding(file);
+		} else {
+			// keep the structure of the sub-directories
+			std::string relative = removeEnding(file);
+			if(relative.compare(0, baseDir.size(), baseDir) == 0)
+				relative = relative.substr(baseDir.size());
+			job.outputBase = options.outputDir + '/' + relative;
+		}
+		jobs.push_back(job);
+	}
+}
+
+//! Append the input ending to output names used by several jobs; return false if the names still collide.
+static bool makeOutputNamesUnique(std::vector<ConvertJob> & jobs) {
+	std::map<std::string, size_t> jobCounts;
+	for(const auto & job : jobs)
+		++jobCounts[job.outputBase];
+	for(auto & job : jobs) {
+		if(jobCounts[job.outputBase] > 1)
+			job.outputBase += '.' + job.input.getEnding();
+	}
+	std::set<std::string> outputNames;
+	for(const auto & job : jobs) {
+		if(!outputNames.insert(job.outputBase).second) {
+			std::cerr << "Several input files would be converted into \"" << job.outputBase << '.'
+					  << Serialization::StreamerMMF::fileExtension << "\" (e.g. \"" << job.input.toString() << "\").\n";
+			return false;
+		}
+	}
+	return true;
+}
+
+//! Return the meshes contained in the descriptions; for key frame animations, the first frame is used.
+static std::vector<Util::Reference<Mesh>> extractMeshes(Util::GenericAttributeList & descriptions) {
+	std::vector<Util::Reference<Mesh>> meshes;
+	for(const auto & entry : descriptions) {
+		auto description = dynamic_cast<Util::GenericAttributeMap *>(entry.get());
+		if(description == nullptr)
+			continue;
+		auto meshWrapper = dynamic_cast<Serialization::MeshWrapper_t *>(description->getValue(Serialization::DESCRIPTION_DATA));
+		if(meshWrapper != nullptr) {
+			meshes.push_back(meshWrapper->get());
+			continue;
+		}
+		auto frames = dynamic_cast<Serialization::StreamerMD2::framesDataWrapper *>(description->getValue(Serialization::StreamerMD2::DESCRIPTION_KEYFRAMES_DATA));
+		auto compactFrames = dynamic_cast<Serialization::StreamerMD2::compactFramesWrapper *>(description->getValue(Serialization::StreamerMD2::DESCRIPTION_COMPACT_KEYFRAMES_DATA));
+		auto indices = dynamic_cast<Serialization::StreamerMD2::indexDataWrapper *>(description->getValue(Serialization::StreamerMD2::DESCRIPTION_MESH_INDEX_DATA));
+		if(indices == nullptr)
+			continue;
+		if(frames != nullptr && !frames->ref().empty())
+			meshes.push_back(new Mesh(MeshIndexData(indices->ref()), MeshVertexData(frames->ref().front())));
+		else if(compactFrames != nullptr && compactFrames->ref().isNotNull())
+			meshes.push_back(new Mesh(MeshIndexData(indices->ref()), MeshVertexData(compactFrames->ref()->getBaseFrame())));
+	}
+	return meshes;
+}
+
+static void processMesh(Mesh * mesh, const ConvertOptions & options) {
+	if(options.eliminateDuplicates && mesh->isUsingIndexData())
+		MeshUtils::eliminateDuplicateVertices(mesh);
+	if(options.optimizeIndices && mesh->isUsingIndexData() && mesh->getDrawMode() == Mesh::DRAW_TRIANGLES)
+		MeshUtils::optimizeIndices(mesh);
+	if(options.quantize) {
+		// the positions are kept, because the .mmf-format cannot store their decoding transformation
+		const VertexDescription compact = MeshUtils::createCompactVertexDescription(mesh->getVertexDescription(), false);
+		if(!(compact == mesh->getVertexDescription()))
+			MeshUtils::compressVertices(mesh, compact);
+	}
+}
+
+static ConvertResult convertFile(const ConvertJob & job, const ConvertOptions & options) {
+	ConvertResult result;
+	const auto start = std::chrono::steady_clock::now();
+	try {
+		result.inputSize = Util::FileUtils::fileSize(job.input);
+		std::unique_ptr<Util::GenericAttributeList> descriptions(Serialization::loadGeneric(job.input));
+		if(!descriptions) {
+			result.message = "cannot be loaded";
+			return result;
+		}
+		const auto meshes = extractMeshes(*descriptions);
+		descriptions.reset();
+		if(meshes.empty()) {
+			result.message = "contains no meshes";
+			return result;
+		}
+		Serialization::StreamerMMF streamer;
+		streamer.setCompression(options.compress);
+		for(size_t i = 0; i < meshes.size(); ++i) {
+			Mesh * mesh = meshes[i].get();
+			processMesh(mesh, options);
+
+			std::ostringstream outputName;
+			outputName << job.outputBase;
+			if(meshes.size() > 1)
+				outputName << '_' << i;
+			outputName << '.' << Serialization::StreamerMMF::fileExtension;
+			const Util::FileName outputFile(outputName.str());
+			{
+				auto output = Util::FileUtils::openForWriting(outputFile);
+				if(!output || !streamer.saveMesh(mesh, *output)) {
+					result.message = "cannot write \"" + outputFile.toString() + "\"";
+					return result;
+				}
+			}
+			result.outputSize += Util::FileUtils::fileSize(outputFile);
+			++result.meshCount;
+			result.vertexCount += mesh->getVertexCount();
+			if(mesh->getDrawMode() == Mesh::DRAW_TRIANGLES)
+				result.triangleCount += (mesh->isUsingIndexData() ? mesh->getIndexCount() : mesh->getVertexCount()) / 3;
+		}
+		result.success = true;
+	} catch(const std::exception & e) {
+		result.message = e.what();
+	}
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return result;
+}
+
+static void printResult(const ConvertJob & job, const ConvertResult & result) {
+	if(!result.success) {
+		std::cout << job.input.toString() << ": FAILED (" << result.message << ")\n";
+		return;
+	}
+	const double mib = 1024.0 * 1024.0;
+	std::cout << job.input.toString() << ": "
+			  << result.meshCount << " mesh(es), "
+			  << result.vertexCount << " vertices, "
+			  << result.triangleCount << " triangles, "
+			  << std::fixed << std::setprecision(2)
+			  << result.inputSize / mib << " MiB -> " << result.outputSize / mib << " MiB, "
+			  << std::setprecision(3) << result.seconds << " s, "
+			  << std::setprecision(1) << (result.seconds > 0 ? result.inputSize / mib / result.seconds : 0.0) << " MiB/s\n"
+			  << std::defaultfloat;
+}
+
+int main(int argc, char * argv[]) {
+	ConvertOptions options;
+	std::vector<std::string> paths;
+	for(int i = 1; i < argc; ++i) {
+		const std::string arg(argv[i]);
+		if(arg == "-o" && i + 1 < argc) {
+			options.outputDir = argv[++i];
+		} else if(arg == "-j" && i + 1 < argc) {
+			options.jobCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		} else if(arg == "-r") {
+			options.recursive = true;
+		} else if(arg == "--dedup") {
+			options.eliminateDuplicates = true;
+		} else if(arg == "--optimize") {
+			options.optimizeIndices = true;
+		} else if(arg == "--quantize") {
+			options.quantize = true;
+		} else if(arg == "--compress") {
+			options.compress = true;
+		} else if(arg == "-h" || arg == "--help") {
+			printUsage();
+			return EXIT_SUCCESS;
+		} else if(!arg.empty() && arg[0] == '-') {
+			std::cerr << "Unknown option \"" << arg << "\".\n";
+			printUsage();
+			return EXIT_FAILURE;
+		} else {
+			paths.push_back(arg);
+		}
+	}
+	if(paths.empty()) {
+		printUsage();
+		return EXIT_FAILURE;
+	}
+
+	Util::init();
+
+	std::vector<ConvertJob> jobs;
+	for(const auto & path : paths)
+		collectJobs(path, options, jobs);
+	if(!makeOutputNamesUnique(jobs))
+		return EXIT_FAILURE;
+	if(!options.outputDir.empty()) {
+		for(const auto & job : jobs)
+			Util::FileUtils::createDir(Util::FileName::createDirName(Util::FileName(job.outputBase).getDir()), true);
+	}
+
+	// the files are handed out one by one, as their sizes differ a lot
+	const uint32_t workerCount = std::min<uint32_t>(MeshUtils::getWorkerCount(options.jobCount), std::max<size_t>(1, jobs.size()));
+	std::atomic<size_t> nextJob(0);
+	std::mutex outputMutex;
+	ConvertResult total;
+	uint32_t failedCount = 0;
+	const auto start = std::chrono::steady_clock::now();
+	const auto work = [&]() {
+		for(size_t i = nextJob++; i < jobs.size(); i = nextJob++) {
+			const ConvertResult result = convertFile(jobs[i], options);
+			std::lock_guard<std::mutex> lock(outputMutex);
+			printResult(jobs[i], result);
+			if(!result.success) {
+				++failedCount;
+				continue;
+			}
+			total.meshCount += result.meshCount;
+			total.vertexCount += result.vertexCount;
+			total.triangleCount += result.triangleCount;
+			total.inputSize += result.inputSize;
+			total.outputSize += result.outputSize;
+		}
+	};
+	std::vector<std::thread> workers;
+	for(uint32_t i = 1; i < workerCount; ++i)
+		workers.emplace_back(work);
+	work();
+	for(auto & worker : workers)
+		worker.join();
+	total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	total.success = true;
+
+	ConvertJob summary;
+	summary.input = Util::FileName("Total (" + std::to_string(jobs.size() - failedCount) + " files, " + std::to_string(workerCount) + " threads)");
+	printResult(summary, total);
+	return failedCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,45 @@
+#
+# This file is part of the Rendering library.
+# Copyright (C) 2019 Sascha Brandt <sascha@brandt.graphics>
+#
+# This library is subject to the terms of the Mozilla Public License, v. 2.0.
+# You should have received a copy of the MPL along with this library; see the
+# file LICENSE. If not, you can obtain one at http://mozilla.org/MPL/2.0/.
+#
+# Smoke test of RenderingMeshConvert; run with
+#   cmake -DCONVERTER=<path of RenderingMeshConvert> -DWORK_DIR=<temporary directory> -P RenderingMeshConvertTest.cmake
+#
+
+function(convert)
+	execute_process(COMMAND "${CONVERTER}" ${ARGN} RESULT_VARIABLE result OUTPUT_VARIABLE output ERROR_VARIABLE output)
+	if(NOT result EQUAL 0)
+		message(FATAL_ERROR "RenderingMeshConvert ${ARGN} failed:\n${output}")
+	endif()
+endfunction()
+
+function(require_file path)
+	if(NOT EXISTS "${path}")
+		message(FATAL_ERROR "\"${path}\" has not been written.")
+	endif()
+	file(READ "${path}" content HEX LIMIT 4)
+	if(content STREQUAL "")
+		message(FATAL_ERROR "\"${path}\" is empty.")
+	endif()
+endfunction()
+
+file(REMOVE_RECURSE "${WORK_DIR}")
+file(MAKE_DIRECTORY "${WORK_DIR}/input")
+file(WRITE "${WORK_DIR}/input/quad.obj" "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nvn 0 0 1\nf 1//1 2//1 3//1 4//1\n")
+file(WRITE "${WORK_DIR}/input/quad.xyz" "0 0 0\n1 0 0\n1 1 0\n0 1 0\n")
+
+# a single file is written next to the input
+convert("${WORK_DIR}/input/quad.obj")
+require_file("${WORK_DIR}/input/quad.mmf")
+
+# files with the same name keep their ending
+convert(--dedup --optimize -o "${WORK_DIR}/output" "${WORK_DIR}/input")
+require_file("${WORK_DIR}/output/quad.obj.mmf")
+require_file("${WORK_DIR}/output/quad.xyz.mmf")
+if(EXISTS "${WORK_DIR}/output/quad.mmf")
+	message(FATAL_ERROR "The output of files with the same name has been written to \"quad.mmf\".")
+endif()